@@ -303,8 +303,20 @@ PyObject* PythonSink::pythonSinkGrab(PythonSinkObject* self)
     int triesLeft = SPLASH_PYTHON_MAX_TRIES;
     while (triesLeft)
     {
-        auto frame = self->sink->getBuffer();
-        if (frame.size() != self->width * self->height * 4 /* RGBA*/)
+        // The frame is copied straight from the sink buffer, or from its shared memory ring
+        PyObject* frame = nullptr;
+        auto frameIsValid = self->sink->readBuffer([&](const uint8_t* data, size_t size) {
+            if (size == self->width * self->height * 4 /* RGBA*/)
+                frame = PyByteArray_FromStringAndSize(reinterpret_cast<const char*>(data), size);
+        });
+
+        if (!frameIsValid)
+        {
+            // The frame has been overwritten while being copied
+            Py_XDECREF(frame);
+            --triesLeft;
+        }
+        else if (!frame)
         {
             --triesLeft;
             this_thread::sleep_for(chrono::milliseconds(5));
@@ -318,7 +330,7 @@ PyObject* PythonSink::pythonSinkGrab(PythonSinkObject* self)
         }
         else
         {
-            buffer = PyByteArray_FromStringAndSize(reinterpret_cast<char*>(frame.data()), frame.size());
+            buffer = frame;
             break;
         }
     }
@@ -45,6 +45,60 @@ void GuiGraph::render()
             ImGui::PlotLines(
                 "", values.data(), values.size(), values.size(), (duration.first + " - " + to_string((int)maxValue) + "ms").c_str(), 0.f, maxValue, ImVec2(width - 30, 80));
         }
+
+        drawFrameLatency();
+    }
+}
+
+/*************/
+void GuiGraph::drawFrameLatency()
+{
+    auto textures = getObjectsOfType("texture_image");
+    auto width = ImGui::GetWindowSize().x;
+    bool headerDrawn = false;
+
+    for (auto& texture : textures)
+    {
+        auto latency = getObjectAttribute(texture->getName(), "frameLatency");
+        auto histogramValue = getObjectAttribute(texture->getName(), "frameLatencyHistogram");
+        if (latency.size() != 4 || histogramValue.size() != 1)
+            continue;
+
+        auto histogram = histogramValue[0].as<Values>();
+        float maxCount{0.f};
+        vector<float> counts;
+        for (auto& count : histogram)
+        {
+            counts.push_back(count.as<float>());
+            maxCount = std::max(maxCount, counts.back());
+        }
+
+        // Textures which never displayed a timestamped frame are skipped
+        if (maxCount == 0.f)
+            continue;
+
+        if (!headerDrawn)
+        {
+            ImGui::Text("Frame latency, from capture to buffer swap");
+            headerDrawn = true;
+        }
+
+        auto dropped = getObjectAttribute(texture->getName(), "droppedFrames");
+        auto duplicated = getObjectAttribute(texture->getName(), "duplicatedFrames");
+        ImGui::Text("%s - mean %.1fms, 95%% %.1fms, max %.1fms - dropped %i, duplicated %i",
+            texture->getAlias().c_str(),
+            latency[1].as<float>(),
+            latency[2].as<float>(),
+            latency[3].as<float>(),
+            dropped[0].as<int>(),
+            duplicated[0].as<int>());
+
+        string buckets = "<2, 4, 8, 16, 25, 33, 50, 66, 100, 150, 250, 500, >500ms";
+        ImGui::PushID(texture->getName().c_str());
+        ImGui::PlotHistogram("", counts.data(), counts.size(), 0, buckets.c_str(), 0.f, maxCount, ImVec2(width - 30, 80));
+        if (ImGui::Button("Reset"))
+            setObjectAttribute(texture->getName(), "resetFrameStats", {});
+        ImGui::PopID();
     }
 }
 
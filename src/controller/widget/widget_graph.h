@@ -43,6 +43,11 @@ class GuiGraph : public GuiWidget
   private:
     unsigned int _maxHistoryLength{300};
     std::map<std::string, std::deque<unsigned long long>> _durationGraph;
+
+    /**
+     * Draw the frame latency histograms of all image textures
+     */
+    void drawFrameLatency();
 };
 
 } // end of namespace
@@ -36,8 +36,8 @@ void BufferObject::setSerializedObject(shared_ptr<SerializedObject> obj)
         _newSerializedObject = true;
 
         // Deserialize it right away, in a separate thread
+        // The write mutex is locked by the implementations, once the object is parsed
         _deserializeFuture = async(launch::async, [this]() {
-            lock_guard<shared_timed_mutex> lock(_writeMutex);
             deserialize();
             _serializedObjectWaiting.store(false, std::memory_order_acq_rel);
         });
@@ -83,7 +83,7 @@ class BufferObject : public GraphObject
     void setNotUpdated();
 
     /**
-     * \brief Update the BufferObject from a serialized representation.
+     * \brief Update the BufferObject from a serialized representation. Implementations lock the write mutex while they modify the object
      * \param obj Serialized object to use as source
      * \return Return true if everything went well
      */
@@ -108,7 +108,7 @@ class BufferObject : public GraphObject
     int64_t getTimestamp() const { return _timestamp; }
 
     /**
-     * \brief Serialize the object
+     * \brief Serialize the object. Large data can be referenced as the payload of the serialized object instead of being copied
      * \return Return a serialized representation of the object
      */
     virtual std::shared_ptr<SerializedObject> serialize() const = 0;
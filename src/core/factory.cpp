@@ -16,9 +16,12 @@
 #include "./graphics/window.h"
 #include "./image/image.h"
 #include "./image/image_ffmpeg.h"
+#include "./image/image_raw.h"
+#include "./image/image_sequence.h"
 #include "./image/queue.h"
 #include "./mesh/mesh.h"
 #include "./sink/sink.h"
+#include "./sink/sink_file.h"
 #include "./utils/log.h"
 #include "./utils/timer.h"
 
@@ -296,6 +299,34 @@ void Factory::registerObjects()
         "Image object reading frames from a video file.",
         true);
 
+    _objectBook["image_sequence"] = Page(
+        [&](RootObject* root) {
+            shared_ptr<GraphObject> object;
+            if (!_scene)
+                object = dynamic_pointer_cast<GraphObject>(make_shared<Image_Sequence>(root));
+            else
+                object = dynamic_pointer_cast<GraphObject>(make_shared<Image>(root));
+            return object;
+        },
+        GraphObject::Category::IMAGE,
+        "image sequence",
+        "Image object playing a sequence of numbered image files (PNG, TGA, EXR, DDS...).",
+        true);
+
+    _objectBook["image_raw"] = Page(
+        [&](RootObject* root) {
+            shared_ptr<GraphObject> object;
+            if (!_scene)
+                object = dynamic_pointer_cast<GraphObject>(make_shared<Image_Raw>(root));
+            else
+                object = dynamic_pointer_cast<GraphObject>(make_shared<Image>(root));
+            return object;
+        },
+        GraphObject::Category::IMAGE,
+        "raw frames",
+        "Image object playing a Splash raw frames container, as created by splash-raw-converter.",
+        true);
+
 #if HAVE_GPHOTO
     _objectBook["image_gphoto"] = Page(
         [&](RootObject* root) {
@@ -371,6 +402,11 @@ void Factory::registerObjects()
         "sink a texture to a host buffer",
         "Get the texture content to a host buffer. Only used internally.");
 
+    _objectBook["sink_file"] = Page([&](RootObject* root) { return dynamic_pointer_cast<GraphObject>(make_shared<Sink_File>(root)); },
+        GraphObject::Category::MISC,
+        "sink a texture to a file",
+        "Records the connected texture to a file, either as raw frames playable with image_raw or encoded with FFmpeg.");
+
 #if HAVE_SHMDATA
     _objectBook["sink_shmdata"] = Page([&](RootObject* root) { return dynamic_pointer_cast<GraphObject>(make_shared<Sink_Shmdata>(root)); },
         GraphObject::Category::MISC,
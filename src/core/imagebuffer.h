@@ -140,10 +140,10 @@ class ImageBufferSpec
     int pixelBytes() const { return bpp / 8; }
 
     /**
-     * \brief Get image size in bytes
+     * \brief Get image size in bytes. Computed from the bits per pixel, to handle subsampled formats like I420
      * \return Return image size
      */
-    int rawSize() const { return pixelBytes() * width * height; }
+    int rawSize() const { return static_cast<int>(static_cast<int64_t>(width) * height * bpp / 8); }
 };
 
 /*************/
@@ -161,6 +161,13 @@ class ImageBuffer
      */
     ImageBuffer(const ImageBufferSpec& spec);
 
+    /**
+     * \brief Constructor taking ownership of an existing buffer, to use with caution, its size must be at least the spec raw size
+     * \param spec Image spec
+     * \param buffer Buffer to use as inner buffer
+     */
+    ImageBuffer(const ImageBufferSpec& spec, ResizableArray<char>&& buffer);
+
     /**
      * \brief Destructor
      */
@@ -189,6 +196,12 @@ class ImageBuffer
      */
     size_t getSize() const { return _buffer.size(); }
 
+    /**
+     * \brief Check whether the data is a view over memory not owned by this buffer
+     * \return Return true if the buffer is external
+     */
+    bool isExternal() const { return _buffer.isExternal(); }
+
     /**
      * \brief Fill all channels with the given value
      * \param value Value to fill the image with
@@ -201,9 +214,35 @@ class ImageBuffer
      */
     void setRawBuffer(ResizableArray<char>&& buffer) { _buffer = std::move(buffer); }
 
+    /**
+     * \brief Get the time at which the frame was captured or decoded
+     * \return Return the timestamp in us, as given by Timer::getTime(), or -1 if not set
+     */
+    int64_t getTimestamp() const { return _timestamp; }
+
+    /**
+     * \brief Set the time at which the frame was captured or decoded
+     * \param timestamp Timestamp in us
+     */
+    void setTimestamp(int64_t timestamp) { _timestamp = timestamp; }
+
+    /**
+     * \brief Get the frame sequence number, incremented by the producer for each frame
+     * \return Return the sequence number, or 0 if not set
+     */
+    uint64_t getSequence() const { return _sequence; }
+
+    /**
+     * \brief Set the frame sequence number
+     * \param sequence Sequence number
+     */
+    void setSequence(uint64_t sequence) { _sequence = sequence; }
+
   private:
     ImageBufferSpec _spec{};
     ResizableArray<char> _buffer;
+    int64_t _timestamp{-1};
+    uint64_t _sequence{0};
 
     /**
      * \brief Initialization
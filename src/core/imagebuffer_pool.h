@@ -0,0 +1,124 @@
+/*
+ * Copyright (C) 2015 Emmanuel Durand
+ *
+ * This file is part of Splash.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Splash is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Splash.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * @imagebuffer_pool.h
+ * The ImageBufferPool class, recycling image buffers once they are not referenced anymore
+ */
+
+#ifndef SPLASH_IMAGEBUFFER_POOL_H
+#define SPLASH_IMAGEBUFFER_POOL_H
+
+#include <deque>
+#include <memory>
+#include <mutex>
+
+#include "./core/imagebuffer.h"
+
+namespace Splash
+{
+
+/*************/
+class ImageBufferPool : public std::enable_shared_from_this<ImageBufferPool>
+{
+  public:
+    /**
+     * \brief Constructor. The pool must be held by a shared_ptr
+     * \param maxFreeBuffers Maximum number of unused buffers kept in the pool
+     */
+    explicit ImageBufferPool(size_t maxFreeBuffers = 4)
+        : _maxFreeBuffers(maxFreeBuffers)
+    {
+    }
+
+    ImageBufferPool(const ImageBufferPool&) = delete;
+    ImageBufferPool& operator=(const ImageBufferPool&) = delete;
+
+    /**
+     * \brief Get an unused buffer with the given spec, if any
+     * \param spec Buffer spec
+     * \return Return a buffer, or nullptr if none matches the spec
+     */
+    std::unique_ptr<ImageBuffer> tryAcquire(const ImageBufferSpec& spec)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        for (auto it = _freeBuffers.begin(); it != _freeBuffers.end(); ++it)
+        {
+            if ((*it)->getSpec() != spec)
+                continue;
+            auto buffer = std::move(*it);
+            _freeBuffers.erase(it);
+            return buffer;
+        }
+        return {};
+    }
+
+    /**
+     * \brief Get a buffer with the given spec, allocating it if no unused one matches the spec
+     * \param spec Buffer spec
+     * \return Return a buffer
+     */
+    std::unique_ptr<ImageBuffer> acquire(const ImageBufferSpec& spec)
+    {
+        auto buffer = tryAcquire(spec);
+        if (!buffer)
+            buffer = std::unique_ptr<ImageBuffer>(new ImageBuffer(spec));
+        return buffer;
+    }
+
+    /**
+     * \brief Give a buffer back to the pool. Buffers viewing external memory are not kept, to release that memory
+     * \param buffer Buffer, always taken from the caller
+     */
+    void release(std::unique_ptr<ImageBuffer> buffer)
+    {
+        if (!buffer || buffer->isExternal())
+            return;
+
+        std::lock_guard<std::mutex> lock(_mutex);
+        _freeBuffers.push_back(std::move(buffer));
+        // The oldest buffers are the less likely to match the next requests
+        while (_freeBuffers.size() > _maxFreeBuffers)
+            _freeBuffers.pop_front();
+    }
+
+    /**
+     * \brief Share a buffer, which goes back to the pool once the last reference to it is released
+     * \param buffer Buffer
+     * \return Return the shared buffer
+     */
+    std::shared_ptr<ImageBuffer> share(std::unique_ptr<ImageBuffer>&& buffer)
+    {
+        std::weak_ptr<ImageBufferPool> pool = shared_from_this();
+        return std::shared_ptr<ImageBuffer>(buffer.release(), [pool](ImageBuffer* released) {
+            auto owned = std::unique_ptr<ImageBuffer>(released);
+            if (auto sharedPool = pool.lock())
+                sharedPool->release(std::move(owned));
+        });
+    }
+
+  private:
+    std::mutex _mutex{};
+    std::deque<std::unique_ptr<ImageBuffer>> _freeBuffers{};
+    size_t _maxFreeBuffers{4};
+};
+
+} // end of namespace
+
+#endif // SPLASH_IMAGEBUFFER_POOL_H
@@ -202,8 +202,21 @@ bool Link::sendBuffer(const string& name, shared_ptr<SerializedObject> buffer)
             memcpy(msg.data(), (void*)name.c_str(), name.size() + 1);
             _socketBufferOut->send(msg, ZMQ_SNDMORE);
 
-            msg.rebuild(bufferPtr->data(), bufferPtr->size(), Link::freeOlderBuffer, this);
-            _socketBufferOut->send(msg);
+            if (!bufferPtr->payload())
+            {
+                msg.rebuild(bufferPtr->data(), bufferPtr->size(), Link::freeOlderBuffer, this);
+                _socketBufferOut->send(msg);
+            }
+            else
+            {
+                // The header is small enough to be copied, the payload is sent as a separate part without copy
+                msg.rebuild(bufferPtr->size());
+                memcpy(msg.data(), bufferPtr->data(), bufferPtr->size());
+                _socketBufferOut->send(msg, ZMQ_SNDMORE);
+
+                msg.rebuild(const_cast<char*>(bufferPtr->payload()), bufferPtr->payloadSize(), Link::freeOlderBuffer, this);
+                _socketBufferOut->send(msg);
+            }
         }
         catch (const zmq::error_t& e)
         {
@@ -321,8 +334,12 @@ void Link::freeOlderBuffer(void* data, void* hint)
     lock_guard<Spinlock> lock(ctx->_otgMutex);
     uint32_t index = 0;
     for (; index < ctx->_otgBuffers.size(); ++index)
-        if (ctx->_otgBuffers[index]->data() == data)
+    {
+        auto& buffer = ctx->_otgBuffers[index];
+        auto sentData = buffer->payload() ? buffer->payload() : buffer->data();
+        if (sentData == data)
             break;
+    }
 
     if (index >= ctx->_otgBuffers.size())
     {
@@ -432,6 +449,14 @@ void Link::handleInputBuffers()
             _socketBufferIn->recv(&msg);
             shared_ptr<SerializedObject> buffer = make_shared<SerializedObject>((char*)msg.data(), (char*)msg.data() + msg.size());
 
+            // Buffers sent with a payload are received as a second part, which is kept as is and referenced by the buffer
+            if (msg.more())
+            {
+                auto payload = make_shared<zmq::message_t>();
+                _socketBufferIn->recv(payload.get());
+                buffer->setPayload(static_cast<const char*>(payload->data()), payload->size(), payload);
+            }
+
             if (_rootObject)
                 _rootObject->setFromSerializedObject(name, std::move(buffer));
         }
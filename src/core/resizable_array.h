@@ -26,6 +26,7 @@
 #define SPLASH_RESIZABLE_ARRAY_H
 
 #include <cstring>
+#include <functional>
 #include <memory>
 
 namespace Splash
@@ -64,6 +65,24 @@ class ResizableArray
         memcpy(_buffer.get(), start, _size * sizeof(T));
     }
 
+    /**
+     * \brief Constructor wrapping an external buffer, which is not copied nor owned
+     * \param buffer Pointer to the external buffer
+     * \param size Buffer size
+     * \param release Function called when the array does not use the buffer anymore
+     */
+    ResizableArray(T* buffer, size_t size, std::function<void()> release)
+        : _size(size)
+        , _external(buffer)
+        , _release(std::move(release))
+    {
+    }
+
+    /**
+     * \brief Destructor
+     */
+    ~ResizableArray() { releaseExternal(); }
+
     /**
      * \brief Copy constructor
      * \param a ResizableArray to copy
@@ -84,7 +103,11 @@ class ResizableArray
         : _size(a._size)
         , _shift(a._shift)
         , _buffer(std::move(a._buffer))
+        , _external(a._external)
+        , _release(std::move(a._release))
     {
+        a._external = nullptr;
+        a._release = nullptr;
     }
 
     /**
@@ -96,6 +119,7 @@ class ResizableArray
         if (this == &a)
             return *this;
 
+        releaseExternal();
         _size = a.size();
         _shift = 0;
         _buffer = std::unique_ptr<T[]>(new T[_size]);
@@ -113,9 +137,14 @@ class ResizableArray
         if (this == &a)
             return *this;
 
+        releaseExternal();
         _size = a._size;
         _shift = a._shift;
         _buffer = std::move(a._buffer);
+        _external = a._external;
+        _release = std::move(a._release);
+        a._external = nullptr;
+        a._release = nullptr;
 
         return *this;
     }
@@ -131,7 +160,7 @@ class ResizableArray
      * \brief Get a pointer to the data
      * \return Return a pointer to the data
      */
-    inline T* data() const { return _buffer.get() + _shift; }
+    inline T* data() const { return (_external ? _external : _buffer.get()) + _shift; }
 
     /**
      * \brief Shift the data, for example to get rid of a header without copying
@@ -152,6 +181,12 @@ class ResizableArray
      */
     inline size_t size() const { return _size; }
 
+    /**
+     * \brief Check whether the array wraps an external buffer
+     * \return Return true if the buffer is external
+     */
+    inline bool isExternal() const { return _external != nullptr; }
+
     /**
      * \brief Resize the buffer
      * \param size New size
@@ -163,15 +198,18 @@ class ResizableArray
             _size = 0;
             _shift = 0;
             _buffer.reset(nullptr);
+            releaseExternal();
         }
 
         auto newBuffer = std::unique_ptr<T[]>(new T[size]);
+        auto source = _external ? data() : _buffer.get();
         if (size >= _size)
-            memcpy(newBuffer.get(), _buffer.get(), _size);
+            memcpy(newBuffer.get(), source, _size);
         else
-            memcpy(newBuffer.get(), _buffer.get(), size);
+            memcpy(newBuffer.get(), source, size);
 
         std::swap(_buffer, newBuffer);
+        releaseExternal();
         _size = size;
         _shift = 0;
     }
@@ -180,6 +218,22 @@ class ResizableArray
     size_t _size{0};                       //!< Buffer size
     size_t _shift{0};                      //!< Buffer shift
     std::unique_ptr<T[]> _buffer{nullptr}; //!< Pointer to the buffer data
+    T* _external{nullptr};                 //!< Pointer to an external buffer, if any
+    std::function<void()> _release{};      //!< Called when the external buffer is not used anymore
+
+    /**
+     * \brief Stop using the external buffer, if any
+     */
+    inline void releaseExternal()
+    {
+        _external = nullptr;
+        if (_release)
+        {
+            auto release = std::move(_release);
+            _release = nullptr;
+            release();
+        }
+    }
 };
 
 } // end of namespace
@@ -0,0 +1,202 @@
+/*
+ * Copyright (C) 2018 Emmanuel Durand
+ *
+ * This file is part of Splash.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Splash is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Splash.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * @ring_buffer.h
+ * Lock-free ring buffer, for a single producer and a single consumer
+ */
+
+#ifndef SPLASH_RING_BUFFER_H
+#define SPLASH_RING_BUFFER_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <type_traits>
+
+namespace Splash
+{
+
+/*************/
+template <typename T>
+class RingBuffer
+{
+    static_assert(std::is_trivially_copyable<T>::value, "RingBuffer only holds trivially copyable types");
+
+  public:
+    /**
+     * \brief Constructor. The storage is allocated once and for all
+     * \param capacity Minimum capacity, rounded up to the next power of two
+     */
+    explicit RingBuffer(size_t capacity)
+    {
+        _capacity = 1;
+        while (_capacity < capacity)
+            _capacity <<= 1;
+        _mask = _capacity - 1;
+        _buffer = std::unique_ptr<T[]>(new T[_capacity]);
+    }
+
+    RingBuffer(const RingBuffer&) = delete;
+    RingBuffer& operator=(const RingBuffer&) = delete;
+
+    /**
+     * \brief Get the capacity of the buffer
+     * \return Return the capacity, in elements
+     */
+    size_t capacity() const { return _capacity; }
+
+    /**
+     * \brief Get the number of queued elements. Can be called from any thread, in which case it is only an estimate
+     * \return Return the queued element count, including flushed elements not yet dropped by the consumer
+     */
+    size_t getSize() const
+    {
+        // The read index is loaded first, as it can not get past the write index loaded afterwards
+        auto readIndex = _readIndex.load(std::memory_order_acquire);
+        return _writeIndex.load(std::memory_order_acquire) - readIndex;
+    }
+
+    /**
+     * Producer side
+     */
+    /**
+     * \brief Get the free space
+     * \return Return the number of elements which can be written
+     */
+    size_t getWriteSpace() const { return _capacity - (_writeIndex.load(std::memory_order_relaxed) - _readIndex.load(std::memory_order_acquire)); }
+
+    /**
+     * \brief Copy elements after the write position. They are not visible to the consumer until commitWrite is called
+     * \param offset Offset from the write position, in elements
+     * \param data Elements to copy
+     * \param count Element count. offset + count must not exceed the free space
+     */
+    void copyIn(size_t offset, const T* data, size_t count)
+    {
+        auto start = (_writeIndex.load(std::memory_order_relaxed) + offset) & _mask;
+        auto firstPart = std::min(count, _capacity - start);
+        std::memcpy(&_buffer[start], data, firstPart * sizeof(T));
+        if (firstPart < count)
+            std::memcpy(&_buffer[0], data + firstPart, (count - firstPart) * sizeof(T));
+    }
+
+    /**
+     * \brief Make written elements visible to the consumer
+     * \param count Element count
+     */
+    void commitWrite(size_t count) { _writeIndex.store(_writeIndex.load(std::memory_order_relaxed) + count, std::memory_order_release); }
+
+    /**
+     * \brief Write elements, only if they all fit
+     * \param data Elements to write
+     * \param count Element count
+     * \return Return false if there was not enough space
+     */
+    bool push(const T* data, size_t count)
+    {
+        if (getWriteSpace() < count)
+            return false;
+        copyIn(0, data, count);
+        commitWrite(count);
+        return true;
+    }
+
+    /**
+     * Consumer side
+     */
+    /**
+     * \brief Get the number of elements available for reading. Also applies any pending flush
+     * \return Return the readable element count
+     */
+    size_t getReadSpace()
+    {
+        auto readIndex = _readIndex.load(std::memory_order_relaxed);
+        auto flushIndex = _flushIndex.load(std::memory_order_acquire);
+        if (flushIndex > readIndex)
+        {
+            readIndex = flushIndex;
+            _readIndex.store(readIndex, std::memory_order_release);
+        }
+        return _writeIndex.load(std::memory_order_acquire) - readIndex;
+    }
+
+    /**
+     * \brief Copy elements after the read position, without consuming them
+     * \param offset Offset from the read position, in elements
+     * \param data Destination
+     * \param count Element count. offset + count must not exceed the readable space
+     */
+    void copyOut(size_t offset, T* data, size_t count) const
+    {
+        auto start = (_readIndex.load(std::memory_order_relaxed) + offset) & _mask;
+        auto firstPart = std::min(count, _capacity - start);
+        std::memcpy(data, &_buffer[start], firstPart * sizeof(T));
+        if (firstPart < count)
+            std::memcpy(data + firstPart, &_buffer[0], (count - firstPart) * sizeof(T));
+    }
+
+    /**
+     * \brief Release read elements to the producer
+     * \param count Element count
+     */
+    void commitRead(size_t count) { _readIndex.store(_readIndex.load(std::memory_order_relaxed) + count, std::memory_order_release); }
+
+    /**
+     * \brief Read elements, only if enough are available
+     * \param data Destination
+     * \param count Element count
+     * \return Return false if there was not enough elements
+     */
+    bool pop(T* data, size_t count)
+    {
+        if (getReadSpace() < count)
+            return false;
+        copyOut(0, data, count);
+        commitRead(count);
+        return true;
+    }
+
+    /**
+     * \brief Discard everything written so far. Can be called from any thread, the consumer drops the data on its next call to getReadSpace
+     */
+    void flush()
+    {
+        auto writeIndex = _writeIndex.load(std::memory_order_acquire);
+        auto flushIndex = _flushIndex.load(std::memory_order_relaxed);
+        while (flushIndex < writeIndex && !_flushIndex.compare_exchange_weak(flushIndex, writeIndex, std::memory_order_release, std::memory_order_relaxed))
+            continue;
+    }
+
+  private:
+    std::unique_ptr<T[]> _buffer{nullptr};
+    size_t _capacity{0};
+    size_t _mask{0};
+
+    // Indices grow monotonically and are wrapped with _mask on access, so that a full and an empty buffer can be told apart
+    std::atomic<uint64_t> _writeIndex{0};
+    std::atomic<uint64_t> _readIndex{0};
+    std::atomic<uint64_t> _flushIndex{0};
+};
+
+} // end of namespace
+
+#endif // SPLASH_RING_BUFFER_H
@@ -413,6 +413,12 @@ void Scene::render()
                 if (obj.second->getType() == "window")
                     dynamic_pointer_cast<Window>(obj.second)->swapBuffers();
             Timer::get() >> "swap";
+
+            // Record the age of the frames which have just been displayed
+            auto swapTime = Timer::getTime();
+            for (auto& obj : _objects)
+                if (obj.second->getType() == "texture_image")
+                    dynamic_pointer_cast<Texture_Image>(obj.second)->recordFrameLatency(swapTime);
         }
     }
 
@@ -427,8 +433,11 @@ void Scene::run()
     _textureUploadFuture = async(std::launch::async, [&]() { textureUploadRun(); });
 
     _mainWindow->setAsCurrentContext();
+    int reservedCoresVersion = 0;
     while (_isRunning)
     {
+        pinToReservedCores(reservedCoresVersion);
+
         // This gets the whole loop duration
         if (_runInBackground && _swapInterval != 0)
         {
@@ -486,13 +495,39 @@ void Scene::updateInputs()
         sendMessageToWorld("quit");
 }
 
+/*************/
+void Scene::pinToReservedCores(int& appliedVersion)
+{
+    auto version = _reservedCoresVersion.load();
+    if (version == appliedVersion)
+        return;
+    appliedVersion = version;
+
+    vector<int> cores;
+    {
+        lock_guard<mutex> lock(_reservedCoresMutex);
+        cores = _reservedCores;
+    }
+
+    // No reserved cores means that the thread can run anywhere
+    if (cores.empty())
+        for (int core = 0; core < Utils::getCoreCount(); ++core)
+            cores.push_back(core);
+
+    if (!Utils::setAffinity(cores))
+        Log::get() << Log::WARNING << "Scene::" << __FUNCTION__ << " - Unable to set the CPU affinity of the render threads" << Log::endl;
+}
+
 /*************/
 void Scene::textureUploadRun()
 {
     _textureUploadWindow->setAsCurrentContext();
 
+    int reservedCoresVersion = 0;
     while (_isRunning)
     {
+        pinToReservedCores(reservedCoresVersion);
+
         if (!_started)
         {
             this_thread::sleep_for(chrono::milliseconds(50));
@@ -1200,6 +1235,27 @@ void Scene::registerAttributes()
         {'s'});
     setAttributeDescription("mediaPath", "Path to the media files");
 
+    addAttribute("reservedCores",
+        [&](const Values& args) {
+            {
+                lock_guard<mutex> lock(_reservedCoresMutex);
+                _reservedCores.clear();
+                for (const auto& arg : args)
+                    _reservedCores.push_back(arg.as<int>());
+            }
+            ++_reservedCoresVersion;
+            return true;
+        },
+        [&]() -> Values {
+            lock_guard<mutex> lock(_reservedCoresMutex);
+            Values cores;
+            for (auto core : _reservedCores)
+                cores.push_back(core);
+            return cores;
+        },
+        {});
+    setAttributeDescription("reservedCores", "CPU cores to run the render and texture upload threads on. Empty to run them on any core");
+
     addAttribute("runInBackground",
         [&](const Values& args) {
             _runInBackground = args[0].as<bool>();
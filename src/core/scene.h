@@ -255,6 +255,11 @@ class Scene : public RootObject
     Spinlock _textureMutex; //!< Sync between texture and render loops
     GLsync _textureUploadFence{nullptr}, _cameraDrawnFence{nullptr};
 
+    // CPU cores the render and texture upload threads are pinned to, kept free from video decoders
+    std::mutex _reservedCoresMutex{};
+    std::vector<int> _reservedCores{};
+    std::atomic_int _reservedCoresVersion{0}; //!< Incremented when _reservedCores changes, for each thread to update its affinity
+
     // NV Swap group specific
     GLuint _maxSwapGroups{0};
     GLuint _maxSwapBarriers{0};
@@ -295,6 +300,12 @@ class Scene : public RootObject
     static void glMsgCallback(GLenum, GLenum, GLuint, GLenum, GLsizei, const GLchar*, void*);
 #endif
 
+    /**
+     * \brief Pin the calling thread to the reserved cores, if they changed since the last call
+     * \param appliedVersion Version of the reserved cores last applied to this thread
+     */
+    void pinToReservedCores(int& appliedVersion);
+
     /**
      * \brief Texture update loop
      */
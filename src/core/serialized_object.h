@@ -25,6 +25,8 @@
 #ifndef SPLASH_SERIALIZED_OBJECT_H
 #define SPLASH_SERIALIZED_OBJECT_H
 
+#include <memory>
+
 #include "./core/resizable_array.h"
 
 namespace Splash
@@ -78,8 +80,38 @@ struct SerializedObject
      */
     void resize(size_t s) { _data.resize(s); }
 
+    /**
+     * \brief Set a payload which logically follows the inner buffer, but is only referenced. This allows for sending large buffers without copying them
+     * \param data Pointer to the payload
+     * \param size Payload size
+     * \param owner Object owning the payload, kept alive as long as the SerializedObject. The payload must not be modified meanwhile
+     */
+    void setPayload(const char* data, size_t size, std::shared_ptr<const void> owner)
+    {
+        _payload = data;
+        _payloadSize = size;
+        _payloadOwner = std::move(owner);
+    }
+
+    /**
+     * \brief Get the pointer to the payload
+     * \return Return a pointer to the payload, or nullptr if there is none
+     */
+    const char* payload() const { return _payload; }
+
+    /**
+     * \brief Get the size of the payload
+     * \return Return the size
+     */
+    std::size_t payloadSize() const { return _payloadSize; }
+
     //! Inner buffer
     ResizableArray<char> _data{};
+
+  private:
+    const char* _payload{nullptr};
+    std::size_t _payloadSize{0};
+    std::shared_ptr<const void> _payloadOwner{nullptr};
 };
 
 } // end of namespace
@@ -0,0 +1,221 @@
+#include "./core/shared_frame_ring.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "./utils/log.h"
+
+using namespace std;
+
+namespace Splash
+{
+
+static_assert(sizeof(SharedFrameRing::RingHeader) == 64, "SharedFrameRing::RingHeader layout is part of the shared memory format");
+static_assert(sizeof(SharedFrameRing::SlotHeader) == 128, "SharedFrameRing::SlotHeader layout is part of the shared memory format");
+static_assert(sizeof(atomic<uint64_t>) == sizeof(uint64_t), "Atomics stored in shared memory must not hold a lock");
+
+/*************/
+// POSIX shared memory names have to start with a slash
+static string getShmName(const string& name)
+{
+    if (!name.empty() && name[0] == '/')
+        return name;
+    return "/" + name;
+}
+
+/*************/
+unique_ptr<SharedFrameRing> SharedFrameRing::create(const string& name, uint32_t slotCount, size_t slotSize)
+{
+    if (slotCount < 2 || slotSize == 0)
+        return nullptr;
+
+    auto shmName = getShmName(name);
+    shm_unlink(shmName.c_str());
+    auto fd = shm_open(shmName.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+    if (fd < 0)
+    {
+        Log::get() << Log::WARNING << "SharedFrameRing::" << __FUNCTION__ << " - Unable to create shared memory " << shmName << ": " << string(strerror(errno)) << Log::endl;
+        return nullptr;
+    }
+
+    // Slots are page aligned, so that the pixels are suitably aligned for any consumer
+    auto pageSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    auto slotStride = (sizeof(SlotHeader) + slotSize + pageSize - 1) / pageSize * pageSize;
+    auto memorySize = sizeof(RingHeader) + slotStride * slotCount;
+
+    if (ftruncate(fd, memorySize) != 0)
+    {
+        Log::get() << Log::WARNING << "SharedFrameRing::" << __FUNCTION__ << " - Unable to allocate shared memory " << shmName << ": " << string(strerror(errno)) << Log::endl;
+        close(fd);
+        shm_unlink(shmName.c_str());
+        return nullptr;
+    }
+
+    struct stat fileStat;
+    fstat(fd, &fileStat);
+    auto memory = mmap(nullptr, memorySize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (memory == MAP_FAILED)
+    {
+        Log::get() << Log::WARNING << "SharedFrameRing::" << __FUNCTION__ << " - Unable to map shared memory " << shmName << ": " << string(strerror(errno)) << Log::endl;
+        shm_unlink(shmName.c_str());
+        return nullptr;
+    }
+
+    auto ring = unique_ptr<SharedFrameRing>(new SharedFrameRing());
+    ring->_name = shmName;
+    ring->_isWriter = true;
+    ring->_inode = fileStat.st_ino;
+    ring->_memory = reinterpret_cast<uint8_t*>(memory);
+    ring->_memorySize = memorySize;
+    ring->_header = reinterpret_cast<RingHeader*>(memory);
+
+    // The memory is zero-filled by ftruncate, so that every slot state is already 0
+    auto header = ring->_header;
+    header->version = version;
+    header->slotCount = slotCount;
+    header->slotSize = slotSize;
+    header->slotStride = slotStride;
+    header->closed.store(0, memory_order_relaxed);
+    header->lastSequence.store(0, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    header->magic = magic;
+
+    return ring;
+}
+
+/*************/
+unique_ptr<SharedFrameRing> SharedFrameRing::open(const string& name)
+{
+    auto shmName = getShmName(name);
+    auto fd = shm_open(shmName.c_str(), O_RDONLY, 0);
+    if (fd < 0)
+        return nullptr;
+
+    struct stat fileStat;
+    if (fstat(fd, &fileStat) != 0 || static_cast<size_t>(fileStat.st_size) < sizeof(RingHeader))
+    {
+        close(fd);
+        return nullptr;
+    }
+
+    auto memorySize = static_cast<size_t>(fileStat.st_size);
+    auto memory = mmap(nullptr, memorySize, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (memory == MAP_FAILED)
+        return nullptr;
+
+    auto header = reinterpret_cast<RingHeader*>(memory);
+    if (header->magic != magic || header->version != version || header->slotCount == 0 || sizeof(RingHeader) + header->slotStride * header->slotCount > memorySize)
+    {
+        munmap(memory, memorySize);
+        return nullptr;
+    }
+    atomic_thread_fence(memory_order_acquire);
+
+    auto ring = unique_ptr<SharedFrameRing>(new SharedFrameRing());
+    ring->_name = shmName;
+    ring->_memory = reinterpret_cast<uint8_t*>(memory);
+    ring->_memorySize = memorySize;
+    ring->_header = header;
+
+    return ring;
+}
+
+/*************/
+SharedFrameRing::~SharedFrameRing()
+{
+    if (!_memory)
+        return;
+
+    if (_isWriter)
+    {
+        _header->closed.store(1, memory_order_release);
+
+        // The name may already have been taken over by a newer ring
+        auto fd = shm_open(_name.c_str(), O_RDONLY, 0);
+        if (fd >= 0)
+        {
+            struct stat fileStat;
+            if (fstat(fd, &fileStat) == 0 && fileStat.st_ino == _inode)
+                shm_unlink(_name.c_str());
+            close(fd);
+        }
+    }
+
+    munmap(_memory, _memorySize);
+}
+
+/*************/
+uint64_t SharedFrameRing::writeFrame(const void* data, size_t size, const ImageBufferSpec& spec, int64_t timestamp)
+{
+    if (!_isWriter || size > _header->slotSize)
+        return 0;
+
+    auto sequence = _header->lastSequence.load(memory_order_relaxed) + 1;
+    auto slot = getSlot(sequence);
+
+    // Readers seeing an odd state, or a state which changed while they were reading, drop the frame
+    slot->state.store(2 * sequence - 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+
+    slot->timestamp = timestamp;
+    slot->size = size;
+    slot->width = spec.width;
+    slot->height = spec.height;
+    slot->channels = spec.channels;
+    slot->bpp = spec.bpp;
+    memset(slot->format, 0, sizeof(slot->format));
+    strncpy(slot->format, spec.format.c_str(), sizeof(slot->format) - 1);
+    memcpy(reinterpret_cast<uint8_t*>(slot) + sizeof(SlotHeader), data, size);
+
+    slot->state.store(2 * sequence, memory_order_release);
+    _header->lastSequence.store(sequence, memory_order_release);
+
+    return sequence;
+}
+
+/*************/
+bool SharedFrameRing::getLastFrame(Frame& frame) const
+{
+    auto sequence = getLastSequence();
+    if (sequence == 0)
+        return false;
+    return getFrame(sequence, frame);
+}
+
+/*************/
+bool SharedFrameRing::getFrame(uint64_t sequence, Frame& frame) const
+{
+    if (sequence == 0 || sequence > getLastSequence())
+        return false;
+
+    auto slot = getSlot(sequence);
+    if (slot->state.load(memory_order_acquire) != 2 * sequence)
+        return false;
+
+    frame.sequence = sequence;
+    frame.timestamp = slot->timestamp;
+    frame.size = std::min<uint64_t>(slot->size, _header->slotSize);
+    frame.spec = ImageBufferSpec(slot->width, slot->height, slot->channels, slot->bpp, ImageBufferSpec::Type::UINT8, string(slot->format, strnlen(slot->format, sizeof(slot->format))));
+    frame.data = reinterpret_cast<const uint8_t*>(slot) + sizeof(SlotHeader);
+
+    return isFrameValid(frame);
+}
+
+/*************/
+bool SharedFrameRing::isFrameValid(const Frame& frame) const
+{
+    if (frame.sequence == 0)
+        return false;
+
+    atomic_thread_fence(memory_order_acquire);
+    return getSlot(frame.sequence)->state.load(memory_order_relaxed) == 2 * frame.sequence;
+}
+
+} // end of namespace
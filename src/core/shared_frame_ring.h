@@ -0,0 +1,194 @@
+/*
+ * Copyright (C) 2018 Emmanuel Durand
+ *
+ * This file is part of Splash.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Splash is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Splash.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * @shared_frame_ring.h
+ * The SharedFrameRing class, a ring of frames in a named POSIX shared memory,
+ * written by a single process and read in place by any number of readers
+ */
+
+#ifndef SPLASH_SHARED_FRAME_RING_H
+#define SPLASH_SHARED_FRAME_RING_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "./core/imagebuffer.h"
+
+namespace Splash
+{
+
+/*************/
+class SharedFrameRing
+{
+  public:
+    static constexpr uint32_t magic{0x53504652}; // "SPFR"
+    static constexpr uint32_t version{1};
+
+    /**
+     * Layout of the shared memory, which readers from other languages have to follow:
+     * - a RingHeader,
+     * - followed by slotCount slots, each one starting every slotStride bytes from the start of the first slot,
+     * - each slot starts with a SlotHeader, and the pixels follow at offset sizeof(SlotHeader)
+     * Every integer is in host byte order. Slot states follow a sequence lock: the state of the slot holding
+     * frame N is 2N - 1 while the frame is written, and 2N once it is complete.
+     */
+    struct RingHeader
+    {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t slotCount;
+        std::atomic<uint32_t> closed;       //!< Set to 1 by the writer when the ring is destroyed
+        uint64_t slotSize;                  //!< Maximum pixel data size of a frame
+        uint64_t slotStride;                //!< Distance between two slots
+        std::atomic<uint64_t> lastSequence; //!< Sequence number of the last complete frame, 0 if none
+        uint8_t padding[24];
+    };
+
+    struct SlotHeader
+    {
+        std::atomic<uint64_t> state; //!< Sequence lock, see above
+        int64_t timestamp;           //!< Frame timestamp, in microseconds
+        uint64_t size;               //!< Pixel data size
+        uint32_t width;
+        uint32_t height;
+        uint32_t channels;
+        uint32_t bpp;
+        char format[16];             //!< Zero-terminated pixel format
+        uint8_t padding[72];
+    };
+
+    /**
+     * A frame, pointing directly into the shared memory
+     */
+    struct Frame
+    {
+        const uint8_t* data{nullptr};
+        uint64_t sequence{0};
+        int64_t timestamp{0};
+        ImageBufferSpec spec{};
+        size_t size{0};
+    };
+
+    /**
+     * \brief Create a new ring, replacing any existing shared memory with the same name
+     * \param name Shared memory name
+     * \param slotCount Number of frames held by the ring
+     * \param slotSize Maximum size of a frame
+     * \return Return the ring, or nullptr if it could not be created
+     */
+    static std::unique_ptr<SharedFrameRing> create(const std::string& name, uint32_t slotCount, size_t slotSize);
+
+    /**
+     * \brief Open an existing ring for reading
+     * \param name Shared memory name
+     * \return Return the ring, or nullptr if it could not be opened
+     */
+    static std::unique_ptr<SharedFrameRing> open(const std::string& name);
+
+    /**
+     * \brief Destructor. The writer marks the ring as closed and removes its name, readers keep their mapping
+     */
+    ~SharedFrameRing();
+
+    SharedFrameRing(const SharedFrameRing&) = delete;
+    SharedFrameRing& operator=(const SharedFrameRing&) = delete;
+
+    /**
+     * \brief Get the name of the shared memory
+     * \return Return the name
+     */
+    std::string getName() const { return _name; }
+
+    /**
+     * \brief Get the slot count and size
+     */
+    uint32_t getSlotCount() const { return _header->slotCount; }
+    size_t getSlotSize() const { return _header->slotSize; }
+
+    /**
+     * \brief Writer side: copy a frame to the next slot. Never waits for the readers
+     * \param data Pixel data
+     * \param size Pixel data size, must not exceed the slot size
+     * \param spec Frame spec
+     * \param timestamp Frame timestamp
+     * \return Return the sequence number of the frame, or 0 if it could not be written
+     */
+    uint64_t writeFrame(const void* data, size_t size, const ImageBufferSpec& spec, int64_t timestamp);
+
+    /**
+     * \brief Reader side: get the last complete frame. The frame is not copied, isFrameValid has to be checked once done with it
+     * \param frame Frame to fill
+     * \return Return false if there is no frame yet, or if it got overwritten while being read
+     */
+    bool getLastFrame(Frame& frame) const;
+
+    /**
+     * \brief Reader side: get a frame given its sequence number, which lets slow readers consume every frame still held by the ring
+     * \param sequence Sequence number
+     * \param frame Frame to fill
+     * \return Return false if the frame is not written yet, or has been overwritten
+     */
+    bool getFrame(uint64_t sequence, Frame& frame) const;
+
+    /**
+     * \brief Reader side: check that the frame has not been overwritten since it was obtained
+     * \param frame Frame
+     * \return Return true if everything read from the frame so far is consistent
+     */
+    bool isFrameValid(const Frame& frame) const;
+
+    /**
+     * \brief Reader side: get the sequence number of the last complete frame
+     * \return Return the sequence number, 0 if no frame was written
+     */
+    uint64_t getLastSequence() const { return _header->lastSequence.load(std::memory_order_acquire); }
+
+    /**
+     * \brief Reader side: check whether the writer destroyed the ring, in which case it should be opened again
+     * \return Return true if closed
+     */
+    bool isClosed() const { return _header->closed.load(std::memory_order_acquire) != 0; }
+
+  private:
+    std::string _name{};
+    bool _isWriter{false};
+    uint64_t _inode{0};
+    uint8_t* _memory{nullptr};
+    size_t _memorySize{0};
+    RingHeader* _header{nullptr};
+
+    /**
+     * \brief Constructor, use create or open instead
+     */
+    SharedFrameRing() = default;
+
+    /**
+     * \brief Get the header of the slot holding the given frame
+     * \param sequence Sequence number
+     * \return Return the slot header
+     */
+    SlotHeader* getSlot(uint64_t sequence) const { return reinterpret_cast<SlotHeader*>(_memory + sizeof(RingHeader) + ((sequence - 1) % _header->slotCount) * _header->slotStride); }
+};
+
+} // end of namespace
+
+#endif // SPLASH_SHARED_FRAME_RING_H
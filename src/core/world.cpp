@@ -14,6 +14,8 @@
 #include "./core/buffer_object.h"
 #include "./core/link.h"
 #include "./core/scene.h"
+#include "./image/clip_cache.h"
+#include "./image/decode_scheduler.h"
 #include "./image/image.h"
 #include "./image/queue.h"
 #include "./mesh/mesh.h"
@@ -1475,6 +1477,35 @@ void World::registerAttributes()
     setAttributeDescription("clockDeviceName", "Set the audio device name from which to read the LTC clock signal");
 #endif
 
+    addAttribute("clipCacheBudget",
+        [&](const Values& args) {
+            ClipCache::get().setBudget(max(0, args[0].as<int>()) * (int64_t)1048576);
+            return true;
+        },
+        [&]() -> Values { return {ClipCache::get().getBudget() / (int64_t)1048576}; },
+        {'n'});
+    setAttributeDescription("clipCacheBudget", "Maximum memory used by all the clips cached in memory by video media (in MB)");
+
+    addAttribute("reservedCores",
+        [&](const Values& args) {
+            vector<int> cores;
+            for (const auto& arg : args)
+                cores.push_back(arg.as<int>());
+            DecodeScheduler::get().setReservedCores(cores);
+            addTask([=]() { sendMessage(SPLASH_ALL_PEERS, "reservedCores", args); });
+            return true;
+        },
+        [&]() -> Values {
+            Values cores;
+            for (auto core : DecodeScheduler::get().getReservedCores())
+                cores.push_back(core);
+            return cores;
+        },
+        {});
+    setAttributeDescription("reservedCores",
+        "CPU cores reserved for the render and texture upload threads of the Scenes, which video decoders do not run on. "
+        "Decoder threads are shared between all videos, according to their resolution and framerate");
+
     addAttribute("looseClock",
         [&](const Values& args) {
             Timer::get().setLoose(args[0].as<bool>());
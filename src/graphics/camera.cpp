@@ -423,13 +423,34 @@ Values Camera::pickVertex(float x, float y)
     float realX = x * _width;
     float realY = y * _height;
 
-    // Get the depth at the given point
-    auto depth = _outFbo->getDepthAt(realX, realY);
-    if (depth == 1.f)
-        return Values();
+    dmat4 lookM = lookAt(_eye, _target, _up);
+    dmat4 projM = computeProjectionMatrix();
+    dvec4 viewport(0, 0, _width, _height);
 
-    // Unproject the point
-    dvec3 screenPoint(realX, realY, depth);
+    // Cast a ray from the near to the far plane through the given point, to find the visible surface.
+    // The ray parameter is the same in every object space, as model matrices are affine
+    float closestHit = numeric_limits<float>::max();
+    dvec3 surfacePoint;
+    for (auto& o : _objects)
+    {
+        if (o.expired())
+            continue;
+        auto obj = o.lock();
+
+        dmat4 modelM = obj->getModelMatrix();
+        dvec3 nearPoint = unProject(dvec3(realX, realY, 0.0), lookM * modelM, projM, viewport);
+        dvec3 farPoint = unProject(dvec3(realX, realY, 1.0), lookM * modelM, projM, viewport);
+        dvec3 hit;
+        float tmpHit;
+        if ((tmpHit = obj->pickRay(nearPoint, farPoint - nearPoint, hit)) < closestHit)
+        {
+            closestHit = tmpHit;
+            surfacePoint = dvec3(modelM * dvec4(hit, 1.0));
+        }
+    }
+
+    if (closestHit == numeric_limits<float>::max())
+        return Values();
 
     float distance = numeric_limits<float>::max();
     dvec4 vertex;
@@ -439,7 +460,7 @@ Values Camera::pickVertex(float x, float y)
             continue;
         auto obj = o.lock();
 
-        dvec3 point = unProject(screenPoint, lookAt(_eye, _target, _up) * obj->getModelMatrix(), computeProjectionMatrix(), dvec4(0, 0, _width, _height));
+        dvec3 point = dvec3(inverse(obj->getModelMatrix()) * dvec4(surfacePoint, 1.0));
         glm::dvec3 closestVertex;
         float tmpDist;
         if ((tmpDist = obj->pickVertex(point, closestVertex)) < distance)
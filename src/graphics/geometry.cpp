@@ -88,7 +88,7 @@ void Geometry::activateAsSharedBuffer()
 /*************/
 void Geometry::activateForFeedback()
 {
-    _feedbackMaxNbrPrimitives = std::max(_verticesNumber / 3, _feedbackMaxNbrPrimitives);
+    _feedbackMaxNbrPrimitives = std::max(_indicesNumber / 3, _feedbackMaxNbrPrimitives);
     if (_glTemporaryBuffers.size() < _glBuffers.size() || _buffersDirty || _feedbackMaxNbrPrimitives * 6 > _temporaryBufferSize)
     {
         _glTemporaryBuffers.clear();
@@ -173,6 +173,7 @@ bool Geometry::deserialize(const shared_ptr<SerializedObject>& obj)
         return false;
     }
 
+    lock_guard<shared_timed_mutex> lock(_writeMutex);
     _serializedMesh = std::move(*obj);
     return true;
 }
@@ -197,28 +198,21 @@ bool Geometry::linkTo(const shared_ptr<GraphObject>& obj)
 /*************/
 float Geometry::pickVertex(dvec3 p, dvec3& v)
 {
-    float distance = numeric_limits<float>::max();
-    dvec3 closestVertex;
-
     if (_mesh.expired())
-        return distance;
+        return numeric_limits<float>::max();
     auto mesh = _mesh.lock();
 
-    vector<float> vertices = mesh->getVertCoords();
-    for (uint32_t i = 0; i < vertices.size(); i += 4)
-    {
-        dvec3 vertex(vertices[i], vertices[i + 1], vertices[i + 2]);
-        float dist = length(p - vertex);
-        if (dist < distance)
-        {
-            closestVertex = vertex;
-            distance = dist;
-        }
-    }
+    return mesh->pickVertex(p, v);
+}
 
-    v = closestVertex;
+/*************/
+float Geometry::pickRay(dvec3 origin, dvec3 direction, dvec3& hit)
+{
+    if (_mesh.expired())
+        return numeric_limits<float>::max();
+    auto mesh = _mesh.lock();
 
-    return distance;
+    return mesh->pickRay(origin, direction, hit);
 }
 
 /*************/
@@ -250,49 +244,76 @@ void Geometry::update()
     {
         mesh->update();
 
-        vector<float> vertices = mesh->getVertCoords();
-        if (vertices.size() == 0)
-            return;
-        _verticesNumber = vertices.size() / 4;
-        _glBuffers[0] = make_shared<GpuBuffer>(4, GL_FLOAT, GL_STATIC_DRAW, _verticesNumber, vertices.data());
-
-        vector<float> texcoords = mesh->getUVCoords();
-        if (texcoords.size() == 0)
-            return;
-        _glBuffers[1] = make_shared<GpuBuffer>(2, GL_FLOAT, GL_STATIC_DRAW, _verticesNumber, texcoords.data());
-
-        vector<float> normals = mesh->getNormals();
-        if (normals.size() == 0)
-            return;
-        _glBuffers[2] = make_shared<GpuBuffer>(4, GL_FLOAT, GL_STATIC_DRAW, _verticesNumber, normals.data());
-
-        // An additional annexe buffer, to be filled by compute shaders. Contains a vec4 for each vertex
-        vector<float> annexe = mesh->getAnnexe();
-        if (annexe.size() == 0)
-            _glBuffers[3] = make_shared<GpuBuffer>(4, GL_FLOAT, GL_STATIC_DRAW, _verticesNumber, nullptr);
+        // If only some vertices were modified, upload them in place
+        vector<Mesh::VertexRange> ranges;
+        if (_glBuffers[0] && _glBuffers[1] && _glBuffers[2] && _glIndexBuffer && mesh->getUpdatedRanges(_timestamp, ranges))
+        {
+            vector<float> vertices, texcoords, normals;
+            for (const auto& range : ranges)
+            {
+                mesh->getVertexRange(range, vertices, texcoords, normals);
+                if (vertices.size() != range.count * 4)
+                    continue;
+                _glBuffers[0]->setSubData(range.first, range.count, vertices.data());
+                _glBuffers[1]->setSubData(range.first, range.count, texcoords.data());
+                _glBuffers[2]->setSubData(range.first, range.count, normals.data());
+            }
+
+            _timestamp = mesh->getTimestamp();
+        }
         else
-            _glBuffers[3] = make_shared<GpuBuffer>(4, GL_FLOAT, GL_STATIC_DRAW, _verticesNumber, annexe.data());
+        {
+            vector<float> vertices = mesh->getVertCoords();
+            if (vertices.size() == 0)
+                return;
+            _verticesNumber = vertices.size() / 4;
+            _glBuffers[0] = make_shared<GpuBuffer>(4, GL_FLOAT, GL_STATIC_DRAW, _verticesNumber, vertices.data());
+
+            vector<float> texcoords = mesh->getUVCoords();
+            if (texcoords.size() == 0)
+                return;
+            _glBuffers[1] = make_shared<GpuBuffer>(2, GL_FLOAT, GL_STATIC_DRAW, _verticesNumber, texcoords.data());
+
+            vector<float> normals = mesh->getNormals();
+            if (normals.size() == 0)
+                return;
+            _glBuffers[2] = make_shared<GpuBuffer>(4, GL_FLOAT, GL_STATIC_DRAW, _verticesNumber, normals.data());
+
+            // An additional annexe buffer, to be filled by compute shaders. Contains a vec4 for each vertex
+            vector<float> annexe = mesh->getAnnexe();
+            if (annexe.size() == 0)
+                _glBuffers[3] = make_shared<GpuBuffer>(4, GL_FLOAT, GL_STATIC_DRAW, _verticesNumber, nullptr);
+            else
+                _glBuffers[3] = make_shared<GpuBuffer>(4, GL_FLOAT, GL_STATIC_DRAW, _verticesNumber, annexe.data());
 
-        // Check the buffers
-        bool buffersSet = true;
-        for (auto& buffer : _glBuffers)
-            if (!*buffer)
-                buffersSet = false;
+            vector<uint32_t> indices = mesh->getIndices();
+            if (indices.size() == 0)
+                return;
+            _indicesNumber = indices.size();
+            _glIndexBuffer = make_shared<GpuBuffer>(1, GL_UNSIGNED_INT, GL_STATIC_DRAW, _indicesNumber, indices.data());
 
-        if (!buffersSet)
-        {
-            _glBuffers.clear();
-            _glBuffers.resize(4);
-            return;
-        }
+            // Check the buffers
+            bool buffersSet = static_cast<bool>(*_glIndexBuffer);
+            for (auto& buffer : _glBuffers)
+                if (!*buffer)
+                    buffersSet = false;
 
-        for (auto& v : _vertexArray)
-            glDeleteVertexArrays(1, &(v.second));
-        _vertexArray.clear();
+            if (!buffersSet)
+            {
+                _glBuffers.clear();
+                _glBuffers.resize(4);
+                _glIndexBuffer.reset();
+                return;
+            }
 
-        _timestamp = mesh->getTimestamp();
+            for (auto& v : _vertexArray)
+                glDeleteVertexArrays(1, &(v.second));
+            _vertexArray.clear();
 
-        _buffersDirty = true;
+            _timestamp = mesh->getTimestamp();
+
+            _buffersDirty = true;
+        }
     }
 
     // If a serialized geometry is present, we use it as the alternative buffer
@@ -346,9 +367,10 @@ void Geometry::update()
 
         glBindVertexArray(vertexArrayIt->second);
 
+        auto useAlternativeBuffers = useAlternativeBuffersForDraw();
         for (uint32_t idx = 0; idx < _glBuffers.size(); ++idx)
         {
-            if (_useAlternativeBuffers && _glAlternativeBuffers.size() != 0 && _glAlternativeBuffers[0])
+            if (useAlternativeBuffers)
             {
                 glBindBuffer(GL_ARRAY_BUFFER, _glAlternativeBuffers[idx]->getId());
                 glVertexAttribPointer((GLuint)idx, _glAlternativeBuffers[idx]->getElementSize(), GL_FLOAT, GL_FALSE, 0, 0);
@@ -361,6 +383,12 @@ void Geometry::update()
             glEnableVertexAttribArray((GLuint)idx);
         }
 
+        // The element array binding is part of the vertex array state, and must not be unbound before it
+        if (!useAlternativeBuffers && _glIndexBuffer)
+            glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _glIndexBuffer->getId());
+        else
+            glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+
         glBindBuffer(GL_ARRAY_BUFFER, 0);
         glBindVertexArray(0);
 
@@ -91,7 +91,13 @@ class Geometry : public BufferObject
      * \brief Get the number of vertices for this geometry
      * \return Return the vertice count
      */
-    int getVerticesNumber() const { return _useAlternativeBuffers ? _alternativeVerticesNumber : _verticesNumber; }
+    int getVerticesNumber() const { return useAlternativeBuffersForDraw() ? _alternativeVerticesNumber : _indicesNumber; }
+
+    /**
+     * \brief Get whether the geometry is drawn from the index buffer, in which case glDrawElements has to be used
+     * \return Return true if the draw is indexed
+     */
+    bool isIndexed() const { return !useAlternativeBuffersForDraw() && _glIndexBuffer; }
 
     /**
      * \brief Get the geometry as serialized
@@ -126,6 +132,15 @@ class Geometry : public BufferObject
      */
     float pickVertex(glm::dvec3 p, glm::dvec3& v);
 
+    /**
+     * \brief Get the first point of the mesh hit by a ray
+     * \param origin Ray origin
+     * \param direction Ray direction
+     * \param hit If detected, hit point coordinates
+     * \return Return the ray parameter at the hit point, or the maximum float value if the mesh is not hit
+     */
+    float pickRay(glm::dvec3 origin, glm::dvec3 direction, glm::dvec3& hit);
+
     /**
      * \brief Set the mesh for this object
      * \param mesh Mesh
@@ -157,6 +172,7 @@ class Geometry : public BufferObject
 
     std::map<GLFWwindow*, GLuint> _vertexArray;
     std::vector<std::shared_ptr<GpuBuffer>> _glBuffers{};
+    std::shared_ptr<GpuBuffer> _glIndexBuffer{}; // Triangle indices into _glBuffers
     std::vector<std::shared_ptr<GpuBuffer>> _glAlternativeBuffers{}; // Alternative buffers used for rendering
     std::vector<std::shared_ptr<GpuBuffer>> _glTemporaryBuffers{};   // Temporary buffers used for feedback
     bool _buffersDirty{false};
@@ -166,6 +182,7 @@ class Geometry : public BufferObject
     SerializedObject _serializedMesh{};
 
     int _verticesNumber{0};
+    int _indicesNumber{0};
     int _alternativeVerticesNumber{0};
     int _alternativeBufferSize{0};
     int _temporaryVerticesNumber{0};
@@ -181,6 +198,12 @@ class Geometry : public BufferObject
      */
     void init();
 
+    /**
+     * \brief Get whether the alternative buffers are the ones drawn from. Alternative buffers are not indexed
+     * \return Return true if the alternative buffers are used
+     */
+    bool useAlternativeBuffersForDraw() const { return _useAlternativeBuffers && _glAlternativeBuffers.size() != 0 && _glAlternativeBuffers[0]; }
+
     /**
      * Register new functors to modify attributes
      */
@@ -118,6 +118,19 @@ void GpuBuffer::setBufferFromVector(const vector<char>& buffer)
     glNamedBufferSubData(_glId, 0, buffer.size(), buffer.data());
 }
 
+/*************/
+void GpuBuffer::setSubData(size_t first, size_t count, const GLvoid* data)
+{
+    if (!_glId || !_type || !_usage || !_elementSize)
+        return;
+
+    if (first + count > _size)
+        return;
+
+    size_t entrySize = _baseSize * _elementSize;
+    glNamedBufferSubData(_glId, first * entrySize, count * entrySize, data);
+}
+
 /*************/
 void GpuBuffer::resize(size_t size)
 {
@@ -141,6 +141,14 @@ class GpuBuffer
      */
     void setBufferFromVector(const std::vector<char>& buffer);
 
+    /**
+     * \brief Set the content of some consecutive entries, which must be within the buffer
+     * \param first First entry to set
+     * \param count Entry count
+     * \param data Source data, holding count entries
+     */
+    void setSubData(size_t first, size_t count, const GLvoid* data);
+
   private:
     GLuint _glId{0};
     size_t _size{0};
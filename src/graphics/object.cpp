@@ -200,7 +200,10 @@ void Object::draw()
         return;
 
     _shader->updateUniforms();
-    glDrawArrays(GL_TRIANGLES, 0, _geometries[0]->getVerticesNumber());
+    if (_geometries[0]->isIndexed())
+        glDrawElements(GL_TRIANGLES, _geometries[0]->getVerticesNumber(), GL_UNSIGNED_INT, nullptr);
+    else
+        glDrawArrays(GL_TRIANGLES, 0, _geometries[0]->getVerticesNumber());
 }
 
 /*************/
@@ -355,6 +358,24 @@ float Object::pickVertex(glm::dvec3 p, glm::dvec3& v)
     return distance;
 }
 
+/*************/
+float Object::pickRay(glm::dvec3 origin, glm::dvec3 direction, glm::dvec3& hit)
+{
+    float t = numeric_limits<float>::max();
+    float tmpT;
+    for (auto& geom : _geometries)
+    {
+        glm::dvec3 point;
+        if ((tmpT = geom->pickRay(origin, direction, point)) < t)
+        {
+            t = tmpT;
+            hit = point;
+        }
+    }
+
+    return t;
+}
+
 /*************/
 void Object::removeGeometry(const shared_ptr<Geometry>& geometry)
 {
@@ -427,9 +448,39 @@ void Object::resetTessellation()
 {
     lock_guard<mutex> lock(_mutex);
 
+    if (!_feedbackShaderExpandIndices)
+    {
+        _feedbackShaderExpandIndices = make_shared<Shader>(Shader::prgFeedback);
+        _feedbackShaderExpandIndices->setAttribute("feedbackPhase", {"expandIndices"});
+        _feedbackShaderExpandIndices->setAttribute("feedbackVaryings", {"GEOM_OUT.vertex", "GEOM_OUT.texcoord", "GEOM_OUT.normal", "GEOM_OUT.annexe"});
+    }
+
+    // Blending attributes are computed per triangle, so the indexed mesh is expanded
+    // to one vertex per triangle corner in the alternative buffers
     for (auto& geom : _geometries)
     {
         geom->useAlternativeBuffers(false);
+
+        do
+        {
+            geom->update();
+            geom->activate();
+            geom->activateForFeedback();
+            _feedbackShaderExpandIndices->activate();
+            if (geom->isIndexed())
+                glDrawElements(GL_TRIANGLES, geom->getVerticesNumber(), GL_UNSIGNED_INT, nullptr);
+            else
+                glDrawArrays(GL_TRIANGLES, 0, geom->getVerticesNumber());
+            _feedbackShaderExpandIndices->deactivate();
+
+            geom->deactivateFeedback();
+            geom->deactivate();
+
+            glMemoryBarrier(GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT);
+        } while (geom->hasBeenResized());
+
+        geom->swapBuffers();
+        geom->useAlternativeBuffers(true);
     }
 }
 
@@ -477,7 +528,10 @@ void Object::tessellateForThisCamera(glm::dmat4 viewMatrix, glm::dmat4 projectio
 
                 geom->activateForFeedback();
                 _feedbackShaderSubdivideCamera->activate();
-                glDrawArrays(GL_PATCHES, 0, geom->getVerticesNumber());
+                if (geom->isIndexed())
+                    glDrawElements(GL_PATCHES, geom->getVerticesNumber(), GL_UNSIGNED_INT, nullptr);
+                else
+                    glDrawArrays(GL_PATCHES, 0, geom->getVerticesNumber());
                 _feedbackShaderSubdivideCamera->deactivate();
 
                 geom->deactivateFeedback();
@@ -153,6 +153,15 @@ class Object : public GraphObject
      */
     float pickVertex(glm::dvec3 p, glm::dvec3& v);
 
+    /**
+     * \brief Get the first point of the geometries hit by a ray
+     * \param origin Ray origin, in object space
+     * \param direction Ray direction, in object space
+     * \param hit Hit point coordinates
+     * \return Return the ray parameter at the hit point, or the maximum float value if nothing is hit
+     */
+    float pickRay(glm::dvec3 origin, glm::dvec3 direction, glm::dvec3& hit);
+
     /**
      * \brief Remove a geometry from this object
      * \param geometry Geometry to remove
@@ -166,7 +175,7 @@ class Object : public GraphObject
     void removeTexture(const std::shared_ptr<Texture>& texture);
 
     /**
-     * \brief Reset tessellation of all linked objects
+     * \brief Reset tessellation of all linked objects, expanding their geometries to one vertex per triangle corner
      */
     void resetTessellation();
 
@@ -229,6 +238,7 @@ class Object : public GraphObject
     std::shared_ptr<Shader> _computeShaderComputeBlending{};
     std::shared_ptr<Shader> _computeShaderTransferVisibilityToAttr{};
     std::shared_ptr<Shader> _feedbackShaderSubdivideCamera{};
+    std::shared_ptr<Shader> _feedbackShaderExpandIndices{};
 
     // A map for previously used graphics shaders
     std::map<std::string, std::shared_ptr<Shader>> _graphicsShaders;
@@ -719,6 +719,10 @@ void Shader::resetShader(ShaderType type)
 
     if (type == vertex)
         _shaders[type] = glCreateShader(GL_VERTEX_SHADER);
+    else if (type == tess_ctrl)
+        _shaders[type] = glCreateShader(GL_TESS_CONTROL_SHADER);
+    else if (type == tess_eval)
+        _shaders[type] = glCreateShader(GL_TESS_EVALUATION_SHADER);
     else if (type == geometry)
         _shaders[type] = glCreateShader(GL_GEOMETRY_SHADER);
     else if (type == fragment)
@@ -830,6 +834,16 @@ void Shader::registerGraphicAttributes()
                 setSource(options + ShaderSources.FRAGMENT_SHADER_PRIMITIVEID, fragment);
                 compileProgram();
             }
+            else if (args[0].as<string>() == "sinkConversion" && (_fill != sinkConversion || _shaderOptions != options))
+            {
+                _currentProgramName = args[0].as<string>();
+                _fill = sinkConversion;
+                _shaderOptions = options;
+                setSource(options + ShaderSources.VERTEX_SHADER_FILTER, vertex);
+                resetShader(geometry);
+                setSource(options + ShaderSources.FRAGMENT_SHADER_SINK_CONVERSION, fragment);
+                compileProgram();
+            }
             else if (args[0].as<string>() == "userDefined" && (_fill != userDefined || _shaderOptions != options))
             {
                 _currentProgramName = args[0].as<string>();
@@ -986,6 +1000,15 @@ void Shader::registerFeedbackAttributes()
             setSource(options + ShaderSources.GEOMETRY_SHADER_FEEDBACK_TESSELLATE_FROM_CAMERA, geometry);
             compileProgram();
         }
+        else if ("expandIndices" == args[0].as<string>())
+        {
+            _currentProgramName = args[0].as<string>();
+            setSource(options + ShaderSources.VERTEX_SHADER_FEEDBACK_EXPAND_INDICES, vertex);
+            resetShader(tess_ctrl);
+            resetShader(tess_eval);
+            resetShader(geometry);
+            compileProgram();
+        }
 
         return true;
     });
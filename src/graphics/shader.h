@@ -78,6 +78,7 @@ class Shader : public GraphObject
         color,
         filter,
         primitiveId,
+        sinkConversion,
         uv,
         userDefined,
         warp,
@@ -744,6 +744,32 @@ struct ShaderSources
         }
     )"};
 
+    /**
+     * Feedback vertex shader expanding an indexed mesh to one vertex per triangle corner
+     */
+    const std::string VERTEX_SHADER_FEEDBACK_EXPAND_INDICES{R"(
+        layout (location = 0) in vec4 _vertex;
+        layout (location = 1) in vec2 _texcoord;
+        layout (location = 2) in vec4 _normal;
+        layout (location = 3) in vec4 _annexe;
+
+        out GEOM_OUT
+        {
+            vec4 vertex;
+            vec2 texcoord;
+            vec4 normal;
+            vec4 annexe;
+        } geom_out;
+
+        void main(void)
+        {
+            geom_out.vertex = _vertex;
+            geom_out.texcoord = _texcoord;
+            geom_out.normal = _normal;
+            geom_out.annexe = _annexe;
+        }
+    )"};
+
     /**************************/
     // GRAPHICS
     /**************************/
@@ -953,6 +979,95 @@ struct ShaderSources
         }
     )"};
 
+    /**
+     * Fragment shader converting and scaling a texture before its read back by a Sink
+     * The output pixels are packed in the bytes of the RGBA render target:
+     * - RGBA: one pixel per texel
+     * - UYVY: two pixels per texel
+     * - I420 and NV12: four bytes of a plane per texel, the planes following each other vertically
+     */
+    const std::string FRAGMENT_SHADER_SINK_CONVERSION{R"(
+        uniform sampler2D _tex0;
+        uniform vec2 _tex0_size = vec2(1.0);
+
+        uniform int _outputFormat = 0; // 0 = RGBA, 1 = UYVY, 2 = I420, 3 = NV12
+        uniform vec2 _outputSize = vec2(1.0);
+        uniform vec4 _regionOfInterest = vec4(0.0, 0.0, 1.0, 1.0); // x, y, width, height, normalized
+
+        in vec2 texCoord;
+        out vec4 fragColor;
+
+        // Sample the input at the given output position, in pixels
+        vec3 sampleAt(vec2 position)
+        {
+            vec2 uv = _regionOfInterest.xy + position / _outputSize * _regionOfInterest.zw;
+            vec2 scale = _tex0_size * _regionOfInterest.zw / _outputSize;
+            float lod = max(0.0, log2(max(scale.x, scale.y)));
+            return textureLod(_tex0, uv, lod).rgb;
+        }
+
+        // BT.601 limited range, matching PixelUtils::rgbaToI420
+        float luma(vec3 c)
+        {
+            return dot(c, vec3(66.0, 129.0, 25.0)) / 256.0 + 16.0 / 255.0;
+        }
+
+        vec2 chroma(vec3 c)
+        {
+            return vec2(dot(c, vec3(-38.0, -74.0, 112.0)), dot(c, vec3(112.0, -94.0, -18.0))) / 256.0 + 128.0 / 255.0;
+        }
+
+        void main(void)
+        {
+            ivec2 texel = ivec2(gl_FragCoord.xy);
+            int width = int(_outputSize.x);
+            int height = int(_outputSize.y);
+
+            if (_outputFormat == 0)
+            {
+                fragColor = vec4(sampleAt(vec2(texel) + 0.5), 1.0);
+            }
+            else if (_outputFormat == 1)
+            {
+                vec3 first = sampleAt(vec2(texel.x * 2, texel.y) + 0.5);
+                vec3 second = sampleAt(vec2(texel.x * 2 + 1, texel.y) + 0.5);
+                vec2 uv = chroma((first + second) * 0.5);
+                fragColor = vec4(uv.x, luma(first), uv.y, luma(second));
+            }
+            else if (texel.y < height)
+            {
+                // Luma plane, shared by I420 and NV12
+                vec2 position = vec2(texel.x * 4, texel.y) + 0.5;
+                fragColor = vec4(luma(sampleAt(position)),
+                    luma(sampleAt(position + vec2(1.0, 0.0))),
+                    luma(sampleAt(position + vec2(2.0, 0.0))),
+                    luma(sampleAt(position + vec2(3.0, 0.0))));
+            }
+            else if (_outputFormat == 2)
+            {
+                // U then V planes, each row of texels holding two rows of the half resolution plane
+                int planeRows = height / 4;
+                int row = texel.y - height;
+                int plane = row / planeRows;
+                int index = (row % planeRows) * width + texel.x * 4;
+                // Chroma is sampled at the center of each 2x2 block
+                vec2 position = vec2((index % (width / 2)) * 2, (index / (width / 2)) * 2) + 1.0;
+                vec4 values;
+                for (int i = 0; i < 4; ++i)
+                    values[i] = chroma(sampleAt(position + vec2(2.0 * float(i), 0.0)))[plane];
+                fragColor = values;
+            }
+            else
+            {
+                // Interleaved UV plane, at half resolution
+                vec2 position = vec2(texel.x * 4, (texel.y - height) * 2) + 1.0;
+                vec2 first = chroma(sampleAt(position));
+                vec2 second = chroma(sampleAt(position + vec2(2.0, 0.0)));
+                fragColor = vec4(first, second);
+            }
+        }
+    )"};
+
     /**
      * Warp vertex shader
      */
@@ -1,9 +1,11 @@
 #include "./graphics/texture_image.h"
 
+#include <algorithm>
 #include <string>
 
 #include "./image/image.h"
 #include "./utils/log.h"
+#include "./utils/pixelutils.h"
 #include "./utils/timer.h"
 
 #define SPLASH_TEXTURE_COPY_THREADS 2
@@ -73,22 +75,11 @@ RgbValue Texture_Image::getMeanValue() const
     ResizableArray<uint8_t> buffer(size);
     glGetTextureImage(_glTex, level, GL_RGBA, GL_UNSIGNED_INT_8_8_8_8_REV, buffer.size(), buffer.data());
 
-    RgbValue meanColor;
-    for (int y = 0; y < height; ++y)
-    {
-        RgbValue rowMeanColor;
-        for (int x = 0; x < width; ++x)
-        {
-            auto index = (x + y * width) * 4;
-            RgbValue color(buffer[index], buffer[index + 1], buffer[index + 2]);
-            rowMeanColor += color;
-        }
-        rowMeanColor /= static_cast<float>(width);
-        meanColor += rowMeanColor;
-    }
-    meanColor /= height;
+    uint64_t sums[4];
+    PixelUtils::channelSums(buffer.data(), width * height, sums);
 
-    return meanColor;
+    auto pixelCount = static_cast<float>(max(width * height, 1));
+    return RgbValue(sums[0] / pixelCount, sums[1] / pixelCount, sums[2] / pixelCount);
 }
 
 /*************/
@@ -296,6 +287,39 @@ GLenum Texture_Image::getChannelOrder(const ImageBufferSpec& spec)
     return glChannelOrder;
 }
 
+/*************/
+void Texture_Image::recordFrameLatency(int64_t swapTime)
+{
+    FrameInfo displayedFrame;
+    {
+        lock_guard<Spinlock> lock(_frameInfoMutex);
+        displayedFrame = _displayedFrame;
+    }
+
+    // Still images, and sources which do not stamp their frames, are not tracked
+    if (displayedFrame.timestamp < 0)
+        return;
+
+    if (displayedFrame.sequence == _lastSwappedSequence)
+        _latencyStats.addDuplicated();
+    _lastSwappedSequence = displayedFrame.sequence;
+    _latencyStats.addSample(swapTime - displayedFrame.timestamp);
+}
+
+/*************/
+void Texture_Image::updateFrameInfo(const FrameInfo& frame, bool immediate)
+{
+    lock_guard<Spinlock> lock(_frameInfoMutex);
+
+    // A gap in the sequence numbers means that frames were replaced before reaching this texture
+    if (frame.sequence != 0 && _pendingFrame.sequence != 0 && frame.sequence > _pendingFrame.sequence + 1)
+        _latencyStats.addDropped(frame.sequence - _pendingFrame.sequence - 1);
+
+    // Frames going through the PBOs reach the texture at the next update
+    _displayedFrame = immediate ? frame : _pendingFrame;
+    _pendingFrame = frame;
+}
+
 /*************/
 void Texture_Image::update()
 {
@@ -312,6 +336,9 @@ void Texture_Image::update()
     img->update();
     _timestamp = img->getTimestamp();
 
+    FrameInfo frame;
+    img->getFrameInfo(frame.timestamp, frame.sequence);
+
     if (_multisample > 1)
     {
         Log::get() << Log::ERROR << "Texture_Image::" << __FUNCTION__ << " - Texture " << _name << " is multisampled, and can not be set from an image" << Log::endl;
@@ -474,6 +501,7 @@ void Texture_Image::update()
         // And copy it to the second PBO
         glCopyNamedBufferSubData(_pbos[0], _pbos[1], 0, 0, imageDataSize);
         _spec = spec;
+        updateFrameInfo(frame, true);
     }
     // Update the content of the texture, i.e the image
     else
@@ -487,6 +515,7 @@ void Texture_Image::update()
         glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
 
         _pboReadIndex = (_pboReadIndex + 1) % 2;
+        updateFrameInfo(frame, false);
 
         // Fill the next PBO with the image pixels
         GLubyte* pixels = (GLubyte*)glMapNamedBufferRange(_pbos[_pboReadIndex], 0, imageDataSize, GL_MAP_WRITE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
@@ -593,6 +622,43 @@ void Texture_Image::registerAttributes()
         },
         {'n', 'n'});
     setAttributeDescription("size", "Change the texture size");
+
+    addAttribute("frameLatency",
+        [&](const Values&) { return true; },
+        [&]() -> Values {
+            return {_latencyStats.getLast(), _latencyStats.getMean(), _latencyStats.getPercentile(0.95f), _latencyStats.getMax()};
+        },
+        {});
+    setAttributeParameter("frameLatency", false, false);
+    setAttributeDescription("frameLatency", "Age of the displayed frame when the buffers are swapped, in ms: last, mean, 95th percentile and maximum");
+
+    addAttribute("frameLatencyHistogram",
+        [&](const Values&) { return true; },
+        [&]() -> Values {
+            Values histogram;
+            for (auto count : _latencyStats.getHistogram())
+                histogram.push_back(static_cast<int64_t>(count));
+            return {histogram};
+        },
+        {});
+    setAttributeParameter("frameLatencyHistogram", false, false);
+    setAttributeDescription("frameLatencyHistogram", "Frame latency histogram, with buckets up to 2, 4, 8, 16, 25, 33, 50, 66, 100, 150, 250, 500ms and above");
+
+    addAttribute("droppedFrames", [&](const Values&) { return true; }, [&]() -> Values { return {static_cast<int64_t>(_latencyStats.getDroppedCount())}; }, {});
+    setAttributeParameter("droppedFrames", false, false);
+    setAttributeDescription("droppedFrames", "Number of frames from the source which were never displayed");
+
+    addAttribute("duplicatedFrames", [&](const Values&) { return true; }, [&]() -> Values { return {static_cast<int64_t>(_latencyStats.getDuplicatedCount())}; }, {});
+    setAttributeParameter("duplicatedFrames", false, false);
+    setAttributeDescription("duplicatedFrames", "Number of buffer swaps which displayed the same frame again");
+
+    addAttribute("resetFrameStats",
+        [&](const Values&) {
+            _latencyStats.reset();
+            return true;
+        });
+    setAttributeParameter("resetFrameStats", false, false);
+    setAttributeDescription("resetFrameStats", "Reset the frame latency histogram, and the dropped and duplicated frame counters");
 }
 
 } // end of namespace
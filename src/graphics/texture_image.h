@@ -36,8 +36,10 @@
 #include "./core/attribute.h"
 #include "./utils/cgutils.h"
 #include "./core/coretypes.h"
+#include "./core/spinlock.h"
 #include "./image/image.h"
 #include "./graphics/texture.h"
+#include "./utils/latencystats.h"
 
 namespace Splash
 {
@@ -154,6 +156,12 @@ class Texture_Image : public Texture
      */
     void resize(int width, int height);
 
+    /**
+     * \brief Record the age of the frame currently displayed, to be called when the windows swap their buffers
+     * \param swapTime Time of the buffer swap, in us, as given by Timer::getTime()
+     */
+    void recordFrameLatency(int64_t swapTime);
+
     /**
      * \brief Enable / disable clamp to edge
      * \param active If true, enables clamping
@@ -191,6 +199,18 @@ class Texture_Image : public Texture
 
     std::weak_ptr<Image> _img;
 
+    // Frame latency tracking
+    struct FrameInfo
+    {
+        int64_t timestamp{-1};
+        uint64_t sequence{0};
+    };
+    Spinlock _frameInfoMutex{};
+    FrameInfo _pendingFrame{};   //!< Frame copied to the PBO, displayed at the next update
+    FrameInfo _displayedFrame{}; //!< Frame currently in the texture
+    uint64_t _lastSwappedSequence{0};
+    LatencyStats _latencyStats{};
+
     // Parameters to send to the shader
     std::unordered_map<std::string, Values> _shaderUniforms;
 
@@ -214,6 +234,13 @@ class Texture_Image : public Texture
      */
     void updatePbos(int width, int height, int bytes);
 
+    /**
+     * \brief Update the frames in flight, and count the dropped frames
+     * \param frame Frame being uploaded
+     * \param immediate True if the frame is uploaded directly to the texture, false if it goes through the PBOs
+     */
+    void updateFrameInfo(const FrameInfo& frame, bool immediate);
+
     /**
      * \brief Register new functors to modify attributes
      */
@@ -0,0 +1,117 @@
+#include "./image/clip_cache.h"
+
+#include <sys/stat.h>
+
+#include "./utils/log.h"
+
+using namespace std;
+
+namespace Splash
+{
+
+/*************/
+string ClipCache::getKey(const string& filepath)
+{
+    struct stat fileStat;
+    if (stat(filepath.c_str(), &fileStat) != 0)
+        return filepath;
+    return filepath + ":" + to_string(fileStat.st_size) + ":" + to_string(fileStat.st_mtime);
+}
+
+/*************/
+shared_ptr<const CachedClip> ClipCache::getClip(const string& filepath)
+{
+    auto key = getKey(filepath);
+
+    lock_guard<mutex> lock(_mutex);
+    for (auto it = _clips.begin(); it != _clips.end(); ++it)
+    {
+        if (it->key != key)
+            continue;
+
+        auto clip = it->clip;
+        _clips.splice(_clips.begin(), _clips, it);
+        return clip;
+    }
+
+    return {};
+}
+
+/*************/
+shared_ptr<const CachedClip> ClipCache::addClip(const string& filepath, unique_ptr<CachedClip>&& clip)
+{
+    if (!clip)
+        return {};
+
+    auto key = getKey(filepath);
+
+    lock_guard<mutex> lock(_mutex);
+    // Another media may have cached the same file in the meantime
+    for (const auto& entry : _clips)
+        if (entry.key == key)
+            return entry.clip;
+
+    if (!makeRoom(clip->size))
+    {
+        Log::get() << Log::MESSAGE << "ClipCache::" << __FUNCTION__ << " - Not enough room in the cache for file " << filepath << Log::endl;
+        return {};
+    }
+
+    Entry entry;
+    entry.key = key;
+    entry.clip = shared_ptr<const CachedClip>(clip.release());
+    _usedSize += entry.clip->size;
+    _clips.push_front(entry);
+
+    Log::get() << Log::MESSAGE << "ClipCache::" << __FUNCTION__ << " - Cached " << entry.clip->frames.size() << " frames from file " << filepath << " ("
+               << entry.clip->size / 1048576 << " MB)" << Log::endl;
+
+    return entry.clip;
+}
+
+/*************/
+bool ClipCache::canFit(int64_t size)
+{
+    lock_guard<mutex> lock(_mutex);
+    int64_t evictableSize = 0;
+    for (const auto& entry : _clips)
+        if (entry.clip.use_count() == 1)
+            evictableSize += entry.clip->size;
+    return _usedSize - evictableSize + size <= _budget;
+}
+
+/*************/
+void ClipCache::setBudget(int64_t budget)
+{
+    lock_guard<mutex> lock(_mutex);
+    _budget = max<int64_t>(0, budget);
+    makeRoom(0);
+}
+
+/*************/
+int64_t ClipCache::getUsedSize()
+{
+    lock_guard<mutex> lock(_mutex);
+    return _usedSize;
+}
+
+/*************/
+bool ClipCache::makeRoom(int64_t size)
+{
+    // Evict the least recently used clips first, if no media is playing them
+    for (auto it = _clips.rbegin(); it != _clips.rend() && _usedSize + size > _budget;)
+    {
+        if (it->clip.use_count() != 1)
+        {
+            ++it;
+            continue;
+        }
+
+        _usedSize -= it->clip->size;
+        it = decltype(it)(_clips.erase(std::next(it).base()));
+    }
+
+    return _usedSize + size <= _budget;
+}
+
+} // end of namespace
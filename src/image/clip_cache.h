@@ -0,0 +1,141 @@
+/*
+ * Copyright (C) 2018 Emmanuel Durand
+ *
+ * This file is part of Splash.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Splash is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Splash.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * @clip_cache.h
+ * The ClipCache singleton, holding decoded frames of short clips in memory
+ */
+
+#ifndef SPLASH_CLIP_CACHE_H
+#define SPLASH_CLIP_CACHE_H
+
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "./config.h"
+
+#include "./core/imagebuffer.h"
+
+namespace Splash
+{
+
+/*************/
+struct CachedClip
+{
+    struct Frame
+    {
+        std::unique_ptr<ImageBuffer> frame{};
+        int64_t timing{0}; // in us
+    };
+
+    std::vector<Frame> frames{};
+    int64_t size{0}; //!< Total size of the frames, in bytes
+};
+
+/*************/
+class ClipCache
+{
+  public:
+    /**
+     * \brief Get the singleton
+     * \return Return the ClipCache singleton
+     */
+    static ClipCache& get()
+    {
+        static auto instance = new ClipCache;
+        return *instance;
+    }
+
+    /**
+     * \brief Get the cached clip for the given file
+     * \param filepath Media file path
+     * \return Return the clip, or nullptr if the file is not cached
+     */
+    std::shared_ptr<const CachedClip> getClip(const std::string& filepath);
+
+    /**
+     * \brief Add a fully decoded clip to the cache. Clips not used anymore are evicted if needed to fit in the budget
+     * \param filepath Media file path
+     * \param clip Decoded clip
+     * \return Return the cached clip, or nullptr if it could not fit in the budget
+     */
+    std::shared_ptr<const CachedClip> addClip(const std::string& filepath, std::unique_ptr<CachedClip>&& clip);
+
+    /**
+     * \brief Check whether a clip of the given size could be cached
+     * \param size Clip size in bytes
+     * \return Return true if the clip would fit in the budget, possibly by evicting unused clips
+     */
+    bool canFit(int64_t size);
+
+    /**
+     * \brief Get the memory budget
+     * \return Return the budget in bytes
+     */
+    int64_t getBudget() const { return _budget; }
+
+    /**
+     * \brief Set the memory budget. Unused clips are evicted if needed
+     * \param budget Budget in bytes
+     */
+    void setBudget(int64_t budget);
+
+    /**
+     * \brief Get the memory currently used by the cache
+     * \return Return the used size in bytes
+     */
+    int64_t getUsedSize();
+
+  private:
+    struct Entry
+    {
+        std::string key{};
+        std::shared_ptr<const CachedClip> clip{};
+    };
+
+    std::mutex _mutex{};
+    std::list<Entry> _clips{}; //!< Most recently used first
+    int64_t _budget{(int64_t)1 << 31};
+    int64_t _usedSize{0};
+
+    ClipCache() = default;
+    ClipCache(const ClipCache&) = delete;
+    ClipCache& operator=(const ClipCache&) = delete;
+
+    /**
+     * \brief Get the cache key for a file, which changes when the file is modified
+     * \param filepath File path
+     * \return Return the key
+     */
+    static std::string getKey(const std::string& filepath);
+
+    /**
+     * \brief Evict unused clips until the given size fits in the budget. Must be called with _mutex locked
+     * \param size Size to make room for
+     * \return Return true if enough room was made
+     */
+    bool makeRoom(int64_t size);
+};
+
+} // end of namespace
+
+#endif // SPLASH_CLIP_CACHE_H
@@ -0,0 +1,96 @@
+#include "./image/decode_scheduler.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "./utils/osutils.h"
+
+using namespace std;
+
+namespace Splash
+{
+
+const int DecodeScheduler::_maxThreadsPerMedia;
+
+/*************/
+DecodeScheduler::Allocation DecodeScheduler::registerMedia(const void* media, int width, int height, float framerate, bool intraOnly)
+{
+    lock_guard<mutex> lock(_mutex);
+
+    auto pixelRate = static_cast<double>(max(width, 1)) * static_cast<double>(max(height, 1)) * max(framerate, 1.f);
+
+    // Threads given to the other open decoders are not available, as their thread count can not be reduced
+    double totalPixelRate = pixelRate;
+    int allocatedThreads = 0;
+    for (const auto& other : _media)
+    {
+        if (other.first == media)
+            continue;
+        totalPixelRate += other.second.pixelRate;
+        allocatedThreads += other.second.threadCount;
+    }
+
+    // A media alone, or much heavier than the others, would otherwise get every decode core and leave none
+    // for the media registered after it
+    totalPixelRate = max(totalPixelRate, 2.0 * pixelRate);
+
+    auto coreCount = static_cast<int>(decodeCores().size());
+    auto availableThreads = max(0, coreCount - allocatedThreads);
+    auto share = static_cast<int>(round(static_cast<double>(coreCount) * pixelRate / totalPixelRate));
+
+    Allocation allocation;
+    allocation.threadCount = max(1, min({_maxThreadsPerMedia, share, availableThreads}));
+    // Frame threading adds a frame of latency per thread, which is not worth it when frames can be decoded by slices
+    allocation.sliceThreading = intraOnly;
+
+    _media[media] = {pixelRate, allocation.threadCount};
+
+    return allocation;
+}
+
+/*************/
+void DecodeScheduler::unregisterMedia(const void* media)
+{
+    lock_guard<mutex> lock(_mutex);
+    _media.erase(media);
+}
+
+/*************/
+void DecodeScheduler::setReservedCores(const vector<int>& cores)
+{
+    lock_guard<mutex> lock(_mutex);
+    _reservedCores = cores;
+}
+
+/*************/
+vector<int> DecodeScheduler::getReservedCores()
+{
+    lock_guard<mutex> lock(_mutex);
+    return _reservedCores;
+}
+
+/*************/
+vector<int> DecodeScheduler::getDecodeCores()
+{
+    lock_guard<mutex> lock(_mutex);
+    return decodeCores();
+}
+
+/*************/
+vector<int> DecodeScheduler::decodeCores() const
+{
+    auto coreCount = Utils::getCoreCount();
+    vector<int> cores;
+    for (int core = 0; core < coreCount; ++core)
+        if (find(_reservedCores.begin(), _reservedCores.end(), core) == _reservedCores.end())
+            cores.push_back(core);
+
+    // Decoders have to run somewhere
+    if (cores.empty())
+        for (int core = 0; core < coreCount; ++core)
+            cores.push_back(core);
+
+    return cores;
+}
+
+} // end of namespace
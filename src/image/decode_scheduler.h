@@ -0,0 +1,122 @@
+/*
+ * Copyright (C) 2018 Emmanuel Durand
+ *
+ * This file is part of Splash.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Splash is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Splash.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * @decode_scheduler.h
+ * The DecodeScheduler singleton, sharing the CPU cores between all video decoders
+ */
+
+#ifndef SPLASH_DECODE_SCHEDULER_H
+#define SPLASH_DECODE_SCHEDULER_H
+
+#include <map>
+#include <mutex>
+#include <vector>
+
+#include "./config.h"
+
+namespace Splash
+{
+
+/*************/
+class DecodeScheduler
+{
+  public:
+    struct Allocation
+    {
+        int threadCount{1};
+        bool sliceThreading{false}; //!< If true, use slice threading, frame threading otherwise
+    };
+
+    /**
+     * \brief Get the singleton
+     * \return Return the DecodeScheduler singleton
+     */
+    static DecodeScheduler& get()
+    {
+        static auto instance = new DecodeScheduler;
+        return *instance;
+    }
+
+    /**
+     * \brief Register a media about to open its decoder, and get its share of the decode cores.
+     * The share is weighted by the pixel rate of all the registered media. As decoder thread counts can not be changed once
+     * the decoder is opened, media registered earlier keep their allocation and a new media only gets threads from the ones
+     * still available. To leave room for the next ones, a media never gets more than half of the decode cores.
+     * A media always gets at least one thread, even if none is left
+     * \param media Media, used as an identifier
+     * \param width Video width
+     * \param height Video height
+     * \param framerate Video framerate
+     * \param intraOnly True if the codec only has intra frames
+     * \return Return the allocation
+     */
+    Allocation registerMedia(const void* media, int width, int height, float framerate, bool intraOnly);
+
+    /**
+     * \brief Unregister a media, once its decoder is closed. Its threads are available again for the next media
+     * \param media Media
+     */
+    void unregisterMedia(const void* media);
+
+    /**
+     * \brief Set the cores to keep free from decoder threads, i.e. for the render and texture upload threads
+     * \param cores Core indices
+     */
+    void setReservedCores(const std::vector<int>& cores);
+
+    /**
+     * \brief Get the reserved cores
+     * \return Return the core indices
+     */
+    std::vector<int> getReservedCores();
+
+    /**
+     * \brief Get the cores decoder threads should run on, which is all cores but the reserved ones
+     * \return Return the core indices
+     */
+    std::vector<int> getDecodeCores();
+
+  private:
+    static const int _maxThreadsPerMedia{16};
+
+    struct Media
+    {
+        double pixelRate{0.0};
+        int threadCount{0};
+    };
+
+    std::mutex _mutex{};
+    std::map<const void*, Media> _media{};
+    std::vector<int> _reservedCores{};
+
+    DecodeScheduler() = default;
+    DecodeScheduler(const DecodeScheduler&) = delete;
+    DecodeScheduler& operator=(const DecodeScheduler&) = delete;
+
+    /**
+     * \brief Get the decode cores. Must be called with _mutex locked
+     * \return Return the core indices
+     */
+    std::vector<int> decodeCores() const;
+};
+
+} // end of namespace
+
+#endif // SPLASH_DECODE_SCHEDULER_H
@@ -1,26 +1,40 @@
 #include "./image/image.h"
 
+#include <condition_variable>
 #include <fstream>
 #include <future>
 #include <memory>
+#include <stdexcept>
 
 #define STB_IMAGE_IMPLEMENTATION
 #define STB_IMAGE_WRITE_IMPLEMENTATION
 #include <stb_image.h>
 #include <stb_image_write.h>
 
+#include "./image/image_cache.h"
+#include "./utils/cgutils.h"
 #include "./utils/log.h"
 #include "./utils/osutils.h"
+#include "./utils/pixelutils.h"
 #include "./utils/timer.h"
 
-#define SPLASH_IMAGE_COPY_THREADS 2
 #define SPLASH_IMAGE_SERIALIZED_HEADER_SIZE 4096
+// Maximum texture size guaranteed by OpenGL 4.5
+#define SPLASH_IMAGE_MAX_SIZE 16384
 
 using namespace std;
 
 namespace Splash
 {
 
+namespace
+{
+// Limits the number of still images decoded concurrently
+mutex decodeSlotsMutex{};
+condition_variable decodeSlotsCondition{};
+int decodeSlots{Utils::getCoreCount()};
+}
+
 /*************/
 Image::Image(RootObject* root)
     : BufferObject(root)
@@ -53,6 +67,9 @@ void Image::init()
 /*************/
 Image::~Image()
 {
+    if (_readFuture.valid())
+        _readFuture.wait();
+
     lock_guard<shared_timed_mutex> writeLock(_writeMutex);
     lock_guard<Spinlock> readlock(_readMutex);
 #ifdef DEBUG
@@ -89,12 +106,27 @@ ImageBufferSpec Image::getSpec() const
         return ImageBufferSpec();
 }
 
+/*************/
+void Image::getFrameInfo(int64_t& timestamp, uint64_t& sequence) const
+{
+    lock_guard<Spinlock> lock(_readMutex);
+    timestamp = _image ? _image->getTimestamp() : -1;
+    sequence = _image ? _image->getSequence() : 0;
+}
+
+/*************/
+void Image::stampFrame(ImageBuffer& frame, int64_t timestamp)
+{
+    frame.setTimestamp(timestamp < 0 ? Timer::getTime() : timestamp);
+    frame.setSequence(++_frameSequence);
+}
+
 /*************/
 void Image::set(const ImageBuffer& img)
 {
     lock_guard<Spinlock> lockRead(_readMutex);
     if (_image)
-        *_image = img;
+        _image = make_shared<ImageBuffer>(img);
 }
 
 /*************/
@@ -104,9 +136,7 @@ void Image::set(unsigned int w, unsigned int h, unsigned int channels, ImageBuff
     ImageBuffer img(spec);
 
     lock_guard<Spinlock> lock(_readMutex);
-    if (!_image)
-        _image = unique_ptr<ImageBuffer>(new ImageBuffer());
-    std::swap(*_image, img);
+    _image = make_shared<ImageBuffer>(std::move(img));
     updateTimestamp();
 }
 
@@ -124,9 +154,8 @@ shared_ptr<SerializedObject> Image::serialize() const
     string xmlSpec = _image->getSpec().to_string();
     int nbrChar = xmlSpec.size();
     int imgSize = _image->getSpec().rawSize();
-    int totalSize = SPLASH_IMAGE_SERIALIZED_HEADER_SIZE + imgSize;
 
-    auto obj = make_shared<SerializedObject>(totalSize);
+    auto obj = make_shared<SerializedObject>(SPLASH_IMAGE_SERIALIZED_HEADER_SIZE);
 
     auto currentObjPtr = obj->data();
     const char* ptr = reinterpret_cast<const char*>(&nbrChar);
@@ -135,20 +164,22 @@ shared_ptr<SerializedObject> Image::serialize() const
 
     const char* charPtr = reinterpret_cast<const char*>(xmlSpec.c_str());
     copy(charPtr, charPtr + nbrChar, currentObjPtr);
-    currentObjPtr = obj->data() + SPLASH_IMAGE_SERIALIZED_HEADER_SIZE;
-
-    // And then, the image
+    currentObjPtr += nbrChar;
+
+    // Frame timestamp and sequence number, to track the latency down to the display
+    int64_t timestamp = _image->getTimestamp();
+    uint64_t sequence = _image->getSequence();
+    ptr = reinterpret_cast<const char*>(&timestamp);
+    copy(ptr, ptr + sizeof(timestamp), currentObjPtr);
+    currentObjPtr += sizeof(timestamp);
+    ptr = reinterpret_cast<const char*>(&sequence);
+    copy(ptr, ptr + sizeof(sequence), currentObjPtr);
+
+    // And then, the image, which is referenced and not copied
     const char* imgPtr = reinterpret_cast<const char*>(_image->data());
     if (imgPtr == NULL)
         return {};
-
-    {
-        vector<future<void>> threads;
-        int stride = SPLASH_IMAGE_COPY_THREADS;
-        for (int i = 0; i < stride - 1; ++i)
-            threads.push_back(async(launch::async, ([=]() { copy(imgPtr + imgSize / stride * i, imgPtr + imgSize / stride * (i + 1), currentObjPtr + imgSize / stride * i); })));
-        copy(imgPtr + imgSize / stride * (stride - 1), imgPtr + imgSize, currentObjPtr + imgSize / stride * (stride - 1));
-    }
+    obj->setPayload(imgPtr, imgSize, _image);
 
     if (Timer::get().isDebug())
         Timer::get() >> ("serialize " + _name);
@@ -175,25 +206,46 @@ bool Image::deserialize(const shared_ptr<SerializedObject>& obj)
 
     try
     {
-        char xmlSpecChar[nbrChar];
-        ptr = reinterpret_cast<char*>(xmlSpecChar);
-        copy(currentObjPtr, currentObjPtr + nbrChar, ptr);
-        string xmlSpec(xmlSpecChar);
+        if (nbrChar < 0 || sizeof(nbrChar) + nbrChar + sizeof(int64_t) + sizeof(uint64_t) > SPLASH_IMAGE_SERIALIZED_HEADER_SIZE)
+            throw runtime_error("Invalid image header");
+
+        string xmlSpec(currentObjPtr, nbrChar);
+        currentObjPtr += nbrChar;
+
+        int64_t timestamp;
+        uint64_t sequence;
+        memcpy(&timestamp, currentObjPtr, sizeof(timestamp));
+        currentObjPtr += sizeof(timestamp);
+        memcpy(&sequence, currentObjPtr, sizeof(sequence));
 
         ImageBufferSpec spec;
         spec.from_string(xmlSpec.c_str());
 
-        ImageBufferSpec curSpec = _bufferDeserialize.getSpec();
-        if (spec != curSpec)
-            _bufferDeserialize = ImageBuffer(spec);
+        unique_ptr<ImageBuffer> buffer;
+        if (obj->payload())
+        {
+            if (obj->payloadSize() < static_cast<size_t>(spec.rawSize()))
+                throw runtime_error("Invalid image payload");
+
+            // The payload is used in place, either the sender's image or the received message. The serialized object
+            // keeps it alive until the buffer is released, and a shared image is never modified by its owner
+            auto payload = ResizableArray<char>(const_cast<char*>(obj->payload()), obj->payloadSize(), [obj]() {});
+            buffer = unique_ptr<ImageBuffer>(new ImageBuffer(spec, std::move(payload)));
+        }
+        else
+        {
+            auto rawBuffer = obj->grabData();
+            rawBuffer.shift(SPLASH_IMAGE_SERIALIZED_HEADER_SIZE);
+            buffer = unique_ptr<ImageBuffer>(new ImageBuffer(spec, std::move(rawBuffer)));
+        }
 
-        auto rawBuffer = obj->grabData();
-        rawBuffer.shift(SPLASH_IMAGE_SERIALIZED_HEADER_SIZE);
-        _bufferDeserialize.setRawBuffer(std::move(rawBuffer));
+        buffer->setTimestamp(timestamp);
+        buffer->setSequence(sequence);
 
-        if (!_bufferImage)
-            _bufferImage = unique_ptr<ImageBuffer>(new ImageBuffer());
-        std::swap(*_bufferImage, _bufferDeserialize);
+        lock_guard<shared_timed_mutex> lock(_writeMutex);
+        // An image not consumed yet by update() is replaced
+        _bufferPool->release(std::move(_bufferImage));
+        _bufferImage = std::move(buffer);
         _imageUpdated = true;
 
         updateTimestamp();
@@ -220,30 +272,128 @@ bool Image::read(const string& filename)
 }
 
 /*************/
-bool Image::readFile(const string& filename)
+bool Image::readAsync(const string& filename)
 {
+    if (_isConnectedToRemote)
+        return true;
+
     if (!ifstream(filename).is_open())
     {
         Log::get() << Log::WARNING << "Image::" << __FUNCTION__ << " - Unable to load file " << filename << Log::endl;
         return false;
     }
 
-    int w, h, c;
-    // We force conversion to RGBA
-    uint8_t* rawImage = stbi_load(filename.c_str(), &w, &h, &c, 4);
+    if (_readFuture.valid())
+        _readFuture.wait();
 
-    if (!rawImage)
+    string filepath;
     {
-        Log::get() << Log::WARNING << "Image::" << __FUNCTION__ << " - Caught an error while opening image file " << filename << Log::endl;
+        shared_lock<shared_timed_mutex> lock(_writeMutex);
+        filepath = _filepath;
+    }
+
+    _readFuture = async(launch::async, [=]() {
+        {
+            unique_lock<mutex> lock(decodeSlotsMutex);
+            decodeSlotsCondition.wait(lock, []() { return decodeSlots > 0; });
+            --decodeSlots;
+        }
+
+        auto success = readFile(filename);
+
+        {
+            lock_guard<mutex> lock(decodeSlotsMutex);
+            ++decodeSlots;
+        }
+        decodeSlotsCondition.notify_one();
+
+        // The file attribute has been accepted before decoding, it is reset so that it does not show an image which is not loaded
+        if (!success)
+        {
+            Log::get() << Log::WARNING << "Image::readAsync - Unable to decode file " << filename << ", the file attribute is reset" << Log::endl;
+            lock_guard<shared_timed_mutex> lock(_writeMutex);
+            if (_filepath == filepath)
+                _filepath.clear();
+        }
+    });
+
+    return true;
+}
+
+/*************/
+bool Image::readFile(const string& filename)
+{
+    if (!ifstream(filename).is_open())
+    {
+        Log::get() << Log::WARNING << "Image::" << __FUNCTION__ << " - Unable to load file " << filename << Log::endl;
         return false;
     }
 
-    auto spec = ImageBufferSpec(w, h, 4, 32, ImageBufferSpec::Type::UINT8, "RGBA");
-    spec.videoFrame = false;
+    ImageBuffer img;
+    if (!_useDiskCache || !ImageCache::get().load(filename, _compressed, img))
+    {
+        int w, h, c;
+        // Images are converted to RGBA. RGB images are decoded as such and expanded afterwards, which is faster than letting stb_image do it
+        if (!stbi_info(filename.c_str(), &w, &h, &c))
+            c = 4;
+        auto decodedChannels = (c == 3) ? 3 : 4;
+        uint8_t* rawImage = stbi_load(filename.c_str(), &w, &h, &c, decodedChannels);
+
+        if (!rawImage)
+        {
+            Log::get() << Log::WARNING << "Image::" << __FUNCTION__ << " - Caught an error while opening image file " << filename << Log::endl;
+            return false;
+        }
+
+        auto rgbaSpec = ImageBufferSpec(w, h, 4, 32, ImageBufferSpec::Type::UINT8, "RGBA");
+        rgbaSpec.videoFrame = false;
+        auto rgbaImage = ImageBuffer(rgbaSpec);
+        if (decodedChannels == 3)
+            PixelUtils::rgbToRgba(rawImage, reinterpret_cast<uint8_t*>(rgbaImage.data()), w * h);
+        else
+            memcpy(rgbaImage.data(), rawImage, w * h * 4);
+        stbi_image_free(rawImage);
+
+        // Larger images may not be uploadable to the GPU, they are halved until they fit
+        if (w > SPLASH_IMAGE_MAX_SIZE || h > SPLASH_IMAGE_MAX_SIZE)
+        {
+            Log::get() << Log::WARNING << "Image::" << __FUNCTION__ << " - Image " << filename << " is larger than " << SPLASH_IMAGE_MAX_SIZE << " pixels, it is downscaled"
+                       << Log::endl;
+            while ((w > SPLASH_IMAGE_MAX_SIZE || h > SPLASH_IMAGE_MAX_SIZE) && w > 1 && h > 1)
+            {
+                auto halfSpec = ImageBufferSpec(w / 2, h / 2, 4, 32, ImageBufferSpec::Type::UINT8, "RGBA");
+                halfSpec.videoFrame = false;
+                auto halfImage = ImageBuffer(halfSpec);
+                PixelUtils::downscaleRgba2x(reinterpret_cast<const uint8_t*>(rgbaImage.data()), w, h, reinterpret_cast<uint8_t*>(halfImage.data()));
+                rgbaImage = std::move(halfImage);
+                w /= 2;
+                h /= 2;
+            }
+        }
+
+        // DXT compression works on 4x4 blocks, other sizes are kept uncompressed
+        if (_compressed && w % 4 == 0 && h % 4 == 0)
+        {
+            auto withAlpha = (c == 2 || c == 4);
+            ImageBufferSpec spec;
+            if (withAlpha)
+                spec = ImageBufferSpec(w, h, 1, 8, ImageBufferSpec::Type::UINT8, "RGBA_DXT5");
+            else
+                spec = ImageBufferSpec(w, h / 2, 1, 8, ImageBufferSpec::Type::UINT8, "RGB_DXT1");
+            spec.videoFrame = false;
+            img = ImageBuffer(spec);
+            dxtCompressFrame(reinterpret_cast<const uint8_t*>(rgbaImage.data()), w, h, withAlpha, reinterpret_cast<uint8_t*>(img.data()));
+        }
+        else
+        {
+            if (_compressed)
+                Log::get() << Log::MESSAGE << "Image::" << __FUNCTION__ << " - Size of image " << filename << " is not a multiple of 4, it will not be compressed" << Log::endl;
+            img = std::move(rgbaImage);
+        }
 
-    auto img = ImageBuffer(spec);
-    memcpy(img.data(), rawImage, w * h * 4);
-    stbi_image_free(rawImage);
+        if (_useDiskCache)
+            ImageCache::get().store(filename, _compressed, img);
+    }
 
     lock_guard<shared_timed_mutex> lock(_writeMutex);
     if (!_bufferImage)
@@ -263,6 +413,9 @@ void Image::zero()
     if (!_image)
         return;
 
+    // External buffers may be shared with a cache
+    if (_image.use_count() > 1 || _image->isExternal())
+        _image = make_shared<ImageBuffer>(_image->getSpec());
     _image->zero();
 }
 
@@ -273,7 +426,12 @@ void Image::update()
     {
         lock_guard<Spinlock> lockRead(_readMutex);
         shared_lock<shared_timed_mutex> lockWrite(_writeMutex);
-        _image.swap(_bufferImage);
+        // Images go back to the pool once released by the serialized objects. The previous one is usually released
+        // right away, and recycled as the next buffer
+        auto previousImage = std::move(_image);
+        _image = _bufferPool->share(std::move(_bufferImage));
+        previousImage.reset();
+        _bufferImage = _bufferPool->tryAcquire(_image->getSpec());
         _imageUpdated = false;
 
         if (_remoteType.empty() || _type == _remoteType)
@@ -340,9 +498,7 @@ void Image::createDefaultImage()
     img.zero();
 
     lock_guard<Spinlock> lock(_readMutex);
-    if (!_image)
-        _image = unique_ptr<ImageBuffer>(new ImageBuffer());
-    std::swap(*_image, img);
+    _image = make_shared<ImageBuffer>(std::move(img));
     updateTimestamp();
 }
 
@@ -366,9 +522,7 @@ void Image::createPattern()
         }
 
     lock_guard<Spinlock> lock(_readMutex);
-    if (!_image)
-        _image = unique_ptr<ImageBuffer>(new ImageBuffer());
-    std::swap(*_image, img);
+    _image = make_shared<ImageBuffer>(std::move(img));
     updateTimestamp();
 }
 
@@ -397,15 +551,54 @@ void Image::registerAttributes()
 
     addAttribute("file",
         [&](const Values& args) {
-            _filepath = args[0].as<string>();
-            if (_filepath.empty())
+            auto filepath = args[0].as<string>();
+            {
+                // Reset from the decoding thread if the file can not be decoded
+                lock_guard<shared_timed_mutex> lock(_writeMutex);
+                _filepath = filepath;
+            }
+            if (filepath.empty())
                 return true;
-            return read(Utils::getFullPathFromFilePath(_filepath, _root->getConfigurationPath()));
+            // Still images are decoded in the background, other media types handle their own reading
+            if (_type == "image")
+                return readAsync(Utils::getFullPathFromFilePath(filepath, _root->getConfigurationPath()));
+            return read(Utils::getFullPathFromFilePath(filepath, _root->getConfigurationPath()));
+        },
+        [&]() -> Values {
+            shared_lock<shared_timed_mutex> lock(_writeMutex);
+            return {_filepath};
         },
-        [&]() -> Values { return {_filepath}; },
         {'s'});
     setAttributeDescription("file", "Image file to load");
 
+    addAttribute("compressed",
+        [&](const Values& args) {
+            auto compressed = args[0].as<bool>();
+            if (compressed == _compressed)
+                return true;
+            _compressed = compressed;
+            string filepath;
+            {
+                shared_lock<shared_timed_mutex> lock(_writeMutex);
+                filepath = _filepath;
+            }
+            if (_type == "image" && !filepath.empty())
+                return readAsync(Utils::getFullPathFromFilePath(filepath, _root->getConfigurationPath()));
+            return true;
+        },
+        [&]() -> Values { return {_compressed}; },
+        {'n'});
+    setAttributeDescription("compressed", "If set to 1, still images are DXT compressed to reduce video memory usage");
+
+    addAttribute("diskCache",
+        [&](const Values& args) {
+            _useDiskCache = args[0].as<bool>();
+            return true;
+        },
+        [&]() -> Values { return {_useDiskCache}; },
+        {'n'});
+    setAttributeDescription("diskCache", "If set to 1, decoded still images are cached on disk to speed up later loads. Least recently used images are removed once the cache exceeds 2GB");
+
     addAttribute("srgb",
         [&](const Values& args) {
             _srgb = (args[0].as<int>() > 0) ? true : false;
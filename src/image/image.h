@@ -26,6 +26,7 @@
 #define SPLASH_IMAGE_H
 
 #include <chrono>
+#include <future>
 #include <mutex>
 
 #include "config.h"
@@ -35,6 +36,7 @@
 #include "./core/coretypes.h"
 #include "./core/root_object.h"
 #include "./core/imagebuffer.h"
+#include "./core/imagebuffer_pool.h"
 
 namespace Splash
 {
@@ -91,6 +93,13 @@ class Image : public BufferObject
      */
     ImageBufferSpec getSpec() const;
 
+    /**
+     * \brief Get the capture timestamp and sequence number of the current frame
+     * \param timestamp Set to the timestamp in us, or -1 if unknown
+     * \param sequence Set to the sequence number
+     */
+    void getFrameInfo(int64_t& timestamp, uint64_t& sequence) const;
+
     /**
      * \brief Set the image from an ImageBuffer
      * \param img Image buffer
@@ -146,18 +155,29 @@ class Image : public BufferObject
   protected:
     Values _mediaInfo{};
 
-    std::unique_ptr<ImageBuffer> _image;
+    std::shared_ptr<ImageBuffer> _image; //!< Shared with the serialized objects being sent, so it must not be modified in place
     std::unique_ptr<ImageBuffer> _bufferImage;
+    std::shared_ptr<ImageBufferPool> _bufferPool{std::make_shared<ImageBufferPool>()}; //!< Buffers released by _image and the serialized objects come back here
     std::string _filepath;
     bool _flip{false};
     bool _flop{false};
     bool _imageUpdated{false};
     bool _srgb{true};
     bool _benchmark{false};
+    bool _compressed{false}; //!< If true, still images are DXT compressed after decoding
+    bool _useDiskCache{true}; //!< If true, decoded still images are cached on disk
+    uint64_t _frameSequence{0}; //!< Sequence number of the last produced frame
 
     void createDefaultImage(); //< Create a default black image
     void createPattern();      //< Create a default pattern
 
+    /**
+     * \brief Set the timestamp and sequence number of a newly produced frame, used to track its latency
+     * \param frame Frame
+     * \param timestamp Capture timestamp in us, or -1 to use the current time
+     */
+    void stampFrame(ImageBuffer& frame, int64_t timestamp = -1);
+
     /**
      * Update the _mediaInfo member
      */
@@ -176,8 +196,14 @@ class Image : public BufferObject
     void registerAttributes();
 
   private:
-    // Deserialization is done in this buffer, to avoid realloc
-    ImageBuffer _bufferDeserialize;
+    std::future<void> _readFuture{};
+
+    /**
+     * \brief Read the specified image file in a separate thread, so that all images of a project are decoded in parallel
+     * \param filename File path
+     * \return Return false if the file does not exist
+     */
+    bool readAsync(const std::string& filename);
 
     /**
      * Add more media info, to be implemented by derived classes
@@ -0,0 +1,240 @@
+#include "./image/image_cache.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <functional>
+#include <sstream>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+
+#include "./utils/log.h"
+#include "./utils/osutils.h"
+
+#define SPLASH_IMAGE_CACHE_HEADER_SIZE 4096
+
+using namespace std;
+
+namespace Splash
+{
+
+namespace
+{
+const char cacheMagic[8] = {'S', 'P', 'L', 'I', 'M', 'G', 'C', '1'};
+}
+
+/*************/
+ImageCache::ImageCache()
+{
+    auto xdgCachePath = getenv("XDG_CACHE_HOME");
+    if (xdgCachePath)
+        setCachePath(string(xdgCachePath) + "/splash/images/");
+    else
+        setCachePath(Utils::getHomePath() + "/.cache/splash/images/");
+}
+
+/*************/
+void ImageCache::setCachePath(const string& path)
+{
+    lock_guard<mutex> lock(_mutex);
+    _cachePath = path;
+    if (_cachePath.empty() || _cachePath.back() != '/')
+        _cachePath += "/";
+}
+
+/*************/
+string ImageCache::getKey(const string& filepath, bool compressed)
+{
+    struct stat fileStat;
+    if (stat(filepath.c_str(), &fileStat) != 0)
+        return "";
+
+    return filepath + ";" + to_string(fileStat.st_size) + ";" + to_string(fileStat.st_mtime) + ";" + to_string(static_cast<int>(compressed));
+}
+
+/*************/
+string ImageCache::getCacheFilePath(const string& key)
+{
+    stringstream filename;
+    filename << hex << std::hash<string>()(key) << ".cache";
+
+    lock_guard<mutex> lock(_mutex);
+    return _cachePath + filename.str();
+}
+
+/*************/
+bool ImageCache::load(const string& filepath, bool compressed, ImageBuffer& image)
+{
+    auto key = getKey(filepath, compressed);
+    if (key.empty())
+        return false;
+
+    auto cacheFilePath = getCacheFilePath(key);
+    auto fd = open(cacheFilePath.c_str(), O_RDONLY);
+    if (fd < 0)
+        return false;
+
+    struct stat fileStat;
+    if (fstat(fd, &fileStat) != 0 || fileStat.st_size < SPLASH_IMAGE_CACHE_HEADER_SIZE)
+    {
+        close(fd);
+        return false;
+    }
+
+    auto fileSize = static_cast<size_t>(fileStat.st_size);
+    auto mappedFile = reinterpret_cast<char*>(mmap(nullptr, fileSize, PROT_READ, MAP_PRIVATE | MAP_POPULATE, fd, 0));
+    close(fd);
+    if (mappedFile == MAP_FAILED)
+        return false;
+
+    // The header holds the key, to detect hash collisions, and the image spec
+    bool success = false;
+    auto headerPtr = mappedFile;
+    if (memcmp(headerPtr, cacheMagic, sizeof(cacheMagic)) == 0)
+    {
+        headerPtr += sizeof(cacheMagic);
+        uint32_t keySize, specSize;
+        memcpy(&keySize, headerPtr, sizeof(keySize));
+        headerPtr += sizeof(keySize);
+
+        if (keySize == key.size() && sizeof(cacheMagic) + 2 * sizeof(uint32_t) + keySize < SPLASH_IMAGE_CACHE_HEADER_SIZE && key.compare(0, keySize, headerPtr, keySize) == 0)
+        {
+            headerPtr += keySize;
+            memcpy(&specSize, headerPtr, sizeof(specSize));
+            headerPtr += sizeof(specSize);
+
+            if (static_cast<size_t>(headerPtr - mappedFile) + specSize <= SPLASH_IMAGE_CACHE_HEADER_SIZE)
+            {
+                ImageBufferSpec spec;
+                spec.from_string(string(headerPtr, specSize));
+                if (spec.rawSize() > 0 && static_cast<size_t>(spec.rawSize()) + SPLASH_IMAGE_CACHE_HEADER_SIZE <= fileSize)
+                {
+                    image = ImageBuffer(spec);
+                    memcpy(image.data(), mappedFile + SPLASH_IMAGE_CACHE_HEADER_SIZE, spec.rawSize());
+                    success = true;
+                }
+            }
+        }
+    }
+
+    munmap(mappedFile, fileSize);
+
+    // The modification time of cache files is their last use, for eviction
+    if (success)
+        utimensat(AT_FDCWD, cacheFilePath.c_str(), nullptr, 0);
+
+    return success;
+}
+
+/*************/
+bool ImageCache::store(const string& filepath, bool compressed, const ImageBuffer& image)
+{
+    auto key = getKey(filepath, compressed);
+    if (key.empty())
+        return false;
+
+    auto spec = image.getSpec();
+    auto specString = spec.to_string();
+    if (sizeof(cacheMagic) + 2 * sizeof(uint32_t) + key.size() + specString.size() > SPLASH_IMAGE_CACHE_HEADER_SIZE)
+        return false;
+
+    string cachePath;
+    {
+        lock_guard<mutex> lock(_mutex);
+        cachePath = _cachePath;
+    }
+
+    // Create the cache directory and its parents
+    for (size_t pos = cachePath.find('/', 1); pos != string::npos; pos = cachePath.find('/', pos + 1))
+        mkdir(cachePath.substr(0, pos).c_str(), 0755);
+
+    vector<char> header(SPLASH_IMAGE_CACHE_HEADER_SIZE, 0);
+    auto headerPtr = header.data();
+    memcpy(headerPtr, cacheMagic, sizeof(cacheMagic));
+    headerPtr += sizeof(cacheMagic);
+    uint32_t keySize = key.size();
+    memcpy(headerPtr, &keySize, sizeof(keySize));
+    headerPtr += sizeof(keySize);
+    memcpy(headerPtr, key.data(), keySize);
+    headerPtr += keySize;
+    uint32_t specSize = specString.size();
+    memcpy(headerPtr, &specSize, sizeof(specSize));
+    headerPtr += sizeof(specSize);
+    memcpy(headerPtr, specString.data(), specSize);
+
+    // Write to a temporary file first, so that concurrent loads never see a partial file
+    auto cacheFilePath = getCacheFilePath(key);
+    auto tmpFilePath = cacheFilePath + "." + to_string(getpid()) + "." + to_string(reinterpret_cast<uintptr_t>(&image)) + ".tmp";
+    auto file = fopen(tmpFilePath.c_str(), "wb");
+    if (!file)
+    {
+        Log::get() << Log::WARNING << "ImageCache::" << __FUNCTION__ << " - Unable to write to cache directory " << cachePath << Log::endl;
+        return false;
+    }
+
+    bool success = fwrite(header.data(), 1, header.size(), file) == header.size();
+    success &= fwrite(image.data(), 1, spec.rawSize(), file) == static_cast<size_t>(spec.rawSize());
+    success &= fclose(file) == 0;
+
+    if (!success || rename(tmpFilePath.c_str(), cacheFilePath.c_str()) != 0)
+    {
+        Log::get() << Log::WARNING << "ImageCache::" << __FUNCTION__ << " - Error while writing cache file for image " << filepath << Log::endl;
+        remove(tmpFilePath.c_str());
+        return false;
+    }
+
+    evict(cachePath);
+    return true;
+}
+
+/*************/
+void ImageCache::evict(const string& cachePath)
+{
+    struct CacheFile
+    {
+        string path;
+        uint64_t size;
+        struct timespec lastUse;
+    };
+
+    const string extension = ".cache";
+    vector<CacheFile> cacheFiles;
+    uint64_t cacheSize = 0;
+    for (const auto& filename : Utils::listDirContent(cachePath))
+    {
+        if (filename.size() <= extension.size() || filename.compare(filename.size() - extension.size(), extension.size(), extension) != 0)
+            continue;
+
+        struct stat fileStat;
+        auto path = cachePath + filename;
+        if (stat(path.c_str(), &fileStat) != 0)
+            continue;
+
+        cacheFiles.push_back({path, static_cast<uint64_t>(fileStat.st_size), fileStat.st_mtim});
+        cacheSize += fileStat.st_size;
+    }
+
+    auto maxSize = _maxSize.load();
+    if (cacheSize <= maxSize)
+        return;
+
+    sort(cacheFiles.begin(), cacheFiles.end(), [](const CacheFile& a, const CacheFile& b) {
+        return a.lastUse.tv_sec < b.lastUse.tv_sec || (a.lastUse.tv_sec == b.lastUse.tv_sec && a.lastUse.tv_nsec < b.lastUse.tv_nsec);
+    });
+
+    for (const auto& file : cacheFiles)
+    {
+        if (cacheSize <= maxSize)
+            break;
+        // The file may already have been removed by a concurrent eviction
+        if (remove(file.path.c_str()) == 0 || errno == ENOENT)
+            cacheSize -= file.size;
+    }
+}
+
+} // end of namespace
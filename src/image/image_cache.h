@@ -0,0 +1,128 @@
+/*
+ * Copyright (C) 2018 Emmanuel Durand
+ *
+ * This file is part of Splash.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Splash is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Splash.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * @image_cache.h
+ * The ImageCache singleton, storing decoded still images on disk
+ */
+
+#ifndef SPLASH_IMAGE_CACHE_H
+#define SPLASH_IMAGE_CACHE_H
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+
+#include "./config.h"
+
+#include "./core/imagebuffer.h"
+
+namespace Splash
+{
+
+class ImageCache
+{
+  public:
+    /**
+     * \brief Get the singleton
+     * \return Return the ImageCache singleton
+     */
+    static ImageCache& get()
+    {
+        static auto instance = new ImageCache;
+        return *instance;
+    }
+
+    /**
+     * \brief Load a decoded image from the cache
+     * \param filepath Path to the original image file
+     * \param compressed True to look for the DXT compressed version of the image
+     * \param image Image buffer to fill
+     * \return Return true if the image was found in the cache, and is up to date
+     */
+    bool load(const std::string& filepath, bool compressed, ImageBuffer& image);
+
+    /**
+     * \brief Store a decoded image in the cache
+     * \param filepath Path to the original image file
+     * \param compressed True if the image is the DXT compressed version
+     * \param image Decoded image
+     * \return Return true if all went well
+     */
+    bool store(const std::string& filepath, bool compressed, const ImageBuffer& image);
+
+    /**
+     * \brief Get the cache directory
+     * \return Return the cache directory
+     */
+    std::string getCachePath() const { return _cachePath; }
+
+    /**
+     * \brief Set the cache directory
+     * \param path Cache directory
+     */
+    void setCachePath(const std::string& path);
+
+    /**
+     * \brief Get the maximum size of the cache
+     * \return Return the size in bytes
+     */
+    uint64_t getMaxSize() const { return _maxSize; }
+
+    /**
+     * \brief Set the maximum size of the cache. Least recently used images are removed when it is exceeded
+     * \param size Size in bytes
+     */
+    void setMaxSize(uint64_t size) { _maxSize = size; }
+
+  private:
+    std::mutex _mutex{};
+    std::string _cachePath{""};
+    std::atomic<uint64_t> _maxSize{2ull << 30};
+
+    ImageCache();
+    ImageCache(const ImageCache&) = delete;
+    ImageCache& operator=(const ImageCache&) = delete;
+
+    /**
+     * \brief Get the key identifying an image file in its current state
+     * \param filepath Path to the original image file
+     * \param compressed True for the compressed version
+     * \return Return the key, or an empty string if the file does not exist
+     */
+    static std::string getKey(const std::string& filepath, bool compressed);
+
+    /**
+     * \brief Get the path of the cache file for the given key
+     * \param key Image key
+     * \return Return the cache file path
+     */
+    std::string getCacheFilePath(const std::string& key);
+
+    /**
+     * \brief Remove the least recently used cache files until the cache fits in its maximum size
+     * \param cachePath Cache directory
+     */
+    void evict(const std::string& cachePath);
+};
+
+} // end of namespace
+
+#endif // SPLASH_IMAGE_CACHE_H
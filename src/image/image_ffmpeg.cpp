@@ -1,5 +1,6 @@
 #include "./image/image_ffmpeg.h"
 
+#include <algorithm>
 #include <chrono>
 #include <functional>
 #include <future>
@@ -10,6 +11,7 @@
 #include <fstream>
 #include <hap.h>
 
+#include "./image/decode_scheduler.h"
 #include "./utils/cgutils.h"
 #include "./utils/osutils.h"
 #include "./utils/log.h"
@@ -54,13 +56,21 @@ void Image_FFmpeg::freeFFmpegObjects()
     if (_continueRead)
     {
         _continueRead = false;
+#if HAVE_PORTAUDIO
+        {
+            lock_guard<mutex> lockAudio(_audioMutex);
+            _audioCondition.notify_all();
+        }
+#endif
         _readLoopThread.join();
         _videoDisplayThread.join();
 #if HAVE_PORTAUDIO
         _audioThread.join();
+        _audioRingBuffer.flush();
         if (_speaker)
             _speaker.reset();
 #endif
+        DecodeScheduler::get().unregisterMedia(this);
     }
 
     if (_avContext)
@@ -68,6 +78,8 @@ void Image_FFmpeg::freeFFmpegObjects()
         avformat_close_input(&_avContext);
         _avContext = nullptr;
     }
+
+    _cachedClip.reset();
 }
 
 /*************/
@@ -84,7 +96,19 @@ bool Image_FFmpeg::read(const string& filename)
     // First: cleanup
     freeFFmpegObjects();
 
-    if (avformat_open_input(&_avContext, filename.c_str(), nullptr, nullptr) != 0)
+    // Live streams are demuxed without buffering, and probed as briefly as possible
+    AVDictionary* openOptions = nullptr;
+    if (_lowLatency)
+    {
+        av_dict_set(&openOptions, "fflags", "nobuffer", 0);
+        av_dict_set(&openOptions, "probesize", "32768", 0);
+        av_dict_set(&openOptions, "analyzeduration", "500000", 0);
+    }
+    _liveOffset = numeric_limits<int64_t>::min();
+
+    auto openStatus = avformat_open_input(&_avContext, filename.c_str(), nullptr, &openOptions);
+    av_dict_free(&openOptions);
+    if (openStatus != 0)
     {
         Log::get() << Log::WARNING << "Image_FFmpeg::" << __FUNCTION__ << " - Couldn't read file " << filename << Log::endl;
         return false;
@@ -99,6 +123,7 @@ bool Image_FFmpeg::read(const string& filename)
 
     Log::get() << Log::MESSAGE << "Image_FFmpeg::" << __FUNCTION__ << " - Successfully loaded file " << filename << Log::endl;
     av_dump_format(_avContext, 0, filename.c_str(), 0);
+    _fullFilepath = filename;
 
 #if HAVE_LINUX
     // Give the kernel hints about how to read the file
@@ -246,7 +271,6 @@ void Image_FFmpeg::readLoop()
     _videoFormat.resize(1024);
     avcodec_string(const_cast<char*>(_videoFormat.data()), _videoFormat.size(), videoCodecContext, 0);
 
-    videoCodecContext->thread_count = min(Utils::getCoreCount(), 16);
     auto videoCodec = avcodec_find_decoder(videoCodecContext->codec_id);
     auto isHap = false;
 
@@ -271,10 +295,28 @@ void Image_FFmpeg::readLoop()
 
     if (videoCodec)
     {
+        // Get this media's share of the decode cores, instead of each media using all of them
+        auto framerate = av_q2d(videoStream->avg_frame_rate);
+        auto allocation = DecodeScheduler::get().registerMedia(this, videoCodecContext->width, videoCodecContext->height, framerate > 0.0 ? framerate : 30.0, _intraOnly);
+        videoCodecContext->thread_count = allocation.threadCount;
+        videoCodecContext->thread_type = allocation.sliceThreading ? FF_THREAD_SLICE : FF_THREAD_FRAME;
+
+        // Frame threading delays the output by one frame per thread
+        if (_lowLatency)
+        {
+            videoCodecContext->flags |= AV_CODEC_FLAG_LOW_DELAY;
+            videoCodecContext->thread_type = FF_THREAD_SLICE;
+        }
+
+        // Decoder threads inherit the affinity of the thread creating them, which keeps them off the reserved cores
+        if (!DecodeScheduler::get().getReservedCores().empty())
+            Utils::setAffinity(DecodeScheduler::get().getDecodeCores());
+
         AVDictionary* optionsDict = nullptr;
         if (avcodec_open2(videoCodecContext, videoCodec, &optionsDict) < 0)
         {
             Log::get() << Log::WARNING << "Image_FFmpeg::" << __FUNCTION__ << " - Could not open video codec for file " << _filepath << Log::endl;
+            DecodeScheduler::get().unregisterMedia(this);
             return;
         }
     }
@@ -353,14 +395,57 @@ void Image_FFmpeg::readLoop()
 
     _videoTimeBase = (double)videoStream->time_base.num / (double)videoStream->time_base.den;
 
+    // Used to detect late frames
+    auto averageFramerate = av_q2d(videoStream->avg_frame_rate);
+    int64_t frameDuration = averageFramerate > 0.0 ? max<int64_t>(1, static_cast<int64_t>(1e6 / averageFramerate)) : 33333;
+    bool skipNonReference = false;
+    int64_t previousTiming = -1;
+
     // This implements looping
     do
     {
         _startTime = Timer::getTime();
 
+        // If the clip has been fully decoded already, by this media or another one, play it from memory
+        if (!_cacheClip)
+            _cachedClip.reset();
+        else if (!_cachedClip)
+            _cachedClip = ClipCache::get().getClip(_fullFilepath);
+
+        if (_cachedClip)
+        {
+            playFromCache();
+
+            // This prevents looping to happen before the queue has been consumed
+            lock_guard<mutex> lockEnd(_videoEndMutex);
+            seek(_trimStart);
+            continue;
+        }
+
+        // Otherwise, keep the decoded frames if this pass goes uninterrupted from the beginning to the end of the clip
+        unique_ptr<CachedClip> clipToCache{};
+        uint64_t seekCountAtStart = 0;
+        {
+            lock_guard<mutex> lockSeek(_videoSeekMutex);
+            seekCountAtStart = _seekCount;
+        }
+
+        bool hasAudio = false;
+#if HAVE_PORTAUDIO
+        hasAudio = _audioStreamIndex >= 0;
+#endif
+        if (_cacheClip && !hasAudio && !_lowLatency && _trimStart == 0.f && _trimEnd == 0.f)
+            clipToCache = unique_ptr<CachedClip>(new CachedClip());
+
+        int64_t packetArrival = 0;
+#if HAVE_PORTAUDIO
+        bool droppingAudio = false;
+#endif
         auto shouldContinueLoop = [&]() -> bool {
             lock_guard<mutex> lock(_videoSeekMutex);
-            return _continueRead && av_read_frame(_avContext, &packet) >= 0;
+            auto status = _continueRead && av_read_frame(_avContext, &packet) >= 0;
+            packetArrival = Timer::getTime();
+            return status;
         };
 
         while (shouldContinueLoop())
@@ -368,6 +453,16 @@ void Image_FFmpeg::readLoop()
             // Reading the video
             if (packet.stream_index == _videoStreamIndex && _videoSeekMutex.try_lock())
             {
+                // Intra frames do not depend on each other, so late ones are not even decoded
+                if (_intraOnly && packet.pts != AV_NOPTS_VALUE && getFrameLateness(static_cast<int64_t>((double)packet.pts * _videoTimeBase * 1e6)) > frameDuration)
+                {
+                    ++_skippedFrames;
+                    clipToCache.reset();
+                    _videoSeekMutex.unlock();
+                    av_packet_unref(&packet);
+                    continue;
+                }
+
                 auto img = unique_ptr<ImageBuffer>();
                 uint64_t timing = 0;
                 bool hasFrame = false;
@@ -384,14 +479,6 @@ void Image_FFmpeg::readLoop()
 
                     if (frameFinished)
                     {
-                        sws_scale(swsContext, (const uint8_t* const*)frame->data, frame->linesize, 0, videoCodecContext->height, rgbFrame->data, rgbFrame->linesize);
-
-                        ImageBufferSpec spec(videoCodecContext->width, videoCodecContext->height, 3, 16, ImageBufferSpec::Type::UINT8, "YUYV");
-                        img.reset(new ImageBuffer(spec));
-
-                        unsigned char* pixels = reinterpret_cast<unsigned char*>(img->data());
-                        copy(buffer.begin(), buffer.end(), pixels);
-
                         if (packet.pts != AV_NOPTS_VALUE)
                             timing = static_cast<uint64_t>((double)av_frame_get_best_effort_timestamp(frame) * _videoTimeBase * 1e6);
                         else
@@ -399,7 +486,42 @@ void Image_FFmpeg::readLoop()
                         // This handles repeated frames
                         timing += frame->repeat_pict * _videoTimeBase * 0.5;
 
-                        hasFrame = true;
+                        // Frames missing from the sequence while skipping have been discarded by the decoder
+                        if (skipNonReference && previousTiming >= 0 && static_cast<int64_t>(timing) > previousTiming)
+                            _skippedFrames += max<int64_t>(0, (static_cast<int64_t>(timing) - previousTiming + frameDuration / 2) / frameDuration - 1);
+                        previousTiming = timing;
+
+                        // While behind schedule, the decoder skips non-reference frames, until a frame is on time again
+                        auto lateness = getFrameLateness(timing);
+                        if (!skipNonReference && lateness > frameDuration)
+                        {
+                            skipNonReference = true;
+                            videoCodecContext->skip_frame = AVDISCARD_NONREF;
+                        }
+                        else if (skipNonReference && lateness <= 0)
+                        {
+                            skipNonReference = false;
+                            videoCodecContext->skip_frame = AVDISCARD_DEFAULT;
+                        }
+
+                        // Late frames are dropped before being converted
+                        if (lateness > frameDuration)
+                        {
+                            ++_lateFrames;
+                            clipToCache.reset();
+                        }
+                        else
+                        {
+                            sws_scale(swsContext, (const uint8_t* const*)frame->data, frame->linesize, 0, videoCodecContext->height, rgbFrame->data, rgbFrame->linesize);
+
+                            ImageBufferSpec spec(videoCodecContext->width, videoCodecContext->height, 3, 16, ImageBufferSpec::Type::UINT8, "YUYV");
+                            img.reset(new ImageBuffer(spec));
+
+                            unsigned char* pixels = reinterpret_cast<unsigned char*>(img->data());
+                            copy(buffer.begin(), buffer.end(), pixels);
+
+                            hasFrame = true;
+                        }
                     }
 
                     av_frame_unref(frame);
@@ -451,6 +573,24 @@ void Image_FFmpeg::readLoop()
                     }
                 }
 
+                if (hasFrame && clipToCache)
+                {
+                    auto clipSize = clipToCache->size + static_cast<int64_t>(img->getSize());
+                    if (clipSize > _cacheMaxSize || !ClipCache::get().canFit(clipSize))
+                    {
+                        Log::get() << Log::MESSAGE << "Image_FFmpeg::" << __FUNCTION__ << " - File " << _filepath << " is too large to be cached in memory" << Log::endl;
+                        clipToCache.reset();
+                    }
+                    else
+                    {
+                        CachedClip::Frame cachedFrame;
+                        cachedFrame.frame = unique_ptr<ImageBuffer>(new ImageBuffer(*img));
+                        cachedFrame.timing = timing;
+                        clipToCache->frames.push_back(std::move(cachedFrame));
+                        clipToCache->size = clipSize;
+                    }
+                }
+
                 int64_t totalBufferSize = 0;
                 {
                     lock_guard<mutex> lockFrames(_videoQueueMutex);
@@ -463,6 +603,8 @@ void Image_FFmpeg::readLoop()
                         _timedFrames.emplace_back();
                         std::swap(_timedFrames[_timedFrames.size() - 1].frame, img);
                         _timedFrames[_timedFrames.size() - 1].timing = timing;
+                        _timedFrames[_timedFrames.size() - 1].arrival = packetArrival;
+                        _videoQueueCondition.notify_one();
                     }
 
                     // Check the current buffer size (sum of all frames in buffer)
@@ -503,20 +645,44 @@ void Image_FFmpeg::readLoop()
                         _audioDeviceOutputUpdated = false;
                     }
 
-                    size_t dataSize = av_samples_get_buffer_size(nullptr, audioCodecContext->channels, frame->nb_samples, audioCodecContext->sample_fmt, 1);
-                    auto buffer = ResizableArray<uint8_t>(dataSize);
-                    auto linesize = dataSize / audioCodecContext->channels;
-                    if (_planar)
-                        for (int c = 0; c < audioCodecContext->channels; ++c)
-                            copy(frame->extended_data[c], frame->extended_data[c] + linesize, buffer.data() + c * linesize);
-                    else
-                        copy(frame->extended_data[0], frame->extended_data[0] + dataSize, buffer.data());
-
                     TimedAudioFrame timedFrame;
-                    timedFrame.frame = std::move(buffer);
                     timedFrame.timing = timing;
-                    lock_guard<mutex> lockAudio(_audioMutex);
-                    _audioQueue.push_back(std::move(timedFrame));
+                    timedFrame.size = av_samples_get_buffer_size(nullptr, audioCodecContext->channels, frame->nb_samples, audioCodecContext->sample_fmt, 1);
+                    auto recordSize = sizeof(timedFrame) + timedFrame.size;
+                    if (recordSize > _audioRingBuffer.capacity())
+                    {
+                        Log::get() << Log::WARNING << "Image_FFmpeg::" << __FUNCTION__ << " - Audio frame too large to be queued, dropping it" << Log::endl;
+                        av_frame_unref(frame);
+                        continue;
+                    }
+
+                    // Waiting for the audio loop to make some room would stall the video, so the frame is dropped instead.
+                    // This only happens if the audio is muxed far ahead of the video
+                    if (_audioRingBuffer.getWriteSpace() < recordSize)
+                    {
+                        if (!droppingAudio)
+                            Log::get() << Log::WARNING << "Image_FFmpeg::" << __FUNCTION__ << " - Audio queue is full, dropping audio frames" << Log::endl;
+                        droppingAudio = true;
+                        av_frame_unref(frame);
+                        continue;
+                    }
+                    droppingAudio = false;
+
+                    // Samples are copied straight from the decoded frame to the ring buffer
+                    if (_continueRead)
+                    {
+                        _audioRingBuffer.copyIn(0, reinterpret_cast<const uint8_t*>(&timedFrame), sizeof(timedFrame));
+                        auto linesize = timedFrame.size / audioCodecContext->channels;
+                        if (_planar)
+                            for (int c = 0; c < audioCodecContext->channels; ++c)
+                                _audioRingBuffer.copyIn(sizeof(timedFrame) + c * linesize, frame->extended_data[c], linesize);
+                        else
+                            _audioRingBuffer.copyIn(sizeof(timedFrame), frame->extended_data[0], timedFrame.size);
+                        _audioRingBuffer.commitWrite(recordSize);
+
+                        lock_guard<mutex> lockAudio(_audioMutex);
+                        _audioCondition.notify_all();
+                    }
 
                     av_frame_unref(frame);
                 }
@@ -528,11 +694,22 @@ void Image_FFmpeg::readLoop()
             }
         }
 
+        if (clipToCache && _continueRead && !clipToCache->frames.empty())
+        {
+            bool uninterrupted = false;
+            {
+                lock_guard<mutex> lockSeek(_videoSeekMutex);
+                uninterrupted = (_seekCount == seekCountAtStart);
+            }
+            if (uninterrupted)
+                _cachedClip = ClipCache::get().addClip(_fullFilepath, std::move(clipToCache));
+        }
+
         // This prevents looping to happen before the queue has been consumed
         lock_guard<mutex> lockEnd(_videoEndMutex);
         // Seek to the beginning, or whatever time is set in _trimStart
         seek(_trimStart);
-    } while (_loopOnVideo && _continueRead);
+    } while (_loopOnVideo && _continueRead && !_lowLatency); // Live streams can not loop
 
     av_frame_free(&rgbFrame);
     av_frame_free(&frame);
@@ -540,6 +717,7 @@ void Image_FFmpeg::readLoop()
         sws_freeContext(swsContext);
     avcodec_close(videoCodecContext);
     avcodec_free_context(&videoCodecContext);
+    DecodeScheduler::get().unregisterMedia(this);
     _videoStreamIndex = -1;
 
 #if HAVE_PORTAUDIO
@@ -556,40 +734,184 @@ void Image_FFmpeg::readLoop()
 /*************/
 void Image_FFmpeg::audioLoop()
 {
+    // Reused from frame to frame, it only grows to fit the largest decoded frame
+    ResizableArray<uint8_t> buffer;
+    TimedAudioFrame timedFrame;
+
     while (_continueRead)
     {
-        auto localQueue = deque<TimedAudioFrame>();
         {
-            lock_guard<mutex> lockAudio(_audioMutex);
-            std::swap(localQueue, _audioQueue);
+            unique_lock<mutex> lockAudio(_audioMutex);
+            _audioCondition.wait_for(lockAudio, chrono::milliseconds(50), [&]() { return !_continueRead || _audioRingBuffer.getReadSpace() >= sizeof(TimedAudioFrame); });
         }
 
-        if (localQueue.empty())
-            this_thread::sleep_for(chrono::milliseconds(10));
+        // Frames are committed as a whole, so the samples are available along with the header
+        if (!_continueRead || _audioRingBuffer.getReadSpace() < sizeof(TimedAudioFrame))
+            continue;
 
-        while (!localQueue.empty() && _continueRead && _speaker)
-        {
-            auto currentTime = Timer::getTime() - _startTime;
+        _audioRingBuffer.copyOut(0, reinterpret_cast<uint8_t*>(&timedFrame), sizeof(timedFrame));
+        if (buffer.size() < timedFrame.size)
+            buffer.resize(timedFrame.size);
+        _audioRingBuffer.copyOut(sizeof(timedFrame), buffer.data(), timedFrame.size);
+        _audioRingBuffer.commitRead(sizeof(timedFrame) + timedFrame.size);
 
-            if (localQueue[0].timing - currentTime < 0)
+        // Wait until the frame is due in less than 100ms. Seeking wakes this up, and makes the frame late
+        int64_t waitTime = 0;
+        {
+            unique_lock<mutex> lockAudio(_audioMutex);
+            _audioCondition.notify_all();
+            waitTime = timedFrame.timing - (Timer::getTime() - _startTime);
+            while (_continueRead && waitTime > 100000)
             {
-                localQueue.pop_front();
-                continue;
+                _audioCondition.wait_for(lockAudio, chrono::microseconds(waitTime - 100000));
+                waitTime = timedFrame.timing - (Timer::getTime() - _startTime);
             }
+        }
+
+        if (waitTime < 0 || !_continueRead || !_speaker)
+            continue;
+
+        _speaker->addToQueue(buffer.data(), timedFrame.size, timedFrame.timing);
+    }
+}
+
+/*************/
+void Image_FFmpeg::syncToAudioClock()
+{
+    if (!_speaker)
+        return;
+
+    auto audioTime = _speaker->getPlaybackTime();
+    if (audioTime < 0)
+        return;
 
-            while (localQueue[0].timing - currentTime > 100000)
+    // Large gaps (i.e. right after a seek) are corrected at once, small ones progressively to prevent jitter
+    auto drift = _currentTime - audioTime;
+    _audioClockDrift = drift;
+    auto correction = abs(drift) > 100000 ? drift : drift / 8;
+    _startTime += correction;
+    _currentTime -= correction;
+}
+#endif
+
+/*************/
+void Image_FFmpeg::displayLiveFrames(deque<TimedFrame>& queue)
+{
+    while (!queue.empty() && _continueRead)
+    {
+        auto& timedFrame = queue.front();
+
+        // The offset between stream timestamps and local time is the lowest transit time seen. It rises slowly
+        // to follow the drift between the sender and local clocks
+        if (timedFrame.timing != 0)
+        {
+            auto transit = timedFrame.arrival - timedFrame.timing;
+            int64_t liveOffset = _liveOffset;
+            if (liveOffset == numeric_limits<int64_t>::min() || transit < liveOffset)
+                _liveOffset = transit;
+            else
+                _liveOffset = liveOffset + min<int64_t>(transit - liveOffset, 100);
+
+            // This keeps the audio and the late frame policy in sync with what is shown
+            _startTime = _liveOffset + _jitterBufferTarget;
+        }
+
+        // Only the latest due frame is shown
+        auto now = Timer::getTime();
+        if (queue.size() > 1 && queue[1].timing != 0 && queue[1].timing + _startTime <= now)
+        {
+            _liveLatency.addDropped(1);
+            queue.pop_front();
+            continue;
+        }
+
+        if (timedFrame.timing != 0)
+        {
+            auto waitTime = timedFrame.timing + _startTime - now;
+            if (waitTime > 2000)
+                this_thread::sleep_for(chrono::microseconds(waitTime));
+        }
+
+        _elapsedTime = timedFrame.timing;
+        _liveLatency.addSample(Timer::getTime() - timedFrame.arrival);
+
+        // Frames are stamped with their arrival time, so that the latency measured up to the display includes the jitter buffer
+        stampFrame(*timedFrame.frame, timedFrame.arrival);
+        {
+            lock_guard<shared_timed_mutex> lock(_writeMutex);
+            if (!_bufferImage)
+                _bufferImage = unique_ptr<ImageBuffer>(new ImageBuffer());
+            std::swap(_bufferImage, timedFrame.frame);
+            _imageUpdated = true;
+            updateTimestamp();
+        }
+
+        queue.pop_front();
+    }
+}
+
+/*************/
+int64_t Image_FFmpeg::getFrameLateness(int64_t timing) const
+{
+    // No clock to be late against after a seek, while paused, or if frames are not timed
+    int64_t startTime = _startTime;
+    if (startTime == -1 || _paused || timing == 0)
+        return 0;
+
+    return Timer::getTime() - startTime - timing;
+}
+
+/*************/
+void Image_FFmpeg::playFromCache()
+{
+    auto clip = _cachedClip;
+    size_t frameIndex = 0;
+
+    while (_continueRead && frameIndex < clip->frames.size())
+    {
+        {
+            lock_guard<mutex> lockSeek(_videoSeekMutex);
+            if (_cacheSeekTiming >= 0)
             {
-                this_thread::sleep_for(chrono::milliseconds(5));
-                currentTime = Timer::getTime() - _startTime;
+                auto seekTiming = _cacheSeekTiming;
+                auto frameIt = lower_bound(clip->frames.begin(), clip->frames.end(), seekTiming, [](const CachedClip::Frame& f, int64_t t) { return f.timing < t; });
+                frameIndex = std::distance(clip->frames.begin(), frameIt);
+                _cacheSeekTiming = -1;
+                if (frameIndex >= clip->frames.size())
+                    break;
             }
 
-            _speaker->addToQueue(localQueue[0].frame);
+            // Frames view the memory of the cache instead of copying it, the clip being kept alive until they are released
+            const auto& cachedFrame = clip->frames[frameIndex];
+            auto frameBuffer = ResizableArray<char>(cachedFrame.frame->data(), cachedFrame.frame->getSize(), [clip]() {});
+            lock_guard<mutex> lockFrames(_videoQueueMutex);
+            _framesSize.push_back(cachedFrame.frame->getSize());
+            _timedFrames.emplace_back();
+            _timedFrames.back().frame = unique_ptr<ImageBuffer>(new ImageBuffer(cachedFrame.frame->getSpec(), std::move(frameBuffer)));
+            _timedFrames.back().timing = cachedFrame.timing;
+            _timedFrames.back().arrival = Timer::getTime();
+            _videoQueueCondition.notify_one();
+        }
+        ++frameIndex;
 
-            localQueue.pop_front();
+        int64_t totalBufferSize = 0;
+        int timedFramesBuffered = 0;
+        {
+            lock_guard<mutex> lockFrames(_videoQueueMutex);
+            for (auto& f : _framesSize)
+                totalBufferSize += f;
+            timedFramesBuffered = _timedFrames.size();
+        }
+
+        // Same buffering limit as when decoding
+        while (timedFramesBuffered > 0 && totalBufferSize > _maximumBufferSize / 2 && _continueRead)
+        {
+            this_thread::sleep_for(chrono::milliseconds(5));
+            lock_guard<mutex> lockQueue(_videoQueueMutex);
+            timedFramesBuffered = _timedFrames.size();
         }
     }
 }
-#endif
 
 /*************/
 void Image_FFmpeg::seek(float seconds)
@@ -610,6 +932,9 @@ void Image_FFmpeg::seek(float seconds)
     else if (seconds > duration)
         seconds = duration;
 
+    ++_seekCount;
+    _cacheSeekTiming = static_cast<int64_t>(seconds * 1e6);
+
     int frame = static_cast<int>(floor(seconds / _videoTimeBase));
     if (avformat_seek_file(_avContext, _videoStreamIndex, 0, frame, frame, seekFlag) < 0)
     {
@@ -625,6 +950,9 @@ void Image_FFmpeg::seek(float seconds)
 #if HAVE_PORTAUDIO
         if (_speaker)
             _speaker->clearQueue();
+        _audioRingBuffer.flush();
+        lock_guard<mutex> lockAudio(_audioMutex);
+        _audioCondition.notify_all();
 #endif
     }
 }
@@ -644,11 +972,20 @@ void Image_FFmpeg::videoDisplayLoop()
     while (_continueRead)
     {
         auto localQueue = deque<TimedFrame>();
-        if (!_timedFrames.empty())
         {
-            lock_guard<mutex> lockFrames(_videoQueueMutex);
-            std::swap(localQueue, _timedFrames);
-            _framesSize.clear();
+            unique_lock<mutex> lockFrames(_videoQueueMutex);
+            _videoQueueCondition.wait_for(lockFrames, chrono::milliseconds(5), [&]() { return !_timedFrames.empty() || !_continueRead; });
+            if (!_timedFrames.empty())
+            {
+                std::swap(localQueue, _timedFrames);
+                _framesSize.clear();
+            }
+        }
+
+        if (_lowLatency)
+        {
+            displayLiveFrames(localQueue);
+            continue;
         }
 
         // This sets the start time after a seek
@@ -706,6 +1043,10 @@ void Image_FFmpeg::videoDisplayLoop()
                 else
                 {
                     _currentTime = Timer::getTime() - _startTime;
+#if HAVE_PORTAUDIO
+                    if (_useAudioClock)
+                        syncToAudioClock();
+#endif
                 }
 
                 // If the frame is beyond the trimming end, seek to the trimming start
@@ -742,6 +1083,8 @@ void Image_FFmpeg::videoDisplayLoop()
 
                 _elapsedTime = timedFrame.timing;
 
+                // Frames are stamped when their time comes: waiting in the queue for it is buffering ahead of the clock, not latency
+                stampFrame(*timedFrame.frame);
                 lock_guard<shared_timed_mutex> lock(_writeMutex);
                 if (!_bufferImage)
                     _bufferImage = unique_ptr<ImageBuffer>(new ImageBuffer());
@@ -778,6 +1121,29 @@ void Image_FFmpeg::registerAttributes()
     setAttributeParameter("bufferSize", true, true);
     setAttributeDescription("bufferSize", "Set the maximum buffer size for the video (in MB)");
 
+    addAttribute("cacheInMemory",
+        [&](const Values& args) {
+            _cacheClip = static_cast<bool>(args[0].as<int>());
+            return true;
+        },
+        [&]() -> Values { return {static_cast<int>(_cacheClip)}; },
+        {'n'});
+    setAttributeParameter("cacheInMemory", true, true);
+    setAttributeDescription("cacheInMemory",
+        "If set to 1, the decoded frames are kept in memory after the first pass and the clip is replayed from there. "
+        "The cache is shared between all media reading the same file, and is not used for files with an audio track");
+
+    addAttribute("cacheMaxSize",
+        [&](const Values& args) {
+            int64_t sizeMB = max(16, args[0].as<int>());
+            _cacheMaxSize = sizeMB * (int64_t)1048576;
+            return true;
+        },
+        [&]() -> Values { return {_cacheMaxSize / (int64_t)1048576}; },
+        {'n'});
+    setAttributeParameter("cacheMaxSize", true, true);
+    setAttributeDescription("cacheMaxSize", "Maximum size of the decoded clip for it to be cached in memory (in MB)");
+
     addAttribute("duration",
         [&](const Values&) { return false; },
         [&]() -> Values {
@@ -799,8 +1165,82 @@ void Image_FFmpeg::registerAttributes()
         {'s'});
     setAttributeParameter("audioDeviceOutput", true, true);
     setAttributeDescription("audioDeviceOutput", "Name of the audio device to send the audio to (i.e. Jack writable client)");
+
+    addAttribute("audioClockMaster",
+        [&](const Values& args) {
+            _useAudioClock = args[0].as<int>();
+            _audioClockDrift = 0;
+            return true;
+        },
+        [&]() -> Values { return {(int)_useAudioClock}; },
+        {'n'});
+    setAttributeParameter("audioClockMaster", true, true);
+    setAttributeDescription("audioClockMaster",
+        "If set to 1, the audio playback position is used as the clock to display the video frames. "
+        "Ignored if useClock is set and a master clock is available");
+
+    addAttribute("audioClockDrift",
+        [&](const Values&) { return false; },
+        [&]() -> Values { return {static_cast<float>(_audioClockDrift) / 1e3f}; });
+    setAttributeParameter("audioClockDrift", false, true);
+    setAttributeDescription("audioClockDrift", "Drift of the video clock relative to the audio playback position, in ms");
 #endif
 
+    addAttribute("lowLatency",
+        [&](const Values& args) {
+            bool lowLatency = args[0].as<int>();
+            if (lowLatency == _lowLatency)
+                return true;
+
+            _lowLatency = lowLatency;
+            _liveLatency.reset();
+            // Demuxing options are set when opening the stream
+            if (_avContext)
+            {
+                auto filepath = _fullFilepath;
+                read(filepath);
+            }
+            return true;
+        },
+        [&]() -> Values { return {static_cast<int>(_lowLatency)}; },
+        {'n'});
+    setAttributeParameter("lowLatency", true, true);
+    setAttributeDescription("lowLatency",
+        "If set to 1, the media is read as a live stream (i.e. RTSP, UDP or SRT): no buffering, minimal probing, no looping, "
+        "and only the latest frame is shown after the jitter buffer delay");
+
+    addAttribute("jitterBuffer",
+        [&](const Values& args) {
+            _jitterBufferTarget = max(0.f, args[0].as<float>()) * 1000;
+            return true;
+        },
+        [&]() -> Values { return {static_cast<float>(_jitterBufferTarget) / 1000.f}; },
+        {'n'});
+    setAttributeParameter("jitterBuffer", true, true);
+    setAttributeDescription("jitterBuffer", "Delay added to the lowest network transit time before showing a live frame, in ms");
+
+    addAttribute("liveLatency",
+        [&](const Values&) { return false; },
+        [&]() -> Values {
+            return {_liveLatency.getLast(), _liveLatency.getMean(), _liveLatency.getPercentile(0.95f), _liveLatency.getMax(), static_cast<int64_t>(_liveLatency.getDroppedCount())};
+        });
+    setAttributeParameter("liveLatency", false, true);
+    setAttributeDescription("liveLatency",
+        "Delay between reading and showing live frames, in ms: last, mean, 95th percentile and maximum, followed by the count of frames "
+        "dropped to show the latest one");
+
+    addAttribute("lateFrames",
+        [&](const Values&) { return false; },
+        [&]() -> Values { return {static_cast<int64_t>(_lateFrames)}; });
+    setAttributeParameter("lateFrames", false, true);
+    setAttributeDescription("lateFrames", "Number of frames decoded too late to be shown, and dropped");
+
+    addAttribute("skippedFrames",
+        [&](const Values&) { return false; },
+        [&]() -> Values { return {static_cast<int64_t>(_skippedFrames)}; });
+    setAttributeParameter("skippedFrames", false, true);
+    setAttributeDescription("skippedFrames", "Number of frames not decoded at all to catch up when the decoding is late");
+
     addAttribute("loop",
         [&](const Values& args) {
             _loopOnVideo = (bool)args[0].as<int>();
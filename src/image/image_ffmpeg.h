@@ -25,12 +25,15 @@
 #ifndef SPLASH_IMAGE_FFMPEG_H
 #define SPLASH_IMAGE_FFMPEG_H
 
+#define SPLASH_FFMPEG_AUDIO_RINGBUFFER_SIZE (8 * 1024 * 1024)
+
 #include "./config.h"
 
 #include <atomic>
 #include <condition_variable>
 #include <deque>
 #include <future>
+#include <limits>
 #include <mutex>
 #include <thread>
 
@@ -44,7 +47,10 @@ extern "C" {
 
 #include "./core/attribute.h"
 #include "./core/coretypes.h"
+#include "./core/ring_buffer.h"
+#include "./image/clip_cache.h"
 #include "./image/image.h"
+#include "./utils/latencystats.h"
 #if HAVE_PORTAUDIO
 #include "./sound/speaker.h"
 #endif
@@ -89,8 +95,10 @@ class Image_FFmpeg : public Image
     {
         std::unique_ptr<ImageBuffer> frame{};
         int64_t timing{0ull}; // in us
+        int64_t arrival{0};   // in us, local time at which the packet was read
     };
     std::deque<TimedFrame> _timedFrames;
+    std::condition_variable _videoQueueCondition{}; //!< Notified when frames are added to _timedFrames
 
     // Frame size history, used to keep the frame buffer smaller than _maximumBufferSize
     std::vector<int64_t> _framesSize{};
@@ -113,6 +121,16 @@ class Image_FFmpeg : public Image
     float _trimStart{0.f}; //!< Start trimming time
     float _trimEnd{0.f};   //!< End trimming time
 
+    // Low latency mode, for live streams
+    std::atomic_bool _lowLatency{false};
+    int64_t _jitterBufferTarget{50000};                                    //!< Delay added to the lowest transit time seen, in us
+    std::atomic<int64_t> _liveOffset{std::numeric_limits<int64_t>::min()}; //!< Lowest transit time seen, from stream timestamps to local time
+    LatencyStats _liveLatency{};                                           //!< Delay between reading a frame and showing it
+
+    // Late frame policy counters
+    std::atomic<uint64_t> _lateFrames{0};    //!< Frames decoded too late to be shown
+    std::atomic<uint64_t> _skippedFrames{0}; //!< Frames not decoded to catch up
+
     std::mutex _clockMutex;
     bool _useClock{false};
     int64_t _clockTime{-1};
@@ -121,6 +139,14 @@ class Image_FFmpeg : public Image
     double _videoTimeBase{0.033};
     int _videoStreamIndex{-1};
     std::string _videoFormat{""}; //!< Holds the current video format information
+    std::string _fullFilepath{""};
+
+    // Decoded clip cache, to replay short clips from memory
+    bool _cacheClip{false};
+    int64_t _cacheMaxSize{(int64_t)1 << 28};
+    std::shared_ptr<const CachedClip> _cachedClip{};
+    uint64_t _seekCount{0};       //!< Incremented on every seek, protected by _videoSeekMutex
+    int64_t _cacheSeekTiming{-1}; //!< Position to jump to when playing from the cache, protected by _videoSeekMutex
 
 #if HAVE_PORTAUDIO
     std::unique_ptr<Speaker> _speaker;
@@ -129,15 +155,19 @@ class Image_FFmpeg : public Image
     bool _planar{false};
     std::string _audioDeviceOutput{""};
     bool _audioDeviceOutputUpdated{false};
+    bool _useAudioClock{false};               //!< If true, the audio playback position drives the video
+    std::atomic<int64_t> _audioClockDrift{0}; //!< Local clock minus audio playback position, in us
 
     std::thread _audioThread{};
+    // Decoded audio frames are written to the ring buffer by the read loop as this header followed by the samples
     struct TimedAudioFrame
     {
-        ResizableArray<uint8_t> frame{};
-        int64_t timing{0ull}; // in us
+        int64_t timing{0}; // in us
+        uint64_t size{0};  // in bytes
     };
-    std::deque<TimedAudioFrame> _audioQueue{};
-    std::mutex _audioMutex{};
+    RingBuffer<uint8_t> _audioRingBuffer{SPLASH_FFMPEG_AUDIO_RINGBUFFER_SIZE};
+    std::mutex _audioMutex{};                  //!< Only used to wait on _audioCondition
+    std::condition_variable _audioCondition{}; //!< Notified when audio frames are written or read, and on seek
 #endif
 
     /**
@@ -167,6 +197,11 @@ class Image_FFmpeg : public Image
      */
     void readLoop();
 
+    /**
+     * \brief Feed the frame queue from the cached clip, until the end of the clip
+     */
+    void playFromCache();
+
     /**
      * \brief Seek in the video
      * \param seconds Desired position
@@ -185,6 +220,25 @@ class Image_FFmpeg : public Image
      */
     bool setupAudioOutput(AVCodecContext* audioCodecContext);
 
+    /**
+     * \brief Display the frames of a live stream: each frame is shown once the jitter buffer delay has passed, and only the
+     * latest frame is shown when several of them are due
+     * \param queue Frame queue
+     */
+    void displayLiveFrames(std::deque<TimedFrame>& queue);
+
+    /**
+     * \brief Get how late a frame would be if shown now
+     * \param timing Frame timing, in us
+     * \return Return the lateness in us, negative if the frame is early, 0 if there is no reference clock
+     */
+    int64_t getFrameLateness(int64_t timing) const;
+
+    /**
+     * \brief Slave the local clock to the audio playback position, if known
+     */
+    void syncToAudioClock();
+
     /**
      * Audio loop
      */
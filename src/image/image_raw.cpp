@@ -0,0 +1,225 @@
+#include "./image/image_raw.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "./utils/log.h"
+#include "./utils/osutils.h"
+
+using namespace std;
+
+namespace Splash
+{
+
+/*************/
+Image_Raw::Image_Raw(RootObject* root)
+    : Image_Sequence(root)
+{
+    init();
+}
+
+/*************/
+Image_Raw::~Image_Raw()
+{
+    stopReading();
+    closeFile();
+}
+
+/*************/
+void Image_Raw::init()
+{
+    _type = "image_raw";
+    registerAttributes();
+}
+
+/*************/
+void Image_Raw::closeFile()
+{
+    if (_mappedFile)
+    {
+        munmap(_mappedFile, _mappedSize);
+        _mappedFile = nullptr;
+        _mappedSize = 0;
+    }
+
+    if (_directFd >= 0)
+    {
+        close(_directFd);
+        _directFd = -1;
+    }
+
+    if (_fd >= 0)
+    {
+        close(_fd);
+        _fd = -1;
+    }
+
+    _index.clear();
+}
+
+/*************/
+bool Image_Raw::read(const string& filename)
+{
+    stopReading();
+    closeFile();
+
+    if (!RawFrames::isLittleEndian())
+    {
+        Log::get() << Log::WARNING << "Image_Raw::" << __FUNCTION__ << " - Raw frames containers can only be read on little-endian hosts" << Log::endl;
+        return false;
+    }
+
+    _fd = open(filename.c_str(), O_RDONLY);
+    if (_fd < 0)
+    {
+        Log::get() << Log::WARNING << "Image_Raw::" << __FUNCTION__ << " - Unable to open file " << filename << Log::endl;
+        return false;
+    }
+
+    struct stat fileStat;
+    if (fstat(_fd, &fileStat) != 0 || static_cast<uint64_t>(fileStat.st_size) < RawFrames::alignment)
+    {
+        Log::get() << Log::WARNING << "Image_Raw::" << __FUNCTION__ << " - File " << filename << " is too small to be a raw frames container" << Log::endl;
+        closeFile();
+        return false;
+    }
+    auto fileSize = static_cast<uint64_t>(fileStat.st_size);
+
+    RawFrames::Header header;
+    if (pread(_fd, &header, sizeof(header), 0) != sizeof(header) || !RawFrames::isValid(header))
+    {
+        Log::get() << Log::WARNING << "Image_Raw::" << __FUNCTION__ << " - File " << filename << " is not a valid raw frames container" << Log::endl;
+        closeFile();
+        return false;
+    }
+
+    auto indexSize = header.frameCount * sizeof(RawFrames::IndexEntry);
+    if (header.indexOffset + indexSize > fileSize)
+    {
+        Log::get() << Log::WARNING << "Image_Raw::" << __FUNCTION__ << " - File " << filename << " is truncated" << Log::endl;
+        closeFile();
+        return false;
+    }
+
+    vector<RawFrames::IndexEntry> index(header.frameCount);
+    if (pread(_fd, index.data(), indexSize, header.indexOffset) != static_cast<ssize_t>(indexSize))
+    {
+        Log::get() << Log::WARNING << "Image_Raw::" << __FUNCTION__ << " - Could not read the frame index from file " << filename << Log::endl;
+        closeFile();
+        return false;
+    }
+
+    auto readSize = RawFrames::alignedSize(header.frameSize);
+    for (const auto& entry : index)
+    {
+        if (entry.offset % RawFrames::alignment != 0 || entry.offset + readSize > fileSize)
+        {
+            Log::get() << Log::WARNING << "Image_Raw::" << __FUNCTION__ << " - Invalid frame index in file " << filename << Log::endl;
+            closeFile();
+            return false;
+        }
+    }
+
+    // The mapping is always created, as a fallback when direct I/O is not available
+    _mappedSize = fileSize;
+    _mappedFile = reinterpret_cast<char*>(mmap(nullptr, _mappedSize, PROT_READ, MAP_SHARED, _fd, 0));
+    if (_mappedFile == MAP_FAILED)
+    {
+        _mappedFile = nullptr;
+        Log::get() << Log::WARNING << "Image_Raw::" << __FUNCTION__ << " - Could not map file " << filename << " to memory" << Log::endl;
+        closeFile();
+        return false;
+    }
+    madvise(_mappedFile, _mappedSize, MADV_SEQUENTIAL);
+
+#if HAVE_LINUX
+    if (_directIO)
+    {
+        _directFd = open(filename.c_str(), O_RDONLY | O_DIRECT);
+        if (_directFd < 0)
+            Log::get() << Log::MESSAGE << "Image_Raw::" << __FUNCTION__ << " - Direct I/O not supported for file " << filename << ", falling back to memory mapping" << Log::endl;
+    }
+#endif
+
+    _header = header;
+    _spec = RawFrames::specFromHeader(header);
+    _index = std::move(index);
+    _openedFile = filename;
+    if (_header.framerate > 0.0)
+        _framerate = static_cast<float>(_header.framerate);
+
+    Log::get() << Log::MESSAGE << "Image_Raw::" << __FUNCTION__ << " - Successfully loaded file " << filename << " (" << _spec.width << "x" << _spec.height << " " << _spec.format << ", "
+               << _index.size() << " frames)" << Log::endl;
+
+    startReading();
+    return true;
+}
+
+/*************/
+bool Image_Raw::readFrame(int64_t index, ImageBuffer& buffer)
+{
+    const auto& entry = _index[index];
+    auto readSize = RawFrames::alignedSize(_header.frameSize);
+
+    if (_directFd >= 0)
+    {
+        // Direct I/O needs an aligned destination, and reads the whole aligned frame
+        if (buffer.getSpec() != _spec || buffer.getSize() < readSize || reinterpret_cast<uintptr_t>(buffer.data()) % RawFrames::alignment != 0)
+        {
+            auto rawBuffer = ResizableArray<char>(readSize + RawFrames::alignment);
+            auto misalignment = reinterpret_cast<uintptr_t>(rawBuffer.data()) % RawFrames::alignment;
+            if (misalignment != 0)
+                rawBuffer.shift(RawFrames::alignment - misalignment);
+            buffer = ImageBuffer(_spec, std::move(rawBuffer));
+        }
+
+        uint64_t totalRead = 0;
+        while (totalRead < readSize)
+        {
+            auto bytesRead = pread(_directFd, buffer.data() + totalRead, readSize - totalRead, entry.offset + totalRead);
+            if (bytesRead <= 0)
+            {
+                Log::get() << Log::WARNING << "Image_Raw::" << __FUNCTION__ << " - Error while reading frame " << index << " from file " << _openedFile << Log::endl;
+                return false;
+            }
+            totalRead += bytesRead;
+        }
+    }
+    else
+    {
+        if (buffer.getSpec() != _spec)
+            buffer = ImageBuffer(_spec);
+
+        // Ask the kernel to start fetching the next frame while this one is copied
+        const auto& nextEntry = _index[(index + 1) % _index.size()];
+        madvise(_mappedFile + nextEntry.offset, readSize, MADV_WILLNEED);
+        memcpy(buffer.data(), _mappedFile + entry.offset, _header.frameSize);
+    }
+
+    return true;
+}
+
+/*************/
+void Image_Raw::registerAttributes()
+{
+    // Attributes of Image_Sequence are registered by its constructor
+    addAttribute("directIO",
+        [&](const Values& args) {
+            auto directIO = static_cast<bool>(args[0].as<int>());
+            if (directIO == _directIO)
+                return true;
+
+            _directIO = directIO;
+            if (!_openedFile.empty())
+                return read(_openedFile);
+            return true;
+        },
+        [&]() -> Values { return {static_cast<int>(_directIO)}; },
+        {'n'});
+    setAttributeParameter("directIO", true, true);
+    setAttributeDescription("directIO", "If set to 1, frames are read with direct I/O (bypassing the page cache) when supported, otherwise through a memory mapping");
+}
+
+} // end of namespace
@@ -0,0 +1,112 @@
+/*
+ * Copyright (C) 2018 Emmanuel Durand
+ *
+ * This file is part of Splash.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Splash is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Splash.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * @image_raw.h
+ * The Image_Raw class, playing Splash raw frames containers
+ */
+
+#ifndef SPLASH_IMAGE_RAW_H
+#define SPLASH_IMAGE_RAW_H
+
+#include "./config.h"
+
+#include <string>
+#include <vector>
+
+#include "./core/attribute.h"
+#include "./core/coretypes.h"
+#include "./image/image_sequence.h"
+#include "./image/raw_frames.h"
+
+namespace Splash
+{
+
+class Image_Raw : public Image_Sequence
+{
+  public:
+    /**
+     * \brief Constructor
+     * \param root Root object
+     */
+    Image_Raw(RootObject* root);
+
+    /**
+     * \brief Destructor
+     */
+    ~Image_Raw() override;
+
+    /**
+     * No copy constructor
+     */
+    Image_Raw(const Image_Raw&) = delete;
+    Image_Raw& operator=(const Image_Raw&) = delete;
+
+    /**
+     * \brief Set the container to read from
+     * \param filename File to read
+     * \return Return true if all went well
+     */
+    bool read(const std::string& filename) final;
+
+  private:
+    RawFrames::Header _header{};
+    ImageBufferSpec _spec{};
+    std::vector<RawFrames::IndexEntry> _index{};
+
+    std::string _openedFile{""};
+    bool _directIO{true}; //!< If true, frames are read with O_DIRECT when possible, otherwise through the memory mapping
+    int _fd{-1};
+    int _directFd{-1};
+    char* _mappedFile{nullptr};
+    size_t _mappedSize{0};
+
+    /**
+     * \brief Base init for the class
+     */
+    void init();
+
+    /**
+     * \brief Close the file and release the mapping
+     */
+    void closeFile();
+
+    /**
+     * \brief Get the number of frames in the container
+     * \return Return the frame count
+     */
+    int64_t getFrameCount() const final { return _index.size(); }
+
+    /**
+     * \brief Read a single frame into the given buffer
+     * \param index Frame index
+     * \param buffer Buffer to read into
+     * \return Return true if all went well
+     */
+    bool readFrame(int64_t index, ImageBuffer& buffer) final;
+
+    /**
+     * \brief Register new functors to modify attributes
+     */
+    void registerAttributes();
+};
+
+} // end of namespace
+
+#endif // SPLASH_IMAGE_RAW_H
@@ -0,0 +1,688 @@
+#include "./image/image_sequence.h"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+
+extern "C" {
+#include <libavcodec/avcodec.h>
+#include <libavutil/imgutils.h>
+#include <libswscale/swscale.h>
+}
+
+#include <stb_image.h>
+
+#include "./utils/log.h"
+#include "./utils/osutils.h"
+#include "./utils/timer.h"
+
+#define SPLASH_IMAGE_SEQUENCE_MAX_READ_THREADS 16
+
+using namespace std;
+
+namespace Splash
+{
+
+/*************/
+Image_Sequence::Image_Sequence(RootObject* root)
+    : Image(root)
+{
+    init();
+}
+
+/*************/
+Image_Sequence::~Image_Sequence()
+{
+    stopReading();
+}
+
+/*************/
+void Image_Sequence::init()
+{
+    _type = "image_sequence";
+    registerAttributes();
+
+    // This is used for getting documentation "offline"
+    if (!_root)
+        return;
+
+    _readThreadCount = max(1, min(Utils::getCoreCount() / 2, 4));
+    avcodec_register_all();
+}
+
+/*************/
+bool Image_Sequence::read(const string& filename)
+{
+    stopReading();
+
+    auto files = findSequenceFiles(filename);
+    if (files.empty())
+    {
+        Log::get() << Log::WARNING << "Image_Sequence::" << __FUNCTION__ << " - Could not find any file matching " << filename << Log::endl;
+        return false;
+    }
+
+    _files = files;
+    Log::get() << Log::MESSAGE << "Image_Sequence::" << __FUNCTION__ << " - Found " << _files.size() << " files in sequence " << filename << Log::endl;
+
+    startReading();
+    return true;
+}
+
+/*************/
+vector<string> Image_Sequence::findSequenceFiles(const string& filename) const
+{
+    auto directory = Utils::getPathFromFilePath(filename);
+    if (directory.empty() || directory.back() != '/')
+        directory += "/";
+    auto name = Utils::getFilenameFromFilePath(filename);
+
+    // The number is either given as a printf-like pattern, or is the last digit run of the file name
+    string prefix, suffix;
+    auto percentPos = name.find('%');
+    if (percentPos != string::npos)
+    {
+        auto dPos = name.find('d', percentPos);
+        if (dPos == string::npos)
+            return {};
+        prefix = name.substr(0, percentPos);
+        suffix = name.substr(dPos + 1);
+    }
+    else
+    {
+        auto lastDigit = name.find_last_of("0123456789");
+        if (lastDigit == string::npos)
+            return {};
+        auto firstDigit = name.find_last_not_of("0123456789", lastDigit);
+        firstDigit = (firstDigit == string::npos) ? 0 : firstDigit + 1;
+        prefix = name.substr(0, firstDigit);
+        suffix = name.substr(lastDigit + 1);
+    }
+
+    vector<pair<int64_t, string>> numberedFiles;
+    for (const auto& entry : Utils::listDirContent(directory))
+    {
+        if (entry.size() <= prefix.size() + suffix.size())
+            continue;
+        if (entry.compare(0, prefix.size(), prefix) != 0)
+            continue;
+        if (entry.compare(entry.size() - suffix.size(), suffix.size(), suffix) != 0)
+            continue;
+
+        auto number = entry.substr(prefix.size(), entry.size() - prefix.size() - suffix.size());
+        if (number.find_first_not_of("0123456789") != string::npos)
+            continue;
+
+        numberedFiles.emplace_back(stoll(number), directory + entry);
+    }
+
+    sort(numberedFiles.begin(), numberedFiles.end());
+
+    vector<string> files;
+    for (auto& file : numberedFiles)
+        files.push_back(file.second);
+    return files;
+}
+
+/*************/
+void Image_Sequence::startReading()
+{
+    if (getFrameCount() == 0)
+        return;
+
+    {
+        lock_guard<mutex> lockClock(_clockMutex);
+        _currentTime = 0;
+        _startTime = Timer::getTime();
+    }
+
+    {
+        lock_guard<mutex> lockFrames(_frameMutex);
+        _nextFrameToRead = 0;
+        _readPosition = 0;
+        _displayedFrame = -1;
+    }
+
+    _continueRead = true;
+    for (int i = 0; i < _readThreadCount; ++i)
+        _readThreads.emplace_back([&]() { readLoop(); });
+    _displayThread = thread([&]() { displayLoop(); });
+}
+
+/*************/
+void Image_Sequence::stopReading()
+{
+    if (!_continueRead)
+        return;
+
+    {
+        lock_guard<mutex> lockFrames(_frameMutex);
+        _continueRead = false;
+    }
+    _readCondition.notify_all();
+    _displayCondition.notify_all();
+
+    for (auto& readThread : _readThreads)
+        readThread.join();
+    _readThreads.clear();
+    _displayThread.join();
+
+    lock_guard<mutex> lockFrames(_frameMutex);
+    for (auto& frame : _readFrames)
+        returnBufferToPool(std::move(frame.second));
+    _readFrames.clear();
+    _bufferedSize = 0;
+}
+
+/*************/
+unique_ptr<ImageBuffer> Image_Sequence::getBufferFromPool()
+{
+    if (_bufferPool.empty())
+        return unique_ptr<ImageBuffer>(new ImageBuffer());
+
+    auto buffer = std::move(_bufferPool.back());
+    _bufferPool.pop_back();
+    return buffer;
+}
+
+/*************/
+void Image_Sequence::returnBufferToPool(unique_ptr<ImageBuffer>&& buffer)
+{
+    if (!buffer)
+        return;
+
+    // Keep just enough buffers to fill the read-ahead queue
+    if (static_cast<int>(_bufferPool.size()) < _readAhead + _readThreadCount)
+        _bufferPool.push_back(std::move(buffer));
+    else
+        buffer.reset();
+}
+
+/*************/
+bool Image_Sequence::readFrame(int64_t index, ImageBuffer& buffer)
+{
+    return readImageFile(_files[index], buffer);
+}
+
+/*************/
+bool Image_Sequence::readImageFile(const string& filename, ImageBuffer& buffer)
+{
+    auto extension = filename.substr(filename.rfind('.') + 1);
+    transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
+
+    if (extension == "dds")
+        return readDDS(filename, buffer);
+    else if (extension == "exr")
+        return readEXR(filename, buffer);
+    else
+        return readSTB(filename, buffer);
+}
+
+/*************/
+bool Image_Sequence::readDDS(const string& filename, ImageBuffer& buffer)
+{
+    ifstream file(filename, ios::in | ios::binary);
+    if (!file.is_open())
+    {
+        Log::get() << Log::WARNING << "Image_Sequence::" << __FUNCTION__ << " - Unable to open file " << filename << Log::endl;
+        return false;
+    }
+
+    // The DDS header is 128 bytes long, including the magic number
+    array<char, 128> header;
+    file.read(header.data(), header.size());
+    if (!file || strncmp(header.data(), "DDS ", 4) != 0)
+    {
+        Log::get() << Log::WARNING << "Image_Sequence::" << __FUNCTION__ << " - File " << filename << " is not a valid DDS file" << Log::endl;
+        return false;
+    }
+
+    uint32_t height, width;
+    memcpy(&height, header.data() + 12, sizeof(height));
+    memcpy(&width, header.data() + 16, sizeof(width));
+    auto fourCC = string(header.data() + 84, 4);
+
+    string textureFormat;
+    if (fourCC == "DXT1")
+    {
+        textureFormat = "RGB_DXT1";
+    }
+    else if (fourCC == "DXT5")
+    {
+        textureFormat = "RGBA_DXT5";
+    }
+    else if (fourCC == "DX10")
+    {
+        // Extended header, the first field is the DXGI format
+        array<char, 20> headerDX10;
+        file.read(headerDX10.data(), headerDX10.size());
+        uint32_t dxgiFormat;
+        memcpy(&dxgiFormat, headerDX10.data(), sizeof(dxgiFormat));
+        if (dxgiFormat == 71 || dxgiFormat == 72) // DXGI_FORMAT_BC1_UNORM(_SRGB)
+            textureFormat = "RGB_DXT1";
+        else if (dxgiFormat == 77 || dxgiFormat == 78) // DXGI_FORMAT_BC3_UNORM(_SRGB)
+            textureFormat = "RGBA_DXT5";
+    }
+
+    if (textureFormat.empty())
+    {
+        Log::get() << Log::WARNING << "Image_Sequence::" << __FUNCTION__ << " - Only BC1 (DXT1) and BC3 (DXT5) DDS files are supported: " << filename << Log::endl;
+        return false;
+    }
+
+    if (width % 4 != 0 || height % 4 != 0)
+    {
+        Log::get() << Log::WARNING << "Image_Sequence::" << __FUNCTION__ << " - DDS file dimensions must be multiples of 4: " << filename << Log::endl;
+        return false;
+    }
+
+    // Same trick as for Hap: the compressed data is stored as is, with a spec matching its size
+    ImageBufferSpec spec;
+    if (textureFormat == "RGB_DXT1")
+        spec = ImageBufferSpec(width, height / 2, 1, 8, ImageBufferSpec::Type::UINT8, textureFormat);
+    else
+        spec = ImageBufferSpec(width, height, 1, 8, ImageBufferSpec::Type::UINT8, textureFormat);
+
+    if (buffer.getSpec() != spec)
+        buffer = ImageBuffer(spec);
+
+    // Only the first mipmap level is read, directly into the buffer
+    file.read(buffer.data(), spec.rawSize());
+    if (!file)
+    {
+        Log::get() << Log::WARNING << "Image_Sequence::" << __FUNCTION__ << " - File " << filename << " is truncated" << Log::endl;
+        return false;
+    }
+
+    return true;
+}
+
+/*************/
+bool Image_Sequence::readEXR(const string& filename, ImageBuffer& buffer)
+{
+    ifstream file(filename, ios::in | ios::binary | ios::ate);
+    if (!file.is_open())
+    {
+        Log::get() << Log::WARNING << "Image_Sequence::" << __FUNCTION__ << " - Unable to open file " << filename << Log::endl;
+        return false;
+    }
+
+    auto fileSize = static_cast<size_t>(file.tellg());
+    file.seekg(0, ios::beg);
+    vector<uint8_t> fileContent(fileSize + AV_INPUT_BUFFER_PADDING_SIZE, 0);
+    file.read(reinterpret_cast<char*>(fileContent.data()), fileSize);
+
+    auto codec = avcodec_find_decoder(AV_CODEC_ID_EXR);
+    if (!codec)
+    {
+        Log::get() << Log::WARNING << "Image_Sequence::" << __FUNCTION__ << " - FFmpeg has been built without OpenEXR support" << Log::endl;
+        return false;
+    }
+
+    auto codecContext = avcodec_alloc_context3(codec);
+    if (avcodec_open2(codecContext, codec, nullptr) < 0)
+    {
+        avcodec_free_context(&codecContext);
+        return false;
+    }
+
+    AVPacket packet;
+    av_init_packet(&packet);
+    packet.data = fileContent.data();
+    packet.size = fileSize;
+
+    auto frame = av_frame_alloc();
+    bool success = false;
+    if (avcodec_send_packet(codecContext, &packet) >= 0 && avcodec_receive_frame(codecContext, frame) == 0)
+    {
+        auto spec = ImageBufferSpec(frame->width, frame->height, 4, 32, ImageBufferSpec::Type::UINT8, "RGBA");
+        if (buffer.getSpec() != spec)
+            buffer = ImageBuffer(spec);
+
+        auto swsContext = sws_getContext(
+            frame->width, frame->height, static_cast<AVPixelFormat>(frame->format), frame->width, frame->height, AV_PIX_FMT_RGBA, SWS_POINT, nullptr, nullptr, nullptr);
+        if (swsContext)
+        {
+            uint8_t* dstData[4] = {reinterpret_cast<uint8_t*>(buffer.data()), nullptr, nullptr, nullptr};
+            int dstLinesize[4] = {frame->width * 4, 0, 0, 0};
+            sws_scale(swsContext, (const uint8_t* const*)frame->data, frame->linesize, 0, frame->height, dstData, dstLinesize);
+            sws_freeContext(swsContext);
+            success = true;
+        }
+    }
+
+    if (!success)
+        Log::get() << Log::WARNING << "Image_Sequence::" << __FUNCTION__ << " - Could not decode file " << filename << Log::endl;
+
+    av_frame_free(&frame);
+    avcodec_free_context(&codecContext);
+    return success;
+}
+
+/*************/
+bool Image_Sequence::readSTB(const string& filename, ImageBuffer& buffer)
+{
+    int w, h, c;
+    // We force conversion to RGBA
+    uint8_t* rawImage = stbi_load(filename.c_str(), &w, &h, &c, 4);
+    if (!rawImage)
+    {
+        Log::get() << Log::WARNING << "Image_Sequence::" << __FUNCTION__ << " - Caught an error while opening image file " << filename << Log::endl;
+        return false;
+    }
+
+    auto spec = ImageBufferSpec(w, h, 4, 32, ImageBufferSpec::Type::UINT8, "RGBA");
+    if (buffer.getSpec() != spec)
+        buffer = ImageBuffer(spec);
+
+    memcpy(buffer.data(), rawImage, w * h * 4);
+    stbi_image_free(rawImage);
+
+    return true;
+}
+
+/*************/
+void Image_Sequence::readLoop()
+{
+    while (_continueRead)
+    {
+        unique_lock<mutex> lockFrames(_frameMutex);
+        _readCondition.wait(lockFrames, [&]() {
+            if (!_continueRead)
+                return true;
+            auto nextFrame = max(_nextFrameToRead, _readPosition);
+            if (!_loop && nextFrame >= getFrameCount())
+                return false;
+            return nextFrame < _readPosition + _readAhead && _bufferedSize < _maximumBufferSize;
+        });
+
+        if (!_continueRead)
+            break;
+
+        // Frames which are already late are not worth reading
+        _nextFrameToRead = max(_nextFrameToRead, _readPosition);
+        auto frameIndex = _nextFrameToRead++;
+        auto buffer = getBufferFromPool();
+        lockFrames.unlock();
+
+        bool success = readFrame(frameIndex % getFrameCount(), *buffer);
+
+        lockFrames.lock();
+        if (!success || frameIndex < _readPosition || _readFrames.find(frameIndex) != _readFrames.end())
+        {
+            returnBufferToPool(std::move(buffer));
+        }
+        else
+        {
+            _bufferedSize += buffer->getSize();
+            _readFrames[frameIndex] = std::move(buffer);
+        }
+        lockFrames.unlock();
+
+        _displayCondition.notify_one();
+    }
+}
+
+/*************/
+void Image_Sequence::displayLoop()
+{
+    while (_continueRead)
+    {
+        auto frameDuration = static_cast<int64_t>(1e6 / max(_framerate.load(), 1.f));
+
+        //
+        // Get the current master and local clocks
+        //
+        int64_t clockAsMs;
+        bool clockIsPaused{false};
+        bool useClock = _useClock && Timer::get().getMasterClock<chrono::milliseconds>(clockAsMs, clockIsPaused);
+
+        int64_t currentTime;
+        {
+            lock_guard<mutex> lockClock(_clockMutex);
+            if (_paused || (clockIsPaused && useClock))
+            {
+                _startTime = Timer::getTime() - _currentTime;
+            }
+            else if (useClock)
+            {
+                _currentTime = clockAsMs * 1000 + static_cast<int64_t>(_shiftTime * 1e6);
+                _startTime = Timer::getTime() - _currentTime;
+            }
+            else
+            {
+                _currentTime = Timer::getTime() - _startTime;
+            }
+            currentTime = max<int64_t>(0, _currentTime);
+        }
+
+        auto frameCount = getFrameCount();
+        auto frameIndex = currentTime / frameDuration;
+        if (!_loop && frameIndex >= frameCount)
+            frameIndex = frameCount - 1;
+
+        //
+        // Show the latest frame available, dropping the ones which are late
+        //
+        unique_ptr<ImageBuffer> frame{};
+        {
+            unique_lock<mutex> lockFrames(_frameMutex);
+
+            // Going back in time, the read-ahead queue has to be refilled
+            if (frameIndex < _displayedFrame)
+            {
+                for (auto& readFrame : _readFrames)
+                    returnBufferToPool(std::move(readFrame.second));
+                _readFrames.clear();
+                _bufferedSize = 0;
+                _nextFrameToRead = frameIndex;
+                _displayedFrame = -1;
+            }
+
+            if (_readPosition != frameIndex)
+            {
+                _readPosition = frameIndex;
+                _readCondition.notify_all();
+            }
+
+            auto frameIt = _readFrames.upper_bound(frameIndex);
+            if (frameIt != _readFrames.begin())
+            {
+                --frameIt;
+                while (_readFrames.begin() != frameIt)
+                {
+                    _bufferedSize -= _readFrames.begin()->second->getSize();
+                    returnBufferToPool(std::move(_readFrames.begin()->second));
+                    _readFrames.erase(_readFrames.begin());
+                }
+
+                _displayedFrame = frameIt->first;
+                _bufferedSize -= frameIt->second->getSize();
+                frame = std::move(frameIt->second);
+                _readFrames.erase(frameIt);
+                _readCondition.notify_all();
+            }
+        }
+
+        if (frame)
+        {
+            {
+                lock_guard<shared_timed_mutex> lockWrite(_writeMutex);
+                if (!_bufferImage)
+                    _bufferImage = unique_ptr<ImageBuffer>(new ImageBuffer());
+                std::swap(_bufferImage, frame);
+                _imageUpdated = true;
+                updateTimestamp();
+            }
+
+            // The previously displayed frame goes back to the pool
+            lock_guard<mutex> lockFrames(_frameMutex);
+            returnBufferToPool(std::move(frame));
+        }
+
+        // Wait for the next frame to be due, or for a reader to deliver the current one
+        auto waitTime = frameDuration - currentTime % frameDuration;
+        unique_lock<mutex> lockFrames(_frameMutex);
+        if (_continueRead)
+            _displayCondition.wait_for(lockFrames, chrono::microseconds(min<int64_t>(waitTime, 10000)));
+    }
+}
+
+/*************/
+float Image_Sequence::getMediaDuration() const
+{
+    return static_cast<float>(getFrameCount()) / max(_framerate.load(), 1.f);
+}
+
+/*************/
+void Image_Sequence::updateMoreMediaInfo(Values& mediaInfo)
+{
+    mediaInfo.push_back(Value(getMediaDuration(), "duration"));
+    mediaInfo.push_back(Value(getFrameCount(), "frames"));
+    mediaInfo.push_back(Value(_framerate.load(), "framerate"));
+}
+
+/*************/
+void Image_Sequence::registerAttributes()
+{
+    Image::registerAttributes();
+
+    addAttribute("bufferSize",
+        [&](const Values& args) {
+            int64_t sizeMB = max(16, args[0].as<int>());
+            {
+                lock_guard<mutex> lockFrames(_frameMutex);
+                _maximumBufferSize = sizeMB * (int64_t)1048576;
+            }
+            _readCondition.notify_all();
+            return true;
+        },
+        [&]() -> Values { return {_maximumBufferSize / (int64_t)1048576}; },
+        {'n'});
+    setAttributeParameter("bufferSize", true, true);
+    setAttributeDescription("bufferSize", "Set the maximum memory used by frames read in advance (in MB)");
+
+    addAttribute("readAhead",
+        [&](const Values& args) {
+            {
+                lock_guard<mutex> lockFrames(_frameMutex);
+                _readAhead = max(1, args[0].as<int>());
+            }
+            _readCondition.notify_all();
+            return true;
+        },
+        [&]() -> Values { return {_readAhead}; },
+        {'n'});
+    setAttributeParameter("readAhead", true, true);
+    setAttributeDescription("readAhead", "Number of frames to read in advance");
+
+    addAttribute("readThreads",
+        [&](const Values& args) {
+            auto threadCount = max(1, min(args[0].as<int>(), SPLASH_IMAGE_SEQUENCE_MAX_READ_THREADS));
+            if (threadCount == _readThreadCount)
+                return true;
+
+            auto isReading = static_cast<bool>(_continueRead);
+            stopReading();
+            _readThreadCount = threadCount;
+            if (isReading)
+                startReading();
+            return true;
+        },
+        [&]() -> Values { return {_readThreadCount}; },
+        {'n'});
+    setAttributeParameter("readThreads", true, true);
+    setAttributeDescription("readThreads", "Number of threads reading and decoding the files");
+
+    addAttribute("framerate",
+        [&](const Values& args) {
+            auto framerate = args[0].as<float>();
+            if (framerate <= 0.f)
+                return false;
+
+            // Keep the current position in the sequence
+            lock_guard<mutex> lockClock(_clockMutex);
+            _currentTime = static_cast<int64_t>(_currentTime * _framerate / framerate);
+            _startTime = Timer::getTime() - _currentTime;
+            _framerate = framerate;
+            return true;
+        },
+        [&]() -> Values { return {_framerate.load()}; },
+        {'n'});
+    setAttributeParameter("framerate", true, true);
+    setAttributeDescription("framerate", "Playback framerate of the sequence");
+
+    addAttribute("duration",
+        [&](const Values&) { return false; },
+        [&]() -> Values { return {getMediaDuration()}; });
+    setAttributeParameter("duration", false, true);
+
+    addAttribute("loop",
+        [&](const Values& args) {
+            {
+                lock_guard<mutex> lockFrames(_frameMutex);
+                _loop = static_cast<bool>(args[0].as<int>());
+            }
+            _readCondition.notify_all();
+            return true;
+        },
+        [&]() -> Values { return {static_cast<int>(_loop)}; },
+        {'n'});
+    setAttributeParameter("loop", true, true);
+
+    addAttribute("remaining",
+        [&](const Values&) { return false; },
+        [&]() -> Values {
+            lock_guard<mutex> lockClock(_clockMutex);
+            float duration = std::max(0.f, getMediaDuration() - static_cast<float>(_currentTime) / 1e6f);
+            return {duration};
+        });
+    setAttributeParameter("remaining", false, true);
+
+    addAttribute("pause",
+        [&](const Values& args) {
+            _paused = args[0].as<int>();
+            return true;
+        },
+        [&]() -> Values { return {_paused.load()}; },
+        {'n'});
+    setAttributeParameter("pause", false, true);
+
+    addAttribute("seek",
+        [&](const Values& args) {
+            float seconds = max(0.f, args[0].as<float>());
+            lock_guard<mutex> lockClock(_clockMutex);
+            _currentTime = static_cast<int64_t>(seconds * 1e6);
+            _startTime = Timer::getTime() - _currentTime;
+            _seekTime = seconds;
+            return true;
+        },
+        [&]() -> Values { return {_seekTime}; },
+        {'n'});
+    setAttributeParameter("seek", false, true);
+    setAttributeDescription("seek", "Change the read position in the sequence");
+
+    addAttribute("useClock",
+        [&](const Values& args) {
+            _useClock = args[0].as<int>();
+            return true;
+        },
+        [&]() -> Values { return {static_cast<int>(_useClock)}; },
+        {'n'});
+    setAttributeParameter("useClock", true, true);
+    setAttributeDescription("useClock", "Use the master clock if available");
+
+    addAttribute("timeShift",
+        [&](const Values& args) {
+            _shiftTime = args[0].as<float>();
+            return true;
+        },
+        [&]() -> Values { return {_shiftTime}; },
+        {'n'});
+    setAttributeParameter("timeShift", true, true);
+    setAttributeDescription("timeShift", "Time shift relative to the master clock, in seconds");
+}
+
+} // end of namespace
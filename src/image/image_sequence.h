@@ -0,0 +1,215 @@
+/*
+ * Copyright (C) 2018 Emmanuel Durand
+ *
+ * This file is part of Splash.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Splash is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Splash.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * @image_sequence.h
+ * The Image_Sequence class, playing numbered image files as a video
+ */
+
+#ifndef SPLASH_IMAGE_SEQUENCE_H
+#define SPLASH_IMAGE_SEQUENCE_H
+
+#include "./config.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "./core/attribute.h"
+#include "./core/coretypes.h"
+#include "./image/image.h"
+
+namespace Splash
+{
+
+class Image_Sequence : public Image
+{
+  public:
+    /**
+     * \brief Constructor
+     * \param root Root object
+     */
+    Image_Sequence(RootObject* root);
+
+    /**
+     * \brief Destructor
+     */
+    ~Image_Sequence() override;
+
+    /**
+     * No copy constructor
+     */
+    Image_Sequence(const Image_Sequence&) = delete;
+    Image_Sequence& operator=(const Image_Sequence&) = delete;
+
+    /**
+     * \brief Set the sequence to read from
+     * \param filename Path to any file of the sequence, or printf-like pattern (i.e. "frame_%05d.png")
+     * \return Return true if all went well
+     */
+    bool read(const std::string& filename) override;
+
+  protected:
+    std::atomic<float> _framerate{30.f};
+
+    /**
+     * \brief Stop the reading and display threads
+     */
+    void stopReading();
+
+    /**
+     * \brief Start the reading and display threads
+     */
+    void startReading();
+
+    /**
+     * \brief Get the number of frames in the sequence
+     * \return Return the frame count
+     */
+    virtual int64_t getFrameCount() const { return _files.size(); }
+
+    /**
+     * \brief Read a single frame into the given buffer. Called concurrently by the reader threads
+     * \param index Frame index, lower than getFrameCount()
+     * \param buffer Buffer to read into, reallocated only if its spec does not match
+     * \return Return true if all went well
+     */
+    virtual bool readFrame(int64_t index, ImageBuffer& buffer);
+
+    /**
+     * \brief Find the files belonging to the same sequence as the given path
+     * \param filename Path to a file of the sequence, or a printf-like pattern
+     * \return Return the sorted list of files
+     */
+    std::vector<std::string> findSequenceFiles(const std::string& filename) const;
+
+    /**
+     * \brief Register new functors to modify attributes
+     */
+    void registerAttributes();
+
+  private:
+    std::vector<std::string> _files{}; //!< Sorted list of the files in the sequence
+
+    std::vector<std::thread> _readThreads{};
+    std::thread _displayThread{};
+    std::atomic_bool _continueRead{false};
+
+    // Frames read in advance, indexed by their position in the (possibly looping) playback
+    std::mutex _frameMutex{};
+    std::condition_variable _readCondition{};
+    std::condition_variable _displayCondition{};
+    std::map<int64_t, std::unique_ptr<ImageBuffer>> _readFrames{};
+    std::vector<std::unique_ptr<ImageBuffer>> _bufferPool{}; //!< Buffers available for reading, to avoid reallocations
+    int64_t _bufferedSize{0};                                  //!< Size in bytes of the frames in _readFrames
+    int64_t _nextFrameToRead{0};
+    int64_t _readPosition{0};    //!< Frame due for display, reading starts from there
+    int64_t _displayedFrame{-1}; //!< Last frame sent for display
+
+    // Playback parameters
+    int _readThreadCount{4};
+    int _readAhead{8};
+    int64_t _maximumBufferSize{(int64_t)1 << 29};
+    bool _loop{true};
+    std::atomic_bool _paused{false};
+    float _seekTime{0.f};
+    float _shiftTime{0.f};
+    std::atomic_bool _useClock{false};
+
+    std::mutex _clockMutex{};
+    int64_t _startTime{0};
+    int64_t _currentTime{0};
+
+    /**
+     * \brief Base init for the class
+     */
+    void init();
+
+    /**
+     * \brief Get a buffer from the pool, or a new one if the pool is empty. Must be called with _frameMutex locked
+     * \return Return a buffer
+     */
+    std::unique_ptr<ImageBuffer> getBufferFromPool();
+
+    /**
+     * \brief Give a buffer back to the pool. Must be called with _frameMutex locked
+     * \param buffer Buffer to give back
+     */
+    void returnBufferToPool(std::unique_ptr<ImageBuffer>&& buffer);
+
+    /**
+     * \brief Read a single image file into the given buffer
+     * \param filename File to read
+     * \param buffer Buffer to read into, reallocated only if its spec does not match
+     * \return Return true if all went well
+     */
+    bool readImageFile(const std::string& filename, ImageBuffer& buffer);
+
+    /**
+     * \brief Read a DDS file, keeping the BC1 / BC3 compressed data as is
+     * \param filename File to read
+     * \param buffer Buffer to read into
+     * \return Return true if all went well
+     */
+    bool readDDS(const std::string& filename, ImageBuffer& buffer);
+
+    /**
+     * \brief Read an OpenEXR file through FFmpeg, converted to 8 bits RGBA
+     * \param filename File to read
+     * \param buffer Buffer to read into
+     * \return Return true if all went well
+     */
+    bool readEXR(const std::string& filename, ImageBuffer& buffer);
+
+    /**
+     * \brief Read a file handled by stb_image (PNG, TGA, JPG, BMP...), converted to RGBA
+     * \param filename File to read
+     * \param buffer Buffer to read into
+     * \return Return true if all went well
+     */
+    bool readSTB(const std::string& filename, ImageBuffer& buffer);
+
+    /**
+     * \brief Reading loop, run by each reader thread
+     */
+    void readLoop();
+
+    /**
+     * \brief Display loop, selecting the frame to show according to the clocks
+     */
+    void displayLoop();
+
+    /**
+     * \brief Get the duration of the sequence
+     * \return Return the duration in seconds
+     */
+    float getMediaDuration() const;
+
+    /**
+     * \brief Add more media info
+     */
+    void updateMoreMediaInfo(Values& mediaInfo) final;
+};
+
+} // end of namespace
+
+#endif // SPLASH_IMAGE_SEQUENCE_H
@@ -17,11 +17,9 @@
 #include "./utils/cgutils.h"
 #include "./utils/log.h"
 #include "./utils/osutils.h"
+#include "./utils/pixelutils.h"
 #include "./utils/timer.h"
 
-#define SPLASH_SHMDATA_THREADS 2
-#define SPLASH_SHMDATA_WITH_POOL 0 // FIXME: there is an issue with the threadpool in the shmdata callback
-
 using namespace std;
 
 namespace Splash
@@ -90,6 +88,8 @@ void Image_Shmdata::onCaps(const string& dataType)
         _isYUV = false;
         _is420 = false;
         _is422 = false;
+        _isNV12 = false;
+        _isYUY2 = false;
 
         regex regHap, regWidth, regHeight;
         regex regVideo, regFormat;
@@ -160,6 +160,14 @@ void Image_Shmdata::onCaps(const string& dataType)
                     _isYUV = true;
                     _is420 = true;
                 }
+                else if ("NV12" == substr)
+                {
+                    _bpp = 12;
+                    _channels = 3;
+                    _isYUV = true;
+                    _is420 = true;
+                    _isNV12 = true;
+                }
                 else if ("UYVY" == substr)
                 {
                     _bpp = 12;
@@ -167,6 +175,14 @@ void Image_Shmdata::onCaps(const string& dataType)
                     _isYUV = true;
                     _is422 = true;
                 }
+                else if ("YUY2" == substr)
+                {
+                    _bpp = 12;
+                    _channels = 3;
+                    _isYUV = true;
+                    _is422 = true;
+                    _isYUY2 = true;
+                }
             }
         }
         else if (regex_match(dataType, regHap))
@@ -222,120 +238,100 @@ void Image_Shmdata::onData(void* data, int data_size)
 /*************/
 void Image_Shmdata::readHapFrame(void* data, int data_size)
 {
-    lock_guard<shared_timed_mutex> lock(_writeMutex);
-
     // We are using kind of a hack to store a DXT compressed image in an ImageBuffer
     // First, we check the texture format type
     auto textureFormat = string("");
     if (!hapDecodeFrame(data, data_size, nullptr, 0, textureFormat))
         return;
 
-    // Check if we need to resize the reader buffer
     // We set the size so as to have just enough place for the given texture format
-    auto bufSpec = _readerBuffer.getSpec();
-    if (bufSpec.width != _width || (bufSpec.height != _height && textureFormat != _textureFormat))
-    {
-        _textureFormat = textureFormat;
-
-        ImageBufferSpec spec;
-        if (textureFormat == "RGB_DXT1")
-            spec = ImageBufferSpec(_width, (int)(ceil((float)_height / 2.f)), 1, 8, ImageBufferSpec::Type::UINT8);
-        else if (textureFormat == "RGBA_DXT5")
-            spec = ImageBufferSpec(_width, _height, 1, 8, ImageBufferSpec::Type::UINT8);
-        else if (textureFormat == "YCoCg_DXT5")
-            spec = ImageBufferSpec(_width, _height, 1, 8, ImageBufferSpec::Type::UINT8);
-        else
-            return;
-
-        spec.format = textureFormat;
-        _readerBuffer = ImageBuffer(spec);
-    }
+    ImageBufferSpec spec;
+    if (textureFormat == "RGB_DXT1")
+        spec = ImageBufferSpec(_width, (int)(ceil((float)_height / 2.f)), 1, 8, ImageBufferSpec::Type::UINT8);
+    else if (textureFormat == "RGBA_DXT5")
+        spec = ImageBufferSpec(_width, _height, 1, 8, ImageBufferSpec::Type::UINT8);
+    else if (textureFormat == "YCoCg_DXT5")
+        spec = ImageBufferSpec(_width, _height, 1, 8, ImageBufferSpec::Type::UINT8);
+    else
+        return;
+    spec.format = textureFormat;
+    _textureFormat = textureFormat;
 
-    unsigned long outputBufferBytes = bufSpec.width * bufSpec.height * bufSpec.channels;
-    if (!hapDecodeFrame(data, data_size, _readerBuffer.data(), outputBufferBytes, textureFormat))
+    // The chunks are decoded in parallel, straight into the buffer sent to the scenes
+    auto frame = _bufferPool->acquire(spec);
+    if (!hapDecodeFrame(data, data_size, frame->data(), frame->getSize(), textureFormat))
+    {
+        _bufferPool->release(std::move(frame));
         return;
+    }
 
-    if (!_bufferImage)
-        _bufferImage = unique_ptr<ImageBuffer>(new ImageBuffer());
-    std::swap(*(_bufferImage), _readerBuffer);
-    _imageUpdated = true;
-    updateTimestamp();
+    setFrame(std::move(frame));
 }
 
 /*************/
-void Image_Shmdata::readUncompressedFrame(void* data, int /*data_size*/)
+void Image_Shmdata::readUncompressedFrame(void* data, int data_size)
 {
-    lock_guard<shared_timed_mutex> lock(_writeMutex);
+    ImageBufferSpec spec(_width, _height, _channels, 8 * _channels, ImageBufferSpec::Type::UINT8);
+    if (_green < _blue)
+        spec.format = "BGR";
+    else
+        spec.format = "RGB";
+    if (_channels == 4)
+        spec.format.push_back('A');
 
-    // Check if we need to resize the reader buffer
-    auto bufSpec = _readerBuffer.getSpec();
-    if (bufSpec.width != _width || bufSpec.height != _height || bufSpec.channels != _channels)
+    if (_is420 || _is422)
     {
-        ImageBufferSpec spec(_width, _height, _channels, 8 * _channels, ImageBufferSpec::Type::UINT8);
-        if (_green < _blue)
-            spec.format = "BGR";
-        else
-            spec.format = "RGB";
-        if (_channels == 4)
-            spec.format.push_back('A');
-
-        if (_is420 || _is422)
-        {
-            spec.format = "UYVY";
-            spec.bpp = 16;
-        }
-
-        _readerBuffer = ImageBuffer(spec);
+        spec.format = "UYVY";
+        spec.bpp = 16;
     }
 
+    // The shmdata buffer is only valid during this callback, so it is copied once, into the buffer sent to the scenes
+    auto frame = _bufferPool->acquire(spec);
+    auto pixels = reinterpret_cast<uint8_t*>(frame->data());
+    auto input = static_cast<const uint8_t*>(data);
     if (!_isYUV && (_channels == 3 || _channels == 4))
     {
-        char* pixels = (char*)(_readerBuffer).data();
-        vector<future<void>> threads;
-        for (int block = 0; block < SPLASH_SHMDATA_THREADS; ++block)
-        {
-            int size = _width * _height * _channels * sizeof(char);
-            threads.push_back(async(launch::async, [=]() {
-                int sizeOfBlock; // We compute the size of the block, to handle image size non divisible by SPLASH_SHMDATA_THREADS
-                if (size - size / SPLASH_SHMDATA_THREADS * block < 2 * size / SPLASH_SHMDATA_THREADS)
-                    sizeOfBlock = size - size / SPLASH_SHMDATA_THREADS * block;
-                else
-                    sizeOfBlock = size / SPLASH_SHMDATA_THREADS;
-
-                memcpy(pixels + size / SPLASH_SHMDATA_THREADS * block, (const char*)data + size / SPLASH_SHMDATA_THREADS * block, sizeOfBlock);
-            }));
-        }
+        memcpy(pixels, input, min<size_t>(frame->getSize(), data_size));
+    }
+    else if (_isNV12)
+    {
+        const uint8_t* Y = input;
+        const uint8_t* UV = input + _width * _height;
+        PixelUtils::nv12ToUyvy(Y, UV, pixels, _width, _height);
     }
     else if (_is420)
     {
-        const unsigned char* Y = static_cast<const unsigned char*>(data);
-        const unsigned char* U = static_cast<const unsigned char*>(data) + _width * _height;
-        const unsigned char* V = static_cast<const unsigned char*>(data) + _width * _height * 5 / 4;
-        char* pixels = (char*)(_readerBuffer).data();
-
-        for (uint32_t y = 0; y < _height; ++y)
-        {
-            for (uint32_t x = 0; x < _width; x += 2)
-            {
-                pixels[(x + y * _width) * 2 + 0] = U[(x / 2) + (y / 2) * (_width / 2)];
-                pixels[(x + y * _width) * 2 + 1] = Y[x + y * _width];
-                pixels[(x + y * _width) * 2 + 2] = V[(x / 2) + (y / 2) * (_width / 2)];
-                pixels[(x + y * _width) * 2 + 3] = Y[x + y * _width + 1];
-            }
-        }
+        const uint8_t* Y = input;
+        const uint8_t* U = input + _width * _height;
+        const uint8_t* V = input + _width * _height * 5 / 4;
+        PixelUtils::i420ToUyvy(Y, U, V, pixels, _width, _height);
+    }
+    else if (_isYUY2)
+    {
+        PixelUtils::yuyvToUyvy(input, pixels, _width, min<size_t>(frame->getSize(), data_size) / (_width * 2));
     }
     else if (_is422)
     {
-        const unsigned char* YUV = static_cast<const unsigned char*>(data);
-        char* pixels = (char*)(_readerBuffer).data();
-        copy(YUV, YUV + _width * _height * 2, pixels);
+        memcpy(pixels, input, min<size_t>(frame->getSize(), data_size));
     }
     else
+    {
+        _bufferPool->release(std::move(frame));
         return;
+    }
 
-    if (!_bufferImage)
-        _bufferImage = unique_ptr<ImageBuffer>(new ImageBuffer());
-    std::swap(*(_bufferImage), _readerBuffer);
+    setFrame(std::move(frame));
+}
+
+/*************/
+void Image_Shmdata::setFrame(unique_ptr<ImageBuffer>&& frame)
+{
+    stampFrame(*frame);
+
+    lock_guard<shared_timed_mutex> lock(_writeMutex);
+    // A frame not consumed yet by update() is replaced, and goes back to the pool
+    _bufferPool->release(std::move(_bufferImage));
+    _bufferImage = std::move(frame);
     _imageUpdated = true;
     updateTimestamp();
 }
@@ -64,7 +64,6 @@ class Image_Shmdata : public Image
     Utils::ShmdataLogger _logger;
     std::unique_ptr<shmdata::Follower> _reader{nullptr};
 
-    ImageBuffer _readerBuffer;
     std::string _inputDataType{""};
     uint32_t _bpp{0};
     uint32_t _width{0};
@@ -77,6 +76,8 @@ class Image_Shmdata : public Image
     bool _isYUV{false};
     bool _is420{false};
     bool _is422{false};
+    bool _isNV12{false}; //!< 4:2:0 with interleaved chroma
+    bool _isYUY2{false}; //!< 4:2:2 with the luma first
 
     // Hap specific attributes
     std::string _textureFormat{""};
@@ -115,6 +116,12 @@ class Image_Shmdata : public Image
      */
     void readUncompressedFrame(void* data, int data_size);
 
+    /**
+     * \brief Hand a filled frame over to update()
+     * \param frame Frame
+     */
+    void setFrame(std::unique_ptr<ImageBuffer>&& frame);
+
     /**
      * Register new functors to modify attributes
      */
@@ -3,6 +3,7 @@
 #include <fcntl.h>
 #include <poll.h>
 #include <sys/ioctl.h>
+#include <sys/mman.h>
 #include <unistd.h>
 
 #if HAVE_DATAPATH
@@ -62,8 +63,19 @@ bool Image_V4L2::doCapture()
     }
 
     _capturing = openCaptureDevice(_devicePath);
-    if (_capturing)
-        _capturing = initializeUserPtrCapture();
+    if (_capturing && _hasStreamingIO)
+    {
+        // Multi-planar devices are only supported through mmap IO
+        if (_ioMethod == V4L2_MEMORY_MMAP || _bufferType == V4L2_BUF_TYPE_VIDEO_CAPTURE_MPLANE)
+        {
+            _ioMethod = V4L2_MEMORY_MMAP;
+            _capturing = initializeMmapCapture();
+        }
+        else
+        {
+            _capturing = initializeUserPtrCapture();
+        }
+    }
     if (_capturing)
         _capturing = initializeCapture();
     if (_capturing)
@@ -93,24 +105,32 @@ void Image_V4L2::stopCapture()
     closeCaptureDevice();
 }
 
+/*************/
+Image_V4L2::MappedBuffers::~MappedBuffers()
+{
+    for (auto& buffer : buffers)
+        munmap(buffer.first, buffer.second);
+}
+
 /*************/
 void Image_V4L2::captureThreadFunc()
 {
     int result = 0;
     struct v4l2_buffer buffer;
-    enum v4l2_buf_type bufferType;
-    auto bufferSize = _outputWidth * _outputHeight * _spec.pixelBytes();
+    struct v4l2_plane planes[VIDEO_MAX_PLANES];
+    enum v4l2_buf_type bufferType = static_cast<enum v4l2_buf_type>(_bufferType);
+    auto bufferSize = _spec.rawSize();
 
     if (!_hasStreamingIO)
     {
         unique_lock<shared_timed_mutex> lockWrite(_writeMutex, std::defer_lock);
         while (_captureThreadRun)
         {
-            if (!_bufferImage || _bufferImage->getSpec() != _imageBuffers[buffer.index]->getSpec())
-                _bufferImage = unique_ptr<ImageBuffer>(new ImageBuffer(_spec));
-
             lockWrite.lock();
+            if (!_bufferImage || _bufferImage->getSpec() != _spec)
+                _bufferImage = unique_ptr<ImageBuffer>(new ImageBuffer(_spec));
             result = ::read(_deviceFd, _bufferImage->data(), bufferSize);
+            stampFrame(*_bufferImage);
             lockWrite.unlock();
 
             if (result < 0)
@@ -125,28 +145,18 @@ void Image_V4L2::captureThreadFunc()
     }
     else
     {
-        // Initialize the buffers
+        // Initialize and queue the buffers
+        auto bufferCount = _v4l2RequestBuffers.count;
         _imageBuffers.clear();
-        for (uint32_t i = 0; i < _bufferCount; ++i)
+        for (uint32_t i = 0; i < bufferCount; ++i)
         {
-            _imageBuffers.push_back(unique_ptr<ImageBuffer>(new ImageBuffer(_spec)));
+            if (_ioMethod == V4L2_MEMORY_USERPTR)
+                _imageBuffers.push_back(unique_ptr<ImageBuffer>(new ImageBuffer(_spec)));
 
-            memset(&buffer, 0, sizeof(buffer));
-            buffer.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
-            buffer.memory = V4L2_MEMORY_USERPTR;
-            buffer.index = i;
-            buffer.m.userptr = (unsigned long)_imageBuffers[_imageBuffers.size() - 1]->data();
-            buffer.length = bufferSize;
-
-            result = ioctl(_deviceFd, VIDIOC_QBUF, &buffer);
-            if (result < 0)
-            {
-                Log::get() << Log::WARNING << "Image_V4L2::" << __FUNCTION__ << " - VIDIOC_QBUF failed: " << result << Log::endl;
+            if (!queueBuffer(i))
                 return;
-            }
         }
 
-        bufferType = V4L2_BUF_TYPE_VIDEO_CAPTURE;
         result = ioctl(_deviceFd, VIDIOC_STREAMON, &bufferType);
         if (result < 0)
         {
@@ -158,6 +168,9 @@ void Image_V4L2::captureThreadFunc()
         unique_lock<shared_timed_mutex> lockWrite(_writeMutex, std::defer_lock);
         while (_captureThreadRun)
         {
+            if (_ioMethod == V4L2_MEMORY_MMAP && !requeueReleasedBuffers())
+                return;
+
             struct pollfd fd;
             fd.fd = _deviceFd;
             fd.events = POLLIN | POLLPRI;
@@ -168,8 +181,14 @@ void Image_V4L2::captureThreadFunc()
                 if (fd.revents & (POLLIN | POLLPRI))
                 {
                     memset(&buffer, 0, sizeof(buffer));
-                    buffer.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
-                    buffer.memory = V4L2_MEMORY_USERPTR;
+                    buffer.type = _bufferType;
+                    buffer.memory = _ioMethod;
+                    if (_bufferType == V4L2_BUF_TYPE_VIDEO_CAPTURE_MPLANE)
+                    {
+                        memset(planes, 0, sizeof(planes));
+                        buffer.m.planes = planes;
+                        buffer.length = VIDEO_MAX_PLANES;
+                    }
 
                     result = ioctl(_deviceFd, VIDIOC_DQBUF, &buffer);
                     if (result < 0)
@@ -185,35 +204,44 @@ void Image_V4L2::captureThreadFunc()
                         }
                     }
 
-                    if (buffer.index >= _bufferCount)
+                    if (buffer.index >= bufferCount)
                     {
                         Log::get() << Log::WARNING << "Image_V4L2::" << __FUNCTION__ << " - Invalid buffer index: " << buffer.index << Log::endl;
                         return;
                     }
 
-                    if (!_bufferImage || _bufferImage->getSpec() != _imageBuffers[buffer.index]->getSpec())
-                        _bufferImage = unique_ptr<ImageBuffer>(new ImageBuffer(_spec));
+                    // Use the capture time given by the driver, if it matches our clock
+                    int64_t captureTime = -1;
+                    if ((buffer.flags & V4L2_BUF_FLAG_TIMESTAMP_MASK) == V4L2_BUF_FLAG_TIMESTAMP_MONOTONIC)
+                        captureTime = static_cast<int64_t>(buffer.timestamp.tv_sec) * 1000000 + buffer.timestamp.tv_usec;
 
-                    lockWrite.lock();
-                    _bufferImage.swap(_imageBuffers[buffer.index]);
-                    lockWrite.unlock();
+                    if (_ioMethod == V4L2_MEMORY_MMAP)
+                    {
+                        // The frame wraps the mapped buffer, which is requeued once all consumers are done with it
+                        auto frame = getMappedFrame(buffer.index);
+                        stampFrame(*frame, captureTime);
+                        lockWrite.lock();
+                        _bufferImage.swap(frame);
+                        lockWrite.unlock();
+
+                        _imageUpdated = true;
+                        updateTimestamp();
+                    }
+                    else
+                    {
+                        if (!_bufferImage || _bufferImage->getSpec() != _imageBuffers[buffer.index]->getSpec())
+                            _bufferImage = unique_ptr<ImageBuffer>(new ImageBuffer(_spec));
 
-                    _imageUpdated = true;
-                    updateTimestamp();
+                        stampFrame(*_imageBuffers[buffer.index], captureTime);
+                        lockWrite.lock();
+                        _bufferImage.swap(_imageBuffers[buffer.index]);
+                        lockWrite.unlock();
 
-                    auto currentBuffer = buffer.index;
-                    memset(&buffer, 0, sizeof(buffer));
-                    buffer.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
-                    buffer.memory = V4L2_MEMORY_USERPTR;
-                    buffer.index = currentBuffer;
-                    buffer.m.userptr = (unsigned long)_imageBuffers[currentBuffer]->data();
-                    buffer.length = bufferSize;
+                        _imageUpdated = true;
+                        updateTimestamp();
 
-                    result = ioctl(_deviceFd, VIDIOC_QBUF, &buffer);
-                    if (result < 0)
-                    {
-                        Log::get() << Log::WARNING << "Image_V4L2::" << __FUNCTION__ << " - Failed to requeue buffer " << buffer.index << Log::endl;
-                        return;
+                        if (!queueBuffer(buffer.index))
+                            return;
                     }
                 }
             }
@@ -252,25 +280,21 @@ void Image_V4L2::captureThreadFunc()
 #endif
         }
 
-        bufferType = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+        // Stopping the stream gives all the buffers back to the application
         result = ioctl(_deviceFd, VIDIOC_STREAMOFF, &bufferType);
         if (result < 0)
             Log::get() << Log::WARNING << "Image_V4L2::" << __FUNCTION__ << " - VIDIOC_STREAMOFF failed: " << result << Log::endl;
-
-        for (uint32_t i = 0; i < _bufferCount; ++i)
-        {
-            memset(&buffer, 0, sizeof(buffer));
-            buffer.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
-            buffer.memory = V4L2_MEMORY_USERPTR;
-            result = ioctl(_deviceFd, VIDIOC_DQBUF, &buffer);
-            if (result < 0)
-                Log::get() << Log::WARNING << "Image_V4L2::" << __FUNCTION__ << " - VIDIOC_DQBUF failed: " << result << Log::endl;
-        }
     }
 
-    // Reset to a default image
-    _bufferImage = make_unique<ImageBuffer>(ImageBufferSpec(512, 512, 4, 32));
-    _bufferImage->zero();
+    // Reset to a default image. Mapped buffers still held by consumers are unmapped when released
+    auto defaultImage = make_unique<ImageBuffer>(ImageBufferSpec(512, 512, 4, 32));
+    defaultImage->zero();
+    {
+        lock_guard<shared_timed_mutex> lockWrite(_writeMutex);
+        _bufferImage.swap(defaultImage);
+    }
+    _imageBuffers.clear();
+    _mappedBuffers.reset();
     _imageUpdated = true;
     updateTimestamp();
 }
@@ -278,6 +302,12 @@ void Image_V4L2::captureThreadFunc()
 /*************/
 bool Image_V4L2::initializeUserPtrCapture()
 {
+    if (_bufferType != V4L2_BUF_TYPE_VIDEO_CAPTURE)
+    {
+        Log::get() << Log::WARNING << "Image_V4L2::" << __FUNCTION__ << " - Userptr IO is only supported for single-planar capture devices" << Log::endl;
+        return false;
+    }
+
     memset(&_v4l2RequestBuffers, 0, sizeof(_v4l2RequestBuffers));
     _v4l2RequestBuffers.count = _bufferCount;
     _v4l2RequestBuffers.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
@@ -293,6 +323,146 @@ bool Image_V4L2::initializeUserPtrCapture()
     return true;
 }
 
+/*************/
+bool Image_V4L2::initializeMmapCapture()
+{
+    memset(&_v4l2RequestBuffers, 0, sizeof(_v4l2RequestBuffers));
+    _v4l2RequestBuffers.count = _bufferCount;
+    _v4l2RequestBuffers.type = _bufferType;
+    _v4l2RequestBuffers.memory = V4L2_MEMORY_MMAP;
+
+    int result = ioctl(_deviceFd, VIDIOC_REQBUFS, &_v4l2RequestBuffers);
+    if (result < 0)
+    {
+        Log::get() << Log::WARNING << "Image_V4L2::" << __FUNCTION__ << " - Device does not support mmap IO: " << result << Log::endl;
+        return false;
+    }
+
+    // The driver may allocate fewer buffers than requested
+    if (_v4l2RequestBuffers.count < 2)
+    {
+        Log::get() << Log::WARNING << "Image_V4L2::" << __FUNCTION__ << " - Not enough buffers allocated by the device: " << _v4l2RequestBuffers.count << Log::endl;
+        return false;
+    }
+
+    auto mappedBuffers = make_shared<MappedBuffers>();
+    auto frameSize = static_cast<size_t>(_bytesPerLine) * _spec.height;
+    for (uint32_t i = 0; i < _v4l2RequestBuffers.count; ++i)
+    {
+        struct v4l2_buffer buffer;
+        struct v4l2_plane planes[VIDEO_MAX_PLANES];
+        memset(&buffer, 0, sizeof(buffer));
+        memset(planes, 0, sizeof(planes));
+        buffer.type = _bufferType;
+        buffer.memory = V4L2_MEMORY_MMAP;
+        buffer.index = i;
+        if (_bufferType == V4L2_BUF_TYPE_VIDEO_CAPTURE_MPLANE)
+        {
+            buffer.m.planes = planes;
+            buffer.length = VIDEO_MAX_PLANES;
+        }
+
+        if (ioctl(_deviceFd, VIDIOC_QUERYBUF, &buffer) < 0)
+        {
+            Log::get() << Log::WARNING << "Image_V4L2::" << __FUNCTION__ << " - VIDIOC_QUERYBUF failed for buffer " << i << Log::endl;
+            return false;
+        }
+
+        size_t length = buffer.length;
+        off_t offset = buffer.m.offset;
+        if (_bufferType == V4L2_BUF_TYPE_VIDEO_CAPTURE_MPLANE)
+        {
+            length = planes[0].length;
+            offset = planes[0].m.mem_offset;
+        }
+
+        if (length < frameSize)
+        {
+            Log::get() << Log::WARNING << "Image_V4L2::" << __FUNCTION__ << " - Buffer " << i << " is too small for the capture format" << Log::endl;
+            return false;
+        }
+
+        auto mapped = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_SHARED, _deviceFd, offset);
+        if (mapped == MAP_FAILED)
+        {
+            Log::get() << Log::WARNING << "Image_V4L2::" << __FUNCTION__ << " - Unable to map buffer " << i << Log::endl;
+            return false;
+        }
+
+        mappedBuffers->buffers.push_back(make_pair(mapped, length));
+    }
+
+    _mappedBuffers = mappedBuffers;
+    return true;
+}
+
+/*************/
+bool Image_V4L2::queueBuffer(uint32_t index)
+{
+    struct v4l2_buffer buffer;
+    struct v4l2_plane planes[VIDEO_MAX_PLANES];
+    memset(&buffer, 0, sizeof(buffer));
+    buffer.type = _bufferType;
+    buffer.memory = _ioMethod;
+    buffer.index = index;
+
+    if (_ioMethod == V4L2_MEMORY_USERPTR)
+    {
+        buffer.m.userptr = (unsigned long)_imageBuffers[index]->data();
+        buffer.length = _spec.rawSize();
+    }
+    else if (_bufferType == V4L2_BUF_TYPE_VIDEO_CAPTURE_MPLANE)
+    {
+        memset(planes, 0, sizeof(planes));
+        buffer.m.planes = planes;
+        buffer.length = 1;
+    }
+
+    if (ioctl(_deviceFd, VIDIOC_QBUF, &buffer) < 0)
+    {
+        Log::get() << Log::WARNING << "Image_V4L2::" << __FUNCTION__ << " - Failed to queue buffer " << index << Log::endl;
+        return false;
+    }
+
+    return true;
+}
+
+/*************/
+bool Image_V4L2::requeueReleasedBuffers()
+{
+    vector<uint32_t> released;
+    {
+        lock_guard<mutex> lock(_mappedBuffers->releasedMutex);
+        std::swap(released, _mappedBuffers->released);
+    }
+
+    for (auto index : released)
+        if (!queueBuffer(index))
+            return false;
+
+    return true;
+}
+
+/*************/
+unique_ptr<ImageBuffer> Image_V4L2::getMappedFrame(uint32_t index)
+{
+    auto mappedBuffers = _mappedBuffers;
+    auto mapped = reinterpret_cast<char*>(mappedBuffers->buffers[index].first);
+    auto lineSize = _spec.width * _spec.pixelBytes();
+
+    // Lines padded by the driver have to be packed, in which case the buffer can be requeued right away
+    if (_bytesPerLine != lineSize)
+    {
+        auto frame = make_unique<ImageBuffer>(_spec);
+        for (uint32_t y = 0; y < _spec.height; ++y)
+            memcpy(frame->data() + y * lineSize, mapped + y * _bytesPerLine, lineSize);
+        mappedBuffers->release(index);
+        return frame;
+    }
+
+    return make_unique<ImageBuffer>(_spec, ResizableArray<char>(mapped, _spec.rawSize(), [mappedBuffers, index]() { mappedBuffers->release(index); }));
+}
+
 /*************/
 bool Image_V4L2::initializeCapture()
 {
@@ -398,10 +568,20 @@ bool Image_V4L2::openCaptureDevice(const std::string& devicePath)
         return false;
     }
 
+    auto capabilities = _v4l2Capability.capabilities;
+    if (capabilities & V4L2_CAP_DEVICE_CAPS)
+        capabilities = _v4l2Capability.device_caps;
+
     if (!_capabilitiesEnumerated)
     {
-        if (_v4l2Capability.capabilities & V4L2_CAP_VIDEO_CAPTURE)
+        if (capabilities & (V4L2_CAP_VIDEO_CAPTURE | V4L2_CAP_VIDEO_CAPTURE_MPLANE))
         {
+            // The single-planar API is preferred when both are available
+            if (capabilities & V4L2_CAP_VIDEO_CAPTURE)
+                _bufferType = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+            else
+                _bufferType = V4L2_BUF_TYPE_VIDEO_CAPTURE_MPLANE;
+
             if (!enumerateCaptureDeviceInputs())
                 Log::get() << Log::WARNING << "Image_V4L2::" << __FUNCTION__ << " - Failed to enumerate capture inputs" << Log::endl;
 
@@ -420,7 +600,7 @@ bool Image_V4L2::openCaptureDevice(const std::string& devicePath)
             return false;
         }
 
-        if (_v4l2Capability.capabilities & V4L2_CAP_STREAMING)
+        if (capabilities & V4L2_CAP_STREAMING)
         {
             _hasStreamingIO = true;
             Log::get() << Log::MESSAGE << "Image_V4L2::" << __FUNCTION__ << " - Capture device supports streaming I/O" << Log::endl;
@@ -445,11 +625,22 @@ bool Image_V4L2::openCaptureDevice(const std::string& devicePath)
 
     // Try setting the video format
     memset(&_v4l2Format, 0, sizeof(_v4l2Format));
-    _v4l2Format.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
-    _v4l2Format.fmt.pix.width = _outputWidth;
-    _v4l2Format.fmt.pix.height = _outputHeight;
-    _v4l2Format.fmt.pix.field = V4L2_FIELD_NONE;
-    _v4l2Format.fmt.pix.pixelformat = _outputPixelFormat;
+    _v4l2Format.type = _bufferType;
+    if (_bufferType == V4L2_BUF_TYPE_VIDEO_CAPTURE_MPLANE)
+    {
+        _v4l2Format.fmt.pix_mp.width = _outputWidth;
+        _v4l2Format.fmt.pix_mp.height = _outputHeight;
+        _v4l2Format.fmt.pix_mp.field = V4L2_FIELD_NONE;
+        _v4l2Format.fmt.pix_mp.pixelformat = _outputPixelFormat;
+        _v4l2Format.fmt.pix_mp.num_planes = 1;
+    }
+    else
+    {
+        _v4l2Format.fmt.pix.width = _outputWidth;
+        _v4l2Format.fmt.pix.height = _outputHeight;
+        _v4l2Format.fmt.pix.field = V4L2_FIELD_NONE;
+        _v4l2Format.fmt.pix.pixelformat = _outputPixelFormat;
+    }
 
     if (ioctl(_deviceFd, VIDIOC_S_FMT, &_v4l2Format) < 0)
     {
@@ -469,8 +660,26 @@ bool Image_V4L2::openCaptureDevice(const std::string& devicePath)
         return false;
     }
 
-    _outputWidth = _v4l2Format.fmt.pix.width;
-    _outputHeight = _v4l2Format.fmt.pix.height;
+    if (_bufferType == V4L2_BUF_TYPE_VIDEO_CAPTURE_MPLANE)
+    {
+        // Only the packed formats are supported, which fit in a single plane
+        if (_v4l2Format.fmt.pix_mp.num_planes != 1)
+        {
+            Log::get() << Log::WARNING << "Image_V4L2::" << __FUNCTION__ << " - Only single plane pixel formats are supported" << Log::endl;
+            closeCaptureDevice();
+            return false;
+        }
+
+        _outputWidth = _v4l2Format.fmt.pix_mp.width;
+        _outputHeight = _v4l2Format.fmt.pix_mp.height;
+        _bytesPerLine = _v4l2Format.fmt.pix_mp.plane_fmt[0].bytesperline;
+    }
+    else
+    {
+        _outputWidth = _v4l2Format.fmt.pix.width;
+        _outputHeight = _v4l2Format.fmt.pix.height;
+        _bytesPerLine = _v4l2Format.fmt.pix.bytesperline;
+    }
 
     Log::get() << Log::WARNING << "Image_V4L2::" << __FUNCTION__ << " - Capture format set to: " << _outputWidth << "x" << _outputHeight << " for format "
                << string(reinterpret_cast<char*>(&_outputPixelFormat), 4) << Log::endl;
@@ -486,6 +695,9 @@ bool Image_V4L2::openCaptureDevice(const std::string& devicePath)
         break;
     }
 
+    // Some drivers do not report the line stride
+    _bytesPerLine = std::max<uint32_t>(_bytesPerLine, _spec.width * _spec.pixelBytes());
+
     return true;
 }
 
@@ -551,7 +763,7 @@ bool Image_V4L2::enumerateCaptureFormats()
 
     memset(&format, 0, sizeof(format));
     format.index = 0;
-    format.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    format.type = _bufferType;
 
     _v4l2FormatCount = 0;
     while (ioctl(_deviceFd, VIDIOC_ENUM_FMT, &format) >= 0)
@@ -564,7 +776,7 @@ bool Image_V4L2::enumerateCaptureFormats()
     for (int i = 0; i < _v4l2FormatCount; ++i)
     {
         _v4l2Formats[i].index = i;
-        _v4l2Formats[i].type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+        _v4l2Formats[i].type = _bufferType;
 
         if (ioctl(_deviceFd, VIDIOC_ENUM_FMT, &_v4l2Formats[i]) < 0)
         {
@@ -621,6 +833,8 @@ void Image_V4L2::updateMoreMediaInfo(Values& mediaInfo)
 {
     mediaInfo.push_back(Value(_devicePath, "devicePath"));
     mediaInfo.push_back(Value(_v4l2Index, "v4l2Index"));
+    mediaInfo.push_back(Value(string(_ioMethod == V4L2_MEMORY_MMAP ? "mmap" : "userptr"), "ioMethod"));
+    mediaInfo.push_back(Value(static_cast<int>(_v4l2RequestBuffers.count), "bufferCount"));
 }
 
 /*************/
@@ -756,6 +970,47 @@ void Image_V4L2::registerAttributes()
         {'s'});
     setAttributeParameter("pixelFormat", true, true);
     setAttributeDescription("pixelFormat", "Set the desired output format, either RGB or YUYV");
+
+    addAttribute("ioMethod",
+        [&](const Values& args) {
+            auto isCapturing = _capturing;
+            if (isCapturing)
+                stopCapture();
+
+            auto method = args[0].as<string>();
+            if (method == "userptr")
+                _ioMethod = V4L2_MEMORY_USERPTR;
+            else
+                _ioMethod = V4L2_MEMORY_MMAP;
+
+            if (isCapturing)
+                doCapture();
+
+            return true;
+        },
+        [&]() -> Values { return {string(_ioMethod == V4L2_MEMORY_USERPTR ? "userptr" : "mmap")}; },
+        {'s'});
+    setAttributeParameter("ioMethod", true, true);
+    setAttributeDescription("ioMethod",
+        "Set the streaming IO method, either mmap (frames are read directly from the driver buffers) or userptr (the driver writes in buffers allocated by Splash)");
+
+    addAttribute("bufferCount",
+        [&](const Values& args) {
+            auto isCapturing = _capturing;
+            if (isCapturing)
+                stopCapture();
+
+            _bufferCount = std::min(std::max(args[0].as<int>(), 2), static_cast<int>(VIDEO_MAX_FRAME));
+
+            if (isCapturing)
+                doCapture();
+
+            return true;
+        },
+        [&]() -> Values { return {static_cast<int>(_bufferCount)}; },
+        {'n'});
+    setAttributeParameter("bufferCount", true, true);
+    setAttributeDescription("bufferCount", "Set the number of capture buffers. More buffers let consumers hold frames longer before the device runs out of buffers");
 }
 
 } // namespace Splash
@@ -28,7 +28,9 @@
 #include <atomic>
 #include <deque>
 #include <future>
+#include <memory>
 #include <mutex>
+#include <vector>
 
 #include <linux/videodev2.h>
 
@@ -99,9 +101,31 @@ class Image_V4L2 : public Image
     uint32_t _outputPixelFormat{V4L2_PIX_FMT_RGB24};
     std::string _sourceFormatAsString{""};
 
-    struct v4l2_requestbuffers _v4l2RequestBuffers;
-    uint32_t _bufferCount{3};
+    /**
+     * Buffers allocated by the driver and mapped in memory. They are shared with the frames
+     * wrapping them, and unmapped once the capture is stopped and the last frame is destroyed
+     */
+    struct MappedBuffers
+    {
+        std::vector<std::pair<void*, size_t>> buffers{};
+        std::mutex releasedMutex{};
+        std::vector<uint32_t> released{}; //!< Indices of the buffers released by the consumers, to requeue
+
+        ~MappedBuffers();
+        void release(uint32_t index)
+        {
+            std::lock_guard<std::mutex> lock(releasedMutex);
+            released.push_back(index);
+        }
+    };
+
+    struct v4l2_requestbuffers _v4l2RequestBuffers{};
+    uint32_t _ioMethod{V4L2_MEMORY_MMAP};
+    uint32_t _bufferType{V4L2_BUF_TYPE_VIDEO_CAPTURE};
+    uint32_t _bytesPerLine{0};
+    uint32_t _bufferCount{4};
     std::deque<std::unique_ptr<ImageBuffer>> _imageBuffers{};
+    std::shared_ptr<MappedBuffers> _mappedBuffers{};
 
     bool _capturing{false};        //!< True if currently capturing frames
     bool _captureThreadRun{false}; //!< Set to false to stop the capture thread
@@ -130,6 +154,32 @@ class Image_V4L2 : public Image
      */
     bool initializeUserPtrCapture();
 
+    /**
+     * Initialize V4L2 mmap capture mode, and map the buffers allocated by the driver
+     * \return Return true if all went well
+     */
+    bool initializeMmapCapture();
+
+    /**
+     * Queue the given buffer
+     * \param index Buffer index
+     * \return Return true if all went well
+     */
+    bool queueBuffer(uint32_t index);
+
+    /**
+     * Requeue the mapped buffers which have been released by the consumers
+     * \return Return true if all went well
+     */
+    bool requeueReleasedBuffers();
+
+    /**
+     * Get an image wrapping the given mapped buffer, which is requeued when the image is destroyed
+     * \param index Buffer index
+     * \return Return the image
+     */
+    std::unique_ptr<ImageBuffer> getMappedFrame(uint32_t index);
+
     /**
      * Initialize the capture
      * \return Return true if everything is OK
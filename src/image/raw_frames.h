@@ -0,0 +1,156 @@
+/*
+ * Copyright (C) 2018 Emmanuel Durand
+ *
+ * This file is part of Splash.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Splash is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Splash.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * @raw_frames.h
+ * Description of the Splash raw frames container
+ *
+ * The container is laid out so that every frame can be read with aligned direct I/O:
+ * - a header, padded to RawFrames::alignment bytes
+ * - the frames, each one starting on a RawFrames::alignment boundary
+ * - the frame index, also starting on an alignment boundary
+ *
+ * The header and index are stored as is, in little-endian: containers can only be read and written on little-endian hosts
+ */
+
+#ifndef SPLASH_RAW_FRAMES_H
+#define SPLASH_RAW_FRAMES_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+#include "./core/imagebuffer.h"
+
+namespace Splash
+{
+namespace RawFrames
+{
+
+const char magic[8] = {'S', 'P', 'L', 'R', 'A', 'W', '\0', '\0'};
+const uint32_t version = 1;
+const uint64_t alignment = 4096; //!< Alignment of every section of the file, suitable for O_DIRECT
+
+/*************/
+struct Header
+{
+    char magic[8];
+    uint32_t version{0};
+    uint32_t width{0};
+    uint32_t height{0};
+    uint32_t channels{0};
+    uint32_t bpp{0};
+    uint32_t type{0};      //!< ImageBufferSpec::Type
+    char format[32];       //!< ImageBufferSpec format, i.e. "RGBA", "YUYV", "RGB_DXT1"
+    uint64_t frameSize{0}; //!< Size of a frame, without padding
+    uint64_t frameCount{0};
+    uint64_t indexOffset{0};
+    double framerate{30.0};
+};
+
+// The header is written to the disk as is, its layout is part of the format
+static_assert(sizeof(Header) == 96, "RawFrames::Header layout changed");
+static_assert(offsetof(Header, version) == 8 && offsetof(Header, width) == 12 && offsetof(Header, height) == 16 && offsetof(Header, channels) == 20
+        && offsetof(Header, bpp) == 24 && offsetof(Header, type) == 28 && offsetof(Header, format) == 32,
+    "RawFrames::Header layout changed");
+static_assert(offsetof(Header, frameSize) == 64 && offsetof(Header, frameCount) == 72 && offsetof(Header, indexOffset) == 80 && offsetof(Header, framerate) == 88,
+    "RawFrames::Header layout changed");
+
+/*************/
+struct IndexEntry
+{
+    uint64_t offset{0}; //!< Frame position in the file, aligned
+    int64_t timing{0};  //!< Frame timing, in us
+};
+
+static_assert(sizeof(IndexEntry) == 16 && offsetof(IndexEntry, timing) == 8, "RawFrames::IndexEntry layout changed");
+
+/**
+ * \brief Check whether the host is little-endian, which is required to read and write containers
+ * \return Return true if the host is little-endian
+ */
+inline bool isLittleEndian()
+{
+    const uint16_t value = 1;
+    return *reinterpret_cast<const uint8_t*>(&value) == 1;
+}
+
+/**
+ * \brief Round a size up to the container alignment
+ * \param size Size to align
+ * \return Return the aligned size
+ */
+inline uint64_t alignedSize(uint64_t size)
+{
+    return (size + alignment - 1) / alignment * alignment;
+}
+
+/**
+ * \brief Fill a header from an image spec
+ * \param spec Image spec
+ * \param framerate Framerate
+ * \return Return the header
+ */
+inline Header headerFromSpec(const ImageBufferSpec& spec, double framerate)
+{
+    Header header;
+    memcpy(header.magic, magic, sizeof(magic));
+    header.version = version;
+    header.width = spec.width;
+    header.height = spec.height;
+    header.channels = spec.channels;
+    header.bpp = spec.bpp;
+    header.type = static_cast<uint32_t>(spec.type);
+    memset(header.format, 0, sizeof(header.format));
+    strncpy(header.format, spec.format.c_str(), sizeof(header.format) - 1);
+    header.frameSize = spec.rawSize();
+    header.framerate = framerate;
+    return header;
+}
+
+/**
+ * \brief Get the image spec described by a header
+ * \param header Container header
+ * \return Return the image spec
+ */
+inline ImageBufferSpec specFromHeader(const Header& header)
+{
+    auto format = std::string(header.format, strnlen(header.format, sizeof(header.format)));
+    return ImageBufferSpec(header.width, header.height, header.channels, header.bpp, static_cast<ImageBufferSpec::Type>(header.type), format);
+}
+
+/**
+ * \brief Check that a header is valid
+ * \param header Container header
+ * \return Return true if the header is valid
+ */
+inline bool isValid(const Header& header)
+{
+    if (memcmp(header.magic, magic, sizeof(magic)) != 0)
+        return false;
+    if (header.version != version)
+        return false;
+    return header.frameSize == static_cast<uint64_t>(specFromHeader(header).rawSize());
+}
+
+} // end of namespace
+} // end of namespace
+
+#endif // SPLASH_RAW_FRAMES_H
@@ -0,0 +1,268 @@
+#include "./mesh/bvh.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+using namespace std;
+
+namespace Splash
+{
+
+/*************/
+Bvh::Bvh(const vector<glm::vec4>& vertices, const vector<uint32_t>& indices)
+{
+    _vertices.reserve(vertices.size());
+    for (const auto& vertex : vertices)
+        _vertices.push_back(glm::vec3(vertex));
+
+    buildNodes(_vertexNodes, _vertexItems, _vertices, _vertices, _vertices);
+
+    // Triangles referring to undefined vertices are ignored
+    for (size_t i = 0; i + 2 < indices.size(); i += 3)
+    {
+        if (indices[i] >= _vertices.size() || indices[i + 1] >= _vertices.size() || indices[i + 2] >= _vertices.size())
+            continue;
+        _indices.insert(_indices.end(), {indices[i], indices[i + 1], indices[i + 2]});
+    }
+
+    auto triangleCount = _indices.size() / 3;
+    vector<glm::vec3> centroids(triangleCount);
+    vector<glm::vec3> mins(triangleCount);
+    vector<glm::vec3> maxs(triangleCount);
+    for (size_t t = 0; t < triangleCount; ++t)
+    {
+        const auto& a = _vertices[_indices[t * 3]];
+        const auto& b = _vertices[_indices[t * 3 + 1]];
+        const auto& c = _vertices[_indices[t * 3 + 2]];
+        mins[t] = glm::min(a, glm::min(b, c));
+        maxs[t] = glm::max(a, glm::max(b, c));
+        centroids[t] = (a + b + c) / 3.f;
+    }
+
+    buildNodes(_triangleNodes, _triangleItems, centroids, mins, maxs);
+}
+
+/*************/
+void Bvh::buildNodes(vector<Node>& nodes, vector<uint32_t>& items, const vector<glm::vec3>& centroids, const vector<glm::vec3>& mins, const vector<glm::vec3>& maxs)
+{
+    nodes.clear();
+    items.clear();
+    if (centroids.empty())
+        return;
+
+    // Items are sorted along with their bounds, to keep memory accesses contiguous
+    struct Item
+    {
+        glm::vec3 centroid;
+        glm::vec3 min;
+        glm::vec3 max;
+        uint32_t index;
+    };
+
+    vector<Item> sortedItems(centroids.size());
+    for (uint32_t i = 0; i < sortedItems.size(); ++i)
+        sortedItems[i] = {centroids[i], mins[i], maxs[i], i};
+
+    struct Task
+    {
+        uint32_t begin;
+        uint32_t end;
+        int64_t parent;
+    };
+
+    // Nodes are created depth first, first child first, so that the first child of a node always follows it
+    nodes.reserve(2 * sortedItems.size() / _maxLeafSize + 1);
+    vector<Task> tasks{{0, static_cast<uint32_t>(sortedItems.size()), -1}};
+    while (!tasks.empty())
+    {
+        auto task = tasks.back();
+        tasks.pop_back();
+
+        auto nodeIndex = static_cast<uint32_t>(nodes.size());
+        if (task.parent >= 0 && static_cast<uint32_t>(task.parent) + 1 != nodeIndex)
+            nodes[task.parent].first = nodeIndex;
+
+        Node node;
+        node.min = sortedItems[task.begin].min;
+        node.max = sortedItems[task.begin].max;
+        auto centroidMin = sortedItems[task.begin].centroid;
+        auto centroidMax = centroidMin;
+        for (uint32_t i = task.begin + 1; i < task.end; ++i)
+        {
+            const auto& item = sortedItems[i];
+            node.min = glm::min(node.min, item.min);
+            node.max = glm::max(node.max, item.max);
+            centroidMin = glm::min(centroidMin, item.centroid);
+            centroidMax = glm::max(centroidMax, item.centroid);
+        }
+
+        auto extent = centroidMax - centroidMin;
+        if (task.end - task.begin <= _maxLeafSize || (extent[0] <= 0.f && extent[1] <= 0.f && extent[2] <= 0.f))
+        {
+            node.first = task.begin;
+            node.count = task.end - task.begin;
+            nodes.push_back(node);
+            continue;
+        }
+
+        nodes.push_back(node);
+
+        int axis = 0;
+        if (extent[1] > extent[axis])
+            axis = 1;
+        if (extent[2] > extent[axis])
+            axis = 2;
+
+        auto middle = task.begin + (task.end - task.begin) / 2;
+        nth_element(sortedItems.begin() + task.begin, sortedItems.begin() + middle, sortedItems.begin() + task.end, [&](const Item& a, const Item& b) {
+            return a.centroid[axis] < b.centroid[axis];
+        });
+
+        tasks.push_back({middle, task.end, nodeIndex});
+        tasks.push_back({task.begin, middle, nodeIndex});
+    }
+
+    items.resize(sortedItems.size());
+    for (uint32_t i = 0; i < items.size(); ++i)
+        items[i] = sortedItems[i].index;
+}
+
+/*************/
+float Bvh::getClosestVertex(const glm::vec3& point, glm::vec3& vertex) const
+{
+    if (_vertexNodes.empty())
+        return numeric_limits<float>::max();
+
+    auto boxDistance = [&](const Node& node) {
+        auto d = glm::max(glm::max(node.min - point, point - node.max), glm::vec3(0.f));
+        return glm::dot(d, d);
+    };
+
+    float bestDistance = numeric_limits<float>::max();
+    uint32_t bestVertex = 0;
+
+    vector<uint32_t> stack{0};
+    stack.reserve(64);
+    while (!stack.empty())
+    {
+        auto nodeIndex = stack.back();
+        const auto& node = _vertexNodes[nodeIndex];
+        stack.pop_back();
+
+        if (boxDistance(node) >= bestDistance)
+            continue;
+
+        if (node.count != 0)
+        {
+            for (uint32_t i = node.first; i < node.first + node.count; ++i)
+            {
+                auto d = _vertices[_vertexItems[i]] - point;
+                auto distance = glm::dot(d, d);
+                if (distance < bestDistance)
+                {
+                    bestDistance = distance;
+                    bestVertex = _vertexItems[i];
+                }
+            }
+            continue;
+        }
+
+        // Visit the closest child first, so that the other one is more likely to be culled
+        auto firstChild = nodeIndex + 1;
+        auto secondChild = node.first;
+        if (boxDistance(_vertexNodes[firstChild]) < boxDistance(_vertexNodes[secondChild]))
+            swap(firstChild, secondChild);
+        stack.push_back(firstChild);
+        stack.push_back(secondChild);
+    }
+
+    vertex = _vertices[bestVertex];
+    return sqrt(bestDistance);
+}
+
+/*************/
+float Bvh::intersectTriangle(const glm::vec3& a, const glm::vec3& b, const glm::vec3& c, const glm::vec3& origin, const glm::vec3& direction)
+{
+    // Moller-Trumbore ray / triangle intersection
+    auto edge1 = b - a;
+    auto edge2 = c - a;
+    auto p = glm::cross(direction, edge2);
+    auto det = glm::dot(edge1, p);
+    if (det == 0.f)
+        return numeric_limits<float>::max();
+
+    auto s = origin - a;
+    auto u = glm::dot(s, p) / det;
+    if (u < 0.f || u > 1.f)
+        return numeric_limits<float>::max();
+
+    auto q = glm::cross(s, edge1);
+    auto v = glm::dot(direction, q) / det;
+    if (v < 0.f || u + v > 1.f)
+        return numeric_limits<float>::max();
+
+    auto t = glm::dot(edge2, q) / det;
+    return t >= 0.f ? t : numeric_limits<float>::max();
+}
+
+/*************/
+float Bvh::intersect(const glm::vec3& origin, const glm::vec3& direction, glm::vec3& hit) const
+{
+    if (_triangleNodes.empty())
+        return numeric_limits<float>::max();
+
+    auto invDirection = glm::vec3(1.f / direction[0], 1.f / direction[1], 1.f / direction[2]);
+    auto boxEntry = [&](const Node& node) {
+        float tMin = 0.f;
+        float tMax = numeric_limits<float>::max();
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            auto t0 = (node.min[axis] - origin[axis]) * invDirection[axis];
+            auto t1 = (node.max[axis] - origin[axis]) * invDirection[axis];
+            if (t0 > t1)
+                swap(t0, t1);
+            tMin = max(tMin, t0);
+            tMax = min(tMax, t1);
+        }
+        return tMin <= tMax ? tMin : numeric_limits<float>::max();
+    };
+
+    float bestT = numeric_limits<float>::max();
+
+    vector<uint32_t> stack{0};
+    stack.reserve(64);
+    while (!stack.empty())
+    {
+        auto nodeIndex = stack.back();
+        const auto& node = _triangleNodes[nodeIndex];
+        stack.pop_back();
+
+        if (boxEntry(node) >= bestT)
+            continue;
+
+        if (node.count != 0)
+        {
+            for (uint32_t i = node.first; i < node.first + node.count; ++i)
+            {
+                auto triangle = _triangleItems[i] * 3;
+                bestT = min(bestT, intersectTriangle(_vertices[_indices[triangle]], _vertices[_indices[triangle + 1]], _vertices[_indices[triangle + 2]], origin, direction));
+            }
+            continue;
+        }
+
+        auto firstChild = nodeIndex + 1;
+        auto secondChild = node.first;
+        if (boxEntry(_triangleNodes[firstChild]) < boxEntry(_triangleNodes[secondChild]))
+            swap(firstChild, secondChild);
+        stack.push_back(firstChild);
+        stack.push_back(secondChild);
+    }
+
+    if (bestT != numeric_limits<float>::max())
+        hit = origin + direction * bestT;
+
+    return bestT;
+}
+
+} // end of namespace
@@ -0,0 +1,112 @@
+/*
+ * Copyright (C) 2018 Emmanuel Durand
+ *
+ * This file is part of Splash.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Splash is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Splash.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * @bvh.h
+ * Bounding volume hierarchies over the vertices and triangles of a mesh, for picking
+ */
+
+#ifndef SPLASH_BVH_H
+#define SPLASH_BVH_H
+
+#include <cstdint>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+namespace Splash
+{
+
+/*************/
+class Bvh
+{
+  public:
+    /**
+     * \brief Constructor, builds the hierarchies
+     * \param vertices Mesh vertices
+     * \param indices Three indices per triangle
+     */
+    Bvh(const std::vector<glm::vec4>& vertices, const std::vector<uint32_t>& indices);
+
+    /**
+     * \brief Get the vertex closest to a point
+     * \param point Point to compare to
+     * \param vertex Closest vertex
+     * \return Return the distance to the closest vertex, or the maximum float value if there is no vertex
+     */
+    float getClosestVertex(const glm::vec3& point, glm::vec3& vertex) const;
+
+    /**
+     * \brief Get the first triangle hit by a ray
+     * \param origin Ray origin
+     * \param direction Ray direction, not necessarily normalized
+     * \param hit Point hit by the ray
+     * \return Return the ray parameter at the hit point, in direction units, or the maximum float value if no triangle is hit
+     */
+    float intersect(const glm::vec3& origin, const glm::vec3& direction, glm::vec3& hit) const;
+
+    /**
+     * \brief Intersect a ray with a triangle, from both of its sides
+     * \param a First triangle vertex
+     * \param b Second triangle vertex
+     * \param c Third triangle vertex
+     * \param origin Ray origin
+     * \param direction Ray direction
+     * \return Return the ray parameter at the hit point, or the maximum float value if the triangle is not hit
+     */
+    static float intersectTriangle(const glm::vec3& a, const glm::vec3& b, const glm::vec3& c, const glm::vec3& origin, const glm::vec3& direction);
+
+  private:
+    // Items of a leaf are items[first] to items[first + count - 1]. Inner nodes have a count of 0,
+    // their first child follows them and the second one is at index first
+    struct Node
+    {
+        glm::vec3 min;
+        glm::vec3 max;
+        uint32_t first{0};
+        uint32_t count{0};
+    };
+
+    static const uint32_t _maxLeafSize{8};
+
+    std::vector<glm::vec3> _vertices{};
+    std::vector<uint32_t> _indices{};
+    std::vector<Node> _vertexNodes{};
+    std::vector<uint32_t> _vertexItems{};
+    std::vector<Node> _triangleNodes{};
+    std::vector<uint32_t> _triangleItems{};
+
+    /**
+     * \brief Build a hierarchy, splitting nodes at the median of their longest axis
+     * \param nodes Resulting nodes
+     * \param items Resulting item order
+     * \param centroids Centroid of each item
+     * \param mins Bounding box minimum of each item
+     * \param maxs Bounding box maximum of each item
+     */
+    static void buildNodes(std::vector<Node>& nodes,
+        std::vector<uint32_t>& items,
+        const std::vector<glm::vec3>& centroids,
+        const std::vector<glm::vec3>& mins,
+        const std::vector<glm::vec3>& maxs);
+};
+
+} // end of namespace
+
+#endif // SPLASH_BVH_H
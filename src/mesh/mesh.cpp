@@ -1,6 +1,12 @@
 #include "./mesh/mesh.h"
 
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
 #include "./core/root_object.h"
+#include "./core/scene.h"
 #include "./mesh/meshloader.h"
 #include "./utils/log.h"
 #include "./utils/osutils.h"
@@ -22,6 +28,9 @@ Mesh::Mesh(RootObject* root)
 /*************/
 Mesh::~Mesh()
 {
+    if (_bvhFuture.valid())
+        _bvhFuture.wait();
+
 #ifdef DEBUG
     Log::get() << Log::DEBUGGING << "Mesh::~Mesh - Destructor" << Log::endl;
 #endif
@@ -53,7 +62,7 @@ vector<float> Mesh::getVertCoords() const
 {
     lock_guard<Spinlock> lock(_readMutex);
     vector<float> coords;
-    for (auto& v : _mesh.vertices)
+    for (auto& v : _mesh->vertices)
     {
         coords.push_back(v[0]);
         coords.push_back(v[1]);
@@ -68,7 +77,7 @@ vector<float> Mesh::getUVCoords() const
 {
     lock_guard<Spinlock> lock(_readMutex);
     vector<float> coords;
-    for (auto& u : _mesh.uvs)
+    for (auto& u : _mesh->uvs)
     {
         coords.push_back(u[0]);
         coords.push_back(u[1]);
@@ -81,7 +90,7 @@ vector<float> Mesh::getNormals() const
 {
     lock_guard<Spinlock> lock(_readMutex);
     vector<float> normals;
-    for (auto& n : _mesh.normals)
+    for (auto& n : _mesh->normals)
     {
         normals.push_back(n[0]);
         normals.push_back(n[1]);
@@ -96,7 +105,7 @@ vector<float> Mesh::getAnnexe() const
 {
     lock_guard<Spinlock> lock(_readMutex);
     vector<float> annexe;
-    for (auto& a : _mesh.annexe)
+    for (auto& a : _mesh->annexe)
     {
         annexe.push_back(a[0]);
         annexe.push_back(a[1]);
@@ -106,26 +115,282 @@ vector<float> Mesh::getAnnexe() const
     return annexe;
 }
 
+/*************/
+vector<uint32_t> Mesh::getIndices() const
+{
+    lock_guard<Spinlock> lock(_readMutex);
+    return _mesh->indices;
+}
+
+/*************/
+bool Mesh::getUpdatedRanges(int64_t timestamp, vector<VertexRange>& ranges) const
+{
+    lock_guard<Spinlock> lock(_readMutex);
+    if (!_updatedRangesValid || _updatedRangesBase != timestamp)
+        return false;
+
+    ranges = _updatedRanges;
+    return true;
+}
+
+/*************/
+void Mesh::getVertexRange(const VertexRange& range, vector<float>& vertices, vector<float>& uvs, vector<float>& normals) const
+{
+    lock_guard<Spinlock> lock(_readMutex);
+    vertices.clear();
+    uvs.clear();
+    normals.clear();
+
+    if (static_cast<size_t>(range.first) + range.count > _mesh->vertices.size())
+        return;
+
+    vertices.reserve(range.count * 4);
+    uvs.reserve(range.count * 2);
+    normals.reserve(range.count * 4);
+    for (uint32_t i = range.first; i < range.first + range.count; ++i)
+    {
+        const auto& v = _mesh->vertices[i];
+        const auto& u = _mesh->uvs[i];
+        const auto& n = _mesh->normals[i];
+        vertices.insert(vertices.end(), {v[0], v[1], v[2], v[3]});
+        uvs.insert(uvs.end(), {u[0], u[1]});
+        normals.insert(normals.end(), {n[0], n[1], n[2], 0.f});
+    }
+}
+
+/*************/
+float Mesh::pickVertex(const glm::dvec3& point, glm::dvec3& vertex)
+{
+    shared_ptr<MeshContainer> mesh;
+    {
+        lock_guard<Spinlock> lock(_readMutex);
+        mesh = _mesh;
+    }
+
+    auto p = glm::vec3(point);
+    glm::vec3 closestVertex;
+    float distance = numeric_limits<float>::max();
+
+    auto bvh = getBvh(mesh);
+    if (bvh)
+    {
+        distance = bvh->getClosestVertex(p, closestVertex);
+    }
+    else
+    {
+        // Containers are not modified once shared, so this does not need to hold the lock
+        for (const auto& v : mesh->vertices)
+        {
+            auto dist = glm::length(glm::vec3(v) - p);
+            if (dist < distance)
+            {
+                closestVertex = glm::vec3(v);
+                distance = dist;
+            }
+        }
+    }
+
+    if (distance != numeric_limits<float>::max())
+        vertex = glm::dvec3(closestVertex);
+
+    return distance;
+}
+
+/*************/
+float Mesh::pickRay(const glm::dvec3& origin, const glm::dvec3& direction, glm::dvec3& hit)
+{
+    shared_ptr<MeshContainer> mesh;
+    {
+        lock_guard<Spinlock> lock(_readMutex);
+        mesh = _mesh;
+    }
+
+    auto o = glm::vec3(origin);
+    auto d = glm::vec3(direction);
+    float t = numeric_limits<float>::max();
+
+    auto bvh = getBvh(mesh);
+    if (bvh)
+    {
+        glm::vec3 point;
+        t = bvh->intersect(o, d, point);
+    }
+    else
+    {
+        const auto& vertices = mesh->vertices;
+        const auto& indices = mesh->indices;
+        for (size_t i = 0; i + 2 < indices.size(); i += 3)
+        {
+            if (indices[i] >= vertices.size() || indices[i + 1] >= vertices.size() || indices[i + 2] >= vertices.size())
+                continue;
+            t = std::min(t, Bvh::intersectTriangle(glm::vec3(vertices[indices[i]]), glm::vec3(vertices[indices[i + 1]]), glm::vec3(vertices[indices[i + 2]]), o, d));
+        }
+    }
+
+    if (t != numeric_limits<float>::max())
+        hit = origin + direction * static_cast<double>(t);
+
+    return t;
+}
+
+/*************/
+shared_ptr<const Bvh> Mesh::getBvh(const shared_ptr<MeshContainer>& mesh)
+{
+    lock_guard<mutex> lock(_bvhMutex);
+    _bvhRequested = true;
+    if (_bvh && _bvhMesh.lock() == mesh)
+        return _bvh;
+
+    buildBvh(mesh);
+    return nullptr;
+}
+
+/*************/
+void Mesh::buildBvh(const shared_ptr<MeshContainer>& mesh)
+{
+    if (_bvhFuture.valid() && _bvhFuture.wait_for(chrono::seconds(0)) != future_status::ready)
+        return;
+
+    _bvhFuture = async(launch::async, [=]() {
+        auto bvh = make_shared<const Bvh>(mesh->vertices, mesh->indices);
+        lock_guard<mutex> lock(_bvhMutex);
+        _bvh = bvh;
+        _bvhMesh = mesh;
+    });
+}
+
+/*************/
+vector<Mesh::VertexRange> Mesh::computeUpdatedRanges(const MeshContainer& from, const MeshContainer& to)
+{
+    // Ranges separated by only a few vertices are merged, as each range has a cost when sent and uploaded
+    const uint32_t maxGap = 16;
+
+    vector<VertexRange> ranges;
+    auto vertexCount = std::min(from.vertices.size(), to.vertices.size());
+    if (from.uvs.size() != vertexCount || to.uvs.size() != vertexCount || from.normals.size() != vertexCount || to.normals.size() != vertexCount)
+        return {{0, static_cast<uint32_t>(to.vertices.size())}};
+
+    for (uint32_t i = 0; i < vertexCount; ++i)
+    {
+        if (from.vertices[i] == to.vertices[i] && from.uvs[i] == to.uvs[i] && from.normals[i] == to.normals[i])
+            continue;
+
+        if (!ranges.empty() && i - (ranges.back().first + ranges.back().count) <= maxGap)
+            ranges.back().count = i + 1 - ranges.back().first;
+        else
+            ranges.push_back({i, 1});
+    }
+
+    return ranges;
+}
+
+/*************/
+void Mesh::mergeRanges(vector<VertexRange>& ranges, const vector<VertexRange>& other)
+{
+    vector<VertexRange> merged;
+    merged.reserve(ranges.size() + other.size());
+
+    auto first = ranges.begin();
+    auto second = other.begin();
+    while (first != ranges.end() || second != other.end())
+    {
+        VertexRange range;
+        if (second == other.end() || (first != ranges.end() && first->first <= second->first))
+            range = *(first++);
+        else
+            range = *(second++);
+
+        if (!merged.empty() && range.first <= merged.back().first + merged.back().count)
+            merged.back().count = std::max(merged.back().first + merged.back().count, range.first + range.count) - merged.back().first;
+        else
+            merged.push_back(range);
+    }
+
+    ranges = std::move(merged);
+}
+
+/*************/
+void Mesh::setBufferMeshUpdated(const vector<VertexRange>* ranges)
+{
+    // Modifications accumulate until _bufferMesh is copied to _mesh
+    if (!ranges)
+    {
+        _bufferRangesValid = false;
+        _bufferUpdatedRanges.clear();
+    }
+    else if (!_meshUpdated)
+    {
+        _bufferUpdatedRanges = *ranges;
+        _bufferRangesValid = true;
+    }
+    else if (_bufferRangesValid)
+    {
+        mergeRanges(_bufferUpdatedRanges, *ranges);
+    }
+
+    _meshUpdated = true;
+    updateTimestamp();
+}
+
 /*************/
 bool Mesh::read(const string& filename)
 {
     if (!_isConnectedToRemote)
     {
-        Loader::Obj objLoader;
-        if (!objLoader.load(filename))
+        MeshContainer mesh;
+        string binaryFilepath;
+
+        const auto& extension = Loader::Binary::extension;
+        if (filename.size() >= extension.size() && filename.compare(filename.size() - extension.size(), extension.size(), extension) == 0)
         {
-            Log::get() << Log::WARNING << "Mesh::" << __FUNCTION__ << " - Unable to read the specified mesh file: " << filename << Log::endl;
-            return false;
+            Loader::Binary binaryLoader;
+            if (!binaryLoader.load(filename))
+            {
+                Log::get() << Log::WARNING << "Mesh::" << __FUNCTION__ << " - Unable to read the specified mesh file: " << filename << Log::endl;
+                return false;
+            }
+
+            binaryLoader.getIndexedMesh(mesh.vertices, mesh.uvs, mesh.normals, mesh.indices);
+            binaryFilepath = filename;
         }
+        else
+        {
+            // OBJ files are converted once to a binary mesh written next to them, which is used as long as the OBJ file is unchanged
+            auto cacheFilepath = filename + extension;
+            Loader::Binary::Source source;
+            bool hasSource = Loader::Binary::getSource(filename, source);
 
-        MeshContainer mesh;
-        mesh.vertices = objLoader.getVertices();
-        mesh.uvs = objLoader.getUVs();
-        mesh.normals = objLoader.getNormals();
+            Loader::Binary binaryLoader;
+            if (hasSource && binaryLoader.load(cacheFilepath) && binaryLoader.getSource() == source)
+            {
+                binaryLoader.getIndexedMesh(mesh.vertices, mesh.uvs, mesh.normals, mesh.indices);
+                binaryFilepath = cacheFilepath;
+            }
+            else
+            {
+                Loader::Obj objLoader;
+                if (!objLoader.load(filename))
+                {
+                    Log::get() << Log::WARNING << "Mesh::" << __FUNCTION__ << " - Unable to read the specified mesh file: " << filename << Log::endl;
+                    return false;
+                }
+
+                objLoader.getIndexedMesh(mesh.vertices, mesh.uvs, mesh.normals, mesh.indices);
+
+                if (hasSource && Loader::Binary::write(cacheFilepath, mesh.vertices, mesh.uvs, mesh.normals, mesh.indices, false, source))
+                    binaryFilepath = cacheFilepath;
+                else
+                    Log::get() << Log::MESSAGE << "Mesh::" << __FUNCTION__ << " - Unable to write the mesh cache file " << cacheFilepath << Log::endl;
+            }
+        }
 
         lock_guard<shared_timed_mutex> lock(_writeMutex);
-        _mesh = mesh;
+        lock_guard<Spinlock> lockRead(_readMutex);
+        _mesh = make_shared<MeshContainer>(std::move(mesh));
+        _updatedRangesValid = false;
         updateTimestamp();
+        _binaryFilepath = binaryFilepath;
+        _binaryFileTimestamp = _timestamp;
     }
 
     return true;
@@ -134,131 +399,337 @@ bool Mesh::read(const string& filename)
 /*************/
 shared_ptr<SerializedObject> Mesh::serialize() const
 {
+    static_assert(sizeof(glm::vec4) == 4 * sizeof(float) && sizeof(glm::vec3) == 3 * sizeof(float) && sizeof(glm::vec2) == 2 * sizeof(float), "Mesh serialization expects tightly packed vectors");
+
     auto obj = make_shared<SerializedObject>();
 
     if (Timer::get().isDebug())
         Timer::get() << "serialize " + _name;
 
-    // For this, we will use the getVertex, getUV, etc. methods to create a serialized representation of the mesh
-    vector<vector<float>> data;
-    data.push_back(getVertCoords());
-    data.push_back(getUVCoords());
-    data.push_back(getNormals());
-    data.push_back(getAnnexe());
-
     lock_guard<Spinlock> lock(_readMutex);
-    int nbrVertices = data[0].size() / 4;
-    int totalSize = sizeof(nbrVertices); // We add to all this the total number of vertices
-    for (auto& d : data)
-        totalSize += d.size() * sizeof(d[0]);
-    obj->resize(totalSize);
 
-    auto currentObjPtr = obj->data();
-    const char* ptr = reinterpret_cast<const char*>(&nbrVertices);
-    copy(ptr, ptr + sizeof(nbrVertices), currentObjPtr);
-    currentObjPtr += sizeof(nbrVertices);
+    // If the mesh is the one from a binary mesh file, Scenes load it from the disk
+    // and only the path is sent. Layout: -1, path length, then the path
+    if (!_binaryFilepath.empty() && _timestamp == _binaryFileTimestamp)
+    {
+        _keyframeId = 0;
+        _serializedTimestamp = -1;
+
+        int marker = -1;
+        int pathLength = _binaryFilepath.size();
+        obj->resize(2 * sizeof(int) + pathLength);
+        memcpy(obj->data(), &marker, sizeof(marker));
+        memcpy(obj->data() + sizeof(marker), &pathLength, sizeof(pathLength));
+        memcpy(obj->data() + 2 * sizeof(int), _binaryFilepath.data(), pathLength);
+
+        if (Timer::get().isDebug())
+            Timer::get() >> ("serialize " + _name);
+
+        return obj;
+    }
 
-    for (auto& d : data)
+    if (_mesh->uvs.size() != _mesh->vertices.size() || _mesh->normals.size() != _mesh->vertices.size())
     {
-        ptr = reinterpret_cast<const char*>(d.data());
-        copy(ptr, ptr + d.size() * sizeof(float), currentObjPtr);
-        currentObjPtr += d.size() * sizeof(float);
+        Log::get() << Log::WARNING << "Mesh::" << __FUNCTION__ << " - Mesh attributes have inconsistent sizes, it can not be serialized" << Log::endl;
+        return obj;
     }
 
+    // If only some vertices changed since the last serialization, send the ones modified since the last keyframe.
+    // A new keyframe is sent when these get too numerous, and regularly in case one was not received
+    const int maxPartialUpdatesPerKeyframe = 60;
+    bool isNextVersion = _updatedRangesValid && _timestamp == _meshTimestamp && _updatedRangesBase == _serializedTimestamp;
+    if (_sendPartialUpdates && _keyframeId != 0 && isNextVersion && _mesh->annexe.empty() && _partialUpdatesSinceKeyframe < maxPartialUpdatesPerKeyframe)
+    {
+        auto ranges = _keyframeRanges;
+        mergeRanges(ranges, _updatedRanges);
+
+        size_t modifiedVertices = 0;
+        for (const auto& range : ranges)
+            modifiedVertices += range.count;
+
+        if (modifiedVertices <= _mesh->vertices.size() / 2)
+        {
+            _keyframeRanges = std::move(ranges);
+            ++_partialUpdatesSinceKeyframe;
+            _serializedTimestamp = _meshTimestamp;
+            obj = serializeRanges(_keyframeRanges);
+
+            if (Timer::get().isDebug())
+                Timer::get() >> ("serialize " + _name);
+
+            return obj;
+        }
+    }
+
+    _keyframeId = std::max<uint32_t>(_keyframeId + 1, 1);
+    _keyframeRanges.clear();
+    _partialUpdatesSinceKeyframe = 0;
+    _serializedTimestamp = (_timestamp == _meshTimestamp) ? _meshTimestamp : -1;
+
+    // Layout: vertex count, index count, keyframe id, then vertices (vec4), uvs (vec2), normals (vec3), annexe (vec4, if any) and indices (uint32)
+    int nbrVertices = _mesh->vertices.size();
+    int nbrIndices = _mesh->indices.size();
+    bool hasAnnexe = (_mesh->annexe.size() == _mesh->vertices.size() && nbrVertices != 0);
+
+    size_t totalSize = 2 * sizeof(int) + sizeof(_keyframeId) + nbrVertices * (4 + 2 + 3) * sizeof(float) + nbrIndices * sizeof(uint32_t);
+    if (hasAnnexe)
+        totalSize += nbrVertices * 4 * sizeof(float);
+    obj->resize(totalSize);
+
+    auto currentObjPtr = obj->data();
+    auto write = [&](const void* data, size_t size) {
+        memcpy(currentObjPtr, data, size);
+        currentObjPtr += size;
+    };
+
+    write(&nbrVertices, sizeof(nbrVertices));
+    write(&nbrIndices, sizeof(nbrIndices));
+    write(&_keyframeId, sizeof(_keyframeId));
+    write(_mesh->vertices.data(), nbrVertices * sizeof(glm::vec4));
+    write(_mesh->uvs.data(), nbrVertices * sizeof(glm::vec2));
+    write(_mesh->normals.data(), nbrVertices * sizeof(glm::vec3));
+    if (hasAnnexe)
+        write(_mesh->annexe.data(), nbrVertices * sizeof(glm::vec4));
+    write(_mesh->indices.data(), nbrIndices * sizeof(uint32_t));
+
     if (Timer::get().isDebug())
         Timer::get() >> ("serialize " + _name);
 
     return obj;
 }
 
+/*************/
+shared_ptr<SerializedObject> Mesh::serializeRanges(const vector<VertexRange>& ranges) const
+{
+    // Layout: -2, vertex count, keyframe id, flags, range count, ranges (first, count), bounds if quantized,
+    // then for each vertex in the ranges its position (vec4), uv (vec2) and normal (vec3), or their quantized values
+    // (three uint16 for the position, two uint16 for the uv, three int16 for the normal)
+    auto obj = make_shared<SerializedObject>();
+
+    int marker = -2;
+    int nbrVertices = _mesh->vertices.size();
+    uint32_t flags = _quantizePartialUpdates ? partialUpdateQuantized : 0;
+    uint32_t rangeCount = ranges.size();
+
+    size_t vertexCount = 0;
+    for (const auto& range : ranges)
+        vertexCount += range.count;
+
+    glm::vec3 boundsMin{0.f}, boundsMax{0.f};
+    glm::vec2 uvBoundsMin{0.f}, uvBoundsMax{0.f};
+    if (_quantizePartialUpdates && vertexCount != 0)
+    {
+        boundsMin = boundsMax = glm::vec3(_mesh->vertices[ranges[0].first]);
+        uvBoundsMin = uvBoundsMax = _mesh->uvs[ranges[0].first];
+        for (const auto& range : ranges)
+        {
+            for (uint32_t i = range.first; i < range.first + range.count; ++i)
+            {
+                boundsMin = glm::min(boundsMin, glm::vec3(_mesh->vertices[i]));
+                boundsMax = glm::max(boundsMax, glm::vec3(_mesh->vertices[i]));
+                uvBoundsMin = glm::min(uvBoundsMin, _mesh->uvs[i]);
+                uvBoundsMax = glm::max(uvBoundsMax, _mesh->uvs[i]);
+            }
+        }
+    }
+
+    size_t headerSize = 2 * sizeof(int) + sizeof(_keyframeId) + sizeof(flags) + sizeof(rangeCount) + rangeCount * 2 * sizeof(uint32_t);
+    if (_quantizePartialUpdates)
+        headerSize += (3 + 3 + 2 + 2) * sizeof(float);
+    size_t vertexSize = _quantizePartialUpdates ? 8 * sizeof(uint16_t) : (4 + 2 + 3) * sizeof(float);
+    obj->resize(headerSize + vertexCount * vertexSize);
+
+    auto currentObjPtr = obj->data();
+    auto write = [&](const void* data, size_t size) {
+        memcpy(currentObjPtr, data, size);
+        currentObjPtr += size;
+    };
+
+    write(&marker, sizeof(marker));
+    write(&nbrVertices, sizeof(nbrVertices));
+    write(&_keyframeId, sizeof(_keyframeId));
+    write(&flags, sizeof(flags));
+    write(&rangeCount, sizeof(rangeCount));
+    for (const auto& range : ranges)
+    {
+        write(&range.first, sizeof(range.first));
+        write(&range.count, sizeof(range.count));
+    }
+
+    if (_quantizePartialUpdates)
+    {
+        write(&boundsMin, sizeof(boundsMin));
+        write(&boundsMax, sizeof(boundsMax));
+        write(&uvBoundsMin, sizeof(uvBoundsMin));
+        write(&uvBoundsMax, sizeof(uvBoundsMax));
+
+        // A flat dimension is quantized to 0
+        auto quantize = [](float value, float min, float max) -> uint16_t {
+            if (max <= min)
+                return 0;
+            return static_cast<uint16_t>(std::round(glm::clamp((value - min) / (max - min), 0.f, 1.f) * 65535.f));
+        };
+        auto quantizeNormal = [](float value) -> int16_t { return static_cast<int16_t>(std::round(glm::clamp(value, -1.f, 1.f) * 32767.f)); };
+
+        for (const auto& range : ranges)
+        {
+            for (uint32_t i = range.first; i < range.first + range.count; ++i)
+            {
+                const auto& v = _mesh->vertices[i];
+                const auto& u = _mesh->uvs[i];
+                const auto& n = _mesh->normals[i];
+                uint16_t values[5] = {quantize(v[0], boundsMin[0], boundsMax[0]),
+                    quantize(v[1], boundsMin[1], boundsMax[1]),
+                    quantize(v[2], boundsMin[2], boundsMax[2]),
+                    quantize(u[0], uvBoundsMin[0], uvBoundsMax[0]),
+                    quantize(u[1], uvBoundsMin[1], uvBoundsMax[1])};
+                int16_t normal[3] = {quantizeNormal(n[0]), quantizeNormal(n[1]), quantizeNormal(n[2])};
+                write(values, sizeof(values));
+                write(normal, sizeof(normal));
+            }
+        }
+    }
+    else
+    {
+        for (const auto& range : ranges)
+        {
+            for (uint32_t i = range.first; i < range.first + range.count; ++i)
+            {
+                write(&_mesh->vertices[i], sizeof(glm::vec4));
+                write(&_mesh->uvs[i], sizeof(glm::vec2));
+                write(&_mesh->normals[i], sizeof(glm::vec3));
+            }
+        }
+    }
+
+    return obj;
+}
+
 /*************/
 bool Mesh::deserialize(const shared_ptr<SerializedObject>& obj)
 {
-    if (obj.get() == nullptr || obj->size() == 0)
+    if (obj.get() == nullptr || obj->size() < 2 * sizeof(int))
         return false;
 
     if (Timer::get().isDebug())
         Timer::get() << "deserialize " + _name;
 
-    // First, we get the number of vertices
+    // First, we get the number of vertices and indices
     int nbrVertices;
-    char* ptr = reinterpret_cast<char*>(&nbrVertices);
-
+    int nbrIndices;
     auto currentObjPtr = obj->data();
-    copy(currentObjPtr, currentObjPtr + sizeof(nbrVertices), ptr); // This will fail if float have different size between sender and receiver
+    memcpy(&nbrVertices, currentObjPtr, sizeof(nbrVertices)); // This will fail if float have different size between sender and receiver
     currentObjPtr += sizeof(nbrVertices);
+    memcpy(&nbrIndices, currentObjPtr, sizeof(nbrIndices));
+    currentObjPtr += sizeof(nbrIndices);
 
-    if (nbrVertices < 0 || nbrVertices > static_cast<int>(obj->size()))
+    // The World only sent the path to a binary mesh file
+    if (nbrVertices == -1)
+    {
+        if (nbrIndices < 0 || obj->size() != 2 * sizeof(int) + static_cast<size_t>(nbrIndices))
+        {
+            Log::get() << Log::WARNING << "Mesh::" << __FUNCTION__ << " - Bad buffer received, discarding" << Log::endl;
+            return false;
+        }
+
+        auto filepath = string(currentObjPtr, currentObjPtr + nbrIndices);
+        Loader::Binary binaryLoader;
+        if (!binaryLoader.load(filepath))
+        {
+            // The file is not reachable from this Scene, ask the World for the full mesh
+            Log::get() << Log::WARNING << "Mesh::" << __FUNCTION__ << " - Unable to read the mesh file " << filepath << ", requesting the full mesh" << Log::endl;
+            auto scene = dynamic_cast<Scene*>(_root);
+            if (scene)
+                scene->sendMessageToWorld("sendAll", {_name, "sendFullMesh"});
+            return false;
+        }
+
+        MeshContainer mesh;
+        binaryLoader.getIndexedMesh(mesh.vertices, mesh.uvs, mesh.normals, mesh.indices);
+
+        lock_guard<shared_timed_mutex> lock(_writeMutex);
+        _bufferMesh = make_shared<MeshContainer>(std::move(mesh));
+        _keyframeId = 0;
+        setBufferMeshUpdated();
+
+        if (Timer::get().isDebug())
+            Timer::get() >> ("deserialize " + _name);
+
+        return true;
+    }
+
+    // Only some vertices were sent
+    if (nbrVertices == -2)
+    {
+        auto result = deserializeRanges(currentObjPtr, obj->size() - 2 * sizeof(int), nbrIndices);
+
+        if (Timer::get().isDebug())
+            Timer::get() >> ("deserialize " + _name);
+
+        return result;
+    }
+
+    uint32_t keyframeId;
+    if (obj->size() < 2 * sizeof(int) + sizeof(keyframeId))
     {
         Log::get() << Log::WARNING << "Mesh::" << __FUNCTION__ << " - Bad buffer received, discarding" << Log::endl;
         return false;
     }
+    memcpy(&keyframeId, currentObjPtr, sizeof(keyframeId));
+    currentObjPtr += sizeof(keyframeId);
 
-    vector<vector<float>> data;
-    data.push_back(vector<float>(nbrVertices * 4));
-    data.push_back(vector<float>(nbrVertices * 2));
-    data.push_back(vector<float>(nbrVertices * 4));
+    // Check whether there is an annexe buffer in all this
+    uint64_t sizeWithoutAnnexe = 2 * sizeof(int) + sizeof(keyframeId) + static_cast<uint64_t>(nbrVertices) * (4 + 2 + 3) * sizeof(float) + static_cast<uint64_t>(nbrIndices) * sizeof(uint32_t);
+    uint64_t annexeSize = static_cast<uint64_t>(nbrVertices) * 4 * sizeof(float);
+    bool hasAnnexe = (obj->size() == sizeWithoutAnnexe + annexeSize);
 
-    bool hasAnnexe = false;
-    if (obj->size() > static_cast<uint32_t>(nbrVertices) * 4 * 14) // Check whether there is an annexe buffer in all this
+    if (nbrVertices < 0 || nbrIndices < 0 || nbrIndices % 3 != 0 || (obj->size() != sizeWithoutAnnexe && !hasAnnexe))
     {
-        hasAnnexe = true;
-        data.push_back(vector<float>(nbrVertices * 4));
+        Log::get() << Log::WARNING << "Mesh::" << __FUNCTION__ << " - Bad buffer received, discarding" << Log::endl;
+        return false;
     }
 
     // Let's read the values
     try
     {
-        for (auto& d : data)
-        {
-            ptr = reinterpret_cast<char*>(d.data());
-            copy(currentObjPtr, currentObjPtr + d.size() * sizeof(float), ptr);
-            currentObjPtr += d.size() * sizeof(float);
-        }
-
-        // Next step: use these values to reset the vertices of _mesh
         MeshContainer mesh;
 
         mesh.vertices.resize(nbrVertices);
-        for (int i = 0; i < nbrVertices; ++i)
-        {
-            mesh.vertices[i][0] = data[0][i * 4 + 0];
-            mesh.vertices[i][1] = data[0][i * 4 + 1];
-            mesh.vertices[i][2] = data[0][i * 4 + 2];
-            mesh.vertices[i][3] = data[0][i * 4 + 3];
-        }
+        memcpy(mesh.vertices.data(), currentObjPtr, nbrVertices * sizeof(glm::vec4));
+        currentObjPtr += nbrVertices * sizeof(glm::vec4);
 
         mesh.uvs.resize(nbrVertices);
-        for (int i = 0; i < nbrVertices; ++i)
-        {
-            mesh.uvs[i][0] = data[1][i * 2 + 0];
-            mesh.uvs[i][1] = data[1][i * 2 + 1];
-        }
+        memcpy(mesh.uvs.data(), currentObjPtr, nbrVertices * sizeof(glm::vec2));
+        currentObjPtr += nbrVertices * sizeof(glm::vec2);
 
         mesh.normals.resize(nbrVertices);
-        for (int i = 0; i < nbrVertices; ++i)
-        {
-            mesh.normals[i][0] = data[2][i * 4 + 0];
-            mesh.normals[i][1] = data[2][i * 4 + 1];
-            mesh.normals[i][2] = data[2][i * 4 + 2];
-        }
+        memcpy(mesh.normals.data(), currentObjPtr, nbrVertices * sizeof(glm::vec3));
+        currentObjPtr += nbrVertices * sizeof(glm::vec3);
 
         if (hasAnnexe)
         {
             mesh.annexe.resize(nbrVertices);
-            for (int i = 0; i < nbrVertices; ++i)
+            memcpy(mesh.annexe.data(), currentObjPtr, nbrVertices * sizeof(glm::vec4));
+            currentObjPtr += nbrVertices * sizeof(glm::vec4);
+        }
+
+        mesh.indices.resize(nbrIndices);
+        memcpy(mesh.indices.data(), currentObjPtr, nbrIndices * sizeof(uint32_t));
+
+        // Indices end up in a GPU buffer, where out of range values are not caught
+        for (auto index : mesh.indices)
+        {
+            if (index >= static_cast<uint32_t>(nbrVertices))
             {
-                mesh.annexe[i][0] = data[3][i * 4 + 0];
-                mesh.annexe[i][1] = data[3][i * 4 + 1];
-                mesh.annexe[i][2] = data[3][i * 4 + 2];
-                mesh.annexe[i][3] = data[3][i * 4 + 3];
+                Log::get() << Log::WARNING << "Mesh::" << __FUNCTION__ << " - Received indices are out of range, discarding" << Log::endl;
+                return false;
             }
         }
 
-        _bufferMesh = mesh;
-        _meshUpdated = true;
-
-        updateTimestamp();
+        lock_guard<shared_timed_mutex> lock(_writeMutex);
+        _bufferMesh = make_shared<MeshContainer>(std::move(mesh));
+        _keyframeId = keyframeId;
+        setBufferMeshUpdated();
     }
     catch (...)
     {
@@ -273,15 +744,139 @@ bool Mesh::deserialize(const shared_ptr<SerializedObject>& obj)
     return true;
 }
 
+/*************/
+bool Mesh::deserializeRanges(const char* data, size_t size, int nbrVertices)
+{
+    auto currentObjPtr = data;
+    auto read = [&](void* dst, size_t dstSize) {
+        if (static_cast<size_t>(currentObjPtr - data) + dstSize > size)
+            return false;
+        memcpy(dst, currentObjPtr, dstSize);
+        currentObjPtr += dstSize;
+        return true;
+    };
+
+    uint32_t keyframeId;
+    uint32_t flags;
+    uint32_t rangeCount;
+    if (!read(&keyframeId, sizeof(keyframeId)) || !read(&flags, sizeof(flags)) || !read(&rangeCount, sizeof(rangeCount)))
+    {
+        Log::get() << Log::WARNING << "Mesh::" << __FUNCTION__ << " - Bad buffer received, discarding" << Log::endl;
+        return false;
+    }
+
+    if (nbrVertices < 0 || static_cast<uint64_t>(rangeCount) * 2 * sizeof(uint32_t) > size)
+    {
+        Log::get() << Log::WARNING << "Mesh::" << __FUNCTION__ << " - Bad buffer received, discarding" << Log::endl;
+        return false;
+    }
+
+    vector<VertexRange> ranges(rangeCount);
+    uint64_t vertexCount = 0;
+    uint32_t rangeEnd = 0;
+    for (auto& range : ranges)
+    {
+        read(&range.first, sizeof(range.first));
+        read(&range.count, sizeof(range.count));
+        // Ranges must be sorted and within the mesh
+        if (range.first < rangeEnd || static_cast<uint64_t>(range.first) + range.count > static_cast<uint64_t>(nbrVertices))
+        {
+            Log::get() << Log::WARNING << "Mesh::" << __FUNCTION__ << " - Received ranges are out of the mesh, discarding" << Log::endl;
+            return false;
+        }
+        rangeEnd = range.first + range.count;
+        vertexCount += range.count;
+    }
+
+    bool quantized = flags & partialUpdateQuantized;
+    glm::vec3 boundsMin, boundsMax;
+    glm::vec2 uvBoundsMin, uvBoundsMax;
+    if (quantized && !(read(&boundsMin, sizeof(boundsMin)) && read(&boundsMax, sizeof(boundsMax)) && read(&uvBoundsMin, sizeof(uvBoundsMin)) && read(&uvBoundsMax, sizeof(uvBoundsMax))))
+    {
+        Log::get() << Log::WARNING << "Mesh::" << __FUNCTION__ << " - Bad buffer received, discarding" << Log::endl;
+        return false;
+    }
+
+    size_t vertexSize = quantized ? 8 * sizeof(uint16_t) : (4 + 2 + 3) * sizeof(float);
+    if (static_cast<size_t>(currentObjPtr - data) + vertexCount * vertexSize != size)
+    {
+        Log::get() << Log::WARNING << "Mesh::" << __FUNCTION__ << " - Bad buffer received, discarding" << Log::endl;
+        return false;
+    }
+
+    lock_guard<shared_timed_mutex> lock(_writeMutex);
+
+    // Ranges are relative to a keyframe: if it was not received, wait for the next one
+    if (keyframeId != _keyframeId || _bufferMesh->vertices.size() != static_cast<size_t>(nbrVertices))
+        return false;
+
+    // The ranges are applied in place, so the container must not be shared with _mesh
+    if (_bufferMesh.use_count() > 1)
+        _bufferMesh = make_shared<MeshContainer>(*_bufferMesh);
+
+    if (quantized)
+    {
+        auto dequantize = [](uint16_t value, float min, float max) { return min + static_cast<float>(value) / 65535.f * (max - min); };
+        for (const auto& range : ranges)
+        {
+            for (uint32_t i = range.first; i < range.first + range.count; ++i)
+            {
+                uint16_t values[5];
+                int16_t normal[3];
+                read(values, sizeof(values));
+                read(normal, sizeof(normal));
+                _bufferMesh->vertices[i] = glm::vec4(dequantize(values[0], boundsMin[0], boundsMax[0]),
+                    dequantize(values[1], boundsMin[1], boundsMax[1]),
+                    dequantize(values[2], boundsMin[2], boundsMax[2]),
+                    1.f);
+                _bufferMesh->uvs[i] = glm::vec2(dequantize(values[3], uvBoundsMin[0], uvBoundsMax[0]), dequantize(values[4], uvBoundsMin[1], uvBoundsMax[1]));
+                _bufferMesh->normals[i] = glm::vec3(std::max(normal[0] / 32767.f, -1.f), std::max(normal[1] / 32767.f, -1.f), std::max(normal[2] / 32767.f, -1.f));
+            }
+        }
+    }
+    else
+    {
+        for (const auto& range : ranges)
+        {
+            for (uint32_t i = range.first; i < range.first + range.count; ++i)
+            {
+                read(&_bufferMesh->vertices[i], sizeof(glm::vec4));
+                read(&_bufferMesh->uvs[i], sizeof(glm::vec2));
+                read(&_bufferMesh->normals[i], sizeof(glm::vec3));
+            }
+        }
+    }
+
+    setBufferMeshUpdated(&ranges);
+    return true;
+}
+
 /*************/
 void Mesh::update()
 {
     if (_meshUpdated)
     {
-        lock_guard<Spinlock> lock(_readMutex);
-        shared_lock<shared_timed_mutex> lockWrite(_writeMutex);
-        _mesh = _bufferMesh;
-        _meshUpdated = false;
+        shared_ptr<MeshContainer> mesh;
+        {
+            lock_guard<Spinlock> lock(_readMutex);
+            shared_lock<shared_timed_mutex> lockWrite(_writeMutex);
+            // Both now share the same container, which producers replace or copy before modifying it
+            _mesh = _bufferMesh;
+            _meshUpdated = false;
+
+            _updatedRanges = _bufferUpdatedRanges;
+            _updatedRangesValid = _bufferRangesValid;
+            _updatedRangesBase = _meshTimestamp;
+            _meshTimestamp = _timestamp;
+            _bufferRangesValid = false;
+
+            mesh = _mesh;
+        }
+
+        // Once the mesh has been picked, its BVH is kept up to date
+        lock_guard<mutex> lockBvh(_bvhMutex);
+        if (_bvhRequested)
+            buildBvh(mesh);
     }
     else if (_benchmark)
         updateTimestamp();
@@ -296,9 +891,6 @@ void Mesh::createDefaultMesh(int subdiv)
 
     MeshContainer mesh;
 
-    vector<glm::vec2> positions;
-    vector<glm::vec2> uvs;
-
     for (int v = 0; v < subdiv + 2; ++v)
     {
         glm::vec2 position;
@@ -312,8 +904,9 @@ void Mesh::createDefaultMesh(int subdiv)
             uv.x = (float)u / ((float)(subdiv + 1));
             position.x = uv.x * 2.f - 1.f;
 
-            positions.push_back(position);
-            uvs.push_back(uv);
+            mesh.vertices.push_back(glm::vec4(position, 0.0, 1.0));
+            mesh.uvs.push_back(uv);
+            mesh.normals.push_back(glm::vec3(0.0, 0.0, 1.0));
         }
     }
 
@@ -321,33 +914,20 @@ void Mesh::createDefaultMesh(int subdiv)
     {
         for (int u = 0; u < subdiv + 1; ++u)
         {
-            mesh.vertices.push_back(glm::vec4(positions[u + v * (subdiv + 2)], 0.0, 1.0));
-            mesh.vertices.push_back(glm::vec4(positions[u + 1 + v * (subdiv + 2)], 0.0, 1.0));
-            mesh.vertices.push_back(glm::vec4(positions[u + (v + 1) * (subdiv + 2)], 0.0, 1.0));
-
-            mesh.vertices.push_back(glm::vec4(positions[u + 1 + v * (subdiv + 2)], 0.0, 1.0));
-            mesh.vertices.push_back(glm::vec4(positions[u + 1 + (v + 1) * (subdiv + 2)], 0.0, 1.0));
-            mesh.vertices.push_back(glm::vec4(positions[u + (v + 1) * (subdiv + 2)], 0.0, 1.0));
-
-            mesh.uvs.push_back(uvs[u + v * (subdiv + 2)]);
-            mesh.uvs.push_back(uvs[u + 1 + v * (subdiv + 2)]);
-            mesh.uvs.push_back(uvs[u + (v + 1) * (subdiv + 2)]);
+            mesh.indices.push_back(u + v * (subdiv + 2));
+            mesh.indices.push_back(u + 1 + v * (subdiv + 2));
+            mesh.indices.push_back(u + (v + 1) * (subdiv + 2));
 
-            mesh.uvs.push_back(uvs[u + 1 + v * (subdiv + 2)]);
-            mesh.uvs.push_back(uvs[u + 1 + (v + 1) * (subdiv + 2)]);
-            mesh.uvs.push_back(uvs[u + (v + 1) * (subdiv + 2)]);
-
-            mesh.normals.push_back(glm::vec3(0.0, 0.0, 1.0));
-            mesh.normals.push_back(glm::vec3(0.0, 0.0, 1.0));
-            mesh.normals.push_back(glm::vec3(0.0, 0.0, 1.0));
-            mesh.normals.push_back(glm::vec3(0.0, 0.0, 1.0));
-            mesh.normals.push_back(glm::vec3(0.0, 0.0, 1.0));
-            mesh.normals.push_back(glm::vec3(0.0, 0.0, 1.0));
+            mesh.indices.push_back(u + 1 + v * (subdiv + 2));
+            mesh.indices.push_back(u + 1 + (v + 1) * (subdiv + 2));
+            mesh.indices.push_back(u + (v + 1) * (subdiv + 2));
         }
     }
 
     lock_guard<shared_timed_mutex> lock(_writeMutex);
-    _mesh = std::move(mesh);
+    lock_guard<Spinlock> lockRead(_readMutex);
+    _mesh = make_shared<MeshContainer>(std::move(mesh));
+    _updatedRangesValid = false;
 
     updateTimestamp();
 }
@@ -376,6 +956,18 @@ void Mesh::registerAttributes()
         },
         {'n'});
     setAttributeDescription("benchmark", "Set to 1 to resend the image even when not updated");
+
+    addAttribute("sendFullMesh", [&](const Values&) {
+        lock_guard<Spinlock> lock(_readMutex);
+        if (_binaryFilepath.empty())
+            return true;
+
+        // A Scene could not load the binary mesh file, stop sending its path
+        _binaryFilepath.clear();
+        updateTimestamp();
+        return true;
+    });
+    setAttributeDescription("sendFullMesh", "Send the whole mesh to the Scenes instead of the path to its binary file");
 }
 
 } // end of namespace
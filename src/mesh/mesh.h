@@ -26,6 +26,7 @@
 #define SPLASH_MESH_H
 
 #include <chrono>
+#include <future>
 #include <glm/glm.hpp>
 #include <memory>
 #include <mutex>
@@ -36,6 +37,7 @@
 #include "./core/attribute.h"
 #include "./core/buffer_object.h"
 #include "./core/coretypes.h"
+#include "./mesh/bvh.h"
 
 namespace Splash
 {
@@ -43,6 +45,12 @@ namespace Splash
 class Mesh : public BufferObject
 {
   public:
+    struct VertexRange
+    {
+        uint32_t first{0};
+        uint32_t count{0};
+    };
+
     /**
      * \brief Constructor
      * \param root Root object
@@ -69,7 +77,7 @@ class Mesh : public BufferObject
     bool operator==(Mesh& otherMesh) const;
 
     /**
-     * \brief Get a 1D vector of all points of the mesh, in normalized coordinates
+     * \brief Get a 1D vector of all points of the mesh, in normalized coordinates. Points are shared between triangles, see getIndices()
      * \return Return a vector representing all points of the mesh
      */
     virtual std::vector<float> getVertCoords() const;
@@ -92,6 +100,47 @@ class Mesh : public BufferObject
      */
     virtual std::vector<float> getAnnexe() const;
 
+    /**
+     * \brief Get the triangles of the mesh, as three indices into the points per triangle
+     * \return Return a vector of indices
+     */
+    virtual std::vector<uint32_t> getIndices() const;
+
+    /**
+     * \brief Get the vertices modified since a given version of the mesh, if the topology did not change
+     * \param timestamp Timestamp of the version of the mesh to compare to
+     * \param ranges Modified vertex ranges, sorted and not overlapping
+     * \return Return false if the whole mesh has to be considered as modified
+     */
+    bool getUpdatedRanges(int64_t timestamp, std::vector<VertexRange>& ranges) const;
+
+    /**
+     * \brief Get the attributes for a range of vertices, in the same layout as getVertCoords(), getUVCoords() and getNormals()
+     * \param range Vertex range
+     * \param vertices Vertices of the range
+     * \param uvs UV coordinates of the range
+     * \param normals Normals of the range
+     */
+    void getVertexRange(const VertexRange& range, std::vector<float>& vertices, std::vector<float>& uvs, std::vector<float>& normals) const;
+
+    /**
+     * \brief Get the vertex closest to a point. The first call starts maintaining a BVH of the mesh,
+     * built in a separate thread when the mesh changes. Until it is available, all the vertices are tested
+     * \param point Point, in object space
+     * \param vertex Closest vertex
+     * \return Return the distance to the closest vertex, or the maximum float value if the mesh is empty
+     */
+    float pickVertex(const glm::dvec3& point, glm::dvec3& vertex);
+
+    /**
+     * \brief Get the first point of the mesh hit by a ray, using the same BVH as pickVertex()
+     * \param origin Ray origin, in object space
+     * \param direction Ray direction, in object space
+     * \param hit Point hit by the ray
+     * \return Return the ray parameter at the hit point, in direction units, or the maximum float value if the mesh is not hit
+     */
+    float pickRay(const glm::dvec3& origin, const glm::dvec3& direction, glm::dvec3& hit);
+
     /**
      * \brief Read / update the mesh
      * \param filename File to load from
@@ -118,34 +167,115 @@ class Mesh : public BufferObject
     virtual void update();
 
   protected:
+    // Indexed triangle list. Vertex attributes are stored once per unique vertex, and triangles refer to them through indices
     struct MeshContainer
     {
         std::vector<glm::vec4> vertices;
         std::vector<glm::vec2> uvs;
         std::vector<glm::vec3> normals;
         std::vector<glm::vec4> annexe;
+        std::vector<uint32_t> indices;
     };
 
     std::string _filepath{};
-    MeshContainer _mesh;
-    MeshContainer _bufferMesh;
+    std::string _binaryFilepath{};     //!< Binary mesh file the mesh has been loaded from, or converted to
+    int64_t _binaryFileTimestamp{0};   //!< Timestamp of the mesh when loaded from _binaryFilepath
+    // Containers are shared between _bufferMesh and _mesh once updated, and are never modified while shared
+    std::shared_ptr<MeshContainer> _mesh{std::make_shared<MeshContainer>()};
+    std::shared_ptr<MeshContainer> _bufferMesh{std::make_shared<MeshContainer>()};
     bool _meshUpdated{false};
+
+    // Partial updates, for meshes whose vertices are modified but not their topology
+    std::vector<VertexRange> _bufferUpdatedRanges{}; //!< Vertices of _bufferMesh modified since it was last copied to _mesh
+    bool _bufferRangesValid{false};                  //!< True if _bufferUpdatedRanges holds all the modifications of _bufferMesh
+    std::vector<VertexRange> _updatedRanges{};       //!< Vertices modified by the last copy of _bufferMesh to _mesh
+    bool _updatedRangesValid{false};                 //!< True if _updatedRanges holds all the modifications
+    int64_t _updatedRangesBase{-1};                  //!< Timestamp of the version of _mesh _updatedRanges is relative to
+    int64_t _meshTimestamp{-1};                      //!< Timestamp of the version of _bufferMesh last copied to _mesh
+
+    // Partial updates sent to the Scenes. A full mesh is sent as a keyframe, then only the vertices modified
+    // since this keyframe are sent, so that Scenes missing a partial update still end up with the right mesh
+    bool _sendPartialUpdates{true};
+    bool _quantizePartialUpdates{false};
+    mutable uint32_t _keyframeId{0};                    //!< Id of the last keyframe sent, or received
+    mutable std::vector<VertexRange> _keyframeRanges{}; //!< Vertices modified since the last keyframe
+    mutable int _partialUpdatesSinceKeyframe{0};
+    mutable int64_t _serializedTimestamp{-1}; //!< Version of the mesh last serialized
     bool _benchmark{false};
     int _planeSubdivisions{0};
 
+    // Spatial index used for picking
+    std::mutex _bvhMutex{};
+    std::shared_ptr<const Bvh> _bvh{nullptr};
+    std::weak_ptr<MeshContainer> _bvhMesh{}; //!< Container the BVH has been built from
+    bool _bvhRequested{false};               //!< Set once the mesh has been picked, the BVH is then rebuilt when the mesh changes
+    std::future<void> _bvhFuture{};
+
     /**
      * \brief Register new functors to modify attributes
      */
     void registerAttributes();
 
+    /**
+     * \brief Compute the vertex ranges which differ between two meshes with the same vertex count
+     * \param from Previous mesh
+     * \param to New mesh
+     * \return Return the modified ranges
+     */
+    static std::vector<VertexRange> computeUpdatedRanges(const MeshContainer& from, const MeshContainer& to);
+
+    /**
+     * \brief Merge vertex ranges into another set of ranges
+     * \param ranges Ranges to merge into, sorted and not overlapping
+     * \param other Ranges to merge, sorted and not overlapping
+     */
+    static void mergeRanges(std::vector<VertexRange>& ranges, const std::vector<VertexRange>& other);
+
+    /**
+     * \brief Signal that _bufferMesh has been updated. Must be called with the write mutex locked
+     * \param ranges If not null, vertices modified since the previous _bufferMesh, which has the same topology
+     */
+    void setBufferMeshUpdated(const std::vector<VertexRange>* ranges = nullptr);
+
   private:
+    static const uint32_t partialUpdateQuantized{1}; //!< Flag set in partial updates with quantized attributes
+
     void init();
 
+    /**
+     * \brief Get the BVH of the given container, starting its build in a separate thread if it is not available
+     * \param mesh Mesh container
+     * \return Return the BVH, or nullptr if it is not built yet
+     */
+    std::shared_ptr<const Bvh> getBvh(const std::shared_ptr<MeshContainer>& mesh);
+
+    /**
+     * \brief Build the BVH of the given container in a separate thread, if no build is running. Must be called with _bvhMutex locked
+     * \param mesh Mesh container
+     */
+    void buildBvh(const std::shared_ptr<MeshContainer>& mesh);
+
     /**
      * \brief Create a plane mesh, subdivided according to the parameter
      * \param subdiv Number of subdivision for the plane
      */
     void createDefaultMesh(int subdiv = 0);
+
+    /**
+     * \brief Serialize the given vertex ranges of the mesh
+     * \param ranges Vertex ranges
+     * \return Return a serialized object
+     */
+    std::shared_ptr<SerializedObject> serializeRanges(const std::vector<VertexRange>& ranges) const;
+
+    /**
+     * \brief Apply serialized vertex ranges to the mesh
+     * \param data Serialized ranges, after the vertex count
+     * \param size Size of the serialized ranges
+     * \param nbrVertices Vertex count of the sender mesh
+     * \return Return true if all went well
+     */
+    bool deserializeRanges(const char* data, size_t size, int nbrVertices);
 };
 
 } // end of namespace
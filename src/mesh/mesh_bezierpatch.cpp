@@ -27,13 +27,12 @@ void Mesh_BezierPatch::switchMeshes(bool control)
 {
     lock_guard<mutex> lockPatch(_patchMutex);
 
-    if (control)
-        _bufferMesh = _bezierControl;
-    else
-        _bufferMesh = _bezierMesh;
+    auto mesh = control ? _bezierControl : _bezierMesh;
+    if (!mesh)
+        return;
 
-    updateTimestamp();
-    _meshUpdated = true;
+    _bufferMesh = mesh;
+    setBufferMeshUpdated();
 }
 
 /*************/
@@ -71,7 +70,7 @@ void Mesh_BezierPatch::createPatch(int width, int height)
     height = std::max(2, height);
 
     // Check whether the current patch has the same size
-    if (_bezierControl.vertices.size() != 0 && _patch.size.x == width && _patch.size.y == height)
+    if (_bezierControl && _patch.size.x == width && _patch.size.y == height)
         return;
 
     Patch patch;
@@ -118,35 +117,27 @@ void Mesh_BezierPatch::createPatch(Patch& patch)
     _patchUpdated = true;
 
     MeshContainer mesh;
+    for (int i = 0; i < width * height; ++i)
+    {
+        mesh.vertices.push_back(glm::vec4(patch.vertices[i], 0.0, 1.0));
+        mesh.uvs.push_back(patch.uvs[i]);
+        mesh.normals.push_back(glm::vec3(0.0, 0.0, 1.0));
+    }
+
     for (int v = 0; v < height - 1; ++v)
     {
         for (int u = 0; u < width - 1; ++u)
         {
-            mesh.vertices.push_back(glm::vec4(patch.vertices[u + v * width], 0.0, 1.0));
-            mesh.vertices.push_back(glm::vec4(patch.vertices[u + 1 + v * width], 0.0, 1.0));
-            mesh.vertices.push_back(glm::vec4(patch.vertices[u + (v + 1) * width], 0.0, 1.0));
-
-            mesh.vertices.push_back(glm::vec4(patch.vertices[u + 1 + (v + 1) * width], 0.0, 1.0));
-            mesh.vertices.push_back(glm::vec4(patch.vertices[u + (v + 1) * width], 0.0, 1.0));
-            mesh.vertices.push_back(glm::vec4(patch.vertices[u + 1 + v * width], 0.0, 1.0));
-
-            mesh.uvs.push_back(patch.uvs[u + v * width]);
-            mesh.uvs.push_back(patch.uvs[u + 1 + v * width]);
-            mesh.uvs.push_back(patch.uvs[u + (v + 1) * width]);
-
-            mesh.uvs.push_back(patch.uvs[u + 1 + (v + 1) * width]);
-            mesh.uvs.push_back(patch.uvs[u + (v + 1) * width]);
-            mesh.uvs.push_back(patch.uvs[u + 1 + v * width]);
-
-            mesh.normals.push_back(glm::vec3(0.0, 0.0, 1.0));
-            mesh.normals.push_back(glm::vec3(0.0, 0.0, 1.0));
-            mesh.normals.push_back(glm::vec3(0.0, 0.0, 1.0));
-            mesh.normals.push_back(glm::vec3(0.0, 0.0, 1.0));
-            mesh.normals.push_back(glm::vec3(0.0, 0.0, 1.0));
-            mesh.normals.push_back(glm::vec3(0.0, 0.0, 1.0));
+            mesh.indices.push_back(u + v * width);
+            mesh.indices.push_back(u + 1 + v * width);
+            mesh.indices.push_back(u + (v + 1) * width);
+
+            mesh.indices.push_back(u + 1 + (v + 1) * width);
+            mesh.indices.push_back(u + (v + 1) * width);
+            mesh.indices.push_back(u + 1 + v * width);
         }
     }
-    _bezierControl = mesh;
+    _bezierControl = make_shared<MeshContainer>(std::move(mesh));
 
     updateTimestamp();
 }
@@ -156,87 +147,182 @@ void Mesh_BezierPatch::updatePatch()
 {
     lock_guard<mutex> lock(_patchMutex);
 
-    vector<glm::vec2> vertices;
-    vector<glm::vec2> uvs;
+    // Moves are applied to the cached surface as long as they cost less than a full evaluation,
+    // and the surface is evaluated again from time to time to get rid of rounding errors
+    const int maxDeltaUpdates = 256;
 
-    // Update the binomial coefficients if needed
-    if (_patch.size != _binomialDimensions)
-    {
-        _binomialCoeffsX.clear();
-        _binomialCoeffsY.clear();
+    auto vertexCount = static_cast<size_t>(_patchResolution * _patchResolution);
+    bool sameTopology = _basisDimensions == _patch.size && _basisResolution == _patchResolution && _surface.size() == vertexCount && _bezierMesh &&
+                        _evaluatedControlPoints.size() == _patch.vertices.size();
 
-        for (int i = 0; i < _patch.size.x; ++i)
-            _binomialCoeffsX.push_back((float)binomialCoeff(_patch.size.x - 1, i));
+    vector<int> movedPoints;
+    if (sameTopology)
+    {
+        for (size_t i = 0; i < _patch.vertices.size(); ++i)
+            if (_patch.vertices[i] != _evaluatedControlPoints[i])
+                movedPoints.push_back(i);
+    }
 
-        for (int i = 0; i < _patch.size.y; ++i)
-            _binomialCoeffsY.push_back((float)binomialCoeff(_patch.size.y - 1, i));
+    if (!sameTopology)
+        updateBasis();
 
-        _binomialDimensions = _patch.size;
+    if (!sameTopology || movedPoints.size() > static_cast<size_t>(_patch.size.y) || _deltaUpdates + static_cast<int>(movedPoints.size()) > maxDeltaUpdates)
+    {
+        evaluateSurface();
+        _deltaUpdates = 0;
     }
-
-    // Compute the vertices positions
-    for (int v = 0; v < _patchResolution; ++v)
+    else
     {
-        glm::vec2 uv;
+        for (auto index : movedPoints)
+            moveControlPoint(index, _patch.vertices[index] - _evaluatedControlPoints[index]);
+        _deltaUpdates += static_cast<int>(movedPoints.size());
+    }
+    _evaluatedControlPoints = _patch.vertices;
 
-        uv.y = (float)v / ((float)_patchResolution - 1.f);
+    if (!sameTopology)
+    {
+        MeshContainer mesh;
+        mesh.vertices.resize(vertexCount);
+        mesh.uvs.resize(vertexCount);
+        mesh.normals.resize(vertexCount, glm::vec3(0.0, 0.0, 1.0));
+        for (int v = 0; v < _patchResolution; ++v)
+        {
+            for (int u = 0; u < _patchResolution; ++u)
+            {
+                auto index = u + v * _patchResolution;
+                mesh.vertices[index] = glm::vec4(_surface[index], 0.0, 1.0);
+                mesh.uvs[index] = glm::vec2((float)u / ((float)_patchResolution - 1.f), (float)v / ((float)_patchResolution - 1.f));
+            }
+        }
 
-        for (int u = 0; u < _patchResolution; ++u)
+        for (int v = 0; v < _patchResolution - 1; ++v)
         {
-            uv.x = (float)u / ((float)_patchResolution - 1.f);
+            for (int u = 0; u < _patchResolution - 1; ++u)
+            {
+                mesh.indices.push_back(u + v * _patchResolution);
+                mesh.indices.push_back(u + 1 + v * _patchResolution);
+                mesh.indices.push_back(u + (v + 1) * _patchResolution);
+
+                mesh.indices.push_back(u + 1 + v * _patchResolution);
+                mesh.indices.push_back(u + 1 + (v + 1) * _patchResolution);
+                mesh.indices.push_back(u + (v + 1) * _patchResolution);
+            }
+        }
+
+        _bezierMesh = make_shared<MeshContainer>(std::move(mesh));
+        _bezierMeshSpare.reset();
+        _bufferMesh = _bezierMesh;
+        setBufferMeshUpdated();
+        return;
+    }
 
-            glm::vec2 vertex{0.f, 0.f};
-            for (int j = 0; j < _patch.size.y; ++j)
+    // Only the positions changed: they are written to the previous container if it is not used anymore,
+    // and the GPU buffers are updated in place
+    bool isBezierMeshShown = (_bufferMesh == _bezierMesh);
+    swap(_bezierMesh, _bezierMeshSpare);
+    if (!_bezierMesh || _bezierMesh.use_count() > 1 || _bezierMesh->vertices.size() != vertexCount)
+        _bezierMesh = make_shared<MeshContainer>(*_bezierMeshSpare);
+
+    for (size_t i = 0; i < vertexCount; ++i)
+        _bezierMesh->vertices[i] = glm::vec4(_surface[i], 0.0, 1.0);
+
+    _bufferMesh = _bezierMesh;
+    if (isBezierMeshShown)
+    {
+        vector<VertexRange> ranges{{0, static_cast<uint32_t>(vertexCount)}};
+        setBufferMeshUpdated(&ranges);
+    }
+    else
+    {
+        setBufferMeshUpdated();
+    }
+}
+
+/*************/
+void Mesh_BezierPatch::updateBasis()
+{
+    // Bernstein polynomials of degree n are computed from the ones of degree n - 1, which avoids both
+    // binomial coefficients and pow(): B(n, i) = (1 - t) * B(n - 1, i) + t * B(n - 1, i - 1)
+    auto computeBasis = [&](int count, vector<float>& basis) {
+        basis.assign(_patchResolution * count, 0.f);
+        for (int s = 0; s < _patchResolution; ++s)
+        {
+            float t = (float)s / ((float)_patchResolution - 1.f);
+            float* values = &basis[s * count];
+            values[0] = 1.f;
+            for (int degree = 1; degree < count; ++degree)
             {
-                for (int i = 0; i < _patch.size.x; ++i)
-                {
-                    float factor = _binomialCoeffsY[j] * pow(uv.y, (float)j) * pow(1.f - uv.y, (float)_patch.size.y - 1.f - (float)j) * _binomialCoeffsX[i] * pow(uv.x, (float)i) *
-                                   pow(1.f - uv.x, (float)_patch.size.x - 1.f - (float)i);
-                    vertex += factor * _patch.vertices[i + j * _patch.size.x];
-                }
+                for (int i = degree; i > 0; --i)
+                    values[i] = (1.f - t) * values[i] + t * values[i - 1];
+                values[0] *= 1.f - t;
             }
+        }
+    };
+
+    computeBasis(_patch.size.x, _basisX);
+    computeBasis(_patch.size.y, _basisY);
+    _basisDimensions = _patch.size;
+    _basisResolution = _patchResolution;
+}
 
-            vertices.push_back(vertex);
-            uvs.push_back(uv);
+/*************/
+void Mesh_BezierPatch::evaluateSurface()
+{
+    int width = _patch.size.x;
+    int height = _patch.size.y;
+    int resolution = _patchResolution;
+
+    // The patch is evaluated as a curve along each row of control points, which are then combined for each vertex row
+    vector<glm::vec2> rowCurves(height * resolution);
+    for (int j = 0; j < height; ++j)
+    {
+        const auto* controlPoints = &_patch.vertices[j * width];
+        for (int u = 0; u < resolution; ++u)
+        {
+            const auto* basis = &_basisX[u * width];
+            glm::vec2 point{0.f, 0.f};
+            for (int i = 0; i < width; ++i)
+                point += basis[i] * controlPoints[i];
+            rowCurves[u + j * resolution] = point;
         }
     }
 
-    // Create the mesh
-    MeshContainer mesh;
-    for (int v = 0; v < _patchResolution - 1; ++v)
+    _surface.assign(resolution * resolution, glm::vec2(0.f, 0.f));
+    for (int v = 0; v < resolution; ++v)
     {
-        for (int u = 0; u < _patchResolution - 1; ++u)
+        auto* surfaceRow = &_surface[v * resolution];
+        const auto* basis = &_basisY[v * height];
+        for (int j = 0; j < height; ++j)
         {
-            mesh.vertices.push_back(glm::vec4(vertices[u + v * _patchResolution], 0.0, 1.0));
-            mesh.vertices.push_back(glm::vec4(vertices[u + 1 + v * _patchResolution], 0.0, 1.0));
-            mesh.vertices.push_back(glm::vec4(vertices[u + (v + 1) * _patchResolution], 0.0, 1.0));
-
-            mesh.vertices.push_back(glm::vec4(vertices[u + 1 + v * _patchResolution], 0.0, 1.0));
-            mesh.vertices.push_back(glm::vec4(vertices[u + 1 + (v + 1) * _patchResolution], 0.0, 1.0));
-            mesh.vertices.push_back(glm::vec4(vertices[u + (v + 1) * _patchResolution], 0.0, 1.0));
-
-            mesh.uvs.push_back(uvs[u + v * _patchResolution]);
-            mesh.uvs.push_back(uvs[u + 1 + v * _patchResolution]);
-            mesh.uvs.push_back(uvs[u + (v + 1) * _patchResolution]);
-
-            mesh.uvs.push_back(uvs[u + 1 + v * _patchResolution]);
-            mesh.uvs.push_back(uvs[u + 1 + (v + 1) * _patchResolution]);
-            mesh.uvs.push_back(uvs[u + (v + 1) * _patchResolution]);
-
-            mesh.normals.push_back(glm::vec3(0.0, 0.0, 1.0));
-            mesh.normals.push_back(glm::vec3(0.0, 0.0, 1.0));
-            mesh.normals.push_back(glm::vec3(0.0, 0.0, 1.0));
-            mesh.normals.push_back(glm::vec3(0.0, 0.0, 1.0));
-            mesh.normals.push_back(glm::vec3(0.0, 0.0, 1.0));
-            mesh.normals.push_back(glm::vec3(0.0, 0.0, 1.0));
+            float weight = basis[j];
+            const auto* rowCurve = &rowCurves[j * resolution];
+            for (int u = 0; u < resolution; ++u)
+                surfaceRow[u] += weight * rowCurve[u];
         }
     }
+}
 
-    _bufferMesh = mesh;
-    _bezierMesh = mesh;
-
-    updateTimestamp();
-    _meshUpdated = true;
+/*************/
+void Mesh_BezierPatch::moveControlPoint(int index, const glm::vec2& delta)
+{
+    int width = _patch.size.x;
+    int height = _patch.size.y;
+    int resolution = _patchResolution;
+    int i = index % width;
+    int j = index / width;
+
+    // Each vertex moves by the delta weighted by the basis of the control point at this vertex
+    vector<glm::vec2> columnDeltas(resolution);
+    for (int u = 0; u < resolution; ++u)
+        columnDeltas[u] = _basisX[u * width + i] * delta;
+
+    for (int v = 0; v < resolution; ++v)
+    {
+        float weight = _basisY[v * height + j];
+        auto* surfaceRow = &_surface[v * resolution];
+        for (int u = 0; u < resolution; ++u)
+            surfaceRow[u] += weight * columnDeltas[u];
+    }
 }
 
 /*************/
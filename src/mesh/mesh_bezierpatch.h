@@ -52,7 +52,7 @@ class Mesh_BezierPatch : public Mesh
     /**
      * \brief Destructor
      */
-    virtual ~Mesh_BezierPatch() final;
+    virtual ~Mesh_BezierPatch() override;
 
     /**
      * No copy constructor, but a copy operator
@@ -78,7 +78,7 @@ class Mesh_BezierPatch : public Mesh
      */
     virtual void update() final;
 
-  private:
+  protected:
     struct Patch
     {
         glm::ivec2 size{0, 0};
@@ -91,32 +91,20 @@ class Mesh_BezierPatch : public Mesh
     std::mutex _patchMutex{};
 
     bool _patchUpdated{true};
-    MeshContainer _bezierControl;
-    MeshContainer _bezierMesh;
+    std::shared_ptr<MeshContainer> _bezierControl{nullptr};
+    std::shared_ptr<MeshContainer> _bezierMesh{nullptr};
+    std::shared_ptr<MeshContainer> _bezierMeshSpare{nullptr}; //!< Previous Bezier mesh, reused if not shared anymore
 
-    std::vector<float> _binomialCoeffsX{};
-    std::vector<float> _binomialCoeffsY{};
-    glm::ivec2 _binomialDimensions{0, 0};
+    // Bernstein polynomials evaluated at each row and column of the patch, for the current patch size and resolution.
+    // _basisX holds size.x values for each of the _basisResolution columns, and _basisY size.y values for each row
+    std::vector<float> _basisX{};
+    std::vector<float> _basisY{};
+    glm::ivec2 _basisDimensions{0, 0};
+    int _basisResolution{0};
 
-    // Factorial
-    inline int32_t factorial(int32_t i) { return (i == 0 || i == 1) ? 1 : factorial(i - 1) * i; }
-
-    // "Semi" factorial
-    inline int32_t factorial(int32_t n, int32_t k)
-    {
-        int32_t res = 1;
-        for (int32_t i = n - k + 1; i <= n; ++i)
-            res *= i;
-        return res;
-    }
-
-    // Binomial coefficient
-    inline int32_t binomialCoeff(int32_t n, int32_t i)
-    {
-        if (n < i)
-            return 0;
-        return factorial(n, i) / factorial(i);
-    }
+    std::vector<glm::vec2> _surface{};                //!< Evaluated patch, in the same order as the mesh vertices
+    std::vector<glm::vec2> _evaluatedControlPoints{}; //!< Control points _surface has been evaluated from
+    int _deltaUpdates{0};                             //!< Control point moves applied to _surface since it was last fully evaluated
 
     /**
      * \brief Initialization
@@ -137,6 +125,23 @@ class Mesh_BezierPatch : public Mesh
      */
     void updatePatch();
 
+    /**
+     * \brief Compute the Bernstein polynomials for the current patch size and resolution
+     */
+    void updateBasis();
+
+    /**
+     * \brief Evaluate the whole patch into _surface
+     */
+    void evaluateSurface();
+
+    /**
+     * \brief Apply the move of a single control point to _surface
+     * \param index Control point index
+     * \param delta Control point displacement
+     */
+    void moveControlPoint(int index, const glm::vec2& delta);
+
     /**
      * \brief Register new functors to modify attributes
      */
@@ -70,23 +70,23 @@ void Mesh_Shmdata::onData(void* data, int /*data_size*/)
     int verticeNbr = *(intPtr++);
     int polyNbr = *(intPtr++);
 
-    vector<glm::vec4> vertices(verticeNbr);
-    vector<glm::vec2> uvs(verticeNbr);
-    vector<glm::vec3> normals(verticeNbr);
+    MeshContainer newMesh;
+    newMesh.vertices.resize(verticeNbr);
+    newMesh.uvs.resize(verticeNbr);
+    newMesh.normals.resize(verticeNbr);
 
     floatPtr += 2;
-    // First, create the vertices with no UV, normals or faces
+    // First, create the vertices with their UV and normals
     for (int v = 0; v < verticeNbr; ++v)
     {
-        vertices[v] = glm::vec4(floatPtr[0], floatPtr[1], floatPtr[2], 1.f);
-        uvs[v] = glm::vec2(floatPtr[3], floatPtr[4]);
-        normals[v] = glm::vec3(floatPtr[5], floatPtr[6], floatPtr[7]);
+        newMesh.vertices[v] = glm::vec4(floatPtr[0], floatPtr[1], floatPtr[2], 1.f);
+        newMesh.uvs[v] = glm::vec2(floatPtr[3], floatPtr[4]);
+        newMesh.normals[v] = glm::vec3(floatPtr[5], floatPtr[6], floatPtr[7]);
         floatPtr += 8;
     }
 
     intPtr += 8 * verticeNbr;
-    // Then create the faces
-    MeshContainer newMesh;
+    // Then create the faces, which refer to the vertices by their index
     for (int p = 0; p < polyNbr; ++p)
     {
         int size = *(intPtr++);
@@ -95,32 +95,43 @@ void Mesh_Shmdata::onData(void* data, int /*data_size*/)
         if (size >= 3)
         {
             for (int vert = 0; vert < 3; ++vert)
-            {
-                newMesh.vertices.push_back(vertices[*(intPtr + vert)]);
-                newMesh.uvs.push_back(uvs[*(intPtr + vert)]);
-                newMesh.normals.push_back(normals[*(intPtr + vert)]);
-            }
+                newMesh.indices.push_back(*(intPtr + vert));
         }
         if (size == 4)
         {
             for (int vert = 2; vert < 5; ++vert)
-            {
-                newMesh.vertices.push_back(vertices[*(intPtr + (vert % 4))]);
-                newMesh.uvs.push_back(uvs[*(intPtr + (vert % 4))]);
-                newMesh.normals.push_back(normals[*(intPtr + (vert % 4))]);
-            }
+                newMesh.indices.push_back(*(intPtr + (vert % 4)));
         }
 
         intPtr += size;
     }
 
+    // Indices are used as is on the GPU, where out of range values are not caught
+    for (auto index : newMesh.indices)
+    {
+        if (index >= static_cast<uint32_t>(verticeNbr))
+        {
+            Log::get() << Log::WARNING << "Mesh_Shmdata::" << __FUNCTION__ << " - Received faces refer to undefined vertices, discarding" << Log::endl;
+            return;
+        }
+    }
+
     lock_guard<shared_timed_mutex> lock(_writeMutex);
     if (Timer::get().isDebug())
         Timer::get() << "mesh_shmdata " + _name;
 
-    _bufferMesh = std::move(newMesh);
-    _meshUpdated = true;
-    updateTimestamp();
+    // If only the vertices moved, keep track of which ones to send only these
+    if (newMesh.vertices.size() == _bufferMesh->vertices.size() && newMesh.indices == _bufferMesh->indices)
+    {
+        auto ranges = computeUpdatedRanges(*_bufferMesh, newMesh);
+        _bufferMesh = make_shared<MeshContainer>(std::move(newMesh));
+        setBufferMeshUpdated(&ranges);
+    }
+    else
+    {
+        _bufferMesh = make_shared<MeshContainer>(std::move(newMesh));
+        setBufferMeshUpdated();
+    }
 
     if (Timer::get().isDebug())
         Timer::get() >> ("mesh_shmdata " + _name);
@@ -130,6 +141,24 @@ void Mesh_Shmdata::onData(void* data, int /*data_size*/)
 void Mesh_Shmdata::registerAttributes()
 {
     Mesh::registerAttributes();
+
+    addAttribute("partialUpdates",
+        [&](const Values& args) {
+            _sendPartialUpdates = (args[0].as<int>() > 0);
+            return true;
+        },
+        [&]() -> Values { return {_sendPartialUpdates}; },
+        {'n'});
+    setAttributeDescription("partialUpdates", "If set to 1, only the modified vertices are sent to the Scenes when the topology does not change");
+
+    addAttribute("quantizePartialUpdates",
+        [&](const Values& args) {
+            _quantizePartialUpdates = (args[0].as<int>() > 0);
+            return true;
+        },
+        [&]() -> Values { return {_quantizePartialUpdates}; },
+        {'n'});
+    setAttributeDescription("quantizePartialUpdates", "If set to 1, partial updates are sent with positions, UVs and normals stored on 16 bits");
 }
 
 } // end of namespace
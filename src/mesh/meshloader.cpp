@@ -0,0 +1,869 @@
+#include "./mesh/meshloader.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <future>
+#include <limits>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+
+#include "./utils/log.h"
+
+#define SPLASH_MESHLOADER_MIN_CHUNK_SIZE (1 << 20)
+
+using namespace std;
+
+namespace Splash
+{
+namespace Loader
+{
+
+namespace
+{
+
+/*************/
+inline bool isBlank(char c)
+{
+    return c == ' ' || c == '\t' || c == '\r';
+}
+
+/*************/
+inline bool isDigit(char c)
+{
+    return c >= '0' && c <= '9';
+}
+
+/*************/
+inline const char* skipBlanks(const char* p, const char* end)
+{
+    while (p < end && isBlank(*p))
+        ++p;
+    return p;
+}
+
+/*************/
+// Parse a decimal number, without allocation nor locale dependency. Digits beyond what a double
+// can hold are ignored, which is way below the precision of a float anyway
+bool parseFloat(const char*& p, const char* end, float& value)
+{
+    static const double powers[] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+
+    auto start = skipBlanks(p, end);
+    auto c = start;
+
+    bool negative = false;
+    if (c < end && (*c == '-' || *c == '+'))
+        negative = (*c++ == '-');
+
+    uint64_t mantissa = 0;
+    int exponent = 0;
+    int digits = 0;
+    bool hasDigits = false;
+
+    for (; c < end && isDigit(*c); ++c)
+    {
+        hasDigits = true;
+        if (digits < 19)
+        {
+            mantissa = mantissa * 10 + (*c - '0');
+            digits += (mantissa != 0);
+        }
+        else
+        {
+            ++exponent;
+        }
+    }
+
+    if (c < end && *c == '.')
+    {
+        for (++c; c < end && isDigit(*c); ++c)
+        {
+            hasDigits = true;
+            if (digits < 19)
+            {
+                mantissa = mantissa * 10 + (*c - '0');
+                digits += (mantissa != 0);
+                --exponent;
+            }
+        }
+    }
+
+    if (!hasDigits)
+        return false;
+
+    if (c < end && (*c == 'e' || *c == 'E'))
+    {
+        auto e = c + 1;
+        bool negativeExponent = false;
+        if (e < end && (*e == '-' || *e == '+'))
+            negativeExponent = (*e++ == '-');
+
+        if (e < end && isDigit(*e))
+        {
+            int explicitExponent = 0;
+            for (; e < end && isDigit(*e); ++e)
+                explicitExponent = std::min(explicitExponent * 10 + (*e - '0'), 1000);
+            exponent += negativeExponent ? -explicitExponent : explicitExponent;
+            c = e;
+        }
+    }
+
+    auto result = static_cast<double>(mantissa);
+    if (exponent > 0)
+        result *= exponent <= 22 ? powers[exponent] : std::pow(10.0, exponent);
+    else if (exponent < 0)
+        result /= exponent >= -22 ? powers[-exponent] : std::pow(10.0, -exponent);
+
+    value = static_cast<float>(negative ? -result : result);
+    p = c;
+    return true;
+}
+
+/*************/
+bool parseInt(const char*& p, const char* end, int& value)
+{
+    auto c = p;
+    bool negative = false;
+    if (c < end && (*c == '-' || *c == '+'))
+        negative = (*c++ == '-');
+
+    if (c == end || !isDigit(*c))
+        return false;
+
+    int64_t result = 0;
+    for (; c < end && isDigit(*c); ++c)
+        result = std::min<int64_t>(result * 10 + (*c - '0'), INT32_MAX);
+
+    value = static_cast<int>(negative ? -result : result);
+    p = c;
+    return true;
+}
+
+/*************/
+inline bool isLittleEndian()
+{
+    const uint16_t value = 1;
+    return *reinterpret_cast<const uint8_t*>(&value) == 1;
+}
+
+const char binaryMagic[8] = {'S', 'P', 'L', 'M', 'E', 'S', 'H', '\0'};
+
+/*************/
+// FNV-1a hash, over 8 bytes words to keep up with the disk
+uint64_t hashContent(const char* data, size_t size)
+{
+    const uint64_t prime = 0x100000001b3ull;
+    uint64_t hash = 0xcbf29ce484222325ull;
+    size_t index = 0;
+    for (; index + sizeof(uint64_t) <= size; index += sizeof(uint64_t))
+    {
+        uint64_t word;
+        memcpy(&word, data + index, sizeof(word));
+        hash = (hash ^ word) * prime;
+    }
+    for (; index < size; ++index)
+        hash = (hash ^ static_cast<uint8_t>(data[index])) * prime;
+    return hash;
+}
+
+} // end of anonymous namespace
+
+/*************/
+void Obj::clear()
+{
+    _vertices.clear();
+    _uvs.clear();
+    _normals.clear();
+    _faces.clear();
+}
+
+/*************/
+bool Obj::load(const string& filename)
+{
+    clear();
+
+    auto fd = open(filename.c_str(), O_RDONLY);
+    if (fd < 0)
+        return false;
+
+    struct stat fileStat;
+    if (fstat(fd, &fileStat) != 0 || fileStat.st_size == 0)
+    {
+        close(fd);
+        return false;
+    }
+
+    auto size = static_cast<size_t>(fileStat.st_size);
+    auto data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED)
+    {
+        Log::get() << Log::WARNING << "Loader::Obj::" << __FUNCTION__ << " - Unable to map file " << filename << ": " << string(strerror(errno)) << Log::endl;
+        return false;
+    }
+
+    // Every chunk is read once and in order
+    madvise(data, size, MADV_SEQUENTIAL);
+
+    auto result = parse(reinterpret_cast<const char*>(data), size);
+    munmap(data, size);
+
+    return result;
+}
+
+/*************/
+bool Obj::parse(const char* data, size_t size)
+{
+    clear();
+    if (!data || size == 0)
+        return false;
+
+    // Split the file in chunks made of whole lines, one per thread, but not too small to be worth it
+    size_t chunkCount = std::max<size_t>(1, std::min<size_t>(size / SPLASH_MESHLOADER_MIN_CHUNK_SIZE, thread::hardware_concurrency()));
+    vector<const char*> boundaries{data};
+    for (size_t i = 1; i < chunkCount; ++i)
+    {
+        auto position = std::max(data + size * i / chunkCount, boundaries.back());
+        auto lineEnd = reinterpret_cast<const char*>(memchr(position, '\n', data + size - position));
+        boundaries.push_back(lineEnd ? lineEnd + 1 : data + size);
+    }
+    boundaries.push_back(data + size);
+
+    vector<Chunk> chunks(chunkCount);
+    vector<future<void>> parsers;
+    for (size_t i = 1; i < chunkCount; ++i)
+        parsers.push_back(async(launch::async, [&, i]() { parseChunk(boundaries[i], boundaries[i + 1], chunks[i]); }));
+    parseChunk(boundaries[0], boundaries[1], chunks[0]);
+    for (auto& parser : parsers)
+        parser.wait();
+
+    // Merge the chunks, offsetting the relative indices by the elements of the previous chunks
+    size_t vertexCount = 0, uvCount = 0, normalCount = 0, cornerCount = 0, invalidFaces = 0;
+    for (const auto& chunk : chunks)
+    {
+        vertexCount += chunk.vertices.size();
+        uvCount += chunk.uvs.size();
+        normalCount += chunk.normals.size();
+        cornerCount += chunk.faces.size();
+        invalidFaces += chunk.invalidFaces;
+    }
+
+    _vertices.reserve(vertexCount);
+    _uvs.reserve(uvCount);
+    _normals.reserve(normalCount);
+    _faces.reserve(cornerCount);
+
+    for (auto& chunk : chunks)
+    {
+        for (const auto& relative : chunk.relativeCorners)
+        {
+            auto& corner = chunk.faces[relative.corner];
+            if (relative.components & RelativeCorner::vertex)
+                corner.vertexId += _vertices.size();
+            if (relative.components & RelativeCorner::uv)
+                corner.uvId += _uvs.size();
+            if (relative.components & RelativeCorner::normal)
+                corner.normalId += _normals.size();
+        }
+
+        _vertices.insert(_vertices.end(), chunk.vertices.begin(), chunk.vertices.end());
+        _uvs.insert(_uvs.end(), chunk.uvs.begin(), chunk.uvs.end());
+        _normals.insert(_normals.end(), chunk.normals.begin(), chunk.normals.end());
+        _faces.insert(_faces.end(), chunk.faces.begin(), chunk.faces.end());
+        chunk = Chunk();
+    }
+
+    // Faces referring to missing elements would lead to out of bounds reads later on
+    auto isValid = [&](int index, size_t count, bool optional) { return (optional && index == -1) || (index >= 0 && static_cast<size_t>(index) < count); };
+    for (const auto& corner : _faces)
+    {
+        if (!isValid(corner.vertexId, _vertices.size(), false) || !isValid(corner.uvId, _uvs.size(), true) || !isValid(corner.normalId, _normals.size(), true))
+        {
+            Log::get() << Log::WARNING << "Loader::Obj::" << __FUNCTION__ << " - Faces refer to undefined vertices, UVs or normals" << Log::endl;
+            clear();
+            return false;
+        }
+    }
+
+    if (invalidFaces != 0)
+        Log::get() << Log::WARNING << "Loader::Obj::" << __FUNCTION__ << " - Ignored " << invalidFaces << " faces with less than three vertices" << Log::endl;
+
+    // Check that we have faces and vertices
+    if (_vertices.size() == 0 || _faces.size() == 0)
+    {
+        clear();
+        return false;
+    }
+
+    return true;
+}
+
+/*************/
+void Obj::parseChunk(const char* begin, const char* end, Chunk& chunk)
+{
+    vector<FaceVertex> corners;
+    vector<uint8_t> relativeComponents;
+
+    for (auto line = begin; line < end;)
+    {
+        auto lineEnd = reinterpret_cast<const char*>(memchr(line, '\n', end - line));
+        if (!lineEnd)
+            lineEnd = end;
+
+        auto p = skipBlanks(line, lineEnd);
+        line = lineEnd + 1;
+
+        if (lineEnd - p < 2)
+            continue;
+
+        if (p[0] == 'v' && isBlank(p[1]))
+        {
+            // Elements are kept even if malformed, as faces refer to them by their position
+            glm::vec4 vertex(0.f, 0.f, 0.f, 1.f);
+            p += 1;
+            for (int i = 0; i < 4 && parseFloat(p, lineEnd, vertex[i]); ++i)
+                ;
+            chunk.vertices.push_back(vertex);
+        }
+        else if (p[0] == 'v' && p[1] == 't' && lineEnd - p > 2 && isBlank(p[2]))
+        {
+            glm::vec2 uv(0.f, 0.f);
+            p += 2;
+            for (int i = 0; i < 2 && parseFloat(p, lineEnd, uv[i]); ++i)
+                ;
+            chunk.uvs.push_back(uv);
+        }
+        else if (p[0] == 'v' && p[1] == 'n' && lineEnd - p > 2 && isBlank(p[2]))
+        {
+            glm::vec3 normal(0.f, 0.f, 0.f);
+            p += 2;
+            for (int i = 0; i < 3 && parseFloat(p, lineEnd, normal[i]); ++i)
+                ;
+            chunk.normals.push_back(normal);
+        }
+        else if (p[0] == 'f' && isBlank(p[1]))
+        {
+            corners.clear();
+            relativeComponents.clear();
+            bool isValid = true;
+
+            // Corners are written as v, v/vt, v//vn or v/vt/vn, with 1-based indices, or negative ones relative to the last element
+            auto resolve = [&](int index, size_t count, uint8_t component, uint8_t& relative) {
+                if (index < 0)
+                {
+                    relative |= component;
+                    return static_cast<int>(count) + index;
+                }
+                isValid = isValid && (index != 0);
+                return index - 1;
+            };
+
+            p += 1;
+            while (true)
+            {
+                p = skipBlanks(p, lineEnd);
+                int index;
+                if (!parseInt(p, lineEnd, index))
+                    break;
+
+                FaceVertex corner;
+                uint8_t relative = 0;
+                corner.vertexId = resolve(index, chunk.vertices.size(), RelativeCorner::vertex, relative);
+                if (p < lineEnd && *p == '/')
+                {
+                    ++p;
+                    if (parseInt(p, lineEnd, index))
+                        corner.uvId = resolve(index, chunk.uvs.size(), RelativeCorner::uv, relative);
+                    if (p < lineEnd && *p == '/')
+                    {
+                        ++p;
+                        if (parseInt(p, lineEnd, index))
+                            corner.normalId = resolve(index, chunk.normals.size(), RelativeCorner::normal, relative);
+                    }
+                }
+
+                corners.push_back(corner);
+                relativeComponents.push_back(relative);
+
+                // Skip whatever is left of a malformed corner
+                while (p < lineEnd && !isBlank(*p))
+                    ++p;
+            }
+
+            if (!isValid || corners.size() < 3)
+            {
+                ++chunk.invalidFaces;
+                continue;
+            }
+
+            // Polygons are triangulated as a fan, which is correct for the convex ones
+            for (size_t i = 1; i + 1 < corners.size(); ++i)
+            {
+                for (auto c : {size_t(0), i, i + 1})
+                {
+                    if (relativeComponents[c] != 0)
+                    {
+                        RelativeCorner relative;
+                        relative.corner = chunk.faces.size();
+                        relative.components = relativeComponents[c];
+                        chunk.relativeCorners.push_back(relative);
+                    }
+                    chunk.faces.push_back(corners[c]);
+                }
+            }
+        }
+    }
+}
+
+/*************/
+void Obj::getIndexedMesh(vector<glm::vec4>& vertices, vector<glm::vec2>& uvs, vector<glm::vec3>& normals, vector<uint32_t>& indices) const
+{
+    vertices.clear();
+    uvs.clear();
+    normals.clear();
+    indices.clear();
+    indices.reserve(_faces.size());
+
+    // Faces with no normal get smooth normals, computed per vertex from the surrounding faces
+    vector<glm::vec3> smoothNormals;
+    for (size_t i = 0; i + 2 < _faces.size(); i += 3)
+    {
+        auto face = &_faces[i];
+        if (face[0].normalId != -1 && face[1].normalId != -1 && face[2].normalId != -1)
+            continue;
+
+        if (smoothNormals.empty())
+            smoothNormals.resize(_vertices.size(), glm::vec3(0.f, 0.f, 0.f));
+
+        // The cross product is proportional to the face area, which weights the average
+        auto edge1 = glm::vec3(_vertices[face[1].vertexId] - _vertices[face[0].vertexId]);
+        auto edge2 = glm::vec3(_vertices[face[2].vertexId] - _vertices[face[0].vertexId]);
+        auto faceNormal = glm::cross(edge1, edge2);
+        for (int c = 0; c < 3; ++c)
+            if (face[c].normalId == -1)
+                smoothNormals[face[c].vertexId] += faceNormal;
+    }
+
+    for (auto& normal : smoothNormals)
+        if (glm::length(normal) > 0.f)
+            normal = glm::normalize(normal);
+
+    // Unique corners sharing the same vertex are chained together, starting from the vertex
+    vector<int> firstCorner(_vertices.size(), -1);
+    vector<int> nextCorner;
+    vector<FaceVertex> uniqueCorners;
+    nextCorner.reserve(_vertices.size());
+    uniqueCorners.reserve(_vertices.size());
+
+    for (const auto& corner : _faces)
+    {
+        int index = firstCorner[corner.vertexId];
+        while (index != -1 && (uniqueCorners[index].uvId != corner.uvId || uniqueCorners[index].normalId != corner.normalId))
+            index = nextCorner[index];
+
+        if (index == -1)
+        {
+            index = static_cast<int>(uniqueCorners.size());
+            uniqueCorners.push_back(corner);
+            nextCorner.push_back(firstCorner[corner.vertexId]);
+            firstCorner[corner.vertexId] = index;
+        }
+
+        indices.push_back(static_cast<uint32_t>(index));
+    }
+
+    vertices.reserve(uniqueCorners.size());
+    uvs.reserve(uniqueCorners.size());
+    normals.reserve(uniqueCorners.size());
+    for (const auto& corner : uniqueCorners)
+    {
+        vertices.push_back(_vertices[corner.vertexId]);
+        uvs.push_back(corner.uvId == -1 ? glm::vec2(0.f, 0.f) : _uvs[corner.uvId]);
+        normals.push_back(corner.normalId == -1 ? smoothNormals[corner.vertexId] : _normals[corner.normalId]);
+    }
+}
+
+/*************/
+vector<glm::vec4> Obj::getVertices() const
+{
+    vector<glm::vec4> vertices;
+    vertices.reserve(_faces.size());
+
+    for (const auto& corner : _faces)
+        vertices.push_back(_vertices[corner.vertexId]);
+
+    return vertices;
+}
+
+/*************/
+vector<glm::vec2> Obj::getUVs() const
+{
+    vector<glm::vec2> uvs;
+    uvs.reserve(_faces.size());
+
+    for (const auto& corner : _faces)
+    {
+        if (corner.uvId == -1)
+            uvs.push_back(glm::vec2(0.f, 0.f));
+        else
+            uvs.push_back(_uvs[corner.uvId]);
+    }
+
+    return uvs;
+}
+
+/*************/
+vector<glm::vec3> Obj::getNormals() const
+{
+    vector<glm::vec3> normals;
+    normals.reserve(_faces.size());
+
+    for (size_t i = 0; i + 2 < _faces.size(); i += 3)
+    {
+        auto face = &_faces[i];
+        if (face[0].normalId == -1 || face[1].normalId == -1 || face[2].normalId == -1)
+        {
+            auto edge1 = glm::vec3(_vertices[face[1].vertexId] - _vertices[face[0].vertexId]);
+            auto edge2 = glm::vec3(_vertices[face[2].vertexId] - _vertices[face[0].vertexId]);
+            auto normal = glm::normalize(glm::cross(edge1, edge2));
+
+            normals.push_back(normal);
+            normals.push_back(normal);
+            normals.push_back(normal);
+        }
+        else
+        {
+            normals.push_back(_normals[face[0].normalId]);
+            normals.push_back(_normals[face[1].normalId]);
+            normals.push_back(_normals[face[2].normalId]);
+        }
+    }
+
+    return normals;
+}
+
+
+/*************/
+const string Binary::extension{".splashmesh"};
+
+/*************/
+bool Binary::getSource(const string& filename, Source& source)
+{
+    auto fd = open(filename.c_str(), O_RDONLY);
+    if (fd < 0)
+        return false;
+
+    struct stat fileStat;
+    if (fstat(fd, &fileStat) != 0)
+    {
+        close(fd);
+        return false;
+    }
+
+    source.mtime = static_cast<int64_t>(fileStat.st_mtim.tv_sec) * 1000000000 + fileStat.st_mtim.tv_nsec;
+    source.size = static_cast<uint64_t>(fileStat.st_size);
+    source.hash = hashContent(nullptr, 0);
+
+    // The content is hashed too, as the modification time may be preserved by copies
+    auto size = static_cast<size_t>(fileStat.st_size);
+    if (size != 0)
+    {
+        auto data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data == MAP_FAILED)
+        {
+            close(fd);
+            return false;
+        }
+        madvise(data, size, MADV_SEQUENTIAL);
+        source.hash = hashContent(reinterpret_cast<const char*>(data), size);
+        munmap(data, size);
+    }
+
+    close(fd);
+    return true;
+}
+
+/*************/
+void Binary::clear()
+{
+    _vertices.clear();
+    _uvs.clear();
+    _normals.clear();
+    _indices.clear();
+    _source = Source();
+}
+
+/*************/
+bool Binary::load(const string& filename)
+{
+    clear();
+
+    auto fd = open(filename.c_str(), O_RDONLY);
+    if (fd < 0)
+        return false;
+
+    struct stat fileStat;
+    if (fstat(fd, &fileStat) != 0 || static_cast<size_t>(fileStat.st_size) < sizeof(Header))
+    {
+        close(fd);
+        return false;
+    }
+
+    auto size = static_cast<size_t>(fileStat.st_size);
+    auto data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED)
+    {
+        Log::get() << Log::WARNING << "Loader::Binary::" << __FUNCTION__ << " - Unable to map file " << filename << ": " << string(strerror(errno)) << Log::endl;
+        return false;
+    }
+
+    madvise(data, size, MADV_SEQUENTIAL);
+
+    auto result = parse(reinterpret_cast<const char*>(data), size);
+    munmap(data, size);
+
+    return result;
+}
+
+/*************/
+bool Binary::parse(const char* data, size_t size)
+{
+    static_assert(sizeof(Header) == 88, "Loader::Binary header must not be padded");
+
+    clear();
+    if (!data || size < sizeof(Header))
+        return false;
+
+    if (!isLittleEndian())
+    {
+        Log::get() << Log::WARNING << "Loader::Binary::" << __FUNCTION__ << " - Binary meshes can only be read on little-endian hosts" << Log::endl;
+        return false;
+    }
+
+    Header header;
+    memcpy(&header, data, sizeof(header));
+    if (memcmp(header.magic, binaryMagic, sizeof(binaryMagic)) != 0 || header.version != version)
+        return false;
+
+    bool quantized = header.flags & flagQuantized;
+    uint64_t vertexCount = header.vertexCount;
+    uint64_t indexCount = header.indexCount;
+
+    // Sections are aligned on 4 bytes, which only matters for the quantized ones
+    auto align = [](uint64_t offset) { return (offset + 3) & ~static_cast<uint64_t>(3); };
+    uint64_t verticesSize = vertexCount * (quantized ? 3 * sizeof(uint16_t) : sizeof(glm::vec4));
+    uint64_t uvsSize = vertexCount * (quantized ? 2 * sizeof(uint16_t) : sizeof(glm::vec2));
+    uint64_t normalsSize = vertexCount * (quantized ? 3 * sizeof(int16_t) : sizeof(glm::vec3));
+    uint64_t indicesSize = indexCount * sizeof(uint32_t);
+
+    uint64_t verticesOffset = sizeof(Header);
+    uint64_t uvsOffset = align(verticesOffset + verticesSize);
+    uint64_t normalsOffset = align(uvsOffset + uvsSize);
+    uint64_t indicesOffset = align(normalsOffset + normalsSize);
+
+    if (vertexCount == 0 || indexCount == 0 || indexCount % 3 != 0 || indicesOffset + indicesSize != size)
+    {
+        Log::get() << Log::WARNING << "Loader::Binary::" << __FUNCTION__ << " - Binary mesh size does not match its header" << Log::endl;
+        return false;
+    }
+
+    _indices.resize(indexCount);
+    memcpy(_indices.data(), data + indicesOffset, indicesSize);
+    for (auto index : _indices)
+    {
+        if (index >= vertexCount)
+        {
+            Log::get() << Log::WARNING << "Loader::Binary::" << __FUNCTION__ << " - Faces refer to undefined vertices" << Log::endl;
+            clear();
+            return false;
+        }
+    }
+
+    _vertices.resize(vertexCount);
+    _uvs.resize(vertexCount);
+    _normals.resize(vertexCount);
+
+    if (!quantized)
+    {
+        memcpy(_vertices.data(), data + verticesOffset, verticesSize);
+        memcpy(_uvs.data(), data + uvsOffset, uvsSize);
+        memcpy(_normals.data(), data + normalsOffset, normalsSize);
+    }
+    else
+    {
+        auto boundsMin = glm::vec3(header.boundsMin[0], header.boundsMin[1], header.boundsMin[2]);
+        auto boundsScale = (glm::vec3(header.boundsMax[0], header.boundsMax[1], header.boundsMax[2]) - boundsMin) / 65535.f;
+        auto uvBoundsMin = glm::vec2(header.uvBoundsMin[0], header.uvBoundsMin[1]);
+        auto uvBoundsScale = (glm::vec2(header.uvBoundsMax[0], header.uvBoundsMax[1]) - uvBoundsMin) / 65535.f;
+
+        for (uint64_t i = 0; i < vertexCount; ++i)
+        {
+            uint16_t position[3];
+            uint16_t uv[2];
+            int16_t normal[3];
+            memcpy(position, data + verticesOffset + i * sizeof(position), sizeof(position));
+            memcpy(uv, data + uvsOffset + i * sizeof(uv), sizeof(uv));
+            memcpy(normal, data + normalsOffset + i * sizeof(normal), sizeof(normal));
+
+            _vertices[i] = glm::vec4(boundsMin + glm::vec3(position[0], position[1], position[2]) * boundsScale, 1.f);
+            _uvs[i] = uvBoundsMin + glm::vec2(uv[0], uv[1]) * uvBoundsScale;
+            _normals[i] = glm::vec3(normal[0], normal[1], normal[2]) / 32767.f;
+        }
+    }
+
+    _source.mtime = header.sourceMtime;
+    _source.size = header.sourceSize;
+    _source.hash = header.sourceHash;
+
+    return true;
+}
+
+/*************/
+bool Binary::write(const string& filename,
+    const vector<glm::vec4>& vertices,
+    const vector<glm::vec2>& uvs,
+    const vector<glm::vec3>& normals,
+    const vector<uint32_t>& indices,
+    bool quantize,
+    Source source)
+{
+    if (!isLittleEndian())
+    {
+        Log::get() << Log::WARNING << "Loader::Binary::" << __FUNCTION__ << " - Binary meshes can only be written on little-endian hosts" << Log::endl;
+        return false;
+    }
+
+    if (vertices.empty() || uvs.size() != vertices.size() || normals.size() != vertices.size() || indices.empty() || indices.size() % 3 != 0 ||
+        vertices.size() > numeric_limits<uint32_t>::max() || indices.size() > numeric_limits<uint32_t>::max())
+    {
+        Log::get() << Log::WARNING << "Loader::Binary::" << __FUNCTION__ << " - Invalid mesh, it can not be written to " << filename << Log::endl;
+        return false;
+    }
+
+    Header header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, binaryMagic, sizeof(binaryMagic));
+    header.version = version;
+    header.flags = quantize ? flagQuantized : 0;
+    header.vertexCount = static_cast<uint32_t>(vertices.size());
+    header.indexCount = static_cast<uint32_t>(indices.size());
+    header.sourceMtime = source.mtime;
+    header.sourceSize = source.size;
+    header.sourceHash = source.hash;
+
+    vector<char> attributes;
+    auto append = [&](const void* data, size_t size) {
+        auto offset = attributes.size();
+        attributes.resize(offset + size);
+        memcpy(attributes.data() + offset, data, size);
+    };
+    auto align = [&]() { attributes.resize((attributes.size() + 3) & ~static_cast<size_t>(3), 0); };
+
+    if (!quantize)
+    {
+        append(vertices.data(), vertices.size() * sizeof(glm::vec4));
+        append(uvs.data(), uvs.size() * sizeof(glm::vec2));
+        append(normals.data(), normals.size() * sizeof(glm::vec3));
+    }
+    else
+    {
+        auto boundsMin = glm::vec3(vertices[0]);
+        auto boundsMax = boundsMin;
+        for (const auto& vertex : vertices)
+        {
+            boundsMin = glm::min(boundsMin, glm::vec3(vertex));
+            boundsMax = glm::max(boundsMax, glm::vec3(vertex));
+        }
+
+        auto uvBoundsMin = uvs[0];
+        auto uvBoundsMax = uvBoundsMin;
+        for (const auto& uv : uvs)
+        {
+            uvBoundsMin = glm::min(uvBoundsMin, uv);
+            uvBoundsMax = glm::max(uvBoundsMax, uv);
+        }
+
+        for (int i = 0; i < 3; ++i)
+        {
+            header.boundsMin[i] = boundsMin[i];
+            header.boundsMax[i] = boundsMax[i];
+        }
+        for (int i = 0; i < 2; ++i)
+        {
+            header.uvBoundsMin[i] = uvBoundsMin[i];
+            header.uvBoundsMax[i] = uvBoundsMax[i];
+        }
+
+        // Flat dimensions are mapped to a null range, so that they are restored exactly
+        auto quantizeUnsigned = [](float value, float min, float max) {
+            if (max <= min)
+                return static_cast<uint16_t>(0);
+            return static_cast<uint16_t>(std::round(std::min(std::max((value - min) / (max - min), 0.f), 1.f) * 65535.f));
+        };
+
+        for (const auto& vertex : vertices)
+        {
+            uint16_t position[3];
+            for (int i = 0; i < 3; ++i)
+                position[i] = quantizeUnsigned(vertex[i], boundsMin[i], boundsMax[i]);
+            append(position, sizeof(position));
+        }
+        align();
+
+        for (const auto& uv : uvs)
+        {
+            uint16_t quantizedUV[2];
+            for (int i = 0; i < 2; ++i)
+                quantizedUV[i] = quantizeUnsigned(uv[i], uvBoundsMin[i], uvBoundsMax[i]);
+            append(quantizedUV, sizeof(quantizedUV));
+        }
+        align();
+
+        for (const auto& normal : normals)
+        {
+            int16_t quantizedNormal[3];
+            for (int i = 0; i < 3; ++i)
+                quantizedNormal[i] = static_cast<int16_t>(std::round(std::min(std::max(normal[i], -1.f), 1.f) * 32767.f));
+            append(quantizedNormal, sizeof(quantizedNormal));
+        }
+        align();
+    }
+
+    // Write to a temporary file first, so that concurrent loads never see a partial file
+    auto tmpFilename = filename + "." + to_string(getpid()) + ".tmp";
+    auto file = fopen(tmpFilename.c_str(), "wb");
+    if (!file)
+        return false;
+
+    bool success = fwrite(&header, 1, sizeof(header), file) == sizeof(header);
+    success &= fwrite(attributes.data(), 1, attributes.size(), file) == attributes.size();
+    success &= fwrite(indices.data(), sizeof(uint32_t), indices.size(), file) == indices.size();
+    success &= fclose(file) == 0;
+
+    if (!success || rename(tmpFilename.c_str(), filename.c_str()) != 0)
+    {
+        remove(tmpFilename.c_str());
+        return false;
+    }
+
+    return true;
+}
+
+/*************/
+void Binary::getIndexedMesh(vector<glm::vec4>& vertices, vector<glm::vec2>& uvs, vector<glm::vec3>& normals, vector<uint32_t>& indices)
+{
+    vertices = std::move(_vertices);
+    uvs = std::move(_uvs);
+    normals = std::move(_normals);
+    indices = std::move(_indices);
+    clear();
+}
+
+} // end of namespace
+} // end of namespace
@@ -19,22 +19,18 @@
 
 /*
  * @meshloader.h
- * A simple and Splash-oriented Wavefront OBJ loader
+ * Simple and Splash-oriented mesh loaders, for Wavefront OBJ files and Splash binary meshes
  */
 
 #ifndef SPLASH_MESHLOADER_H
 #define SPLASH_MESHLOADER_H
 
-#include <fstream>
-#include <iostream>
-#include <sstream>
+#include <cstdint>
 #include <string>
 #include <vector>
 
 #include <glm/glm.hpp>
 
-#include "../utils/log.h"
-
 namespace Splash
 {
 namespace Loader
@@ -59,233 +55,200 @@ class Obj : public Base
   public:
     ~Obj(){};
 
-    /**/
-    bool load(const std::string& filename)
-    {
-        std::ifstream file(filename, std::ios::in);
-        if (!file.is_open())
-            return false;
-
-        _vertices.clear();
-        _uvs.clear();
-        _normals.clear();
-        _faces.clear();
-
-        for (std::string line; std::getline(file, line);)
-        {
-
-            std::string::size_type pos;
-            if ((pos = line.find("o ")) == 0)
-            {
-                continue;
-            }
-            else if ((pos = line.find("v ")) == 0)
-            {
-                pos += 1;
-                glm::vec4 vertex;
-                int index = 0;
-                do
-                {
-                    pos++;
-                    line = line.substr(pos);
-                    vertex[index] = std::stof(line);
-                    index++;
-                    pos = line.find(" ");
-                } while (pos != std::string::npos && index < 4);
-
-                if (index < 3)
-                    vertex[3] = 1.f;
-
-                _vertices.push_back(vertex);
-            }
-            else if ((pos = line.find("vt ")) == 0)
-            {
-                pos += 2;
-                glm::vec2 uv;
-                int index = 0;
-                do
-                {
-                    pos++;
-                    line = line.substr(pos);
-                    uv[index] = std::stof(line);
-                    index++;
-                    pos = line.find(" ");
-                } while (pos != std::string::npos && index < 2);
-
-                _uvs.push_back(uv);
-            }
-            else if ((pos = line.find("vn ")) == 0)
-            {
-                pos += 2;
-                glm::vec3 normal;
-                int index = 0;
-                do
-                {
-                    pos++;
-                    line = line.substr(pos);
-                    normal[index] = std::stof(line);
-                    index++;
-                    pos = line.find(" ");
-                } while (pos != std::string::npos && index < 3);
-
-                _normals.push_back(normal);
-            }
-            else if ((pos = line.find("f ")) == 0)
-            {
-                pos += 1;
-
-                std::vector<FaceVertex> face;
-                std::string::size_type nextSlash, nextSpace;
-                do
-                {
-                    pos++;
-                    line = line.substr(pos);
-                    nextSpace = line.find(" ");
-
-                    FaceVertex faceVertex;
-                    faceVertex.vertexId = std::stoi(line) - 1;
-
-                    nextSlash = line.find("/");
-                    if (nextSlash != std::string::npos && (nextSpace == std::string::npos || nextSlash < nextSpace))
-                    {
-                        line = line.substr(nextSlash + 1);
-                        nextSlash = line.find("/");
-                        if (nextSlash != 0)
-                        {
-                            nextSpace = line.find(" ");
-                            faceVertex.uvId = std::stoi(line) - 1;
-                        }
-                    }
-                    else
-                        nextSlash = line.find("/");
-                    if (nextSlash != std::string::npos && (nextSpace == std::string::npos || nextSlash < nextSpace))
-                    {
-                        line = line.substr(nextSlash + 1);
-                        nextSpace = line.find(" ");
-                        faceVertex.normalId = std::stoi(line) - 1;
-                    }
-
-                    face.push_back(faceVertex);
-
-                    pos = nextSpace;
-                } while (pos != std::string::npos);
-
-                // We triangulate faces right away if needed
-                // Only tris and quads are supported
-                if (face.size() == 3)
-                {
-                    _faces.push_back(face);
-                }
-                else if (face.size() >= 4)
-                {
-                    std::vector<FaceVertex> newFace;
-                    newFace.push_back(face[0]);
-                    newFace.push_back(face[1]);
-                    newFace.push_back(face[2]);
-                    _faces.push_back(newFace);
-
-                    newFace.clear();
-                    newFace.push_back(face[2]);
-                    newFace.push_back(face[3]);
-                    newFace.push_back(face[0]);
-                    _faces.push_back(newFace);
-                }
-            }
-        }
-
-        // Check that we have faces, vertices and UVs
-        if (_vertices.size() == 0 || _faces.size() == 0)
-        {
-            _vertices.clear();
-            _faces.clear();
-            _uvs.clear();
-            _normals.clear();
-
-            return false;
-        }
-
-        return true;
-    }
+    /**
+     * \brief Load an OBJ file. The file is mapped in memory and split in chunks parsed in parallel
+     * \param filename File path
+     * \return Return true if the file contained a valid mesh
+     */
+    bool load(const std::string& filename);
+
+    /**
+     * \brief Parse an OBJ file from memory
+     * \param data File content
+     * \param size File size
+     * \return Return true if the content is a valid mesh
+     */
+    bool parse(const char* data, size_t size);
+
+    /**
+     * \brief Get the mesh as an indexed triangle list. Corners sharing the same vertex, UV and normal are merged,
+     * and vertices with no normal get the average of the normals of the faces around them
+     * \param vertices Unique vertices
+     * \param uvs UV for each unique vertex
+     * \param normals Normal for each unique vertex
+     * \param indices Three indices per triangle
+     */
+    void getIndexedMesh(std::vector<glm::vec4>& vertices, std::vector<glm::vec2>& uvs, std::vector<glm::vec3>& normals, std::vector<uint32_t>& indices) const;
+
+    /**
+     * \brief Get the mesh as a list of triangles, with one vertex, UV and normal per triangle corner
+     */
+    std::vector<glm::vec4> getVertices() const;
+    std::vector<glm::vec2> getUVs() const;
+    std::vector<glm::vec3> getNormals() const;
 
     /**/
-    std::vector<glm::vec4> getVertices() const
+    std::vector<std::vector<int>> getFaces() const { return std::vector<std::vector<int>>(); }
+
+  private:
+    struct FaceVertex
     {
-        std::vector<glm::vec4> vertices;
+        int vertexId{-1};
+        int uvId{-1};
+        int normalId{-1};
+    };
 
-        for (auto& face : _faces)
-        {
-            vertices.push_back(_vertices[face[0].vertexId]);
-            vertices.push_back(_vertices[face[1].vertexId]);
-            vertices.push_back(_vertices[face[2].vertexId]);
-        }
+    struct RelativeCorner
+    {
+        static const uint8_t vertex{1};
+        static const uint8_t uv{2};
+        static const uint8_t normal{4};
 
-        return vertices;
-    }
+        size_t corner{0};      //!< Index of the corner in the chunk faces
+        uint8_t components{0}; //!< Components holding an index relative to the chunk
+    };
 
-    /**/
-    std::vector<glm::vec2> getUVs() const
+    /**
+     * Result of the parsing of a part of the file. Relative indices are resolved once every chunk
+     * is parsed, as they depend on the number of elements defined in the previous chunks
+     */
+    struct Chunk
     {
-        std::vector<glm::vec2> uvs;
-
-        for (auto& face : _faces)
-        {
-            if (face[0].uvId == -1)
-                for (uint32_t i = 0; i < face.size(); ++i)
-                    uvs.push_back(glm::vec2(0.f, 0.f));
-            else
-            {
-                uvs.push_back(_uvs[face[0].uvId]);
-                uvs.push_back(_uvs[face[1].uvId]);
-                uvs.push_back(_uvs[face[2].uvId]);
-            }
-        }
-
-        return uvs;
-    }
+        std::vector<glm::vec4> vertices{};
+        std::vector<glm::vec2> uvs{};
+        std::vector<glm::vec3> normals{};
+        std::vector<FaceVertex> faces{};               //!< Triangulated faces, three corners per triangle
+        std::vector<RelativeCorner> relativeCorners{}; //!< Corners using relative indices
+        size_t invalidFaces{0};
+    };
 
-    /**/
-    std::vector<glm::vec3> getNormals() const
+    std::vector<glm::vec4> _vertices;
+    std::vector<glm::vec2> _uvs;
+    std::vector<glm::vec3> _normals;
+    std::vector<FaceVertex> _faces; //!< Triangulated faces, three corners per triangle
+
+    /**
+     * \brief Parse a part of the file, made of whole lines
+     * \param begin Chunk start
+     * \param end Chunk end
+     * \param chunk Chunk to fill
+     */
+    static void parseChunk(const char* begin, const char* end, Chunk& chunk);
+
+    /**
+     * \brief Clear all the loaded data
+     */
+    void clear();
+};
+
+/**********/
+/**
+ * Splash binary mesh format. Meshes are stored indexed, in little-endian, after a fixed size header.
+ * Attributes are stored either as floats, or quantized to 16 bits integers within the mesh bounds
+ */
+class Binary
+{
+  public:
+    static const uint32_t version{2};
+    static const std::string extension; //!< Extension of binary mesh files, also appended to OBJ files to get their cache
+
+    /**
+     * Description of the file a binary mesh has been converted from, used to check whether a cache is still valid
+     */
+    struct Source
     {
-        std::vector<glm::vec3> normals;
-
-        for (auto& face : _faces)
-        {
-            if (face[0].normalId == -1)
-            {
-                auto edge1 = glm::vec3(_vertices[face[1].vertexId] - _vertices[face[0].vertexId]);
-                auto edge2 = glm::vec3(_vertices[face[2].vertexId] - _vertices[face[0].vertexId]);
-                auto normal = glm::normalize(glm::cross(edge1, edge2));
-
-                normals.push_back(normal);
-                normals.push_back(normal);
-                normals.push_back(normal);
-            }
-            else
-            {
-                normals.push_back(_normals[face[0].normalId]);
-                normals.push_back(_normals[face[1].normalId]);
-                normals.push_back(_normals[face[2].normalId]);
-            }
-        }
-
-        return normals;
-    }
+        int64_t mtime; //!< Modification time, in nanoseconds since epoch
+        uint64_t size; //!< Size in bytes
+        uint64_t hash; //!< Hash of the content
+        bool operator==(const Source& other) const { return mtime == other.mtime && size == other.size && hash == other.hash; }
+    };
 
-    /**/
-    std::vector<std::vector<int>> getFaces() const { return std::vector<std::vector<int>>(); }
+    /**
+     * \brief Get the description of the given file, which includes a hash of its whole content
+     * \param filename File path
+     * \param source Description of the file
+     * \return Return false if the file could not be accessed
+     */
+    static bool getSource(const std::string& filename, Source& source);
+
+    /**
+     * \brief Load a binary mesh. The file is mapped in memory
+     * \param filename File path
+     * \return Return true if the file contained a valid mesh
+     */
+    bool load(const std::string& filename);
+
+    /**
+     * \brief Parse a binary mesh from memory
+     * \param data File content
+     * \param size File size
+     * \return Return true if the content is a valid mesh
+     */
+    bool parse(const char* data, size_t size);
+
+    /**
+     * \brief Write an indexed mesh to a binary mesh file. The file is written next to its destination, then moved in place
+     * \param filename File path
+     * \param vertices Vertices
+     * \param uvs UV for each vertex
+     * \param normals Normal for each vertex
+     * \param indices Three indices per triangle
+     * \param quantize If true, store attributes on 16 bits. The fourth vertex coordinate is then lost and set to 1
+     * \param source Description of the file the mesh was converted from, if any
+     * \return Return true if the file was written
+     */
+    static bool write(const std::string& filename,
+        const std::vector<glm::vec4>& vertices,
+        const std::vector<glm::vec2>& uvs,
+        const std::vector<glm::vec3>& normals,
+        const std::vector<uint32_t>& indices,
+        bool quantize = false,
+        Source source = Source());
+
+    /**
+     * \brief Get the mesh as an indexed triangle list, moving it out of the loader
+     * \param vertices Vertices
+     * \param uvs UV for each vertex
+     * \param normals Normal for each vertex
+     * \param indices Three indices per triangle
+     */
+    void getIndexedMesh(std::vector<glm::vec4>& vertices, std::vector<glm::vec2>& uvs, std::vector<glm::vec3>& normals, std::vector<uint32_t>& indices);
+
+    /**
+     * \brief Get the description of the file the mesh was converted from
+     * \return Return the source description, zeroed if unknown
+     */
+    Source getSource() const { return _source; }
 
   private:
+    struct Header
+    {
+        char magic[8];
+        uint32_t version;
+        uint32_t flags;
+        uint32_t vertexCount;
+        uint32_t indexCount;
+        int64_t sourceMtime;
+        uint64_t sourceSize;
+        uint64_t sourceHash;
+        float boundsMin[3];
+        float boundsMax[3];
+        float uvBoundsMin[2];
+        float uvBoundsMax[2];
+    };
+
+    static const uint32_t flagQuantized{1};
+
     std::vector<glm::vec4> _vertices;
     std::vector<glm::vec2> _uvs;
     std::vector<glm::vec3> _normals;
+    std::vector<uint32_t> _indices;
+    Source _source{};
 
-    struct FaceVertex
-    {
-        int vertexId{-1};
-        int uvId{-1};
-        int normalId{-1};
-    };
-    std::vector<std::vector<FaceVertex>> _faces;
+    /**
+     * \brief Clear all the loaded data
+     */
+    void clear();
 };
 
 } // end of namespace
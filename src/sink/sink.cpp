@@ -1,9 +1,14 @@
 #include "./sink/sink.h"
 
+#include <algorithm>
 #include <fstream>
 
+#include "./utils/log.h"
 #include "./utils/timer.h"
 
+// Number of reads of a frame overwritten while being copied, before giving up
+#define SPLASH_SINK_MAX_READ_TRIES 4
+
 using namespace std;
 
 namespace Splash
@@ -36,6 +41,51 @@ Sink::~Sink()
     glDeleteBuffers(_pbos.size(), _pbos.data());
 }
 
+/*************/
+ResizableArray<uint8_t> Sink::getBuffer() const
+{
+    ResizableArray<uint8_t> buffer;
+    for (int tries = 0; tries < SPLASH_SINK_MAX_READ_TRIES; ++tries)
+    {
+        auto frameIsValid = readBuffer([&](const uint8_t* data, size_t size) {
+            buffer.resize(size);
+            if (size != 0)
+                memcpy(buffer.data(), data, size);
+        });
+
+        if (frameIsValid)
+            return buffer;
+    }
+
+    // The frame has been overwritten while being copied on every try
+    return ResizableArray<uint8_t>();
+}
+
+/*************/
+bool Sink::readBuffer(const function<void(const uint8_t*, size_t)>& reader) const
+{
+    unique_lock<mutex> lock(_lockPixels);
+    if (!_sharedFrameRing)
+    {
+        reader(_buffer.data(), _buffer.size());
+        return true;
+    }
+
+    // The ring never waits for its readers, so the frame is read without holding the lock and checked afterwards
+    auto ring = _sharedFrameRing;
+    lock.unlock();
+
+    SharedFrameRing::Frame frame;
+    if (!ring->getLastFrame(frame))
+    {
+        reader(nullptr, 0);
+        return ring->getLastSequence() == 0;
+    }
+
+    reader(frame.data, frame.size);
+    return ring->isFrameValid(frame);
+}
+
 /*************/
 string Sink::getCaps() const
 {
@@ -104,39 +154,175 @@ void Sink::update()
         return;
     _lastFrameTiming = currentTime;
 
-    if (_spec != textureSpec || _pbos.size() != _pboCount)
+    shared_ptr<Texture> readbackTexture = _inputTexture;
+    auto outputSpec = textureSpec;
+    if (isConversionNeeded())
+    {
+        outputSpec = convertInput(textureSpec);
+        if (outputSpec.rawSize() == 0)
+            return;
+        readbackTexture = _conversionFbo->getColorTexture();
+    }
+    auto readbackSpec = readbackTexture->getSpec();
+
+    if (_spec != outputSpec || _readbackSpec != readbackSpec || _pbos.size() != _pboCount)
     {
-        updatePbos(textureSpec.width, textureSpec.height, textureSpec.pixelBytes());
-        _spec = textureSpec;
+        updatePbos(readbackSpec.width, readbackSpec.height, readbackSpec.pixelBytes());
+        _spec = outputSpec;
+        _readbackSpec = readbackSpec;
         _image = ImageBuffer(_spec);
     }
 
     // TODO: figure out why replacing glGetTexImage with glGetTextureImage is not straightforward
-    _inputTexture->bind();
+    readbackTexture->bind();
     glBindBuffer(GL_PIXEL_PACK_BUFFER, _pbos[_pboWriteIndex]);
-    if (_spec.bpp == 32)
+    if (_readbackSpec.bpp == 32)
         glGetTexImage(GL_TEXTURE_2D, 0, GL_RGBA, GL_UNSIGNED_INT_8_8_8_8_REV, 0);
-    else if (_spec.bpp == 24)
+    else if (_readbackSpec.bpp == 24)
         glGetTexImage(GL_TEXTURE_2D, 0, GL_RGB, GL_UNSIGNED_BYTE, 0);
-    else if (_spec.bpp == 16 && _spec.channels != 1)
+    else if (_readbackSpec.bpp == 16 && _readbackSpec.channels != 1)
         glGetTexImage(GL_TEXTURE_2D, 0, GL_RG, GL_UNSIGNED_SHORT, 0);
-    else if (_spec.bpp == 16 && _spec.channels == 1)
+    else if (_readbackSpec.bpp == 16 && _readbackSpec.channels == 1)
         glGetTexImage(GL_TEXTURE_2D, 0, GL_RED, GL_UNSIGNED_SHORT, 0);
-    else if (_spec.bpp == 8)
+    else if (_readbackSpec.bpp == 8)
         glGetTexImage(GL_TEXTURE_2D, 0, GL_RED, GL_UNSIGNED_BYTE, 0);
 
     glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
-    _inputTexture->unbind();
+    readbackTexture->unbind();
 
     _pboWriteIndex = (_pboWriteIndex + 1) % _pbos.size();
 
-    _mappedPixels = (GLubyte*)glMapNamedBufferRange(_pbos[_pboWriteIndex], 0, _spec.rawSize(), GL_MAP_READ_BIT);
+    _mappedPixels = (GLubyte*)glMapNamedBufferRange(_pbos[_pboWriteIndex], 0, _readbackSpec.rawSize(), GL_MAP_READ_BIT);
+}
+
+/*************/
+bool Sink::isConversionNeeded() const
+{
+    return _outputFormat != "RGBA" || _outputSize[0] > 0 || _outputSize[1] > 0 || _regionOfInterest != array<float, 4>({{0.f, 0.f, 1.f, 1.f}});
+}
+
+/*************/
+ImageBufferSpec Sink::convertInput(const ImageBufferSpec& inputSpec)
+{
+    if (!_conversionFbo)
+    {
+        _conversionFbo = make_unique<Framebuffer>(_root);
+        _conversionScreen = make_shared<Object>(_root);
+        _conversionScreen->setAttribute("fill", {"sinkConversion"});
+        _conversionScreen->addGeometry(make_shared<Geometry>(_root));
+    }
+
+    if (_conversionInput != _inputTexture)
+    {
+        if (_conversionInput)
+            _conversionScreen->removeTexture(_conversionInput);
+        _conversionInput = _inputTexture;
+        _conversionScreen->addTexture(_conversionInput);
+    }
+
+    // Output size, following the ratio of the region of interest if only one dimension is set
+    auto roiWidth = inputSpec.width * _regionOfInterest[2];
+    auto roiHeight = inputSpec.height * _regionOfInterest[3];
+    int width = _outputSize[0];
+    int height = _outputSize[1];
+    if (width <= 0 && height <= 0)
+    {
+        width = static_cast<int>(roiWidth);
+        height = static_cast<int>(roiHeight);
+    }
+    else if (width <= 0)
+    {
+        width = static_cast<int>(height * roiWidth / roiHeight);
+    }
+    else if (height <= 0)
+    {
+        height = static_cast<int>(width * roiHeight / roiWidth);
+    }
+
+    // Each texel of the render target holds four bytes of the output
+    int format = 0;
+    ImageBufferSpec outputSpec;
+    int targetWidth = 0;
+    int targetHeight = 0;
+    if (_outputFormat == "UYVY")
+    {
+        format = 1;
+        width = width / 2 * 2;
+        outputSpec = ImageBufferSpec(width, height, 3, 16, ImageBufferSpec::Type::UINT8, "UYVY");
+        targetWidth = width / 2;
+        targetHeight = height;
+    }
+    else if (_outputFormat == "I420" || _outputFormat == "NV12")
+    {
+        format = _outputFormat == "I420" ? 2 : 3;
+        width = width / 8 * 8;
+        height = height / 4 * 4;
+        outputSpec = ImageBufferSpec(width, height, 3, 12, ImageBufferSpec::Type::UINT8, _outputFormat);
+        targetWidth = width / 4;
+        targetHeight = height * 3 / 2;
+    }
+    else
+    {
+        outputSpec = ImageBufferSpec(width, height, 4, 32, ImageBufferSpec::Type::UINT8, "RGBA");
+        targetWidth = width;
+        targetHeight = height;
+    }
+
+    if (targetWidth <= 0 || targetHeight <= 0)
+        return {};
+
+    if (_conversionFbo->getWidth() != targetWidth || _conversionFbo->getHeight() != targetHeight)
+        _conversionFbo->setSize(targetWidth, targetHeight);
+
+    _conversionFbo->bindDraw();
+    glViewport(0, 0, targetWidth, targetHeight);
+
+    _conversionScreen->activate();
+    auto shader = _conversionScreen->getShader();
+    shader->setAttribute("uniform", {"_outputFormat", format});
+    shader->setAttribute("uniform", {"_outputSize", static_cast<float>(width), static_cast<float>(height)});
+    shader->setAttribute("uniform", {"_regionOfInterest", _regionOfInterest[0], _regionOfInterest[1], _regionOfInterest[2], _regionOfInterest[3]});
+    _conversionScreen->draw();
+    _conversionScreen->deactivate();
+
+    _conversionFbo->unbindDraw();
+
+    return outputSpec;
 }
 
 /*************/
 void Sink::handlePixels(const char* pixels, const ImageBufferSpec& spec)
 {
     uint32_t size = spec.rawSize();
+
+    if (!_sharedMemoryName.empty())
+    {
+        if (!_sharedFrameRing || _sharedFrameRing->getName() != "/" + _sharedMemoryName || _sharedFrameRing->getSlotCount() != _sharedMemorySlots ||
+            _sharedFrameRing->getSlotSize() < size)
+        {
+            auto ring = shared_ptr<SharedFrameRing>(SharedFrameRing::create(_sharedMemoryName, _sharedMemorySlots, size));
+            if (!ring)
+            {
+                Log::get() << Log::WARNING << "Sink::" << __FUNCTION__ << " - Disabling shared memory output " << _sharedMemoryName << Log::endl;
+                _sharedMemoryName.clear();
+            }
+            lock_guard<mutex> lock(_lockPixels);
+            _sharedFrameRing = ring;
+        }
+
+        if (_sharedFrameRing)
+        {
+            _sharedFrameRing->writeFrame(pixels, size, spec, Timer::get().getTime());
+            return;
+        }
+    }
+    else if (_sharedFrameRing)
+    {
+        lock_guard<mutex> lock(_lockPixels);
+        _sharedFrameRing.reset();
+    }
+
+    lock_guard<mutex> lock(_lockPixels);
     if (size != _buffer.size())
         _buffer.resize(size);
 
@@ -189,6 +375,65 @@ void Sink::registerAttributes()
         [&]() -> Values { return {static_cast<int>(_opened)}; },
         {'n'});
     setAttributeDescription("opened", "If true, the sink lets frames through");
+
+    addAttribute("outputFormat",
+        [&](const Values& args) {
+            auto format = args[0].as<string>();
+            if (format != "RGBA" && format != "UYVY" && format != "I420" && format != "NV12")
+                return false;
+            _outputFormat = format;
+            return true;
+        },
+        [&]() -> Values { return {_outputFormat}; },
+        {'s'});
+    setAttributeDescription("outputFormat",
+        "Pixel format of the output, converted on the GPU before being read back: RGBA, UYVY, I420 or NV12. "
+        "The width is rounded down to a multiple of 8, and the height to a multiple of 4, for I420 and NV12");
+
+    addAttribute("outputSize",
+        [&](const Values& args) {
+            _outputSize = {{max(0, args[0].as<int>()), max(0, args[1].as<int>())}};
+            return true;
+        },
+        [&]() -> Values { return {_outputSize[0], _outputSize[1]}; },
+        {'n', 'n'});
+    setAttributeDescription("outputSize", "Output size, scaled on the GPU. If a dimension is 0, it follows the ratio of the region of interest");
+
+    addAttribute("regionOfInterest",
+        [&](const Values& args) {
+            auto x = min(max(args[0].as<float>(), 0.f), 1.f);
+            auto y = min(max(args[1].as<float>(), 0.f), 1.f);
+            auto width = min(max(args[2].as<float>(), 0.f), 1.f - x);
+            auto height = min(max(args[3].as<float>(), 0.f), 1.f - y);
+            if (width == 0.f || height == 0.f)
+                return false;
+            _regionOfInterest = {{x, y, width, height}};
+            return true;
+        },
+        [&]() -> Values { return {_regionOfInterest[0], _regionOfInterest[1], _regionOfInterest[2], _regionOfInterest[3]}; },
+        {'n', 'n', 'n', 'n'});
+    setAttributeDescription("regionOfInterest", "Region of the input sent to the output, as normalized x, y, width and height");
+
+    addAttribute("sharedMemory",
+        [&](const Values& args) {
+            _sharedMemoryName = args[0].as<string>();
+            // POSIX shared memory names are a single path component
+            _sharedMemoryName.erase(remove(_sharedMemoryName.begin(), _sharedMemoryName.end(), '/'), _sharedMemoryName.end());
+            return true;
+        },
+        [&]() -> Values { return {_sharedMemoryName}; },
+        {'s'});
+    setAttributeDescription("sharedMemory",
+        "If set, frames are written to a ring in the shared memory of this name (in /dev/shm), where local readers can access them without any copy. Readers are never waited for");
+
+    addAttribute("sharedMemorySlots",
+        [&](const Values& args) {
+            _sharedMemorySlots = max(args[0].as<int>(), 2);
+            return true;
+        },
+        [&]() -> Values { return {static_cast<int>(_sharedMemorySlots)}; },
+        {'n'});
+    setAttributeDescription("sharedMemorySlots", "Number of frames held by the shared memory ring, which is how far behind readers can lag");
 }
 
 } // end of namespace
@@ -25,6 +25,8 @@
 #ifndef SPLASH_SINK_H
 #define SPLASH_SINK_H
 
+#include <array>
+#include <functional>
 #include <future>
 #include <memory>
 #include <mutex>
@@ -35,6 +37,9 @@
 #include "./core/coretypes.h"
 #include "./core/graph_object.h"
 #include "./core/resizable_array.h"
+#include "./core/shared_frame_ring.h"
+#include "./graphics/framebuffer.h"
+#include "./graphics/object.h"
 #include "./graphics/texture.h"
 
 namespace Splash
@@ -55,9 +60,16 @@ class Sink : public GraphObject
 
     /**
      * Get the current buffer as a resizable array
-     * \return Return the buffer
+     * \return Return the buffer, which is empty if it kept being overwritten while being copied
      */
-    ResizableArray<uint8_t> getBuffer() const { return _buffer; };
+    ResizableArray<uint8_t> getBuffer() const;
+
+    /**
+     * \brief Give the current buffer to the reader, without copying it
+     * \param reader Function reading the buffer. It must not keep the pointer once it returns
+     * \return Return false if the frame got overwritten while being read, in which case the reader's output should be discarded
+     */
+    bool readBuffer(const std::function<void(const uint8_t*, size_t)>& reader) const;
 
     /**
      * Generate a caps from the input texture spec
@@ -89,6 +101,7 @@ class Sink : public GraphObject
 
   protected:
     uint32_t _framerate{30}; //!< Maximum framerate
+    bool _opened{false};     //!< If true, the sink lets frames through
 
     /**
      * \brief Register new functors to modify attributes
@@ -97,12 +110,24 @@ class Sink : public GraphObject
 
   private:
     std::shared_ptr<Texture> _inputTexture{nullptr};
-    ImageBufferSpec _spec{};
+    ImageBufferSpec _spec{};         //!< Spec of the frames sent to handlePixels
+    ImageBufferSpec _readbackSpec{}; //!< Spec of the texture read back, which differs from _spec when converting on the GPU
     ImageBuffer _image{};
-    std::mutex _lockPixels{};
+    mutable std::mutex _lockPixels{};
     ResizableArray<uint8_t> _buffer{};
 
-    bool _opened{false}; //!< If true, the sink lets frames through
+    // Frames can be sent to a shared memory ring instead of _buffer, for local readers to access them without any copy
+    std::string _sharedMemoryName{};                           //!< Shared memory name, the ring is disabled if empty
+    uint32_t _sharedMemorySlots{4};                            //!< Number of frames held by the ring
+    std::shared_ptr<SharedFrameRing> _sharedFrameRing{nullptr}; //!< Protected by _lockPixels, but used by its single writer without it
+
+    // Conversion and scaling on the GPU, reducing the amount of data read back
+    std::string _outputFormat{"RGBA"};                             //!< RGBA, UYVY, I420 or NV12
+    std::array<int, 2> _outputSize{{0, 0}};                        //!< Output size, the input size is used if null
+    std::array<float, 4> _regionOfInterest{{0.f, 0.f, 1.f, 1.f}}; //!< Input region, normalized
+    std::unique_ptr<Framebuffer> _conversionFbo{nullptr};
+    std::shared_ptr<Object> _conversionScreen{nullptr};
+    std::shared_ptr<Texture> _conversionInput{nullptr};
 
     uint64_t _lastFrameTiming{0};
     uint32_t _pboCount{3};
@@ -115,6 +140,19 @@ class Sink : public GraphObject
      */
     virtual void handlePixels(const char* pixels, const ImageBufferSpec& spec);
 
+    /**
+     * \brief Check whether the input has to be converted before being read back
+     * \return Return true if a conversion is needed
+     */
+    bool isConversionNeeded() const;
+
+    /**
+     * \brief Convert and scale the input texture on the GPU
+     * \param inputSpec Input texture spec
+     * \return Return the spec of the converted frame, or an empty spec if the conversion failed
+     */
+    ImageBufferSpec convertInput(const ImageBufferSpec& inputSpec);
+
     /**
      * \brief Update the pbos according to the parameters
      * \param width Width
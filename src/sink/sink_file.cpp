@@ -0,0 +1,680 @@
+#include "./sink/sink_file.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "./utils/log.h"
+#include "./utils/pixelutils.h"
+#include "./utils/timer.h"
+
+#define SPLASH_SINK_FILE_BATCH_SIZE (32 * 1024 * 1024)
+
+using namespace std;
+
+namespace Splash
+{
+
+/*************/
+Sink_File::Sink_File(RootObject* root)
+    : Sink(root)
+{
+    _type = "sink_file";
+    registerAttributes();
+
+    av_register_all();
+
+    _writeThread = thread([&]() { writeLoop(); });
+}
+
+/*************/
+Sink_File::~Sink_File()
+{
+    {
+        lock_guard<mutex> lock(_queueMutex);
+        _writeContinue = false;
+    }
+    _queueCondition.notify_one();
+    if (_writeThread.joinable())
+        _writeThread.join();
+}
+
+/*************/
+void Sink_File::update()
+{
+    Sink::update();
+
+    // Closing the sink ends the recording, opening it again starts a new one
+    if (_wasOpened && !_opened)
+        endRecording();
+    _wasOpened = _opened;
+}
+
+/*************/
+void Sink_File::handlePixels(const char* pixels, const ImageBufferSpec& spec)
+{
+    size_t size = spec.rawSize();
+    if (!pixels || size == 0)
+        return;
+
+    {
+        lock_guard<mutex> lock(_queueMutex);
+        if (_queuedBytes + size > _maxQueuedBytes)
+        {
+            ++_droppedFrames;
+            return;
+        }
+        _queuedBytes += size;
+    }
+
+    // The mapped pixels are only valid during this call, so they are copied to a pooled frame
+    auto frame = _framePool->acquire(spec);
+    memcpy(frame->data(), pixels, size);
+    frame->setTimestamp(Timer::get().getTime());
+
+    {
+        lock_guard<mutex> lock(_queueMutex);
+        _queue.push_back(std::move(frame));
+    }
+    _queueCondition.notify_one();
+}
+
+/*************/
+void Sink_File::endRecording()
+{
+    {
+        lock_guard<mutex> lock(_queueMutex);
+        _queue.push_back(nullptr);
+    }
+    _queueCondition.notify_one();
+}
+
+/*************/
+void Sink_File::writeLoop()
+{
+    while (true)
+    {
+        unique_ptr<ImageBuffer> frame;
+        {
+            unique_lock<mutex> lock(_queueMutex);
+            _queueCondition.wait(lock, [&]() { return !_queue.empty() || !_writeContinue; });
+            // Queued frames are still written when stopping
+            if (_queue.empty())
+                break;
+            frame = std::move(_queue.front());
+            _queue.pop_front();
+            if (frame)
+                _queuedBytes -= frame->getSpec().rawSize();
+        }
+
+        if (!frame)
+        {
+            closeRecording();
+            continue;
+        }
+
+        if (!_recording && !_recordingFailed)
+            _recordingFailed = !openRecording(frame->getSpec());
+
+        if (_recording && frame->getSpec() == _recordingSpec)
+        {
+            if (_recordingEncoded)
+                writeEncodedFrame(*frame);
+            else
+                writeRawFrame(*frame);
+        }
+        else
+        {
+            ++_droppedFrames;
+        }
+
+        _framePool->release(std::move(frame));
+    }
+
+    closeRecording();
+}
+
+/*************/
+bool Sink_File::openRecording(const ImageBufferSpec& spec)
+{
+    string path;
+    string codecName;
+    int bitRate;
+    bool directIO;
+    {
+        lock_guard<mutex> lock(_queueMutex);
+        _recordingEncoded = _encoded;
+        path = _path;
+        codecName = _codecName;
+        bitRate = _bitRate;
+        directIO = _directIO;
+    }
+
+    _firstTimestamp = -1;
+    _recordingSpec = spec;
+    _throughputStart = Timer::get().getTime();
+    _throughputBytes = 0;
+
+    if (_recordingEncoded)
+        _recording = openEncodedFile(path, spec, codecName, bitRate);
+    else
+        _recording = openRawFile(path, spec, directIO);
+
+    if (_recording)
+        Log::get() << Log::MESSAGE << "Sink_File::" << __FUNCTION__ << " - Recording to " << path << Log::endl;
+
+    return _recording;
+}
+
+/*************/
+void Sink_File::closeRecording()
+{
+    if (_recording)
+    {
+        if (_recordingEncoded)
+            closeEncodedFile();
+        else
+            closeRawFile();
+        Log::get() << Log::MESSAGE << "Sink_File::" << __FUNCTION__ << " - Recording ended" << Log::endl;
+    }
+
+    _recording = false;
+    _recordingFailed = false;
+    _writeThroughput = 0;
+}
+
+/*************/
+bool Sink_File::openRawFile(const string& path, const ImageBufferSpec& spec, bool directIO)
+{
+    if (!RawFrames::isLittleEndian())
+    {
+        Log::get() << Log::WARNING << "Sink_File::" << __FUNCTION__ << " - Raw frames containers can only be written on little-endian hosts" << Log::endl;
+        return false;
+    }
+
+    int flags = O_WRONLY | O_CREAT | O_TRUNC;
+#if HAVE_LINUX
+    if (directIO)
+        _fd = open(path.c_str(), flags | O_DIRECT, 0644);
+#endif
+    // Some file systems refuse direct I/O when opening the file
+    if (_fd < 0)
+        _fd = open(path.c_str(), flags, 0644);
+
+    if (_fd < 0)
+    {
+        Log::get() << Log::WARNING << "Sink_File::" << __FUNCTION__ << " - Unable to open file " << path << ": " << string(strerror(errno)) << Log::endl;
+        return false;
+    }
+
+    _header = RawFrames::headerFromSpec(spec, _framerate);
+    _index.clear();
+
+    // Frames are accumulated in a large batch, so that the disk sees few large aligned writes
+    auto frameStride = RawFrames::alignedSize(_header.frameSize);
+    _batchCapacity = max<size_t>(frameStride, SPLASH_SINK_FILE_BATCH_SIZE / frameStride * frameStride);
+    _batch = ResizableArray<uint8_t>(_batchCapacity + RawFrames::alignment);
+    auto misalignment = reinterpret_cast<uintptr_t>(_batch.data()) % RawFrames::alignment;
+    if (misalignment != 0)
+        _batch.shift(RawFrames::alignment - misalignment);
+    _batchSize = 0;
+    _batchOffset = RawFrames::alignment;
+
+    return true;
+}
+
+/*************/
+void Sink_File::writeRawFrame(const ImageBuffer& frame)
+{
+    auto frameSize = _header.frameSize;
+    auto frameStride = RawFrames::alignedSize(frameSize);
+    if (_batchSize + frameStride > _batchCapacity && !flushBatch())
+    {
+        ++_droppedFrames;
+        return;
+    }
+
+    auto destination = _batch.data() + _batchSize;
+    memcpy(destination, frame.data(), frameSize);
+    memset(destination + frameSize, 0, frameStride - frameSize);
+
+    if (_firstTimestamp < 0)
+        _firstTimestamp = frame.getTimestamp();
+
+    RawFrames::IndexEntry entry;
+    entry.offset = _batchOffset + _batchSize;
+    entry.timing = frame.getTimestamp() - _firstTimestamp;
+    _index.push_back(entry);
+
+    _batchSize += frameStride;
+}
+
+/*************/
+bool Sink_File::flushBatch()
+{
+    if (_batchSize == 0)
+        return true;
+
+    if (!writeAligned(_batch.data(), _batchSize, _batchOffset))
+    {
+        // The frames of the batch are lost, and removed from the index
+        while (!_index.empty() && _index.back().offset >= _batchOffset)
+            _index.pop_back();
+        _droppedFrames += _batchSize / RawFrames::alignedSize(_header.frameSize);
+        _batchSize = 0;
+        return false;
+    }
+
+    _batchOffset += _batchSize;
+    _batchSize = 0;
+    return true;
+}
+
+/*************/
+bool Sink_File::writeAligned(const uint8_t* data, size_t size, uint64_t offset)
+{
+    size_t written = 0;
+    while (written < size)
+    {
+        auto result = pwrite(_fd, data + written, size - written, offset + written);
+        if (result < 0 && errno == EINTR)
+            continue;
+
+#if HAVE_LINUX
+        // Some file systems accept O_DIRECT when opening, but not when writing
+        if (result < 0 && errno == EINVAL)
+        {
+            auto flags = fcntl(_fd, F_GETFL);
+            if (flags >= 0 && (flags & O_DIRECT) && fcntl(_fd, F_SETFL, flags & ~O_DIRECT) == 0)
+            {
+                Log::get() << Log::MESSAGE << "Sink_File::" << __FUNCTION__ << " - Direct I/O not supported, falling back to buffered writes" << Log::endl;
+                continue;
+            }
+            errno = EINVAL;
+        }
+#endif
+
+        if (result <= 0)
+        {
+            Log::get() << Log::WARNING << "Sink_File::" << __FUNCTION__ << " - Error while writing to file: " << string(strerror(errno)) << Log::endl;
+            return false;
+        }
+
+        written += result;
+    }
+
+    addWrittenBytes(size);
+    return true;
+}
+
+/*************/
+void Sink_File::closeRawFile()
+{
+    if (_fd < 0)
+        return;
+
+    flushBatch();
+
+    // The index follows the frames, and the header is written last, both padded to the alignment to keep using direct I/O
+    _header.frameCount = _index.size();
+    _header.indexOffset = _batchOffset;
+
+    auto indexSize = RawFrames::alignedSize(_index.size() * sizeof(RawFrames::IndexEntry));
+    if (indexSize > _batchCapacity)
+    {
+        _batchCapacity = indexSize;
+        _batch = ResizableArray<uint8_t>(_batchCapacity + RawFrames::alignment);
+        auto misalignment = reinterpret_cast<uintptr_t>(_batch.data()) % RawFrames::alignment;
+        if (misalignment != 0)
+            _batch.shift(RawFrames::alignment - misalignment);
+    }
+
+    if (indexSize != 0)
+    {
+        memset(_batch.data(), 0, indexSize);
+        memcpy(_batch.data(), _index.data(), _index.size() * sizeof(RawFrames::IndexEntry));
+        writeAligned(_batch.data(), indexSize, _header.indexOffset);
+    }
+
+    memset(_batch.data(), 0, RawFrames::alignment);
+    memcpy(_batch.data(), &_header, sizeof(_header));
+    writeAligned(_batch.data(), RawFrames::alignment, 0);
+
+    close(_fd);
+    _fd = -1;
+    _batch = ResizableArray<uint8_t>();
+    _batchCapacity = 0;
+    _index.clear();
+}
+
+/*************/
+bool Sink_File::openEncodedFile(const string& path, const ImageBufferSpec& spec, const string& codecName, int bitRate)
+{
+    AVCodec* codec{nullptr};
+    if (codecName == "h264")
+    {
+        codec = avcodec_find_encoder_by_name("h264_nvenc");
+        if (!codec)
+            codec = avcodec_find_encoder_by_name("libx264");
+    }
+    else if (codecName == "hevc")
+    {
+        codec = avcodec_find_encoder_by_name("hevc_nvenc");
+        if (!codec)
+            codec = avcodec_find_encoder_by_name("libx265");
+    }
+    else
+    {
+        codec = avcodec_find_encoder_by_name(codecName.c_str());
+    }
+
+    if (!codec)
+    {
+        Log::get() << Log::WARNING << "Sink_File::" << __FUNCTION__ << " - Unable to find encoder for codec " << codecName << Log::endl;
+        return false;
+    }
+
+    // Frames are either given as RGBA, or already converted to I420 by the Sink
+    auto isSupported = [&](AVPixelFormat format) {
+        for (auto pixelFormat = codec->pix_fmts; pixelFormat && *pixelFormat != AV_PIX_FMT_NONE; ++pixelFormat)
+            if (*pixelFormat == format)
+                return true;
+        return false;
+    };
+
+    auto isRGBA = spec.format.find("RGBA") != string::npos && spec.bpp == 32;
+    auto pixelFormat = AV_PIX_FMT_NONE;
+    if ((isRGBA || spec.format == "I420") && isSupported(AV_PIX_FMT_YUV420P))
+        pixelFormat = AV_PIX_FMT_YUV420P;
+    else if (isRGBA && isSupported(AV_PIX_FMT_RGBA))
+        pixelFormat = AV_PIX_FMT_RGBA;
+    else if (isRGBA && isSupported(AV_PIX_FMT_BGRA))
+        pixelFormat = AV_PIX_FMT_BGRA;
+
+    if (pixelFormat == AV_PIX_FMT_NONE)
+    {
+        Log::get() << Log::WARNING << "Sink_File::" << __FUNCTION__ << " - Codec " << codecName << " does not support input format " << spec.format << Log::endl;
+        return false;
+    }
+
+    // The container is guessed from the file extension
+    avformat_alloc_output_context2(&_formatContext, nullptr, nullptr, path.c_str());
+    if (!_formatContext)
+        avformat_alloc_output_context2(&_formatContext, nullptr, "matroska", path.c_str());
+    if (!_formatContext)
+    {
+        Log::get() << Log::WARNING << "Sink_File::" << __FUNCTION__ << " - Unable to create output context for file " << path << Log::endl;
+        return false;
+    }
+
+    _stream = avformat_new_stream(_formatContext, nullptr);
+    _codecContext = avcodec_alloc_context3(codec);
+    if (!_stream || !_codecContext)
+    {
+        Log::get() << Log::WARNING << "Sink_File::" << __FUNCTION__ << " - Unable to allocate the video stream" << Log::endl;
+        closeEncodedFile();
+        return false;
+    }
+
+    _codecContext->bit_rate = bitRate;
+    _codecContext->width = spec.width;
+    _codecContext->height = spec.height;
+    _codecContext->time_base = (AVRational){1, 1000000};
+    _codecContext->framerate = (AVRational){static_cast<int>(_framerate), 1};
+    _codecContext->pix_fmt = pixelFormat;
+    if (_formatContext->oformat->flags & AVFMT_GLOBALHEADER)
+        _codecContext->flags |= AV_CODEC_FLAG_GLOBAL_HEADER;
+
+    if (avcodec_open2(_codecContext, codec, nullptr) < 0)
+    {
+        Log::get() << Log::WARNING << "Sink_File::" << __FUNCTION__ << " - Unable to open codec " << codecName << Log::endl;
+        closeEncodedFile();
+        return false;
+    }
+
+    avcodec_parameters_from_context(_stream->codecpar, _codecContext);
+    _stream->time_base = _codecContext->time_base;
+
+    if (!(_formatContext->oformat->flags & AVFMT_NOFILE) && avio_open(&_formatContext->pb, path.c_str(), AVIO_FLAG_WRITE) < 0)
+    {
+        Log::get() << Log::WARNING << "Sink_File::" << __FUNCTION__ << " - Unable to open file " << path << Log::endl;
+        closeEncodedFile();
+        return false;
+    }
+
+    if (avformat_write_header(_formatContext, nullptr) < 0)
+    {
+        Log::get() << Log::WARNING << "Sink_File::" << __FUNCTION__ << " - Unable to write the header of file " << path << Log::endl;
+        closeEncodedFile();
+        return false;
+    }
+
+    // The frame is only allocated once the header is written, so that the trailer is written if and only if it exists
+    _encodedFrame = av_frame_alloc();
+    _encodedFrame->format = pixelFormat;
+    _encodedFrame->width = spec.width;
+    _encodedFrame->height = spec.height;
+    if (av_frame_get_buffer(_encodedFrame, 32) < 0)
+    {
+        Log::get() << Log::WARNING << "Sink_File::" << __FUNCTION__ << " - Unable to allocate the frame buffer" << Log::endl;
+        closeEncodedFile();
+        return false;
+    }
+
+    return true;
+}
+
+/*************/
+void Sink_File::writeEncodedFrame(const ImageBuffer& frame)
+{
+    if (av_frame_make_writable(_encodedFrame) < 0)
+        return;
+
+    auto spec = frame.getSpec();
+    auto pixels = reinterpret_cast<const uint8_t*>(frame.data());
+    if (_codecContext->pix_fmt == AV_PIX_FMT_YUV420P && spec.format != "I420")
+    {
+        PixelUtils::rgbaToI420(pixels,
+            false,
+            spec.width,
+            spec.height,
+            _encodedFrame->data[0],
+            _encodedFrame->linesize[0],
+            _encodedFrame->data[1],
+            _encodedFrame->linesize[1],
+            _encodedFrame->data[2],
+            _encodedFrame->linesize[2]);
+    }
+    else if (_codecContext->pix_fmt == AV_PIX_FMT_BGRA)
+    {
+        for (uint32_t row = 0; row < spec.height; ++row)
+            PixelUtils::swapRedBlue(pixels + row * spec.width * 4, _encodedFrame->data[0] + row * _encodedFrame->linesize[0], spec.width);
+    }
+    else
+    {
+        // The input already has the encoder format, only the line alignment differs
+        uint8_t* planes[4];
+        int linesizes[4];
+        av_image_fill_arrays(planes, linesizes, pixels, _codecContext->pix_fmt, spec.width, spec.height, 1);
+        av_image_copy(_encodedFrame->data, _encodedFrame->linesize, const_cast<const uint8_t**>(planes), linesizes, _codecContext->pix_fmt, spec.width, spec.height);
+    }
+
+    if (_firstTimestamp < 0)
+        _firstTimestamp = frame.getTimestamp();
+    _encodedFrame->pts = frame.getTimestamp() - _firstTimestamp;
+
+    if (!encodeAndWrite(_encodedFrame))
+        ++_droppedFrames;
+}
+
+/*************/
+bool Sink_File::encodeAndWrite(AVFrame* frame)
+{
+    if (avcodec_send_frame(_codecContext, frame) < 0)
+        return false;
+
+    AVPacket packet;
+    av_init_packet(&packet);
+    packet.data = nullptr;
+    packet.size = 0;
+
+    while (true)
+    {
+        auto result = avcodec_receive_packet(_codecContext, &packet);
+        if (result == AVERROR(EAGAIN) || result == AVERROR_EOF)
+            break;
+        else if (result < 0)
+            return false;
+
+        av_packet_rescale_ts(&packet, _codecContext->time_base, _stream->time_base);
+        packet.stream_index = _stream->index;
+        auto packetSize = packet.size;
+        if (av_interleaved_write_frame(_formatContext, &packet) < 0)
+            return false;
+        addWrittenBytes(packetSize);
+    }
+
+    return true;
+}
+
+/*************/
+void Sink_File::closeEncodedFile()
+{
+    if (_encodedFrame)
+    {
+        encodeAndWrite(nullptr);
+        av_write_trailer(_formatContext);
+        av_frame_free(&_encodedFrame);
+    }
+
+    if (_codecContext)
+        avcodec_free_context(&_codecContext);
+
+    if (_formatContext)
+    {
+        if (!(_formatContext->oformat->flags & AVFMT_NOFILE) && _formatContext->pb)
+            avio_closep(&_formatContext->pb);
+        avformat_free_context(_formatContext);
+        _formatContext = nullptr;
+    }
+
+    _stream = nullptr;
+}
+
+/*************/
+void Sink_File::addWrittenBytes(uint64_t bytes)
+{
+    _writtenBytes += bytes;
+    _throughputBytes += bytes;
+
+    auto currentTime = Timer::get().getTime();
+    if (currentTime - _throughputStart >= 1000000)
+    {
+        _writeThroughput = _throughputBytes * 1000000 / (currentTime - _throughputStart);
+        _throughputStart = currentTime;
+        _throughputBytes = 0;
+    }
+}
+
+/*************/
+void Sink_File::registerAttributes()
+{
+    Sink::registerAttributes();
+
+    addAttribute("bitrate",
+        [&](const Values& args) {
+            lock_guard<mutex> lock(_queueMutex);
+            _bitRate = max(1000000, args[0].as<int>());
+            return true;
+        },
+        [&]() -> Values { return {_bitRate}; },
+        {'n'});
+    setAttributeDescription("bitrate", "Target bitrate of encoded recordings, applied to the next recording");
+
+    addAttribute("codec",
+        [&](const Values& args) {
+            lock_guard<mutex> lock(_queueMutex);
+            _codecName = args[0].as<string>();
+            transform(_codecName.begin(), _codecName.end(), _codecName.begin(), ::tolower);
+            return true;
+        },
+        [&]() -> Values { return {_codecName}; },
+        {'s'});
+    setAttributeDescription("codec",
+        "Codec of encoded recordings, applied to the next recording: h264, hevc, or any FFmpeg encoder name (i.e. hap). "
+        "The container is deduced from the file extension");
+
+    addAttribute("directIO",
+        [&](const Values& args) {
+            lock_guard<mutex> lock(_queueMutex);
+            _directIO = args[0].as<bool>();
+            return true;
+        },
+        [&]() -> Values { return {_directIO}; },
+        {'n'});
+    setAttributeDescription("directIO", "If true, raw recordings bypass the page cache when the file system allows it");
+
+    addAttribute("format",
+        [&](const Values& args) {
+            auto format = args[0].as<string>();
+            if (format != "raw" && format != "encoded")
+                return false;
+            auto encoded = (format == "encoded");
+            if (encoded != _encoded)
+            {
+                endRecording();
+                lock_guard<mutex> lock(_queueMutex);
+                _encoded = encoded;
+            }
+            return true;
+        },
+        [&]() -> Values { return {string(_encoded ? "encoded" : "raw")}; },
+        {'s'});
+    setAttributeDescription("format", "Recording format: raw (a raw frames container, playable with image_raw) or encoded (with FFmpeg)");
+
+    addAttribute("maxQueueSize",
+        [&](const Values& args) {
+            lock_guard<mutex> lock(_queueMutex);
+            _maxQueuedBytes = static_cast<size_t>(max(16, args[0].as<int>())) * 1024 * 1024;
+            return true;
+        },
+        [&]() -> Values { return {static_cast<int>(_maxQueuedBytes / (1024 * 1024))}; },
+        {'n'});
+    setAttributeDescription("maxQueueSize", "Maximum amount of frames waiting to be written, in MB. Frames are dropped above it");
+
+    addAttribute("path",
+        [&](const Values& args) {
+            endRecording();
+            lock_guard<mutex> lock(_queueMutex);
+            _path = args[0].as<string>();
+            return true;
+        },
+        [&]() -> Values { return {_path}; },
+        {'s'});
+    setAttributeDescription("path", "Path of the recorded file. Changing it ends the current recording, and an existing file is overwritten");
+
+    addAttribute("droppedFrames",
+        [&](const Values&) { return false; },
+        [&]() -> Values { return {static_cast<int64_t>(_droppedFrames)}; });
+    setAttributeParameter("droppedFrames", false, true);
+    setAttributeDescription("droppedFrames", "Number of frames dropped because the disk could not keep up");
+
+    addAttribute("queueDepth",
+        [&](const Values&) { return false; },
+        [&]() -> Values {
+            lock_guard<mutex> lock(_queueMutex);
+            return {static_cast<int>(_queue.size()), static_cast<float>(_queuedBytes) / (1024.f * 1024.f)};
+        });
+    setAttributeParameter("queueDepth", false, true);
+    setAttributeDescription("queueDepth", "Frames waiting to be written: count, and size in MB");
+
+    addAttribute("writeThroughput",
+        [&](const Values&) { return false; },
+        [&]() -> Values { return {static_cast<float>(_writeThroughput) / (1024.f * 1024.f), static_cast<float>(_writtenBytes) / (1024.f * 1024.f)}; });
+    setAttributeParameter("writeThroughput", false, true);
+    setAttributeDescription("writeThroughput", "Write throughput over the last second in MB/s, followed by the amount written so far in MB");
+}
+
+} // end of namespace
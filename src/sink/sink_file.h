@@ -0,0 +1,191 @@
+/*
+ * Copyright (C) 2018 Emmanuel Durand
+ *
+ * This file is part of Splash.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Splash is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Splash.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * @sink_file.h
+ * The Sink_File class, recording the connected object to a file
+ */
+
+#ifndef SPLASH_SINK_FILE_H
+#define SPLASH_SINK_FILE_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+extern "C" {
+#include <libavcodec/avcodec.h>
+#include <libavformat/avformat.h>
+#include <libavutil/imgutils.h>
+}
+
+#include "./core/imagebuffer_pool.h"
+#include "./image/raw_frames.h"
+#include "./sink/sink.h"
+
+namespace Splash
+{
+
+class Sink_File : public Sink
+{
+  public:
+    /**
+     * \brief Constructor
+     * \param root Root object
+     */
+    Sink_File(RootObject* root);
+
+    /**
+     * \brief Destructor
+     */
+    ~Sink_File() override;
+
+    /**
+     * \brief Update the inner buffer of the sink, and end the recording once the sink gets closed
+     */
+    void update() final;
+
+  protected:
+    std::string _path{"/tmp/splash_record.raw"};
+    bool _encoded{false}; //!< If true, frames are encoded with FFmpeg, otherwise they are stored in a raw frames container
+    std::string _codecName{"h264"};
+    int _bitRate{20000000};
+    bool _directIO{true};
+    bool _wasOpened{false};
+
+    // Frames are written to disk from a dedicated thread. A null frame ends the current recording
+    std::thread _writeThread{};
+    std::atomic_bool _writeContinue{true};
+    std::mutex _queueMutex{};
+    std::condition_variable _queueCondition{};
+    std::deque<std::unique_ptr<ImageBuffer>> _queue{};
+    std::shared_ptr<ImageBufferPool> _framePool{std::make_shared<ImageBufferPool>()};
+    size_t _queuedBytes{0};
+    size_t _maxQueuedBytes{512 * 1024 * 1024};
+
+    // Statistics
+    std::atomic<uint64_t> _droppedFrames{0};
+    std::atomic<uint64_t> _writtenBytes{0};
+    std::atomic<uint64_t> _writeThroughput{0}; //!< In bytes per second, over the last second
+    int64_t _throughputStart{0};
+    uint64_t _throughputBytes{0};
+
+    // Raw frames container, written with large aligned batches
+    int _fd{-1};
+    ResizableArray<uint8_t> _batch{}; //!< Aligned on RawFrames::alignment
+    size_t _batchCapacity{0};
+    size_t _batchSize{0};
+    uint64_t _batchOffset{0};         //!< File offset of the batch
+    RawFrames::Header _header{};
+    std::vector<RawFrames::IndexEntry> _index{};
+    int64_t _firstTimestamp{-1};
+
+    // FFmpeg objects, for encoded recordings
+    AVFormatContext* _formatContext{nullptr};
+    AVCodecContext* _codecContext{nullptr};
+    AVStream* _stream{nullptr};
+    AVFrame* _encodedFrame{nullptr};
+    ImageBufferSpec _recordingSpec{};
+    bool _recording{false};
+    bool _recordingEncoded{false}; //!< Format of the current recording, as _encoded may change meanwhile
+    bool _recordingFailed{false}; //!< Set if the recording could not be opened, until it is ended
+
+    /**
+     * \brief Queue the pixels for the writing thread. Frames are dropped if too much data is waiting
+     * \param pixels Input image
+     * \param spec Input image specifications
+     */
+    void handlePixels(const char* pixels, const ImageBufferSpec& spec) final;
+
+    /**
+     * \brief Ask the writing thread to end the current recording once the queued frames are written
+     */
+    void endRecording();
+
+    /**
+     * \brief Writing loop
+     */
+    void writeLoop();
+
+    /**
+     * \brief Start a new recording
+     * \param spec Spec of the recorded frames
+     * \return Return true if all went well
+     */
+    bool openRecording(const ImageBufferSpec& spec);
+
+    /**
+     * \brief Finish the current recording, writing any pending data
+     */
+    void closeRecording();
+
+    /**
+     * \brief Raw frames container
+     */
+    bool openRawFile(const std::string& path, const ImageBufferSpec& spec, bool directIO);
+    void writeRawFrame(const ImageBuffer& frame);
+    void closeRawFile();
+
+    /**
+     * \brief Write the pending batch to the file
+     * \return Return true if all went well
+     */
+    bool flushBatch();
+
+    /**
+     * \brief Write aligned data to the file, disabling direct I/O if the file system does not support it
+     * \param data Data, aligned on RawFrames::alignment
+     * \param size Data size, multiple of RawFrames::alignment
+     * \param offset File offset, multiple of RawFrames::alignment
+     * \return Return true if all went well
+     */
+    bool writeAligned(const uint8_t* data, size_t size, uint64_t offset);
+
+    /**
+     * \brief Encoded video file
+     */
+    bool openEncodedFile(const std::string& path, const ImageBufferSpec& spec, const std::string& codecName, int bitRate);
+    void writeEncodedFrame(const ImageBuffer& frame);
+    void closeEncodedFile();
+
+    /**
+     * \brief Send the frame to the encoder, and write the resulting packets
+     * \param frame Frame to encode, or nullptr to flush the encoder
+     * \return Return true if all went well
+     */
+    bool encodeAndWrite(AVFrame* frame);
+
+    /**
+     * \brief Update the write statistics
+     * \param bytes Bytes written
+     */
+    void addWrittenBytes(uint64_t bytes);
+
+    /**
+     * \brief Register new functors to modify attributes
+     */
+    void registerAttributes();
+};
+
+} // end of namespace
+
+#endif // SPLASH_SINK_FILE_H
@@ -1,8 +1,10 @@
 #include "./sink/sink_shmdata_encoded.h"
 
 #include <algorithm>
+#include <cstring>
 #include <regex>
 
+#include "./utils/pixelutils.h"
 #include "./utils/timer.h"
 
 using namespace std;
@@ -18,14 +20,44 @@ Sink_Shmdata_Encoded::Sink_Shmdata_Encoded(RootObject* root)
     registerAttributes();
 
     av_register_all();
+
+    _encodeThread = thread([&]() { encodeLoop(); });
 }
 
 /*************/
 Sink_Shmdata_Encoded::~Sink_Shmdata_Encoded()
 {
+    {
+        lock_guard<mutex> lock(_queueMutex);
+        _encodeContinue = false;
+    }
+    _queueCondition.notify_one();
+    if (_encodeThread.joinable())
+        _encodeThread.join();
+
     freeFFmpegObjects();
 }
 
+/*************/
+void Sink_Shmdata_Encoded::encodeLoop()
+{
+    while (true)
+    {
+        unique_ptr<ImageBuffer> frame;
+        {
+            unique_lock<mutex> lock(_queueMutex);
+            _queueCondition.wait(lock, [&]() { return !_queue.empty() || !_encodeContinue; });
+            if (!_encodeContinue)
+                break;
+            frame = std::move(_queue.front());
+            _queue.pop_front();
+        }
+
+        encodeFrame(*frame);
+        _framePool->release(std::move(frame));
+    }
+}
+
 /*************/
 AVCodec* Sink_Shmdata_Encoded::findEncoderByName(const string& codecName)
 {
@@ -71,58 +103,46 @@ unordered_map<string, string> Sink_Shmdata_Encoded::parseOptions(const string& o
 }
 
 /*************/
-bool Sink_Shmdata_Encoded::initFFmpegObjects(const ImageBufferSpec& spec)
+bool Sink_Shmdata_Encoded::initFFmpegObjects(const ImageBufferSpec& spec, const string& codecName, const string& optionString, int bitRate, double framerate)
 {
-    _codec = findEncoderByName(_codecName);
+    _codec = findEncoderByName(codecName);
     if (!_codec)
     {
-        Log::get() << Log::WARNING << "Sink_Shmdata_Encoded::" << __FUNCTION__ << " - Unable to find encoder for codec " << _codecName << Log::endl;
+        Log::get() << Log::WARNING << "Sink_Shmdata_Encoded::" << __FUNCTION__ << " - Unable to find encoder for codec " << codecName << Log::endl;
         return false;
     }
 
     _context = avcodec_alloc_context3(_codec);
     if (!_context)
     {
-        Log::get() << Log::WARNING << "Sink_Shmdata_Encoded::" << __FUNCTION__ << " - Unable to allocate video codec context for codec " << _codecName << Log::endl;
+        Log::get() << Log::WARNING << "Sink_Shmdata_Encoded::" << __FUNCTION__ << " - Unable to allocate video codec context for codec " << codecName << Log::endl;
         return false;
     }
 
-    _context->bit_rate = _bitRate;
+    _context->bit_rate = bitRate;
     _context->width = spec.width;
     _context->height = spec.height;
-    _context->time_base = (AVRational){1, static_cast<int>(_framerate)};
+    _context->time_base = (AVRational){1, static_cast<int>(framerate)};
     _context->sample_aspect_ratio = (AVRational){static_cast<int>(spec.width), static_cast<int>(spec.height)};
     _context->pix_fmt = AV_PIX_FMT_YUV420P;
 
-    auto options = parseOptions(_options);
+    auto options = parseOptions(optionString);
     for (auto& option : options)
         av_opt_set(_context->priv_data, option.first.c_str(), option.second.c_str(), 0);
 
     if (avcodec_open2(_context, _codec, nullptr) < 0)
     {
-        Log::get() << Log::WARNING << "Sink_Shmdata_Encoded::" << __FUNCTION__ << " - Unable to open codec " << _codecName << Log::endl;
+        Log::get() << Log::WARNING << "Sink_Shmdata_Encoded::" << __FUNCTION__ << " - Unable to open codec " << codecName << Log::endl;
         return false;
     }
 
-    _swsContext = sws_getContext(spec.width, spec.height, AV_PIX_FMT_RGB32, spec.width, spec.height, AV_PIX_FMT_YUV420P, SWS_BILINEAR, nullptr, nullptr, nullptr);
-
-    _frame = av_frame_alloc();
     _yuvFrame = av_frame_alloc();
-    if (!_frame || !_yuvFrame)
+    if (!_yuvFrame)
     {
         Log::get() << Log::WARNING << "Sink_Shmdata_Encoded::" << __FUNCTION__ << " - Unable to allocate frame" << Log::endl;
         return false;
     }
 
-    _frame->format = AV_PIX_FMT_RGB32;
-    _frame->width = spec.width;
-    _frame->height = spec.height;
-    if (av_image_alloc(_frame->data, _frame->linesize, _context->width, _context->height, AV_PIX_FMT_RGB32, 32) < 0)
-    {
-        Log::get() << Log::WARNING << "Sink_Shmdata_Encoded::" << __FUNCTION__ << " - Unable to allocate raw RGBA picture buffer" << Log::endl;
-        return false;
-    }
-
     _yuvFrame->format = AV_PIX_FMT_YUV420P;
     _yuvFrame->width = spec.width;
     _yuvFrame->height = spec.height;
@@ -146,13 +166,11 @@ void Sink_Shmdata_Encoded::freeFFmpegObjects()
         _context = nullptr;
     }
 
-    if (_frame)
-        av_frame_free(&_frame);
     if (_yuvFrame)
+    {
+        av_freep(&_yuvFrame->data[0]);
         av_frame_free(&_yuvFrame);
-
-    if (_swsContext)
-        sws_freeContext(_swsContext);
+    }
 }
 
 /*************/
@@ -193,22 +211,81 @@ void Sink_Shmdata_Encoded::handlePixels(const char* pixels, const ImageBufferSpe
     if (!pixels || size == 0)
         return;
 
-    if (_resetEncoding || !_context || !_writer || spec != _previousSpec || _previousFramerate != _framerate)
+    if (!_dropOldest)
+    {
+        lock_guard<mutex> lock(_queueMutex);
+        if (_queue.size() >= _queueSize)
+        {
+            _encodeLatency.addDropped(1);
+            return;
+        }
+    }
+
+    // The mapped pixels are only valid during this call, so they are copied to a pooled frame
+    auto frame = _framePool->acquire(spec);
+    memcpy(frame->data(), pixels, size);
+    frame->setTimestamp(Timer::get().getTime());
+
+    {
+        lock_guard<mutex> lock(_queueMutex);
+        while (_queue.size() >= _queueSize)
+        {
+            _encodeLatency.addDropped(1);
+            _framePool->release(std::move(_queue.front()));
+            _queue.pop_front();
+        }
+        _queue.push_back(std::move(frame));
+    }
+    _queueCondition.notify_one();
+}
+
+/*************/
+void Sink_Shmdata_Encoded::encodeFrame(const ImageBuffer& frame)
+{
+    // Parameters are set from the attribute setters, while frames are encoded in _encodeThread
+    string path;
+    string codecName;
+    string options;
+    int bitRate;
+    double framerate;
+    {
+        lock_guard<mutex> lock(_queueMutex);
+        path = _path;
+        codecName = _codecName;
+        options = _options;
+        bitRate = _bitRate;
+        framerate = _framerate;
+    }
+
+    auto spec = frame.getSpec();
+    auto size = spec.rawSize();
+
+    if (spec.format != "I420" && spec.format.find("RGBA") == string::npos)
+    {
+        if (spec != _previousSpec)
+            Log::get() << Log::WARNING << "Sink_Shmdata_Encoded::" << __FUNCTION__ << " - Unsupported input format " << spec.format << ", use either RGBA or I420" << Log::endl;
+        _previousSpec = spec;
+        return;
+    }
+
+    if (_resetEncoding || !_context || !_writer || spec != _previousSpec || _previousFramerate != framerate)
     {
         _resetEncoding = false;
 
         // Reset FFmpeg context and stuff
         freeFFmpegObjects();
-        if (!initFFmpegObjects(spec))
+        if (!initFFmpegObjects(spec, codecName, options, bitRate, framerate))
             return;
+        // Timestamps start with the first encoded frame, which was read back before the encoder got initialized
+        _startTime = frame.getTimestamp();
 
         // Reset shmdata writer
-        _caps = generateCaps(spec, _framerate, _options, _codecName, _context);
+        _caps = generateCaps(spec, framerate, options, codecName, _context);
         _writer.reset(nullptr);
-        _writer.reset(new shmdata::Writer(_path, size, _caps, &_logger));
+        _writer.reset(new shmdata::Writer(path, size, _caps, &_logger));
 
         _previousSpec = spec;
-        _previousFramerate = _framerate;
+        _previousFramerate = framerate;
     }
 
     // Encoding
@@ -216,10 +293,30 @@ void Sink_Shmdata_Encoded::handlePixels(const char* pixels, const ImageBufferSpe
     _packet.data = nullptr;
     _packet.size = 0;
 
-    av_image_fill_arrays(_frame->data, _frame->linesize, reinterpret_cast<const uint8_t*>(pixels), AV_PIX_FMT_RGB32, spec.width, spec.height, 1);
-    sws_scale(_swsContext, _frame->data, _frame->linesize, 0, spec.height, _yuvFrame->data, _yuvFrame->linesize);
+    if (spec.format == "I420")
+    {
+        // Already converted on the GPU, only the planes have to be copied to the aligned frame
+        uint8_t* planes[4];
+        int linesizes[4];
+        av_image_fill_arrays(planes, linesizes, reinterpret_cast<const uint8_t*>(frame.data()), AV_PIX_FMT_YUV420P, spec.width, spec.height, 1);
+        av_image_copy(_yuvFrame->data, _yuvFrame->linesize, const_cast<const uint8_t**>(planes), linesizes, AV_PIX_FMT_YUV420P, spec.width, spec.height);
+    }
+    else
+    {
+        // Pixels are read from the texture as RGBA bytes
+        PixelUtils::rgbaToI420(reinterpret_cast<const uint8_t*>(frame.data()),
+            false,
+            spec.width,
+            spec.height,
+            _yuvFrame->data[0],
+            _yuvFrame->linesize[0],
+            _yuvFrame->data[1],
+            _yuvFrame->linesize[1],
+            _yuvFrame->data[2],
+            _yuvFrame->linesize[2]);
+    }
 
-    _yuvFrame->pts = (static_cast<double>((Timer::get().getTime() - _startTime)) / 1e3) / _framerate;
+    _yuvFrame->pts = (static_cast<double>((frame.getTimestamp() - _startTime)) / 1e3) / framerate;
     _yuvFrame->quality = _context->global_quality;
     _yuvFrame->pict_type = AV_PICTURE_TYPE_NONE;
 
@@ -242,6 +339,8 @@ void Sink_Shmdata_Encoded::handlePixels(const char* pixels, const ImageBufferSpe
         if (_writer && _packet.size != 0)
             _writer->copy_to_shm(_packet.data, _packet.size);
     }
+
+    _encodeLatency.addSample(Timer::get().getTime() - frame.getTimestamp());
 }
 
 /*************/
@@ -251,6 +350,7 @@ void Sink_Shmdata_Encoded::registerAttributes()
 
     addAttribute("bitrate",
         [&](const Values& args) {
+            lock_guard<mutex> lock(_queueMutex);
             _bitRate = std::max(1000000, args[0].as<int>());
             _resetEncoding = true;
             return true;
@@ -262,10 +362,36 @@ void Sink_Shmdata_Encoded::registerAttributes()
     addAttribute("caps", [&](const Values&) { return true; }, [&]() -> Values { return {_caps}; });
     setAttributeDescription("caps", "Generated caps");
 
+    addAttribute("dropPolicy",
+        [&](const Values& args) {
+            auto policy = args[0].as<string>();
+            if (policy != "oldest" && policy != "newest")
+                return false;
+            _dropOldest = (policy == "oldest");
+            return true;
+        },
+        [&]() -> Values { return {string(_dropOldest ? "oldest" : "newest")}; },
+        {'s'});
+    setAttributeDescription("dropPolicy", "Frame dropped when the encoder can not keep up: either the \"oldest\" queued frame, or the \"newest\" one");
+
+    addAttribute("encodeLatency",
+        [&](const Values&) { return false; },
+        [&]() -> Values { return {_encodeLatency.getLast(), _encodeLatency.getMean(), _encodeLatency.getPercentile(0.95f), _encodeLatency.getMax()}; });
+    setAttributeParameter("encodeLatency", false, true);
+    setAttributeDescription("encodeLatency", "Delay between reading back a frame and sending it encoded, in ms: last, mean, 95th percentile and maximum");
+
+    addAttribute("droppedFrames",
+        [&](const Values&) { return false; },
+        [&]() -> Values { return {static_cast<int64_t>(_encodeLatency.getDroppedCount())}; });
+    setAttributeParameter("droppedFrames", false, true);
+    setAttributeDescription("droppedFrames", "Number of frames dropped because the encoder could not keep up");
+
     addAttribute("codec",
         [&](const Values& args) {
-            _codecName = args[0].as<string>();
-            transform(_codecName.begin(), _codecName.end(), _codecName.begin(), ::tolower);
+            auto codecName = args[0].as<string>();
+            transform(codecName.begin(), codecName.end(), codecName.begin(), ::tolower);
+            lock_guard<mutex> lock(_queueMutex);
+            _codecName = codecName;
             _resetEncoding = true;
             return true;
         },
@@ -275,6 +401,7 @@ void Sink_Shmdata_Encoded::registerAttributes()
 
     addAttribute("codecOptions",
         [&](const Values& args) {
+            lock_guard<mutex> lock(_queueMutex);
             _options = args[0].as<string>();
             _resetEncoding = true;
             return true;
@@ -286,10 +413,21 @@ void Sink_Shmdata_Encoded::registerAttributes()
         "Options can be listed with the following terminal command:\n"
         "$ ffmpeg -h encoder=ENCODER_NAME");
 
+    addAttribute("queueSize",
+        [&](const Values& args) {
+            lock_guard<mutex> lock(_queueMutex);
+            _queueSize = std::max(1, args[0].as<int>());
+            return true;
+        },
+        [&]() -> Values { return {static_cast<int>(_queueSize)}; },
+        {'n'});
+    setAttributeDescription("queueSize", "Maximum number of frames waiting to be encoded");
+
     addAttribute("socket",
         [&](const Values& args) {
+            lock_guard<mutex> lock(_queueMutex);
             _path = args[0].as<string>();
-            _previousSpec = ImageBufferSpec();
+            _resetEncoding = true;
             return true;
         },
         [&]() -> Values { return {_path}; },
@@ -25,6 +25,11 @@
 #ifndef SPLASH_SINK_SHMDATA_ENCODED_H
 #define SPLASH_SINK_SHMDATA_ENCODED_H
 
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
 #include <unordered_map>
 
 #include <shmdata/writer.hpp>
@@ -34,9 +39,10 @@ extern "C" {
 #include <libavformat/avformat.h>
 #include <libavutil/imgutils.h>
 #include <libavutil/opt.h>
-#include <libswscale/swscale.h>
 }
 
+#include "./core/imagebuffer_pool.h"
+#include "./utils/latencystats.h"
 #include "./utils/osutils.h"
 #include "./sink/sink.h"
 
@@ -63,13 +69,23 @@ class Sink_Shmdata_Encoded : public Sink
     std::unique_ptr<shmdata::Writer> _writer{nullptr};
     ImageBufferSpec _previousSpec{};
     uint32_t _previousFramerate{0};
-    bool _resetEncoding{false};
+    std::atomic_bool _resetEncoding{false};
+
+    // Frames are converted and encoded in a dedicated thread, so that the encoder never holds the render loop
+    std::thread _encodeThread{};
+    std::atomic_bool _encodeContinue{true};
+    std::mutex _queueMutex{}; //!< Also protects the parameters set through attributes: path, codec, options, bitrate
+    std::condition_variable _queueCondition{};
+    std::deque<std::unique_ptr<ImageBuffer>> _queue{};
+    std::shared_ptr<ImageBufferPool> _framePool{std::make_shared<ImageBufferPool>()};
+    uint32_t _queueSize{2};        //!< Maximum number of frames waiting for the encoder
+    bool _dropOldest{true};        //!< If true, the oldest queued frame is dropped when the queue is full, otherwise the new frame is
+    LatencyStats _encodeLatency{}; //!< Delay between the read back of a frame and its output
 
     // FFmpeg objects
     AVCodec* _codec{nullptr};
     AVCodecContext* _context{nullptr};
-    AVFrame *_frame{nullptr}, *_yuvFrame{nullptr};
-    SwsContext* _swsContext{nullptr};
+    AVFrame* _yuvFrame{nullptr};
     AVPacket _packet;
 
     // Codec parameters
@@ -79,6 +95,17 @@ class Sink_Shmdata_Encoded : public Sink
     double _framerate{30.0};
     std::string _options{"profile=baseline"};
 
+    /**
+     * Encoding loop, converting and encoding the queued frames
+     */
+    void encodeLoop();
+
+    /**
+     * Convert, encode and send a frame
+     * \param frame Frame, read back as RGBA
+     */
+    void encodeFrame(const ImageBuffer& frame);
+
     /**
      * Find an encoder base on its name
      * \param encoderName Codec name
@@ -89,9 +116,13 @@ class Sink_Shmdata_Encoded : public Sink
     /**
      * Init FFmpeg objects
      * \param spec Input image specifications
+     * \param codecName Codec name
+     * \param optionString String of the options sent to the encoder
+     * \param bitRate Target bitrate
+     * \param framerate Expected framerate
      * \return Return true if all went well
      */
-    bool initFFmpegObjects(const ImageBufferSpec& spec);
+    bool initFFmpegObjects(const ImageBufferSpec& spec, const std::string& codecName, const std::string& optionString, int bitRate, double framerate);
 
     /**
      * Free everything related to FFmpeg
@@ -110,7 +141,7 @@ class Sink_Shmdata_Encoded : public Sink
     std::string generateCaps(const ImageBufferSpec& spec, uint32_t framerate, const std::string& optionString, const std::string& codecName, AVCodecContext* ctx);
 
     /**
-     * Class to be implemented to copy the _mappedPixels somewhere
+     * Queue the pixels for the encoding thread
      * \param pixels Input image
      * \param spec Input image specifications
      */
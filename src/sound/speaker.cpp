@@ -1,5 +1,7 @@
 #include "./sound/speaker.h"
 
+#include <cstring>
+
 #include "./utils/log.h"
 #include "./utils/timer.h"
 
@@ -24,10 +26,24 @@ Speaker::~Speaker()
 /*************/
 void Speaker::clearQueue()
 {
-    std::lock_guard<std::mutex> lock(_ringWriteMutex);
-    _ringReadPosition = 0;
-    _ringWritePosition = 0;
-    _ringUnusedSpace = 0;
+    _queueEndTiming = -1;
+    _ringBuffer.flush();
+}
+
+/*************/
+int64_t Speaker::getPlaybackTime() const
+{
+    auto queueEndTiming = _queueEndTiming.load();
+    if (!_ready || queueEndTiming < 0)
+        return -1;
+
+    // An empty queue means that the output is playing silence, so the position is unknown
+    auto queuedBytes = static_cast<int64_t>(_ringBuffer.getSize());
+    if (queuedBytes == 0)
+        return -1;
+
+    auto bytesPerSecond = static_cast<int64_t>(_sampleRate * _channels * _sampleSize);
+    return queueEndTiming - queuedBytes * 1000000 / bytesPerSecond - _outputLatency;
 }
 
 /*************/
@@ -75,7 +91,7 @@ void Speaker::initResources()
 
 /*************/
 int Speaker::portAudioCallback(
-    const void* /*in*/, void* out, uint64_t framesPerBuffer, const PaStreamCallbackTimeInfo* /*timeInfo*/, PaStreamCallbackFlags /*statusFlags*/, void* userData)
+    const void* /*in*/, void* out, uint64_t framesPerBuffer, const PaStreamCallbackTimeInfo* timeInfo, PaStreamCallbackFlags /*statusFlags*/, void* userData)
 {
     auto that = static_cast<Speaker*>(userData);
     uint8_t* output = (uint8_t*)out;
@@ -83,42 +99,20 @@ int Speaker::portAudioCallback(
     if (!output)
         return paContinue;
 
-    int readPosition = that->_ringReadPosition;
-    int writePosition = that->_ringWritePosition;
+    if (timeInfo && timeInfo->outputBufferDacTime > timeInfo->currentTime)
+        that->_outputLatency = static_cast<int64_t>((timeInfo->outputBufferDacTime - timeInfo->currentTime) * 1e6);
 
     // If the ring buffer is not filled enough, fill with zeros instead
-    int delta = 0;
-    if (writePosition >= readPosition)
-        delta = writePosition - readPosition;
-    else
-        delta = SPLASH_SPEAKER_RINGBUFFER_SIZE - readPosition + writePosition;
-    int step = framesPerBuffer * that->_channels * that->_sampleSize;
-
-    if (delta < step)
+    size_t step = framesPerBuffer * that->_channels * that->_sampleSize;
+    if (that->_ringBuffer.getReadSpace() < step)
     {
-        for (int i = 0; i < step; ++i)
-            *output++ = 0;
+        memset(output, 0, step);
     }
     // Else, we copy the values and move the read position
     else
     {
-        int effectiveSpace = SPLASH_SPEAKER_RINGBUFFER_SIZE - that->_ringUnusedSpace;
-
-        int ringBufferEndLength = effectiveSpace - readPosition;
-
-        if (step <= ringBufferEndLength)
-        {
-            copy(&that->_ringBuffer[readPosition], &that->_ringBuffer[readPosition + step], output);
-        }
-        else
-        {
-            copy(&that->_ringBuffer[readPosition], &that->_ringBuffer[effectiveSpace], output);
-            output += ringBufferEndLength;
-            copy(&that->_ringBuffer[0], &that->_ringBuffer[step - ringBufferEndLength], output);
-        }
-
-        readPosition = (readPosition + step) % effectiveSpace;
-        that->_ringReadPosition = readPosition;
+        that->_ringBuffer.copyOut(0, output, step);
+        that->_ringBuffer.commitRead(step);
     }
 
     if (that->_abortCallback)
@@ -27,15 +27,15 @@
 
 #define SPLASH_SPEAKER_RINGBUFFER_SIZE (4 * 1024 * 1024)
 
-#include <array>
 #include <atomic>
+#include <cstring>
 #include <memory>
-#include <mutex>
 #include <vector>
 
 #include "./config.h"
 #include "./core/attribute.h"
 #include "./core/graph_object.h"
+#include "./core/ring_buffer.h"
 #include "./sound/sound_engine.h"
 
 namespace Splash
@@ -67,18 +67,31 @@ class Speaker : public GraphObject
     Speaker& operator=(const Speaker&) = delete;
 
     /**
-     * \brief Add a buffer to the playing queue
+     * \brief Add a buffer to the playing queue. Lock-free and allocation-free, to be called from a single thread
      * \param buffer Buffer to add
-     * \return Return false if there was an error
+     * \param size Buffer size, in elements
+     * \param timing Media timestamp of the buffer start in us, used to compute the playback time. Negative if unknown
+     * \return Return false if there was not enough room left in the queue
      */
     template <typename T>
-    bool addToQueue(const ResizableArray<T>& buffer);
+    bool addToQueue(const T* buffer, size_t size, int64_t timing = -1);
+    template <typename T>
+    bool addToQueue(const ResizableArray<T>& buffer)
+    {
+        return addToQueue(buffer.data(), buffer.size());
+    }
 
     /**
-     * \brief Clear the queue
+     * \brief Clear the queue. The data is dropped by the output callback, the next time it runs
      */
     void clearQueue();
 
+    /**
+     * \brief Get the media timestamp of the sample currently heard, from the samples consumed by the output and its latency
+     * \return Return the playback time in us, or -1 if unknown or if the queue ran dry
+     */
+    int64_t getPlaybackTime() const;
+
     /**
      * \brief Set the audio parameters
      * \param channels Channel count
@@ -97,13 +110,13 @@ class Speaker : public GraphObject
     size_t _sampleSize{2};
     std::string _deviceName{""};
 
-    bool _abortCallback{false};
+    std::atomic_bool _abortCallback{false};
 
-    std::array<uint8_t, SPLASH_SPEAKER_RINGBUFFER_SIZE> _ringBuffer;
-    std::atomic_int _ringWritePosition{0};
-    std::atomic_int _ringReadPosition{0};
-    std::atomic_int _ringUnusedSpace{0};
-    std::mutex _ringWriteMutex;
+    // Shared between addToQueue and the PortAudio callback, which must never block
+    RingBuffer<uint8_t> _ringBuffer{SPLASH_SPEAKER_RINGBUFFER_SIZE};
+    std::atomic<int64_t> _queueEndTiming{-1}; //!< Media timestamp of the end of the queued data, in us
+    std::atomic<int64_t> _outputLatency{0};   //!< Delay between the callback and the samples being heard, in us
+    std::vector<uint8_t> _interleavedBuffer{}; //!< Planar input is interleaved here before being queued, only used by addToQueue
 
     /**
      * \brief Free all PortAudio resources
@@ -115,6 +128,16 @@ class Speaker : public GraphObject
      */
     void initResources();
 
+    /**
+     * \brief Interleave planar samples
+     * \param planes Input planes, one after the other
+     * \param out Output buffer
+     * \param sampleNbr Sample count per channel
+     * \param channels Channel count
+     */
+    template <typename S>
+    static void interleave(const uint8_t* planes, uint8_t* out, size_t sampleNbr, unsigned int channels);
+
     /**
      * \brief PortAudio callback
      * \param in Unused
@@ -134,57 +157,60 @@ class Speaker : public GraphObject
 
 /*************/
 template <typename T>
-bool Speaker::addToQueue(const ResizableArray<T>& buffer)
+bool Speaker::addToQueue(const T* buffer, size_t size, int64_t timing)
 {
-    std::lock_guard<std::mutex> lock(_ringWriteMutex);
+    auto byteSize = size * sizeof(T);
+    auto bytes = reinterpret_cast<const uint8_t*>(buffer);
 
-    // If the input buffer is planar, we need to interlace it
-    ResizableArray<T> interleavedBuffer(buffer.size());
+    if (_ringBuffer.getWriteSpace() < byteSize)
+        return false;
+
+    // If the input buffer is planar, it is interleaved before being copied into the ring buffer in one go
     if (_planar)
     {
-        size_t step = _sampleSize / sizeof(T);
-        uint32_t sampleNbr = (buffer.size() / step) / _channels;
-        int linesize = sampleNbr * step;
-        for (uint32_t channel = 0; channel < _channels; ++channel)
-            for (uint32_t sample = 0; sample < sampleNbr; ++sample)
-            {
-                int index = sample * step + channel * linesize;
-                std::copy(&buffer[index], &buffer[index + step], &interleavedBuffer[(sample * _channels + channel) * step]);
-            }
+        size_t sampleNbr = byteSize / _sampleSize / _channels;
+        byteSize = sampleNbr * _sampleSize * _channels;
+        if (_interleavedBuffer.size() < byteSize)
+            _interleavedBuffer.resize(byteSize);
+
+        auto interleaved = _interleavedBuffer.data();
+        if (_sampleSize == 1)
+            interleave<uint8_t>(bytes, interleaved, sampleNbr, _channels);
+        else if (_sampleSize == 2)
+            interleave<uint16_t>(bytes, interleaved, sampleNbr, _channels);
+        else
+            interleave<uint32_t>(bytes, interleaved, sampleNbr, _channels);
+        _ringBuffer.copyIn(0, interleaved, byteSize);
     }
-
-    auto bufferSampleSize = sizeof(T);
-    int readPosition = _ringReadPosition;
-    int writePosition = _ringWritePosition;
-
-    int delta = 0;
-    if (readPosition > writePosition)
-        delta = readPosition - writePosition;
     else
-        delta = SPLASH_SPEAKER_RINGBUFFER_SIZE - writePosition + readPosition;
-
-    if (delta < static_cast<int>(buffer.size() * bufferSampleSize))
-        return false;
+    {
+        _ringBuffer.copyIn(0, bytes, byteSize);
+    }
 
-    int spaceLeft = SPLASH_SPEAKER_RINGBUFFER_SIZE - writePosition;
+    _ringBuffer.commitWrite(byteSize);
 
-    const uint8_t* bufferPtr;
-    if (_planar)
-        bufferPtr = static_cast<const uint8_t*>(interleavedBuffer.data());
+    if (timing < 0)
+        _queueEndTiming = -1;
     else
-        bufferPtr = static_cast<const uint8_t*>(buffer.data());
+        _queueEndTiming = timing + static_cast<int64_t>(byteSize) * 1000000 / (_sampleRate * _channels * _sampleSize);
 
-    if (spaceLeft < static_cast<int>(buffer.size() * bufferSampleSize))
+    return true;
+}
+
+/*************/
+template <typename S>
+void Speaker::interleave(const uint8_t* planes, uint8_t* out, size_t sampleNbr, unsigned int channels)
+{
+    for (unsigned int channel = 0; channel < channels; ++channel)
     {
-        _ringUnusedSpace = spaceLeft;
-        writePosition = 0;
+        auto plane = planes + channel * sampleNbr * sizeof(S);
+        for (size_t sample = 0; sample < sampleNbr; ++sample)
+        {
+            S value;
+            memcpy(&value, plane + sample * sizeof(S), sizeof(S));
+            memcpy(out + (sample * channels + channel) * sizeof(S), &value, sizeof(S));
+        }
     }
-
-    std::copy(bufferPtr, bufferPtr + buffer.size() * bufferSampleSize, &_ringBuffer[writePosition]);
-    writePosition = (writePosition + buffer.size() * bufferSampleSize);
-
-    _ringWritePosition = writePosition;
-    return true;
 }
 
 } // end of namespace
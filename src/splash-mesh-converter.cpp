@@ -0,0 +1,123 @@
+/*
+ * Copyright (C) 2018 Emmanuel Durand
+ *
+ * This file is part of Splash.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Splash is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Splash.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * @splash-mesh-converter.cpp
+ * A tool to convert OBJ files to Splash binary meshes
+ */
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "./mesh/meshloader.h"
+#include "./utils/log.h"
+
+using namespace std;
+using namespace Splash;
+
+/*************/
+struct Parameters
+{
+    bool valid{true};
+    string input{""};
+    string output{""};
+    bool quantize{false};
+};
+
+/*************/
+void showHelp()
+{
+    cout << "Splash mesh converter" << endl;
+    cout << "Converts an OBJ file to a Splash binary mesh, loadable as any mesh file" << endl;
+    cout << "If the output is the input file name followed by " << Loader::Binary::extension << ", it is used as the cache for the OBJ file" << endl;
+    cout << endl;
+    cout << "Usage:" << endl;
+    cout << " --help (-h): this very help" << endl;
+    cout << " -i (--input) [filename]: OBJ file to convert" << endl;
+    cout << " -o (--output) [filename]: output binary mesh, defaults to the input file name followed by " << Loader::Binary::extension << endl;
+    cout << " -q (--quantize): store the attributes on 16 bits, the fourth vertex coordinate is then lost" << endl;
+
+    exit(0);
+}
+
+/*************/
+Parameters parseArgs(int argc, char** argv)
+{
+    Parameters params;
+
+    if (argc == 1)
+        showHelp();
+
+    for (int i = 1; i < argc; ++i)
+    {
+        auto arg = string(argv[i]);
+        if ((arg == "-i" || arg == "--input") && i < argc - 1)
+            params.input = string(argv[++i]);
+        else if ((arg == "-o" || arg == "--output") && i < argc - 1)
+            params.output = string(argv[++i]);
+        else if (arg == "-q" || arg == "--quantize")
+            params.quantize = true;
+        else if (arg == "-h" || arg == "--help")
+            showHelp();
+    }
+
+    if (params.input.empty())
+    {
+        params.valid = false;
+        Log::get() << Log::WARNING << "Please specify an input file." << Log::endl;
+    }
+
+    if (params.output.empty())
+        params.output = params.input + Loader::Binary::extension;
+
+    return params;
+}
+
+/*************/
+int main(int argc, char** argv)
+{
+    auto params = parseArgs(argc, argv);
+    if (!params.valid)
+        return 1;
+
+    Loader::Binary::Source source;
+    Loader::Obj objLoader;
+    if (!Loader::Binary::getSource(params.input, source) || !objLoader.load(params.input))
+    {
+        Log::get() << Log::WARNING << "Could not read file " << params.input << Log::endl;
+        return 1;
+    }
+
+    vector<glm::vec4> vertices;
+    vector<glm::vec2> uvs;
+    vector<glm::vec3> normals;
+    vector<uint32_t> indices;
+    objLoader.getIndexedMesh(vertices, uvs, normals, indices);
+
+    if (!Loader::Binary::write(params.output, vertices, uvs, normals, indices, params.quantize, source))
+    {
+        Log::get() << Log::WARNING << "Could not write file " << params.output << Log::endl;
+        return 1;
+    }
+
+    cout << "Converted " << indices.size() / 3 << " triangles and " << vertices.size() << " vertices to " << params.output << endl;
+
+    return 0;
+}
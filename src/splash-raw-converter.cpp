@@ -0,0 +1,369 @@
+/*
+ * Copyright (C) 2018 Emmanuel Durand
+ *
+ * This file is part of Splash.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Splash is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Splash.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * @splash-raw-converter.cpp
+ * A tool to convert any video file readable by FFmpeg to a Splash raw frames container
+ */
+
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+extern "C" {
+#include <libavcodec/avcodec.h>
+#include <libavformat/avformat.h>
+#include <libavutil/imgutils.h>
+#include <libswscale/swscale.h>
+}
+
+#include "./core/imagebuffer.h"
+#include "./image/raw_frames.h"
+#include "./utils/cgutils.h"
+#include "./utils/log.h"
+
+using namespace std;
+using namespace Splash;
+
+/*************/
+struct Parameters
+{
+    bool valid{true};
+    string input{""};
+    string output{""};
+    string format{"YUYV"};
+};
+
+/*************/
+void showHelp()
+{
+    cout << "Splash raw frames converter" << endl;
+    cout << "Converts a video file to a Splash raw frames container, playable with the image_raw media type" << endl;
+    cout << "Hap encoded videos are stored as DXT compressed frames, other codecs are decoded to the given format" << endl;
+    cout << endl;
+    cout << "Usage:" << endl;
+    cout << " --help (-h): this very help" << endl;
+    cout << " -i (--input) [filename]: video file to convert" << endl;
+    cout << " -o (--output) [filename]: output raw frames file" << endl;
+    cout << " -f (--format) [YUYV|RGBA]: pixel format for non-Hap videos, defaults to YUYV" << endl;
+
+    exit(0);
+}
+
+/*************/
+Parameters parseArgs(int argc, char** argv)
+{
+    Parameters params;
+
+    if (argc == 1)
+        showHelp();
+
+    for (int i = 1; i < argc; ++i)
+    {
+        auto arg = string(argv[i]);
+        if ((arg == "-i" || arg == "--input") && i < argc - 1)
+            params.input = string(argv[++i]);
+        else if ((arg == "-o" || arg == "--output") && i < argc - 1)
+            params.output = string(argv[++i]);
+        else if ((arg == "-f" || arg == "--format") && i < argc - 1)
+            params.format = string(argv[++i]);
+        else if (arg == "-h" || arg == "--help")
+            showHelp();
+    }
+
+    if (params.input.empty() || params.output.empty())
+    {
+        params.valid = false;
+        Log::get() << Log::WARNING << "Please specify both an input and an output file." << Log::endl;
+    }
+
+    if (params.format != "YUYV" && params.format != "RGBA")
+    {
+        params.valid = false;
+        Log::get() << Log::WARNING << "Unsupported output format " << params.format << ", use either YUYV or RGBA." << Log::endl;
+    }
+
+    return params;
+}
+
+/*************/
+class RawFramesWriter
+{
+  public:
+    RawFramesWriter(const string& filename)
+        : _file(filename, ios::out | ios::binary | ios::trunc)
+    {
+    }
+
+    bool isOpen() const { return _file.is_open(); }
+
+    /**
+     * Write a frame, the container header being set from the first frame
+     */
+    bool addFrame(const ImageBuffer& frame, int64_t timing, double framerate)
+    {
+        auto spec = frame.getSpec();
+        if (_index.empty())
+        {
+            _header = RawFrames::headerFromSpec(spec, framerate);
+            _nextOffset = RawFrames::alignment;
+        }
+        else if (spec.rawSize() != static_cast<int>(_header.frameSize) || spec.format != string(_header.format))
+        {
+            Log::get() << Log::WARNING << "Frame format changed in the middle of the video, which is not supported by the raw frames container." << Log::endl;
+            return false;
+        }
+
+        RawFrames::IndexEntry entry;
+        entry.offset = _nextOffset;
+        entry.timing = timing;
+        _index.push_back(entry);
+
+        _file.seekp(entry.offset);
+        _file.write(frame.data(), _header.frameSize);
+        _nextOffset += RawFrames::alignedSize(_header.frameSize);
+
+        return static_cast<bool>(_file);
+    }
+
+    /**
+     * Write the index and the final header
+     */
+    bool finalize()
+    {
+        if (_index.empty())
+            return false;
+
+        _header.frameCount = _index.size();
+        _header.indexOffset = _nextOffset;
+
+        _file.seekp(_header.indexOffset);
+        _file.write(reinterpret_cast<const char*>(_index.data()), _index.size() * sizeof(RawFrames::IndexEntry));
+
+        // Pad the file so that the index can also be read with aligned I/O
+        auto indexSize = _index.size() * sizeof(RawFrames::IndexEntry);
+        auto padding = vector<char>(RawFrames::alignedSize(indexSize) - indexSize, 0);
+        _file.write(padding.data(), padding.size());
+
+        auto header = vector<char>(RawFrames::alignment, 0);
+        memcpy(header.data(), &_header, sizeof(_header));
+        _file.seekp(0);
+        _file.write(header.data(), header.size());
+
+        return static_cast<bool>(_file);
+    }
+
+    size_t getFrameCount() const { return _index.size(); }
+
+  private:
+    ofstream _file;
+    RawFrames::Header _header{};
+    vector<RawFrames::IndexEntry> _index{};
+    uint64_t _nextOffset{RawFrames::alignment};
+};
+
+/*************/
+string tagToFourCC(unsigned int tag)
+{
+    string fourcc;
+    for (int i = 0; i < 4; ++i)
+        fourcc.push_back(static_cast<char>((tag >> (8 * i)) & 0xFF));
+    return fourcc;
+}
+
+/*************/
+int main(int argc, char** argv)
+{
+    auto params = parseArgs(argc, argv);
+    if (!params.valid)
+        return 1;
+
+    av_register_all();
+
+    AVFormatContext* avContext = nullptr;
+    if (avformat_open_input(&avContext, params.input.c_str(), nullptr, nullptr) != 0 || avformat_find_stream_info(avContext, nullptr) < 0)
+    {
+        Log::get() << Log::WARNING << "Could not read file " << params.input << Log::endl;
+        return 1;
+    }
+
+    int videoStreamIndex = -1;
+    for (uint32_t i = 0; i < avContext->nb_streams; ++i)
+    {
+        if (avContext->streams[i]->codecpar->codec_type == AVMEDIA_TYPE_VIDEO)
+        {
+            videoStreamIndex = i;
+            break;
+        }
+    }
+
+    if (videoStreamIndex == -1)
+    {
+        Log::get() << Log::WARNING << "No video stream found in file " << params.input << Log::endl;
+        avformat_close_input(&avContext);
+        return 1;
+    }
+
+    auto videoStream = avContext->streams[videoStreamIndex];
+    auto codecContext = avcodec_alloc_context3(nullptr);
+    avcodec_parameters_to_context(codecContext, videoStream->codecpar);
+    codecContext->thread_count = 0; // Let FFmpeg choose
+
+    auto isHap = tagToFourCC(codecContext->codec_tag).find("Hap") != string::npos;
+    auto codec = avcodec_find_decoder(codecContext->codec_id);
+    if (!isHap && (!codec || avcodec_open2(codecContext, codec, nullptr) < 0))
+    {
+        Log::get() << Log::WARNING << "Video codec not supported for file " << params.input << Log::endl;
+        avcodec_free_context(&codecContext);
+        avformat_close_input(&avContext);
+        return 1;
+    }
+
+    auto timeBase = av_q2d(videoStream->time_base);
+    auto framerate = av_q2d(videoStream->avg_frame_rate);
+    if (framerate <= 0.0)
+        framerate = 30.0;
+
+    if (!RawFrames::isLittleEndian())
+    {
+        Log::get() << Log::WARNING << "Raw frames containers can only be written on little-endian hosts" << Log::endl;
+        avcodec_free_context(&codecContext);
+        avformat_close_input(&avContext);
+        return 1;
+    }
+
+    RawFramesWriter writer(params.output);
+    if (!writer.isOpen())
+    {
+        Log::get() << Log::WARNING << "Could not open file " << params.output << " for writing" << Log::endl;
+        avcodec_free_context(&codecContext);
+        avformat_close_input(&avContext);
+        return 1;
+    }
+
+    auto pixelFormat = params.format == "RGBA" ? AV_PIX_FMT_RGBA : AV_PIX_FMT_YUYV422;
+    SwsContext* swsContext = nullptr;
+    auto frame = av_frame_alloc();
+    bool success = true;
+    size_t lastReportedCount = 0;
+
+    AVPacket packet;
+    av_init_packet(&packet);
+
+    auto writeDecodedFrame = [&]() {
+        if (!swsContext)
+            swsContext = sws_getContext(codecContext->width,
+                codecContext->height,
+                codecContext->pix_fmt,
+                codecContext->width,
+                codecContext->height,
+                pixelFormat,
+                SWS_BICUBIC,
+                nullptr,
+                nullptr,
+                nullptr);
+
+        ImageBufferSpec spec;
+        if (pixelFormat == AV_PIX_FMT_RGBA)
+            spec = ImageBufferSpec(codecContext->width, codecContext->height, 4, 32, ImageBufferSpec::Type::UINT8, "RGBA");
+        else
+            spec = ImageBufferSpec(codecContext->width, codecContext->height, 3, 16, ImageBufferSpec::Type::UINT8, "YUYV");
+        ImageBuffer img(spec);
+
+        uint8_t* dstData[4] = {reinterpret_cast<uint8_t*>(img.data()), nullptr, nullptr, nullptr};
+        int dstLinesize[4] = {static_cast<int>(spec.width * spec.pixelBytes()), 0, 0, 0};
+        sws_scale(swsContext, (const uint8_t* const*)frame->data, frame->linesize, 0, codecContext->height, dstData, dstLinesize);
+
+        auto timing = static_cast<int64_t>(av_frame_get_best_effort_timestamp(frame) * timeBase * 1e6);
+        success &= writer.addFrame(img, timing, framerate);
+        av_frame_unref(frame);
+    };
+
+    while (success && av_read_frame(avContext, &packet) >= 0)
+    {
+        if (packet.stream_index != videoStreamIndex)
+        {
+            av_packet_unref(&packet);
+            continue;
+        }
+
+        if (isHap)
+        {
+            string textureFormat;
+            if (hapDecodeFrame(packet.data, packet.size, nullptr, 0, textureFormat))
+            {
+                // Same layout as the one used by Image_FFmpeg for Hap frames
+                ImageBufferSpec spec;
+                if (textureFormat == "RGB_DXT1")
+                    spec = ImageBufferSpec(codecContext->width, (int)(ceil((float)codecContext->height / 2.f)), 1, 8, ImageBufferSpec::Type::UINT8, textureFormat);
+                else
+                    spec = ImageBufferSpec(codecContext->width, codecContext->height, 1, 8, ImageBufferSpec::Type::UINT8, textureFormat);
+
+                ImageBuffer img(spec);
+                if (hapDecodeFrame(packet.data, packet.size, img.data(), spec.rawSize(), textureFormat))
+                {
+                    auto timing = packet.pts != AV_NOPTS_VALUE ? static_cast<int64_t>(packet.pts * timeBase * 1e6) : 0;
+                    success &= writer.addFrame(img, timing, framerate);
+                }
+            }
+        }
+        else
+        {
+            if (avcodec_send_packet(codecContext, &packet) < 0)
+                Log::get() << Log::WARNING << "Error while decoding a frame in file " << params.input << Log::endl;
+            while (success && avcodec_receive_frame(codecContext, frame) == 0)
+                writeDecodedFrame();
+        }
+
+        av_packet_unref(&packet);
+
+        if (writer.getFrameCount() >= lastReportedCount + 100)
+        {
+            lastReportedCount = writer.getFrameCount();
+            Log::get() << Log::MESSAGE << "Converted " << lastReportedCount << " frames" << Log::endl;
+        }
+    }
+
+    // Flush the decoder
+    if (!isHap && success)
+    {
+        avcodec_send_packet(codecContext, nullptr);
+        while (success && avcodec_receive_frame(codecContext, frame) == 0)
+            writeDecodedFrame();
+    }
+
+    success &= writer.finalize();
+
+    av_frame_free(&frame);
+    if (swsContext)
+        sws_freeContext(swsContext);
+    avcodec_free_context(&codecContext);
+    avformat_close_input(&avContext);
+
+    if (!success)
+    {
+        Log::get() << Log::WARNING << "An error occured while writing file " << params.output << Log::endl;
+        return 1;
+    }
+
+    Log::get() << Log::MESSAGE << "Wrote " << writer.getFrameCount() << " frames to " << params.output << Log::endl;
+    return 0;
+}
@@ -1,7 +1,12 @@
 #include "./utils/cgutils.h"
 
+#include <algorithm>
+#include <cfloat>
+#include <cstring>
 #include <future>
 
+#include "./utils/osutils.h"
+
 using namespace std;
 
 namespace Splash
@@ -49,4 +54,222 @@ bool hapDecodeFrame(void* in, unsigned int inSize, void* out, unsigned int outSi
     return true;
 }
 
+namespace
+{
+
+/*************/
+// Pack a RGB color to 565
+uint16_t dxtPack565(const uint8_t* rgb)
+{
+    return ((static_cast<uint16_t>(rgb[0]) * 31 + 127) / 255) << 11 | ((static_cast<uint16_t>(rgb[1]) * 63 + 127) / 255) << 5 | ((static_cast<uint16_t>(rgb[2]) * 31 + 127) / 255);
+}
+
+/*************/
+// Unpack a 565 color to RGB
+void dxtUnpack565(uint16_t color, float* rgb)
+{
+    rgb[0] = static_cast<float>((color >> 11) & 31) * 255.f / 31.f;
+    rgb[1] = static_cast<float>((color >> 5) & 63) * 255.f / 63.f;
+    rgb[2] = static_cast<float>(color & 31) * 255.f / 31.f;
+}
+
+/*************/
+// Compress 16 RGBA pixels to a DXT1 color block, with endpoints along the principal axis of the colors
+void dxtCompressColorBlock(const uint8_t* block, uint8_t* out)
+{
+    float mean[3] = {0.f, 0.f, 0.f};
+    for (int i = 0; i < 16; ++i)
+        for (int c = 0; c < 3; ++c)
+            mean[c] += static_cast<float>(block[i * 4 + c]) / 16.f;
+
+    // Covariance matrix, stored as xx, xy, xz, yy, yz, zz
+    float cov[6] = {0.f, 0.f, 0.f, 0.f, 0.f, 0.f};
+    for (int i = 0; i < 16; ++i)
+    {
+        float d[3];
+        for (int c = 0; c < 3; ++c)
+            d[c] = static_cast<float>(block[i * 4 + c]) - mean[c];
+        cov[0] += d[0] * d[0];
+        cov[1] += d[0] * d[1];
+        cov[2] += d[0] * d[2];
+        cov[3] += d[1] * d[1];
+        cov[4] += d[1] * d[2];
+        cov[5] += d[2] * d[2];
+    }
+
+    // Power iteration to get the principal axis
+    float axis[3] = {1.f, 1.f, 1.f};
+    for (int iteration = 0; iteration < 8; ++iteration)
+    {
+        float x = cov[0] * axis[0] + cov[1] * axis[1] + cov[2] * axis[2];
+        float y = cov[1] * axis[0] + cov[3] * axis[1] + cov[4] * axis[2];
+        float z = cov[2] * axis[0] + cov[4] * axis[1] + cov[5] * axis[2];
+        float norm = max(abs(x), max(abs(y), abs(z)));
+        if (norm < 1e-6f)
+            break;
+        axis[0] = x / norm;
+        axis[1] = y / norm;
+        axis[2] = z / norm;
+    }
+
+    // Endpoints are the pixels with the extreme projections on the axis
+    float minProjection = FLT_MAX;
+    float maxProjection = -FLT_MAX;
+    int minIndex = 0;
+    int maxIndex = 0;
+    for (int i = 0; i < 16; ++i)
+    {
+        float projection = 0.f;
+        for (int c = 0; c < 3; ++c)
+            projection += (static_cast<float>(block[i * 4 + c]) - mean[c]) * axis[c];
+        if (projection < minProjection)
+        {
+            minProjection = projection;
+            minIndex = i;
+        }
+        if (projection > maxProjection)
+        {
+            maxProjection = projection;
+            maxIndex = i;
+        }
+    }
+
+    uint16_t color0 = dxtPack565(&block[maxIndex * 4]);
+    uint16_t color1 = dxtPack565(&block[minIndex * 4]);
+    // color0 > color1 selects the four colors mode
+    if (color0 < color1)
+        std::swap(color0, color1);
+
+    uint32_t indices = 0;
+    if (color0 != color1)
+    {
+        float palette[4][3];
+        dxtUnpack565(color0, palette[0]);
+        dxtUnpack565(color1, palette[1]);
+        for (int c = 0; c < 3; ++c)
+        {
+            palette[2][c] = (2.f * palette[0][c] + palette[1][c]) / 3.f;
+            palette[3][c] = (palette[0][c] + 2.f * palette[1][c]) / 3.f;
+        }
+
+        for (int i = 0; i < 16; ++i)
+        {
+            uint32_t bestIndex = 0;
+            float bestDistance = FLT_MAX;
+            for (uint32_t p = 0; p < 4; ++p)
+            {
+                float distance = 0.f;
+                for (int c = 0; c < 3; ++c)
+                {
+                    float d = static_cast<float>(block[i * 4 + c]) - palette[p][c];
+                    distance += d * d;
+                }
+                if (distance < bestDistance)
+                {
+                    bestDistance = distance;
+                    bestIndex = p;
+                }
+            }
+            indices |= bestIndex << (2 * i);
+        }
+    }
+
+    out[0] = color0 & 0xFF;
+    out[1] = color0 >> 8;
+    out[2] = color1 & 0xFF;
+    out[3] = color1 >> 8;
+    for (int b = 0; b < 4; ++b)
+        out[4 + b] = (indices >> (8 * b)) & 0xFF;
+}
+
+/*************/
+// Compress the alpha of 16 RGBA pixels to a DXT5 alpha block
+void dxtCompressAlphaBlock(const uint8_t* block, uint8_t* out)
+{
+    uint8_t alpha0 = 0;
+    uint8_t alpha1 = 255;
+    for (int i = 0; i < 16; ++i)
+    {
+        alpha0 = max(alpha0, block[i * 4 + 3]);
+        alpha1 = min(alpha1, block[i * 4 + 3]);
+    }
+
+    // alpha0 > alpha1 selects the eight values mode
+    uint64_t indices = 0;
+    if (alpha0 > alpha1)
+    {
+        float palette[8];
+        palette[0] = alpha0;
+        palette[1] = alpha1;
+        for (int p = 1; p < 7; ++p)
+            palette[p + 1] = (static_cast<float>(7 - p) * alpha0 + static_cast<float>(p) * alpha1) / 7.f;
+
+        for (int i = 0; i < 16; ++i)
+        {
+            uint64_t bestIndex = 0;
+            float bestDistance = FLT_MAX;
+            for (uint64_t p = 0; p < 8; ++p)
+            {
+                float distance = abs(static_cast<float>(block[i * 4 + 3]) - palette[p]);
+                if (distance < bestDistance)
+                {
+                    bestDistance = distance;
+                    bestIndex = p;
+                }
+            }
+            indices |= bestIndex << (3 * i);
+        }
+    }
+
+    out[0] = alpha0;
+    out[1] = alpha1;
+    for (int b = 0; b < 6; ++b)
+        out[2 + b] = (indices >> (8 * b)) & 0xFF;
+}
+
+} // namespace
+
+/*************/
+bool dxtCompressFrame(const uint8_t* rgba, unsigned int width, unsigned int height, bool withAlpha, uint8_t* out)
+{
+    if (!rgba || !out || width % 4 != 0 || height % 4 != 0)
+        return false;
+
+    const unsigned int blockSize = withAlpha ? 16 : 8;
+    const unsigned int blocksPerRow = width / 4;
+    const unsigned int blockRows = height / 4;
+
+    auto compressRows = [=](unsigned int firstRow, unsigned int lastRow) {
+        uint8_t block[64];
+        for (unsigned int blockY = firstRow; blockY < lastRow; ++blockY)
+        {
+            for (unsigned int blockX = 0; blockX < blocksPerRow; ++blockX)
+            {
+                for (unsigned int y = 0; y < 4; ++y)
+                    memcpy(block + y * 16, rgba + ((blockY * 4 + y) * width + blockX * 4) * 4, 16);
+
+                auto blockOut = out + (blockY * blocksPerRow + blockX) * blockSize;
+                if (withAlpha)
+                {
+                    dxtCompressAlphaBlock(block, blockOut);
+                    dxtCompressColorBlock(block, blockOut + 8);
+                }
+                else
+                {
+                    dxtCompressColorBlock(block, blockOut);
+                }
+            }
+        }
+    };
+
+    auto threadCount = max(1u, min(static_cast<unsigned int>(Utils::getCoreCount()), blockRows));
+    vector<future<void>> threads;
+    for (unsigned int t = 0; t < threadCount; ++t)
+        threads.push_back(async(launch::async, compressRows, blockRows * t / threadCount, blockRows * (t + 1) / threadCount));
+    for (auto& thread : threads)
+        thread.wait();
+
+    return true;
+}
+
 } // end of namespace
@@ -246,6 +246,13 @@ void hapDecodeCallback(HapDecodeWorkFunction func, void* p, unsigned int count,
 // If out is null, only sets the format
 bool hapDecodeFrame(void* in, unsigned int inSize, void* out, unsigned int outSize, std::string& format);
 
+/*************/
+// DXT
+/*************/
+// Compress a RGBA image to DXT1 (withAlpha == false) or DXT5 (withAlpha == true), on multiple threads
+// Width and height must be multiples of 4. Output size is width * height / 2 for DXT1, width * height for DXT5
+bool dxtCompressFrame(const uint8_t* rgba, unsigned int width, unsigned int height, bool withAlpha, uint8_t* out);
+
 } // end of namespace
 
 #endif
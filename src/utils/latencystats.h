@@ -0,0 +1,188 @@
+/*
+ * Copyright (C) 2018 Emmanuel Durand
+ *
+ * This file is part of Splash.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Splash is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Splash.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * @latencystats.h
+ * The LatencyStats class, gathering frame latency histograms and dropped / duplicated frame counters
+ */
+
+#ifndef SPLASH_LATENCYSTATS_H
+#define SPLASH_LATENCYSTATS_H
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+namespace Splash
+{
+
+/*************/
+class LatencyStats
+{
+  public:
+    /**
+     * \brief Get the upper bounds of the histogram buckets, in milliseconds. The last bucket holds everything above
+     * \return Return the bucket bounds
+     */
+    static std::vector<float> getBucketBounds() { return std::vector<float>(bucketBounds().begin(), bucketBounds().end()); }
+
+    /**
+     * \brief Add a latency sample
+     * \param latency Latency, in microseconds
+     */
+    void addSample(int64_t latency)
+    {
+        auto latencyMs = static_cast<float>(std::max<int64_t>(latency, 0)) / 1000.f;
+        auto& bounds = bucketBounds();
+        auto bucket = std::lower_bound(bounds.begin(), bounds.end(), latencyMs) - bounds.begin();
+
+        std::lock_guard<std::mutex> lock(_mutex);
+        ++_buckets[bucket];
+        ++_sampleCount;
+        _sum += latencyMs;
+        _last = latencyMs;
+        _max = std::max(_max, latencyMs);
+    }
+
+    /**
+     * \brief Count frames which never reached the output
+     * \param count Number of dropped frames
+     */
+    void addDropped(uint64_t count)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _dropped += count;
+    }
+
+    /**
+     * \brief Count a frame which has been output more than once
+     */
+    void addDuplicated()
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        ++_duplicated;
+    }
+
+    /**
+     * \brief Reset all statistics
+     */
+    void reset()
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _buckets.fill(0);
+        _sampleCount = 0;
+        _sum = 0.0;
+        _last = 0.f;
+        _max = 0.f;
+        _dropped = 0;
+        _duplicated = 0;
+    }
+
+    /**
+     * \brief Get the histogram, as the sample count for each bucket
+     * \return Return the histogram
+     */
+    std::vector<uint64_t> getHistogram() const
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return std::vector<uint64_t>(_buckets.begin(), _buckets.end());
+    }
+
+    /**
+     * \brief Estimate a percentile from the histogram, as the upper bound of the bucket containing it
+     * \param percentile Percentile, between 0 and 1
+     * \return Return the latency in milliseconds, or the maximum latency for the last bucket
+     */
+    float getPercentile(float percentile) const
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (_sampleCount == 0)
+            return 0.f;
+
+        auto target = static_cast<uint64_t>(std::max(1.f, percentile * _sampleCount));
+        auto& bounds = bucketBounds();
+        uint64_t count = 0;
+        for (size_t i = 0; i < bounds.size(); ++i)
+        {
+            count += _buckets[i];
+            if (count >= target)
+                return std::min(bounds[i], _max);
+        }
+
+        return _max;
+    }
+
+    /**
+     * \brief Get the last, mean and maximum latencies, in milliseconds
+     */
+    float getLast() const
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _last;
+    }
+
+    float getMean() const
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _sampleCount == 0 ? 0.f : static_cast<float>(_sum / _sampleCount);
+    }
+
+    float getMax() const
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _max;
+    }
+
+    /**
+     * \brief Get the dropped and duplicated frame counts
+     */
+    uint64_t getDroppedCount() const
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _dropped;
+    }
+
+    uint64_t getDuplicatedCount() const
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _duplicated;
+    }
+
+  private:
+    static const std::array<float, 12>& bucketBounds()
+    {
+        static const std::array<float, 12> bounds{{2.f, 4.f, 8.f, 16.f, 25.f, 33.f, 50.f, 66.f, 100.f, 150.f, 250.f, 500.f}};
+        return bounds;
+    }
+
+    mutable std::mutex _mutex{};
+    std::array<uint64_t, 13> _buckets{{}};
+    uint64_t _sampleCount{0};
+    double _sum{0.0};
+    float _last{0.f};
+    float _max{0.f};
+    uint64_t _dropped{0};
+    uint64_t _duplicated{0};
+};
+
+} // end of namespace
+
+#endif // SPLASH_LATENCYSTATS_H
@@ -0,0 +1,651 @@
+#include "./utils/pixelutils.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define SPLASH_PIXELUTILS_X86 1
+#include <immintrin.h>
+#define SPLASH_TARGET_SSE4 __attribute__((target("sse4.1")))
+#define SPLASH_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define SPLASH_PIXELUTILS_X86 0
+#endif
+
+using namespace std;
+
+namespace Splash
+{
+namespace PixelUtils
+{
+
+namespace
+{
+atomic_int currentSimdLevel{-1};
+
+// BT.601 limited range coefficients, in 8 bits fixed point
+const int yCoeffs[3] = {66, 129, 25};
+const int uCoeffs[3] = {-38, -74, 112};
+const int vCoeffs[3] = {112, -94, -18};
+
+/*************/
+// Scalar kernels, also used for the remainder of SIMD kernels
+/*************/
+void i420ToUyvyRowScalar(const uint8_t* y, const uint8_t* u, const uint8_t* v, uint8_t* out, uint32_t x, uint32_t width)
+{
+    for (; x + 1 < width; x += 2)
+    {
+        out[x * 2 + 0] = u[x / 2];
+        out[x * 2 + 1] = y[x];
+        out[x * 2 + 2] = v[x / 2];
+        out[x * 2 + 3] = y[x + 1];
+    }
+}
+
+/*************/
+void nv12ToUyvyRowScalar(const uint8_t* y, const uint8_t* uv, uint8_t* out, uint32_t x, uint32_t width)
+{
+    for (; x + 1 < width; x += 2)
+    {
+        out[x * 2 + 0] = uv[x];
+        out[x * 2 + 1] = y[x];
+        out[x * 2 + 2] = uv[x + 1];
+        out[x * 2 + 3] = y[x + 1];
+    }
+}
+
+/*************/
+void swapBytePairsScalar(const uint8_t* in, uint8_t* out, size_t index, size_t size)
+{
+    for (; index + 1 < size; index += 2)
+    {
+        auto first = in[index];
+        out[index] = in[index + 1];
+        out[index + 1] = first;
+    }
+}
+
+/*************/
+void rgbToRgbaScalar(const uint8_t* rgb, uint8_t* rgba, size_t index, size_t pixelCount)
+{
+    for (; index < pixelCount; ++index)
+    {
+        rgba[index * 4 + 0] = rgb[index * 3 + 0];
+        rgba[index * 4 + 1] = rgb[index * 3 + 1];
+        rgba[index * 4 + 2] = rgb[index * 3 + 2];
+        rgba[index * 4 + 3] = 255;
+    }
+}
+
+/*************/
+void swapRedBlueScalar(const uint8_t* in, uint8_t* out, size_t index, size_t pixelCount)
+{
+    for (; index < pixelCount; ++index)
+    {
+        auto red = in[index * 4 + 0];
+        out[index * 4 + 0] = in[index * 4 + 2];
+        out[index * 4 + 1] = in[index * 4 + 1];
+        out[index * 4 + 2] = red;
+        out[index * 4 + 3] = in[index * 4 + 3];
+    }
+}
+
+/*************/
+void rgbaToLumaRowScalar(const uint8_t* rgba, bool bgra, uint8_t* y, uint32_t x, uint32_t width)
+{
+    auto r = bgra ? 2 : 0;
+    auto b = bgra ? 0 : 2;
+    for (; x < width; ++x)
+    {
+        auto pixel = rgba + x * 4;
+        y[x] = ((yCoeffs[0] * pixel[r] + yCoeffs[1] * pixel[1] + yCoeffs[2] * pixel[b] + 128) >> 8) + 16;
+    }
+}
+
+/*************/
+void rgbaToChromaRowScalar(const uint8_t* row0, const uint8_t* row1, bool bgra, uint8_t* u, uint8_t* v, uint32_t x, uint32_t width)
+{
+    auto r = bgra ? 2 : 0;
+    auto b = bgra ? 0 : 2;
+    for (; x < width; x += 2)
+    {
+        // At an odd width, the last column is used twice
+        auto p00 = row0 + x * 4;
+        auto p01 = (x + 1 < width) ? p00 + 4 : p00;
+        auto p10 = row1 + x * 4;
+        auto p11 = (x + 1 < width) ? p10 + 4 : p10;
+        int red = (p00[r] + p01[r] + p10[r] + p11[r] + 2) >> 2;
+        int green = (p00[1] + p01[1] + p10[1] + p11[1] + 2) >> 2;
+        int blue = (p00[b] + p01[b] + p10[b] + p11[b] + 2) >> 2;
+        u[x / 2] = ((uCoeffs[0] * red + uCoeffs[1] * green + uCoeffs[2] * blue + 128) >> 8) + 128;
+        v[x / 2] = ((vCoeffs[0] * red + vCoeffs[1] * green + vCoeffs[2] * blue + 128) >> 8) + 128;
+    }
+}
+
+/*************/
+void downscaleRowScalar(const uint8_t* row0, const uint8_t* row1, uint8_t* out, uint32_t x, uint32_t outWidth)
+{
+    for (; x < outWidth; ++x)
+    {
+        for (int c = 0; c < 4; ++c)
+        {
+            auto left = (row0[x * 8 + c] + row1[x * 8 + c] + 1) >> 1;
+            auto right = (row0[x * 8 + 4 + c] + row1[x * 8 + 4 + c] + 1) >> 1;
+            out[x * 4 + c] = (left + right + 1) >> 1;
+        }
+    }
+}
+
+/*************/
+void channelSumsScalar(const uint8_t* rgba, size_t index, size_t pixelCount, uint64_t sums[4])
+{
+    for (; index < pixelCount; ++index)
+        for (int c = 0; c < 4; ++c)
+            sums[c] += rgba[index * 4 + c];
+}
+
+#if SPLASH_PIXELUTILS_X86
+/*************/
+// SSE4.1 kernels. They return the number of elements processed, the remainder being handled by the scalar kernels
+/*************/
+SPLASH_TARGET_SSE4 uint32_t i420ToUyvyRowSSE4(const uint8_t* y, const uint8_t* u, const uint8_t* v, uint8_t* out, uint32_t width)
+{
+    uint32_t x = 0;
+    for (; x + 16 <= width; x += 16)
+    {
+        auto uv = _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(u + x / 2)), _mm_loadl_epi64(reinterpret_cast<const __m128i*>(v + x / 2)));
+        auto luma = _mm_loadu_si128(reinterpret_cast<const __m128i*>(y + x));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + x * 2), _mm_unpacklo_epi8(uv, luma));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + x * 2 + 16), _mm_unpackhi_epi8(uv, luma));
+    }
+    return x;
+}
+
+/*************/
+SPLASH_TARGET_SSE4 uint32_t nv12ToUyvyRowSSE4(const uint8_t* y, const uint8_t* uv, uint8_t* out, uint32_t width)
+{
+    uint32_t x = 0;
+    for (; x + 16 <= width; x += 16)
+    {
+        auto chroma = _mm_loadu_si128(reinterpret_cast<const __m128i*>(uv + x));
+        auto luma = _mm_loadu_si128(reinterpret_cast<const __m128i*>(y + x));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + x * 2), _mm_unpacklo_epi8(chroma, luma));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + x * 2 + 16), _mm_unpackhi_epi8(chroma, luma));
+    }
+    return x;
+}
+
+/*************/
+SPLASH_TARGET_SSE4 size_t swapBytePairsSSE4(const uint8_t* in, uint8_t* out, size_t size)
+{
+    size_t index = 0;
+    for (; index + 16 <= size; index += 16)
+    {
+        auto pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + index));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + index), _mm_or_si128(_mm_slli_epi16(pixels, 8), _mm_srli_epi16(pixels, 8)));
+    }
+    return index;
+}
+
+/*************/
+SPLASH_TARGET_SSE4 size_t rgbToRgbaSSE4(const uint8_t* rgb, uint8_t* rgba, size_t pixelCount)
+{
+    const auto shuffle = _mm_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+    const auto alpha = _mm_set1_epi32(static_cast<int>(0xFF000000));
+    size_t index = 0;
+    // Each load reads 16 bytes but only uses 12, so we stop early enough not to read past the end
+    for (; index + 6 <= pixelCount; index += 4)
+    {
+        auto pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(rgb + index * 3));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(rgba + index * 4), _mm_or_si128(_mm_shuffle_epi8(pixels, shuffle), alpha));
+    }
+    return index;
+}
+
+/*************/
+SPLASH_TARGET_SSE4 size_t swapRedBlueSSE4(const uint8_t* in, uint8_t* out, size_t pixelCount)
+{
+    const auto shuffle = _mm_setr_epi8(2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15);
+    size_t index = 0;
+    for (; index + 4 <= pixelCount; index += 4)
+    {
+        auto pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + index * 4));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + index * 4), _mm_shuffle_epi8(pixels, shuffle));
+    }
+    return index;
+}
+
+/*************/
+SPLASH_TARGET_SSE4 inline __m128i rgbaToLuma4SSE4(const uint8_t* rgba, __m128i coeffs)
+{
+    const auto zero = _mm_setzero_si128();
+    auto pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(rgba));
+    auto low = _mm_madd_epi16(_mm_cvtepu8_epi16(pixels), coeffs);
+    auto high = _mm_madd_epi16(_mm_unpackhi_epi8(pixels, zero), coeffs);
+    auto luma = _mm_hadd_epi32(low, high);
+    return _mm_add_epi32(_mm_srai_epi32(_mm_add_epi32(luma, _mm_set1_epi32(128)), 8), _mm_set1_epi32(16));
+}
+
+/*************/
+SPLASH_TARGET_SSE4 uint32_t rgbaToLumaRowSSE4(const uint8_t* rgba, bool bgra, uint8_t* y, uint32_t width)
+{
+    const auto coeffs = bgra ? _mm_setr_epi16(yCoeffs[2], yCoeffs[1], yCoeffs[0], 0, yCoeffs[2], yCoeffs[1], yCoeffs[0], 0)
+                             : _mm_setr_epi16(yCoeffs[0], yCoeffs[1], yCoeffs[2], 0, yCoeffs[0], yCoeffs[1], yCoeffs[2], 0);
+    uint32_t x = 0;
+    for (; x + 16 <= width; x += 16)
+    {
+        auto first = _mm_packus_epi32(rgbaToLuma4SSE4(rgba + x * 4, coeffs), rgbaToLuma4SSE4(rgba + x * 4 + 16, coeffs));
+        auto second = _mm_packus_epi32(rgbaToLuma4SSE4(rgba + x * 4 + 32, coeffs), rgbaToLuma4SSE4(rgba + x * 4 + 48, coeffs));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(y + x), _mm_packus_epi16(first, second));
+    }
+    return x;
+}
+
+/*************/
+// Computes the chroma of two 2x2 blocks, returned as [U0, U1, V0, V1]
+SPLASH_TARGET_SSE4 inline __m128i rgbaToChroma4SSE4(const uint8_t* row0, const uint8_t* row1, __m128i uCoeffsVec, __m128i vCoeffsVec)
+{
+    const auto zero = _mm_setzero_si128();
+    auto pixels0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row0));
+    auto pixels1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row1));
+    auto low = _mm_add_epi16(_mm_cvtepu8_epi16(pixels0), _mm_cvtepu8_epi16(pixels1));
+    auto high = _mm_add_epi16(_mm_unpackhi_epi8(pixels0, zero), _mm_unpackhi_epi8(pixels1, zero));
+    low = _mm_add_epi16(low, _mm_srli_si128(low, 8));
+    high = _mm_add_epi16(high, _mm_srli_si128(high, 8));
+    auto mean = _mm_srli_epi16(_mm_add_epi16(_mm_unpacklo_epi64(low, high), _mm_set1_epi16(2)), 2);
+    auto chroma = _mm_hadd_epi32(_mm_madd_epi16(mean, uCoeffsVec), _mm_madd_epi16(mean, vCoeffsVec));
+    return _mm_add_epi32(_mm_srai_epi32(_mm_add_epi32(chroma, _mm_set1_epi32(128)), 8), _mm_set1_epi32(128));
+}
+
+/*************/
+SPLASH_TARGET_SSE4 uint32_t rgbaToChromaRowSSE4(const uint8_t* row0, const uint8_t* row1, bool bgra, uint8_t* u, uint8_t* v, uint32_t width)
+{
+    const auto uCoeffsVec = bgra ? _mm_setr_epi16(uCoeffs[2], uCoeffs[1], uCoeffs[0], 0, uCoeffs[2], uCoeffs[1], uCoeffs[0], 0)
+                                 : _mm_setr_epi16(uCoeffs[0], uCoeffs[1], uCoeffs[2], 0, uCoeffs[0], uCoeffs[1], uCoeffs[2], 0);
+    const auto vCoeffsVec = bgra ? _mm_setr_epi16(vCoeffs[2], vCoeffs[1], vCoeffs[0], 0, vCoeffs[2], vCoeffs[1], vCoeffs[0], 0)
+                                 : _mm_setr_epi16(vCoeffs[0], vCoeffs[1], vCoeffs[2], 0, vCoeffs[0], vCoeffs[1], vCoeffs[2], 0);
+    uint32_t x = 0;
+    for (; x + 8 <= width; x += 8)
+    {
+        auto first = rgbaToChroma4SSE4(row0 + x * 4, row1 + x * 4, uCoeffsVec, vCoeffsVec);
+        auto second = rgbaToChroma4SSE4(row0 + x * 4 + 16, row1 + x * 4 + 16, uCoeffsVec, vCoeffsVec);
+        auto chroma = _mm_packus_epi16(_mm_packus_epi32(_mm_unpacklo_epi64(first, second), _mm_unpackhi_epi64(first, second)), _mm_setzero_si128());
+        auto uValues = _mm_cvtsi128_si32(chroma);
+        auto vValues = _mm_cvtsi128_si32(_mm_srli_si128(chroma, 4));
+        memcpy(u + x / 2, &uValues, 4);
+        memcpy(v + x / 2, &vValues, 4);
+    }
+    return x;
+}
+
+/*************/
+SPLASH_TARGET_SSE4 uint32_t downscaleRowSSE4(const uint8_t* row0, const uint8_t* row1, uint8_t* out, uint32_t outWidth)
+{
+    uint32_t x = 0;
+    for (; x + 4 <= outWidth; x += 4)
+    {
+        auto first = _mm_avg_epu8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(row0 + x * 8)), _mm_loadu_si128(reinterpret_cast<const __m128i*>(row1 + x * 8)));
+        auto second = _mm_avg_epu8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(row0 + x * 8 + 16)), _mm_loadu_si128(reinterpret_cast<const __m128i*>(row1 + x * 8 + 16)));
+        auto even = _mm_castps_si128(_mm_shuffle_ps(_mm_castsi128_ps(first), _mm_castsi128_ps(second), _MM_SHUFFLE(2, 0, 2, 0)));
+        auto odd = _mm_castps_si128(_mm_shuffle_ps(_mm_castsi128_ps(first), _mm_castsi128_ps(second), _MM_SHUFFLE(3, 1, 3, 1)));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + x * 4), _mm_avg_epu8(even, odd));
+    }
+    return x;
+}
+
+/*************/
+SPLASH_TARGET_SSE4 size_t channelSumsSSE4(const uint8_t* rgba, size_t pixelCount, uint64_t sums[4])
+{
+    // Pixels are reordered as RRRRGGGGBBBBAAAA, then summed with SAD to get 64 bits accumulators
+    const auto shuffle = _mm_setr_epi8(0, 4, 8, 12, 1, 5, 9, 13, 2, 6, 10, 14, 3, 7, 11, 15);
+    const auto mask = _mm_setr_epi32(-1, 0, -1, 0);
+    const auto zero = _mm_setzero_si128();
+    auto redBlue = _mm_setzero_si128();
+    auto greenAlpha = _mm_setzero_si128();
+    size_t index = 0;
+    for (; index + 4 <= pixelCount; index += 4)
+    {
+        auto pixels = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(rgba + index * 4)), shuffle);
+        redBlue = _mm_add_epi64(redBlue, _mm_sad_epu8(_mm_and_si128(pixels, mask), zero));
+        greenAlpha = _mm_add_epi64(greenAlpha, _mm_sad_epu8(_mm_andnot_si128(mask, pixels), zero));
+    }
+
+    uint64_t values[4];
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(values), redBlue);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(values + 2), greenAlpha);
+    sums[0] += values[0];
+    sums[1] += values[2];
+    sums[2] += values[1];
+    sums[3] += values[3];
+    return index;
+}
+
+/*************/
+// AVX2 kernels
+/*************/
+SPLASH_TARGET_AVX2 uint32_t i420ToUyvyRowAVX2(const uint8_t* y, const uint8_t* u, const uint8_t* v, uint8_t* out, uint32_t width)
+{
+    uint32_t x = 0;
+    for (; x + 32 <= width; x += 32)
+    {
+        auto uValues = _mm_loadu_si128(reinterpret_cast<const __m128i*>(u + x / 2));
+        auto vValues = _mm_loadu_si128(reinterpret_cast<const __m128i*>(v + x / 2));
+        auto uv = _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_unpacklo_epi8(uValues, vValues)), _mm_unpackhi_epi8(uValues, vValues), 1);
+        auto luma = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(y + x));
+        auto low = _mm256_unpacklo_epi8(uv, luma);
+        auto high = _mm256_unpackhi_epi8(uv, luma);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + x * 2), _mm256_permute2x128_si256(low, high, 0x20));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + x * 2 + 32), _mm256_permute2x128_si256(low, high, 0x31));
+    }
+    return x;
+}
+
+/*************/
+SPLASH_TARGET_AVX2 uint32_t nv12ToUyvyRowAVX2(const uint8_t* y, const uint8_t* uv, uint8_t* out, uint32_t width)
+{
+    uint32_t x = 0;
+    for (; x + 32 <= width; x += 32)
+    {
+        auto chroma = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(uv + x));
+        auto luma = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(y + x));
+        auto low = _mm256_unpacklo_epi8(chroma, luma);
+        auto high = _mm256_unpackhi_epi8(chroma, luma);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + x * 2), _mm256_permute2x128_si256(low, high, 0x20));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + x * 2 + 32), _mm256_permute2x128_si256(low, high, 0x31));
+    }
+    return x;
+}
+
+/*************/
+SPLASH_TARGET_AVX2 size_t swapBytePairsAVX2(const uint8_t* in, uint8_t* out, size_t size)
+{
+    size_t index = 0;
+    for (; index + 32 <= size; index += 32)
+    {
+        auto pixels = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + index));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + index), _mm256_or_si256(_mm256_slli_epi16(pixels, 8), _mm256_srli_epi16(pixels, 8)));
+    }
+    return index;
+}
+
+/*************/
+SPLASH_TARGET_AVX2 size_t rgbToRgbaAVX2(const uint8_t* rgb, uint8_t* rgba, size_t pixelCount)
+{
+    const auto shuffle = _mm256_broadcastsi128_si256(_mm_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1));
+    const auto alpha = _mm256_set1_epi32(static_cast<int>(0xFF000000));
+    size_t index = 0;
+    for (; index + 10 <= pixelCount; index += 8)
+    {
+        auto low = _mm_loadu_si128(reinterpret_cast<const __m128i*>(rgb + index * 3));
+        auto high = _mm_loadu_si128(reinterpret_cast<const __m128i*>(rgb + index * 3 + 12));
+        auto pixels = _mm256_inserti128_si256(_mm256_castsi128_si256(low), high, 1);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(rgba + index * 4), _mm256_or_si256(_mm256_shuffle_epi8(pixels, shuffle), alpha));
+    }
+    return index;
+}
+
+/*************/
+SPLASH_TARGET_AVX2 size_t swapRedBlueAVX2(const uint8_t* in, uint8_t* out, size_t pixelCount)
+{
+    const auto shuffle = _mm256_broadcastsi128_si256(_mm_setr_epi8(2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15));
+    size_t index = 0;
+    for (; index + 8 <= pixelCount; index += 8)
+    {
+        auto pixels = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + index * 4));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + index * 4), _mm256_shuffle_epi8(pixels, shuffle));
+    }
+    return index;
+}
+
+/*************/
+SPLASH_TARGET_AVX2 uint32_t downscaleRowAVX2(const uint8_t* row0, const uint8_t* row1, uint8_t* out, uint32_t outWidth)
+{
+    uint32_t x = 0;
+    for (; x + 8 <= outWidth; x += 8)
+    {
+        auto first = _mm256_avg_epu8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(row0 + x * 8)), _mm256_loadu_si256(reinterpret_cast<const __m256i*>(row1 + x * 8)));
+        auto second =
+            _mm256_avg_epu8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(row0 + x * 8 + 32)), _mm256_loadu_si256(reinterpret_cast<const __m256i*>(row1 + x * 8 + 32)));
+        auto even = _mm256_castps_si256(_mm256_shuffle_ps(_mm256_castsi256_ps(first), _mm256_castsi256_ps(second), _MM_SHUFFLE(2, 0, 2, 0)));
+        auto odd = _mm256_castps_si256(_mm256_shuffle_ps(_mm256_castsi256_ps(first), _mm256_castsi256_ps(second), _MM_SHUFFLE(3, 1, 3, 1)));
+        // Shuffles work on 128 bits lanes, so the result has to be put back in order
+        auto result = _mm256_permute4x64_epi64(_mm256_avg_epu8(even, odd), _MM_SHUFFLE(3, 1, 2, 0));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + x * 4), result);
+    }
+    return x;
+}
+
+/*************/
+SPLASH_TARGET_AVX2 size_t channelSumsAVX2(const uint8_t* rgba, size_t pixelCount, uint64_t sums[4])
+{
+    const auto shuffle = _mm256_broadcastsi128_si256(_mm_setr_epi8(0, 4, 8, 12, 1, 5, 9, 13, 2, 6, 10, 14, 3, 7, 11, 15));
+    const auto mask = _mm256_setr_epi32(-1, 0, -1, 0, -1, 0, -1, 0);
+    const auto zero = _mm256_setzero_si256();
+    auto redBlue = _mm256_setzero_si256();
+    auto greenAlpha = _mm256_setzero_si256();
+    size_t index = 0;
+    for (; index + 8 <= pixelCount; index += 8)
+    {
+        auto pixels = _mm256_shuffle_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(rgba + index * 4)), shuffle);
+        redBlue = _mm256_add_epi64(redBlue, _mm256_sad_epu8(_mm256_and_si256(pixels, mask), zero));
+        greenAlpha = _mm256_add_epi64(greenAlpha, _mm256_sad_epu8(_mm256_andnot_si256(mask, pixels), zero));
+    }
+
+    uint64_t values[8];
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(values), redBlue);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(values + 4), greenAlpha);
+    sums[0] += values[0] + values[2];
+    sums[1] += values[4] + values[6];
+    sums[2] += values[1] + values[3];
+    sums[3] += values[5] + values[7];
+    return index;
+}
+#endif
+} // namespace
+
+/*************/
+SimdLevel getSupportedSimdLevel()
+{
+#if SPLASH_PIXELUTILS_X86
+    static const auto supportedLevel = []() {
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2"))
+            return SimdLevel::AVX2;
+        else if (__builtin_cpu_supports("sse4.1"))
+            return SimdLevel::SSE4;
+        else
+            return SimdLevel::Scalar;
+    }();
+    return supportedLevel;
+#else
+    return SimdLevel::Scalar;
+#endif
+}
+
+/*************/
+SimdLevel getSimdLevel()
+{
+    auto level = currentSimdLevel.load(memory_order_relaxed);
+    if (level < 0)
+    {
+        level = static_cast<int>(getSupportedSimdLevel());
+        currentSimdLevel.store(level, memory_order_relaxed);
+    }
+    return static_cast<SimdLevel>(level);
+}
+
+/*************/
+void setSimdLevel(SimdLevel level)
+{
+    currentSimdLevel.store(min(static_cast<int>(level), static_cast<int>(getSupportedSimdLevel())), memory_order_relaxed);
+}
+
+/*************/
+void i420ToUyvy(const uint8_t* y, const uint8_t* u, const uint8_t* v, uint8_t* uyvy, uint32_t width, uint32_t height)
+{
+#if SPLASH_PIXELUTILS_X86
+    auto level = getSimdLevel();
+#endif
+    for (uint32_t row = 0; row < height; ++row)
+    {
+        auto yRow = y + row * width;
+        auto uRow = u + (row / 2) * (width / 2);
+        auto vRow = v + (row / 2) * (width / 2);
+        auto outRow = uyvy + row * width * 2;
+
+        uint32_t x = 0;
+#if SPLASH_PIXELUTILS_X86
+        if (level == SimdLevel::AVX2)
+            x = i420ToUyvyRowAVX2(yRow, uRow, vRow, outRow, width);
+        else if (level == SimdLevel::SSE4)
+            x = i420ToUyvyRowSSE4(yRow, uRow, vRow, outRow, width);
+#endif
+        i420ToUyvyRowScalar(yRow, uRow, vRow, outRow, x, width);
+    }
+}
+
+/*************/
+void nv12ToUyvy(const uint8_t* y, const uint8_t* uv, uint8_t* uyvy, uint32_t width, uint32_t height)
+{
+#if SPLASH_PIXELUTILS_X86
+    auto level = getSimdLevel();
+#endif
+    for (uint32_t row = 0; row < height; ++row)
+    {
+        auto yRow = y + row * width;
+        auto uvRow = uv + (row / 2) * width;
+        auto outRow = uyvy + row * width * 2;
+
+        uint32_t x = 0;
+#if SPLASH_PIXELUTILS_X86
+        if (level == SimdLevel::AVX2)
+            x = nv12ToUyvyRowAVX2(yRow, uvRow, outRow, width);
+        else if (level == SimdLevel::SSE4)
+            x = nv12ToUyvyRowSSE4(yRow, uvRow, outRow, width);
+#endif
+        nv12ToUyvyRowScalar(yRow, uvRow, outRow, x, width);
+    }
+}
+
+/*************/
+void yuyvToUyvy(const uint8_t* yuyv, uint8_t* uyvy, uint32_t width, uint32_t height)
+{
+    auto size = static_cast<size_t>(width) * height * 2;
+    size_t index = 0;
+#if SPLASH_PIXELUTILS_X86
+    auto level = getSimdLevel();
+    if (level == SimdLevel::AVX2)
+        index = swapBytePairsAVX2(yuyv, uyvy, size);
+    else if (level == SimdLevel::SSE4)
+        index = swapBytePairsSSE4(yuyv, uyvy, size);
+#endif
+    swapBytePairsScalar(yuyv, uyvy, index, size);
+}
+
+/*************/
+void rgbaToI420(const uint8_t* rgba, bool bgra, uint32_t width, uint32_t height, uint8_t* y, int yStride, uint8_t* u, int uStride, uint8_t* v, int vStride)
+{
+#if SPLASH_PIXELUTILS_X86
+    auto level = getSimdLevel();
+#endif
+    for (uint32_t row = 0; row < height; ++row)
+    {
+        auto inRow = rgba + row * width * 4;
+        auto yRow = y + row * yStride;
+
+        uint32_t x = 0;
+#if SPLASH_PIXELUTILS_X86
+        if (level != SimdLevel::Scalar)
+            x = rgbaToLumaRowSSE4(inRow, bgra, yRow, width);
+#endif
+        rgbaToLumaRowScalar(inRow, bgra, yRow, x, width);
+
+        if (row % 2 == 0)
+        {
+            // At an odd height, the last row is used twice
+            auto nextRow = (row + 1 < height) ? inRow + width * 4 : inRow;
+            auto uRow = u + (row / 2) * uStride;
+            auto vRow = v + (row / 2) * vStride;
+            x = 0;
+#if SPLASH_PIXELUTILS_X86
+            if (level != SimdLevel::Scalar)
+                x = rgbaToChromaRowSSE4(inRow, nextRow, bgra, uRow, vRow, width);
+#endif
+            rgbaToChromaRowScalar(inRow, nextRow, bgra, uRow, vRow, x, width);
+        }
+    }
+}
+
+/*************/
+void rgbToRgba(const uint8_t* rgb, uint8_t* rgba, size_t pixelCount)
+{
+    size_t index = 0;
+#if SPLASH_PIXELUTILS_X86
+    auto level = getSimdLevel();
+    if (level == SimdLevel::AVX2)
+        index = rgbToRgbaAVX2(rgb, rgba, pixelCount);
+    else if (level == SimdLevel::SSE4)
+        index = rgbToRgbaSSE4(rgb, rgba, pixelCount);
+#endif
+    rgbToRgbaScalar(rgb, rgba, index, pixelCount);
+}
+
+/*************/
+void swapRedBlue(const uint8_t* in, uint8_t* out, size_t pixelCount)
+{
+    size_t index = 0;
+#if SPLASH_PIXELUTILS_X86
+    auto level = getSimdLevel();
+    if (level == SimdLevel::AVX2)
+        index = swapRedBlueAVX2(in, out, pixelCount);
+    else if (level == SimdLevel::SSE4)
+        index = swapRedBlueSSE4(in, out, pixelCount);
+#endif
+    swapRedBlueScalar(in, out, index, pixelCount);
+}
+
+/*************/
+void downscaleRgba2x(const uint8_t* rgba, uint32_t width, uint32_t height, uint8_t* out)
+{
+#if SPLASH_PIXELUTILS_X86
+    auto level = getSimdLevel();
+#endif
+    auto outWidth = width / 2;
+    auto outHeight = height / 2;
+    for (uint32_t row = 0; row < outHeight; ++row)
+    {
+        auto row0 = rgba + (row * 2) * width * 4;
+        auto row1 = row0 + width * 4;
+        auto outRow = out + row * outWidth * 4;
+
+        uint32_t x = 0;
+#if SPLASH_PIXELUTILS_X86
+        if (level == SimdLevel::AVX2)
+            x = downscaleRowAVX2(row0, row1, outRow, outWidth);
+        else if (level == SimdLevel::SSE4)
+            x = downscaleRowSSE4(row0, row1, outRow, outWidth);
+#endif
+        downscaleRowScalar(row0, row1, outRow, x, outWidth);
+    }
+}
+
+/*************/
+void channelSums(const uint8_t* rgba, size_t pixelCount, uint64_t sums[4])
+{
+    for (int c = 0; c < 4; ++c)
+        sums[c] = 0;
+
+    size_t index = 0;
+#if SPLASH_PIXELUTILS_X86
+    auto level = getSimdLevel();
+    if (level == SimdLevel::AVX2)
+        index = channelSumsAVX2(rgba, pixelCount, sums);
+    else if (level == SimdLevel::SSE4)
+        index = channelSumsSSE4(rgba, pixelCount, sums);
+#endif
+    channelSumsScalar(rgba, index, pixelCount, sums);
+}
+
+} // end of namespace
+} // end of namespace
@@ -0,0 +1,154 @@
+/*
+ * Copyright (C) 2018 Emmanuel Durand
+ *
+ * This file is part of Splash.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Splash is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Splash.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * @pixelutils.h
+ * Pixel format conversion kernels, with SIMD implementations selected at runtime
+ */
+
+#ifndef SPLASH_PIXELUTILS_H
+#define SPLASH_PIXELUTILS_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace Splash
+{
+namespace PixelUtils
+{
+
+/*************/
+// SIMD dispatch
+/*************/
+enum class SimdLevel : int
+{
+    Scalar = 0,
+    SSE4 = 1,
+    AVX2 = 2
+};
+
+/**
+ * \brief Get the best SIMD instruction set supported by the CPU
+ * \return Return the supported SIMD level
+ */
+SimdLevel getSupportedSimdLevel();
+
+/**
+ * \brief Get the SIMD instruction set currently used by the kernels
+ * \return Return the current SIMD level
+ */
+SimdLevel getSimdLevel();
+
+/**
+ * \brief Set the SIMD instruction set to use, clamped to what the CPU supports. Mostly useful for testing
+ * \param level SIMD level
+ */
+void setSimdLevel(SimdLevel level);
+
+/*************/
+// YUV conversions
+/*************/
+/**
+ * \brief Interleave planar I420 to packed UYVY. Width must be even
+ * \param y Luma plane, width * height
+ * \param u U plane, width / 2 * height / 2
+ * \param v V plane, width / 2 * height / 2
+ * \param uyvy Output buffer, width * height * 2
+ * \param width Image width
+ * \param height Image height
+ */
+void i420ToUyvy(const uint8_t* y, const uint8_t* u, const uint8_t* v, uint8_t* uyvy, uint32_t width, uint32_t height);
+
+/**
+ * \brief Interleave semi-planar NV12 to packed UYVY. Width must be even
+ * \param y Luma plane, width * height
+ * \param uv Interleaved chroma plane, width * height / 2
+ * \param uyvy Output buffer, width * height * 2
+ * \param width Image width
+ * \param height Image height
+ */
+void nv12ToUyvy(const uint8_t* y, const uint8_t* uv, uint8_t* uyvy, uint32_t width, uint32_t height);
+
+/**
+ * \brief Convert packed YUYV to packed UYVY. Also works the other way around
+ * \param yuyv Input buffer, width * height * 2
+ * \param uyvy Output buffer, width * height * 2
+ * \param width Image width
+ * \param height Image height
+ */
+void yuyvToUyvy(const uint8_t* yuyv, uint8_t* uyvy, uint32_t width, uint32_t height);
+
+/**
+ * \brief Convert RGBA (or BGRA) to planar I420, using BT.601 limited range coefficients. At odd sizes, the chroma of the last column and row is computed from them alone
+ * \param rgba Input buffer, width * height * 4
+ * \param bgra True if the input is BGRA
+ * \param width Image width
+ * \param height Image height
+ * \param y Luma plane
+ * \param yStride Luma plane stride in bytes
+ * \param u U plane
+ * \param uStride U plane stride in bytes
+ * \param v V plane
+ * \param vStride V plane stride in bytes
+ */
+void rgbaToI420(const uint8_t* rgba, bool bgra, uint32_t width, uint32_t height, uint8_t* y, int yStride, uint8_t* u, int uStride, uint8_t* v, int vStride);
+
+/*************/
+// RGB conversions
+/*************/
+/**
+ * \brief Expand RGB to RGBA, with an opaque alpha
+ * \param rgb Input buffer, pixelCount * 3
+ * \param rgba Output buffer, pixelCount * 4
+ * \param pixelCount Number of pixels
+ */
+void rgbToRgba(const uint8_t* rgb, uint8_t* rgba, size_t pixelCount);
+
+/**
+ * \brief Swap the red and blue channels, converting RGBA to BGRA or the other way around. Input and output can be the same buffer
+ * \param in Input buffer, pixelCount * 4
+ * \param out Output buffer, pixelCount * 4
+ * \param pixelCount Number of pixels
+ */
+void swapRedBlue(const uint8_t* in, uint8_t* out, size_t pixelCount);
+
+/*************/
+// Resampling and statistics
+/*************/
+/**
+ * \brief Downscale a RGBA image by a factor of two, averaging each 2x2 block
+ * \param rgba Input buffer, width * height * 4
+ * \param width Input width
+ * \param height Input height
+ * \param out Output buffer, (width / 2) * (height / 2) * 4
+ */
+void downscaleRgba2x(const uint8_t* rgba, uint32_t width, uint32_t height, uint8_t* out);
+
+/**
+ * \brief Sum each channel of a 4 channels, 8 bits image
+ * \param rgba Input buffer, pixelCount * 4
+ * \param pixelCount Number of pixels
+ * \param sums Output sums, one per channel
+ */
+void channelSums(const uint8_t* rgba, size_t pixelCount, uint64_t sums[4]);
+
+} // end of namespace
+} // end of namespace
+
+#endif // SPLASH_PIXELUTILS_H
@@ -0,0 +1,156 @@
+#include <doctest.h>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include "./mesh/bvh.h"
+#include "./utils/timer.h"
+
+using namespace std;
+using namespace Splash;
+
+/*************/
+TEST_CASE("Testing BVH closest vertex")
+{
+    mt19937 generator(42);
+    uniform_real_distribution<float> distribution(-10.f, 10.f);
+
+    vector<glm::vec4> vertices(10000);
+    for (auto& vertex : vertices)
+        vertex = glm::vec4(distribution(generator), distribution(generator), distribution(generator), 1.f);
+
+    Bvh bvh(vertices, {});
+
+    for (int i = 0; i < 100; ++i)
+    {
+        auto point = glm::vec3(distribution(generator), distribution(generator), distribution(generator));
+
+        float expectedDistance = numeric_limits<float>::max();
+        for (const auto& vertex : vertices)
+            expectedDistance = min(expectedDistance, glm::length(glm::vec3(vertex) - point));
+
+        glm::vec3 closestVertex;
+        auto distance = bvh.getClosestVertex(point, closestVertex);
+        CHECK(distance == doctest::Approx(expectedDistance));
+        CHECK(glm::length(closestVertex - point) == doctest::Approx(expectedDistance));
+    }
+
+    glm::vec3 vertex;
+    CHECK(Bvh({}, {}).getClosestVertex(glm::vec3(0.f), vertex) == numeric_limits<float>::max());
+}
+
+/*************/
+TEST_CASE("Testing BVH ray intersection")
+{
+    // A grid of 100 x 100 quads in the z = 0 plane, from (0, 0) to (1, 1), with a bump in its middle
+    const int resolution = 101;
+    vector<glm::vec4> vertices;
+    vector<uint32_t> indices;
+    for (int v = 0; v < resolution; ++v)
+        for (int u = 0; u < resolution; ++u)
+            vertices.push_back(glm::vec4(u / 100.f, v / 100.f, (u == 50 && v == 50) ? 1.f : 0.f, 1.f));
+    for (int v = 0; v < resolution - 1; ++v)
+    {
+        for (int u = 0; u < resolution - 1; ++u)
+        {
+            uint32_t corner = u + v * resolution;
+            indices.insert(indices.end(), {corner, corner + 1, corner + resolution + 1, corner, corner + resolution + 1, corner + resolution});
+        }
+    }
+
+    Bvh bvh(vertices, indices);
+    glm::vec3 hit;
+
+    auto t = bvh.intersect(glm::vec3(0.25f, 0.75f, 2.f), glm::vec3(0.f, 0.f, -1.f), hit);
+    CHECK(t == doctest::Approx(2.f));
+    CHECK(hit[0] == doctest::Approx(0.25f));
+    CHECK(hit[1] == doctest::Approx(0.75f));
+    CHECK(hit[2] == doctest::Approx(0.f));
+
+    // The bump is hit before the plane behind it
+    t = bvh.intersect(glm::vec3(0.5f, 0.5f, 2.f), glm::vec3(0.f, 0.f, -2.f), hit);
+    CHECK(t == doctest::Approx(0.5f));
+    CHECK(hit[2] == doctest::Approx(1.f));
+
+    // Triangles are hit from both sides
+    t = bvh.intersect(glm::vec3(0.25f, 0.25f, -1.f), glm::vec3(0.f, 0.f, 1.f), hit);
+    CHECK(t == doctest::Approx(1.f));
+
+    CHECK(bvh.intersect(glm::vec3(2.f, 2.f, 1.f), glm::vec3(0.f, 0.f, -1.f), hit) == numeric_limits<float>::max());
+    CHECK(bvh.intersect(glm::vec3(0.25f, 0.25f, 1.f), glm::vec3(0.f, 0.f, 1.f), hit) == numeric_limits<float>::max());
+}
+
+/*************/
+TEST_CASE("Benchmarking BVH picking" * doctest::skip())
+{
+    // A grid of about 2M vertices, gently curved so that it is not flat along any axis
+    const int resolution = 1415;
+    vector<glm::vec4> vertices;
+    vector<uint32_t> indices;
+    vertices.reserve(resolution * resolution);
+    for (int v = 0; v < resolution; ++v)
+        for (int u = 0; u < resolution; ++u)
+        {
+            float x = static_cast<float>(u) / (resolution - 1) * 2.f - 1.f;
+            float y = static_cast<float>(v) / (resolution - 1) * 2.f - 1.f;
+            vertices.push_back(glm::vec4(x, y, 0.25f * (x * x + y * y), 1.f));
+        }
+    for (int v = 0; v < resolution - 1; ++v)
+    {
+        for (int u = 0; u < resolution - 1; ++u)
+        {
+            uint32_t corner = u + v * resolution;
+            indices.insert(indices.end(), {corner, corner + 1, corner + resolution + 1, corner, corner + resolution + 1, corner + resolution});
+        }
+    }
+
+    auto start = Timer::getTime();
+    Bvh bvh(vertices, indices);
+    MESSAGE("BVH build: " << (Timer::getTime() - start) / 1000 << "ms for " << vertices.size() << " vertices");
+
+    mt19937 generator(42);
+    uniform_real_distribution<float> distribution(-1.f, 1.f);
+    const int queryCount = 100;
+    // Picked points lie close to the visible surface
+    vector<glm::vec3> points;
+    for (int i = 0; i < queryCount; ++i)
+    {
+        float x = distribution(generator);
+        float y = distribution(generator);
+        points.push_back(glm::vec3(x, y, 0.25f * (x * x + y * y) + 0.01f * distribution(generator)));
+    }
+
+    // Closest vertex, through the BVH and with the linear scan it replaces
+    vector<float> distances;
+    glm::vec3 closestVertex;
+    start = Timer::getTime();
+    for (const auto& point : points)
+        distances.push_back(bvh.getClosestVertex(point, closestVertex));
+    auto bvhDuration = Timer::getTime() - start;
+
+    vector<float> expectedDistances;
+    start = Timer::getTime();
+    for (const auto& point : points)
+    {
+        float expectedDistance = numeric_limits<float>::max();
+        for (const auto& vertex : vertices)
+            expectedDistance = min(expectedDistance, glm::length(glm::vec3(vertex) - point));
+        expectedDistances.push_back(expectedDistance);
+    }
+    auto linearDuration = Timer::getTime() - start;
+
+    for (int i = 0; i < queryCount; ++i)
+        CHECK(distances[i] == doctest::Approx(expectedDistances[i]));
+    MESSAGE("Closest vertex: " << bvhDuration / queryCount << "us through the BVH, " << linearDuration / queryCount << "us with a linear scan");
+
+    // Ray casting, from above the grid
+    int hitCount = 0;
+    glm::vec3 hit;
+    start = Timer::getTime();
+    for (const auto& point : points)
+        if (bvh.intersect(glm::vec3(point[0], point[1], 2.f), glm::vec3(0.f, 0.f, -1.f), hit) != numeric_limits<float>::max())
+            ++hitCount;
+    auto rayDuration = Timer::getTime() - start;
+    CHECK(hitCount == queryCount);
+    MESSAGE("Ray intersection: " << rayDuration / queryCount << "us through the BVH");
+}
@@ -0,0 +1,156 @@
+#include <doctest.h>
+#include <cstdlib>
+#include <vector>
+
+#include "./utils/cgutils.h"
+
+using namespace std;
+using namespace Splash;
+
+/*************/
+// Reference DXT1 color block decoder
+void decodeColorBlock(const uint8_t* in, uint8_t* block)
+{
+    uint16_t color[2] = {static_cast<uint16_t>(in[0] | in[1] << 8), static_cast<uint16_t>(in[2] | in[3] << 8)};
+    int palette[4][3];
+    for (int p = 0; p < 2; ++p)
+    {
+        palette[p][0] = ((color[p] >> 11) & 31) * 255 / 31;
+        palette[p][1] = ((color[p] >> 5) & 63) * 255 / 63;
+        palette[p][2] = (color[p] & 31) * 255 / 31;
+    }
+
+    for (int c = 0; c < 3; ++c)
+    {
+        if (color[0] > color[1])
+        {
+            palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+            palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+        }
+        else
+        {
+            palette[2][c] = (palette[0][c] + palette[1][c]) / 2;
+            palette[3][c] = 0;
+        }
+    }
+
+    uint32_t indices = in[4] | in[5] << 8 | in[6] << 16 | static_cast<uint32_t>(in[7]) << 24;
+    for (int i = 0; i < 16; ++i)
+        for (int c = 0; c < 3; ++c)
+            block[i * 4 + c] = palette[(indices >> (2 * i)) & 3][c];
+}
+
+/*************/
+// Reference DXT5 alpha block decoder
+void decodeAlphaBlock(const uint8_t* in, uint8_t* block)
+{
+    int palette[8];
+    palette[0] = in[0];
+    palette[1] = in[1];
+    if (palette[0] > palette[1])
+    {
+        for (int p = 1; p < 7; ++p)
+            palette[p + 1] = ((7 - p) * palette[0] + p * palette[1]) / 7;
+    }
+    else
+    {
+        for (int p = 1; p < 5; ++p)
+            palette[p + 1] = ((5 - p) * palette[0] + p * palette[1]) / 5;
+        palette[6] = 0;
+        palette[7] = 255;
+    }
+
+    uint64_t indices = 0;
+    for (int b = 0; b < 6; ++b)
+        indices |= static_cast<uint64_t>(in[2 + b]) << (8 * b);
+    for (int i = 0; i < 16; ++i)
+        block[i * 4 + 3] = palette[(indices >> (3 * i)) & 7];
+}
+
+/*************/
+vector<uint8_t> decodeFrame(const vector<uint8_t>& compressed, unsigned int width, unsigned int height, bool withAlpha)
+{
+    vector<uint8_t> rgba(width * height * 4, 255);
+    const unsigned int blockSize = withAlpha ? 16 : 8;
+    uint8_t block[64];
+    for (unsigned int blockY = 0; blockY < height / 4; ++blockY)
+    {
+        for (unsigned int blockX = 0; blockX < width / 4; ++blockX)
+        {
+            auto in = compressed.data() + (blockY * (width / 4) + blockX) * blockSize;
+            if (withAlpha)
+            {
+                decodeAlphaBlock(in, block);
+                decodeColorBlock(in + 8, block);
+            }
+            else
+            {
+                decodeColorBlock(in, block);
+            }
+
+            for (unsigned int y = 0; y < 4; ++y)
+                for (unsigned int x = 0; x < 4; ++x)
+                    for (unsigned int c = 0; c < (withAlpha ? 4u : 3u); ++c)
+                        rgba[((blockY * 4 + y) * width + blockX * 4 + x) * 4 + c] = block[(y * 4 + x) * 4 + c];
+        }
+    }
+    return rgba;
+}
+
+/*************/
+TEST_CASE("Testing DXT compression round trip")
+{
+    const unsigned int width = 64;
+    const unsigned int height = 32;
+
+    // Smooth gradients, so that each block is close to a line in the color space
+    vector<uint8_t> rgba(width * height * 4);
+    for (unsigned int y = 0; y < height; ++y)
+    {
+        for (unsigned int x = 0; x < width; ++x)
+        {
+            auto pixel = &rgba[(y * width + x) * 4];
+            pixel[0] = x * 4;
+            pixel[1] = 255 - y * 8;
+            pixel[2] = 128;
+            pixel[3] = (x + y) * 2;
+        }
+    }
+
+    for (auto withAlpha : {false, true})
+    {
+        vector<uint8_t> compressed(width * height / (withAlpha ? 1 : 2));
+        REQUIRE(dxtCompressFrame(rgba.data(), width, height, withAlpha, compressed.data()));
+
+        auto decoded = decodeFrame(compressed, width, height, withAlpha);
+        int maxError = 0;
+        for (unsigned int i = 0; i < width * height; ++i)
+            for (unsigned int c = 0; c < (withAlpha ? 4u : 3u); ++c)
+                maxError = max(maxError, abs(static_cast<int>(decoded[i * 4 + c]) - static_cast<int>(rgba[i * 4 + c])));
+        CHECK(maxError <= 16);
+    }
+
+    // A uniform block is only affected by the 565 quantization
+    vector<uint8_t> uniform(16 * 4);
+    for (unsigned int i = 0; i < 16; ++i)
+    {
+        uniform[i * 4 + 0] = 200;
+        uniform[i * 4 + 1] = 100;
+        uniform[i * 4 + 2] = 50;
+        uniform[i * 4 + 3] = 77;
+    }
+    vector<uint8_t> compressed(16);
+    REQUIRE(dxtCompressFrame(uniform.data(), 4, 4, true, compressed.data()));
+    auto decoded = decodeFrame(compressed, 4, 4, true);
+    for (unsigned int i = 0; i < 16; ++i)
+    {
+        CHECK(abs(static_cast<int>(decoded[i * 4 + 0]) - 200) <= 4);
+        CHECK(abs(static_cast<int>(decoded[i * 4 + 1]) - 100) <= 2);
+        CHECK(abs(static_cast<int>(decoded[i * 4 + 2]) - 50) <= 4);
+        CHECK(decoded[i * 4 + 3] == 77);
+    }
+
+    // Sizes must be multiples of 4
+    CHECK(!dxtCompressFrame(rgba.data(), 6, 4, false, compressed.data()));
+    CHECK(!dxtCompressFrame(rgba.data(), 4, 6, false, compressed.data()));
+}
@@ -0,0 +1,88 @@
+#include <doctest.h>
+#include <algorithm>
+#include <cmath>
+
+#include "./image/decode_scheduler.h"
+
+using namespace std;
+using namespace Splash;
+
+/*************/
+TEST_CASE("Testing the decode threads allocation")
+{
+    auto& scheduler = DecodeScheduler::get();
+    auto previousReservedCores = scheduler.getReservedCores();
+    scheduler.setReservedCores({});
+
+    const int coreCount = scheduler.getDecodeCores().size();
+    const int halfCores = max(1, min(16, static_cast<int>(round(coreCount / 2.0))));
+    int first, second, third;
+
+    SUBCASE("A media alone gets half of the decode cores")
+    {
+        auto allocation = scheduler.registerMedia(&first, 1920, 1080, 30.f, false);
+        CHECK(allocation.threadCount == halfCores);
+        CHECK(!allocation.sliceThreading);
+
+        // Registering the same media again does not count its previous allocation
+        allocation = scheduler.registerMedia(&first, 1920, 1080, 30.f, true);
+        CHECK(allocation.threadCount == halfCores);
+        CHECK(allocation.sliceThreading);
+
+        scheduler.unregisterMedia(&first);
+    }
+
+    SUBCASE("New media only get the threads still available")
+    {
+        auto firstAllocation = scheduler.registerMedia(&first, 3840, 2160, 60.f, false);
+        auto secondAllocation = scheduler.registerMedia(&second, 3840, 2160, 60.f, false);
+        auto thirdAllocation = scheduler.registerMedia(&third, 3840, 2160, 60.f, false);
+
+        CHECK(firstAllocation.threadCount == halfCores);
+        CHECK(secondAllocation.threadCount == max(1, min(halfCores, coreCount - firstAllocation.threadCount)));
+        auto thirdShare = static_cast<int>(round(coreCount / 3.0));
+        CHECK(thirdAllocation.threadCount == max(1, min({16, thirdShare, coreCount - firstAllocation.threadCount - secondAllocation.threadCount})));
+        if (coreCount >= 2)
+            CHECK(firstAllocation.threadCount + secondAllocation.threadCount <= coreCount);
+
+        // Threads of unregistered media are given back
+        scheduler.unregisterMedia(&first);
+        scheduler.unregisterMedia(&second);
+        thirdAllocation = scheduler.registerMedia(&third, 3840, 2160, 60.f, false);
+        CHECK(thirdAllocation.threadCount == halfCores);
+
+        scheduler.unregisterMedia(&third);
+    }
+
+    SUBCASE("Lighter media get a smaller share")
+    {
+        auto firstAllocation = scheduler.registerMedia(&first, 3840, 2160, 60.f, false);
+        auto secondAllocation = scheduler.registerMedia(&second, 640, 360, 30.f, false);
+        CHECK(firstAllocation.threadCount == halfCores);
+        CHECK(secondAllocation.threadCount >= 1);
+        CHECK(secondAllocation.threadCount <= max(1, coreCount / 10));
+
+        scheduler.unregisterMedia(&first);
+        scheduler.unregisterMedia(&second);
+    }
+
+    SUBCASE("Reserved cores are not used for decoding")
+    {
+        scheduler.setReservedCores({0});
+        auto cores = scheduler.getDecodeCores();
+        if (coreCount > 1)
+        {
+            CHECK(static_cast<int>(cores.size()) == coreCount - 1);
+            CHECK(find(cores.begin(), cores.end(), 0) == cores.end());
+        }
+
+        // Decoders have to run somewhere
+        vector<int> allCores;
+        for (int core = 0; core < coreCount; ++core)
+            allCores.push_back(core);
+        scheduler.setReservedCores(allCores);
+        CHECK(static_cast<int>(scheduler.getDecodeCores().size()) == coreCount);
+    }
+
+    scheduler.setReservedCores(previousReservedCores);
+}
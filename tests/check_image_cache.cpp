@@ -0,0 +1,112 @@
+#include <doctest.h>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <thread>
+#include <unistd.h>
+
+#include "./image/image_cache.h"
+#include "./utils/osutils.h"
+
+using namespace std;
+using namespace Splash;
+
+/*************/
+string createSourceFile(const string& path, const string& content)
+{
+    ofstream file(path, ios::binary | ios::trunc);
+    file << content;
+    return path;
+}
+
+/*************/
+ImageBuffer createCacheImage(unsigned int size, char value)
+{
+    ImageBuffer image(ImageBufferSpec(size, size, 4, 32));
+    memset(image.data(), value, image.getSize());
+    return image;
+}
+
+/*************/
+size_t countCacheFiles(const string& path)
+{
+    size_t count = 0;
+    for (const auto& filename : Utils::listDirContent(path))
+        if (filename.find(".cache") != string::npos && filename.find(".tmp") == string::npos)
+            ++count;
+    return count;
+}
+
+/*************/
+TEST_CASE("Testing the image disk cache")
+{
+    char tmpPath[] = "/tmp/splash_image_cache_XXXXXX";
+    REQUIRE(mkdtemp(tmpPath) != nullptr);
+    const string root = string(tmpPath) + "/";
+
+    auto& cache = ImageCache::get();
+    auto previousCachePath = cache.getCachePath();
+    auto previousMaxSize = cache.getMaxSize();
+    cache.setCachePath(root + "cache/");
+
+    SUBCASE("Storing and loading images")
+    {
+        auto source = createSourceFile(root + "image.png", "first version");
+        auto image = createCacheImage(64, 42);
+
+        ImageBuffer loaded;
+        CHECK(!cache.load(source, false, loaded));
+        REQUIRE(cache.store(source, false, image));
+        REQUIRE(cache.load(source, false, loaded));
+        CHECK(loaded.getSpec() == image.getSpec());
+        CHECK(memcmp(loaded.data(), image.data(), image.getSize()) == 0);
+
+        // The compressed version is cached separately
+        CHECK(!cache.load(source, true, loaded));
+
+        // A modified source file invalidates the cached image
+        createSourceFile(source, "second, longer version");
+        CHECK(!cache.load(source, false, loaded));
+
+        // Missing source files are never cached
+        CHECK(!cache.store(root + "missing.png", false, image));
+    }
+
+    SUBCASE("Evicting the least recently used images")
+    {
+        auto image = createCacheImage(64, 1);
+        auto fileSize = image.getSize() + 4096;
+        cache.setMaxSize(fileSize * 2);
+
+        auto first = createSourceFile(root + "first.png", "first");
+        auto second = createSourceFile(root + "second.png", "second");
+        auto third = createSourceFile(root + "third.png", "third");
+
+        REQUIRE(cache.store(first, false, image));
+        this_thread::sleep_for(chrono::milliseconds(10));
+        REQUIRE(cache.store(second, false, image));
+        this_thread::sleep_for(chrono::milliseconds(10));
+
+        // Loading an image marks it as recently used
+        ImageBuffer loaded;
+        REQUIRE(cache.load(first, false, loaded));
+        this_thread::sleep_for(chrono::milliseconds(10));
+
+        REQUIRE(cache.store(third, false, image));
+        CHECK(countCacheFiles(root + "cache/") == 2);
+        CHECK(cache.load(first, false, loaded));
+        CHECK(!cache.load(second, false, loaded));
+        CHECK(cache.load(third, false, loaded));
+    }
+
+    cache.setCachePath(previousCachePath);
+    cache.setMaxSize(previousMaxSize);
+
+    for (const auto& directory : {root + "cache/", root})
+        for (const auto& filename : Utils::listDirContent(directory))
+            if (filename[0] != '.')
+                remove((directory + filename).c_str());
+    rmdir(tmpPath);
+}
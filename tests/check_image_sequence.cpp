@@ -0,0 +1,148 @@
+#include <doctest.h>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <thread>
+#include <unistd.h>
+
+#include "./image/image_sequence.h"
+#include "./utils/osutils.h"
+#include "./utils/timer.h"
+
+using namespace std;
+using namespace Splash;
+
+/*************/
+class Image_SequenceMock : public Image_Sequence
+{
+  public:
+    using Image_Sequence::findSequenceFiles;
+    using Image_Sequence::startReading;
+
+    Image_SequenceMock()
+        : Image_Sequence(nullptr)
+    {
+    }
+
+    // The reader threads call the overridden methods, so they are stopped before this class goes away
+    ~Image_SequenceMock() override { stopReading(); }
+
+    /**
+     * Get the index of the frame last shown
+     */
+    int64_t getShownFrame()
+    {
+        update();
+        auto image = get();
+        if (image.getSpec() != _spec)
+            return -1;
+        int64_t index;
+        memcpy(&index, image.data(), sizeof(index));
+        return index;
+    }
+
+    /**
+     * Wait for the given frame to be shown
+     */
+    bool waitForFrame(int64_t index)
+    {
+        auto start = Timer::getTime();
+        while (Timer::getTime() - start < 2000000)
+        {
+            if (getShownFrame() == index)
+                return true;
+            this_thread::sleep_for(chrono::milliseconds(5));
+        }
+        return false;
+    }
+
+  private:
+    const ImageBufferSpec _spec{16, 16, 4, 32};
+
+    int64_t getFrameCount() const final { return 100; }
+
+    bool readFrame(int64_t index, ImageBuffer& buffer) final
+    {
+        if (buffer.getSpec() != _spec)
+            buffer = ImageBuffer(_spec);
+        memcpy(buffer.data(), &index, sizeof(index));
+        return true;
+    }
+};
+
+/*************/
+TEST_CASE("Testing image sequence files lookup")
+{
+    char tmpPath[] = "/tmp/splash_image_sequence_XXXXXX";
+    REQUIRE(mkdtemp(tmpPath) != nullptr);
+    const string root = string(tmpPath) + "/";
+
+    for (const auto& filename : {"frame_1.png", "frame_2.png", "frame_10.png", "frame_009.png", "frame_a.png", "frame_5.jpg", "other_3.png", "take2_0001.png", "take2_0002.png"})
+        ofstream(root + filename) << "frame";
+
+    Image_SequenceMock sequence;
+
+    // Frames are sorted by their number, not alphabetically
+    auto files = sequence.findSequenceFiles(root + "frame_1.png");
+    REQUIRE(files.size() == 4);
+    CHECK(files[0] == root + "frame_1.png");
+    CHECK(files[1] == root + "frame_2.png");
+    CHECK(files[2] == root + "frame_009.png");
+    CHECK(files[3] == root + "frame_10.png");
+
+    CHECK(sequence.findSequenceFiles(root + "frame_%05d.png") == files);
+    CHECK(sequence.findSequenceFiles(root + "frame_42.png") == files);
+
+    // Only the last digit run is the frame number
+    files = sequence.findSequenceFiles(root + "take2_0001.png");
+    REQUIRE(files.size() == 2);
+    CHECK(files[0] == root + "take2_0001.png");
+    CHECK(files[1] == root + "take2_0002.png");
+
+    CHECK(sequence.findSequenceFiles(root + "frame_%s.png").empty());
+    CHECK(sequence.findSequenceFiles(root + "frame.png").empty());
+    CHECK(sequence.findSequenceFiles(root + "missing_1.png").empty());
+
+    for (const auto& filename : Utils::listDirContent(root))
+        if (filename[0] != '.')
+            remove((root + filename).c_str());
+    rmdir(tmpPath);
+}
+
+/*************/
+TEST_CASE("Testing image sequence frames order")
+{
+    Image_SequenceMock sequence;
+    sequence.setAttribute("framerate", {10});
+    sequence.setAttribute("pause", {1});
+    sequence.startReading();
+
+    // Paused, the sequence stays on its first frame
+    CHECK(sequence.waitForFrame(0));
+
+    // Seeking shows the frame at the given time, forward and backward
+    sequence.setAttribute("seek", {5.0f});
+    CHECK(sequence.waitForFrame(50));
+    sequence.setAttribute("seek", {2.0f});
+    CHECK(sequence.waitForFrame(20));
+    sequence.setAttribute("seek", {2.55f});
+    CHECK(sequence.waitForFrame(25));
+
+    // Once playing, frames are shown in order
+    sequence.setAttribute("framerate", {100});
+    sequence.setAttribute("seek", {0.f});
+    REQUIRE(sequence.waitForFrame(0));
+    sequence.setAttribute("pause", {0});
+    int64_t previousFrame = -1;
+    auto start = Timer::getTime();
+    while (Timer::getTime() - start < 300000)
+    {
+        auto frame = sequence.getShownFrame();
+        CHECK(frame >= previousFrame);
+        previousFrame = frame;
+        this_thread::sleep_for(chrono::milliseconds(5));
+    }
+    CHECK(previousFrame > 0);
+}
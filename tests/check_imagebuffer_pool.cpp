@@ -0,0 +1,94 @@
+#include <doctest.h>
+#include <memory>
+#include <vector>
+
+#include "./core/imagebuffer_pool.h"
+
+using namespace std;
+using namespace Splash;
+
+/*************/
+TEST_CASE("Testing the image buffer pool")
+{
+    auto pool = make_shared<ImageBufferPool>();
+    const auto spec = ImageBufferSpec(64, 32, 4, 32);
+    const auto otherSpec = ImageBufferSpec(32, 32, 4, 32);
+
+    SUBCASE("Acquiring and releasing buffers")
+    {
+        CHECK(pool->tryAcquire(spec) == nullptr);
+
+        auto buffer = pool->acquire(spec);
+        REQUIRE(buffer != nullptr);
+        CHECK(buffer->getSpec() == spec);
+        auto data = buffer->data();
+        pool->release(std::move(buffer));
+
+        // A buffer is only given back for the same spec
+        CHECK(pool->tryAcquire(otherSpec) == nullptr);
+        buffer = pool->tryAcquire(spec);
+        REQUIRE(buffer != nullptr);
+        CHECK(buffer->data() == data);
+        CHECK(pool->tryAcquire(spec) == nullptr);
+    }
+
+    SUBCASE("Sharing buffers")
+    {
+        auto buffer = pool->acquire(spec);
+        auto data = buffer->data();
+        auto shared = pool->share(std::move(buffer));
+        auto otherReference = shared;
+
+        shared.reset();
+        CHECK(pool->tryAcquire(spec) == nullptr);
+
+        // The buffer goes back to the pool once the last reference is released
+        otherReference.reset();
+        buffer = pool->tryAcquire(spec);
+        REQUIRE(buffer != nullptr);
+        CHECK(buffer->data() == data);
+
+        // Releasing a shared buffer after the pool is destroyed only frees it
+        auto otherPool = make_shared<ImageBufferPool>();
+        shared = otherPool->share(std::move(buffer));
+        otherPool.reset();
+        shared.reset();
+    }
+
+    SUBCASE("Bounding the number of free buffers")
+    {
+        vector<unique_ptr<ImageBuffer>> buffers;
+        vector<char*> data;
+        for (int i = 0; i < 6; ++i)
+        {
+            buffers.push_back(pool->acquire(spec));
+            data.push_back(buffers.back()->data());
+        }
+        for (auto& buffer : buffers)
+            pool->release(std::move(buffer));
+
+        // Only the 4 most recently released buffers are kept
+        vector<char*> keptData;
+        while (auto buffer = pool->tryAcquire(spec))
+            keptData.push_back(buffer->data());
+        CHECK(keptData == vector<char*>(data.begin() + 2, data.end()));
+
+        auto smallPool = make_shared<ImageBufferPool>(1);
+        smallPool->release(smallPool->acquire(spec));
+        smallPool->release(smallPool->acquire(otherSpec));
+        CHECK(smallPool->tryAcquire(spec) == nullptr);
+        CHECK(smallPool->tryAcquire(otherSpec) != nullptr);
+    }
+
+    SUBCASE("External buffers are not kept")
+    {
+        vector<char> memory(spec.rawSize());
+        bool released = false;
+        auto external = unique_ptr<ImageBuffer>(new ImageBuffer(spec, ResizableArray<char>(memory.data(), memory.size(), [&]() { released = true; })));
+        REQUIRE(external->isExternal());
+
+        pool->release(std::move(external));
+        CHECK(released);
+        CHECK(pool->tryAcquire(spec) == nullptr);
+    }
+}
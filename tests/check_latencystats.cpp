@@ -0,0 +1,44 @@
+#include <doctest.h>
+
+#include "./utils/latencystats.h"
+
+using namespace std;
+using namespace Splash;
+
+/*************/
+TEST_CASE("Testing LatencyStats")
+{
+    LatencyStats stats;
+    CHECK(stats.getPercentile(0.5f) == 0.f);
+
+    // 90 samples at 10ms, 10 samples at 120ms
+    for (int i = 0; i < 90; ++i)
+        stats.addSample(10000);
+    for (int i = 0; i < 10; ++i)
+        stats.addSample(120000);
+
+    auto histogram = stats.getHistogram();
+    CHECK(histogram.size() == LatencyStats::getBucketBounds().size() + 1);
+    CHECK(histogram[3] == 90);
+    CHECK(histogram[9] == 10);
+
+    CHECK(stats.getLast() == doctest::Approx(120.f));
+    CHECK(stats.getMean() == doctest::Approx(21.f));
+    CHECK(stats.getMax() == doctest::Approx(120.f));
+    CHECK(stats.getPercentile(0.5f) == doctest::Approx(16.f));
+    CHECK(stats.getPercentile(0.95f) == doctest::Approx(120.f));
+
+    // Samples above the last bound go to the last bucket
+    stats.addSample(2000000);
+    CHECK(stats.getHistogram().back() == 1);
+
+    stats.addDropped(3);
+    stats.addDuplicated();
+    CHECK(stats.getDroppedCount() == 3);
+    CHECK(stats.getDuplicatedCount() == 1);
+
+    stats.reset();
+    CHECK(stats.getMax() == 0.f);
+    CHECK(stats.getDroppedCount() == 0);
+    CHECK(stats.getHistogram()[3] == 0);
+}
@@ -0,0 +1,160 @@
+#include <doctest.h>
+#include <cstring>
+#include <mutex>
+#include <vector>
+
+#include "./mesh/mesh.h"
+
+using namespace std;
+using namespace Splash;
+
+/*************/
+class MeshMock : public Mesh
+{
+  public:
+    using Mesh::computeUpdatedRanges;
+    using Mesh::MeshContainer;
+    using Mesh::mergeRanges;
+
+    MeshMock()
+        : Mesh(nullptr)
+    {
+    }
+
+    void setQuantized(bool quantized) { _quantizePartialUpdates = quantized; }
+
+    void setMesh(const MeshContainer& mesh, const vector<VertexRange>* ranges = nullptr)
+    {
+        lock_guard<shared_timed_mutex> lock(_writeMutex);
+        _bufferMesh = make_shared<MeshContainer>(mesh);
+        setBufferMeshUpdated(ranges);
+    }
+};
+
+/*************/
+MeshMock::MeshContainer createGrid(int size)
+{
+    MeshMock::MeshContainer mesh;
+    for (int y = 0; y < size; ++y)
+    {
+        for (int x = 0; x < size; ++x)
+        {
+            mesh.vertices.push_back(glm::vec4(static_cast<float>(x), static_cast<float>(y), 0.f, 1.f));
+            mesh.uvs.push_back(glm::vec2(static_cast<float>(x) / size, static_cast<float>(y) / size));
+            mesh.normals.push_back(glm::vec3(0.f, 0.f, 1.f));
+        }
+    }
+
+    for (int y = 0; y < size - 1; ++y)
+    {
+        for (int x = 0; x < size - 1; ++x)
+        {
+            uint32_t index = x + y * size;
+            mesh.indices.insert(mesh.indices.end(), {index, index + 1, index + size});
+            mesh.indices.insert(mesh.indices.end(), {index + 1, index + size + 1, index + size});
+        }
+    }
+
+    return mesh;
+}
+
+/*************/
+TEST_CASE("Testing mesh updated ranges")
+{
+    auto from = createGrid(16);
+    auto to = from;
+    auto ranges = MeshMock::computeUpdatedRanges(from, to);
+    CHECK(ranges.empty());
+
+    // Ranges separated by a few vertices are merged
+    to.vertices[2].z = 1.f;
+    to.uvs[3] = glm::vec2(0.5f, 0.5f);
+    to.normals[30] = glm::vec3(1.f, 0.f, 0.f);
+    to.vertices[40].x = 2.f;
+    to.vertices[100].y = 2.f;
+    ranges = MeshMock::computeUpdatedRanges(from, to);
+    REQUIRE(ranges.size() == 3);
+    CHECK(ranges[0].first == 2);
+    CHECK(ranges[0].count == 2);
+    CHECK(ranges[1].first == 30);
+    CHECK(ranges[1].count == 11);
+    CHECK(ranges[2].first == 100);
+    CHECK(ranges[2].count == 1);
+}
+
+/*************/
+TEST_CASE("Testing mesh ranges merging")
+{
+    vector<Mesh::VertexRange> ranges{{0, 2}, {10, 5}, {30, 1}};
+    MeshMock::mergeRanges(ranges, {{1, 3}, {15, 2}, {20, 4}});
+    REQUIRE(ranges.size() == 4);
+    CHECK(ranges[0].first == 0);
+    CHECK(ranges[0].count == 4);
+    CHECK(ranges[1].first == 10);
+    CHECK(ranges[1].count == 7);
+    CHECK(ranges[2].first == 20);
+    CHECK(ranges[2].count == 4);
+    CHECK(ranges[3].first == 30);
+    CHECK(ranges[3].count == 1);
+
+    vector<Mesh::VertexRange> empty;
+    MeshMock::mergeRanges(empty, {{5, 5}});
+    REQUIRE(empty.size() == 1);
+    CHECK(empty[0].first == 5);
+    CHECK(empty[0].count == 5);
+}
+
+/*************/
+TEST_CASE("Testing mesh partial updates")
+{
+    for (auto quantized : {false, true})
+    {
+        MeshMock sender;
+        sender.setQuantized(quantized);
+        Mesh receiver(nullptr);
+
+        auto mesh = createGrid(8);
+        sender.setMesh(mesh);
+        sender.update();
+        receiver.deserialize(sender.serialize());
+        receiver.update();
+        CHECK(receiver.getVertCoords() == sender.getVertCoords());
+
+        mesh.vertices[10] = glm::vec4(3.5f, 1.25f, -2.f, 1.f);
+        mesh.vertices[11] = glm::vec4(4.5f, 1.5f, 2.f, 1.f);
+        mesh.uvs[11] = glm::vec2(0.25f, 0.75f);
+        mesh.normals[40] = glm::vec3(0.f, 1.f, 0.f);
+        vector<Mesh::VertexRange> ranges{{10, 2}, {40, 1}};
+        sender.setMesh(mesh, &ranges);
+        sender.update();
+
+        // Only the modified vertices are sent
+        auto obj = sender.serialize();
+        int marker;
+        memcpy(&marker, obj->data(), sizeof(marker));
+        CHECK(marker == -2);
+
+        REQUIRE(receiver.deserialize(obj));
+        receiver.update();
+
+        auto expectedVertices = sender.getVertCoords();
+        auto vertices = receiver.getVertCoords();
+        REQUIRE(vertices.size() == expectedVertices.size());
+        for (size_t i = 0; i < vertices.size(); ++i)
+            CHECK(vertices[i] == doctest::Approx(expectedVertices[i]).epsilon(0.001));
+
+        auto expectedUVs = sender.getUVCoords();
+        auto uvs = receiver.getUVCoords();
+        REQUIRE(uvs.size() == expectedUVs.size());
+        for (size_t i = 0; i < uvs.size(); ++i)
+            CHECK(uvs[i] == doctest::Approx(expectedUVs[i]).epsilon(0.001));
+
+        auto expectedNormals = sender.getNormals();
+        auto normals = receiver.getNormals();
+        REQUIRE(normals.size() == expectedNormals.size());
+        for (size_t i = 0; i < normals.size(); ++i)
+            CHECK(normals[i] == doctest::Approx(expectedNormals[i]).epsilon(0.001));
+
+        CHECK(receiver.getIndices() == sender.getIndices());
+    }
+}
@@ -0,0 +1,153 @@
+#include <doctest.h>
+#include <cmath>
+#include <vector>
+
+#include "./mesh/mesh_bezierpatch.h"
+
+using namespace std;
+using namespace Splash;
+
+/*************/
+class Mesh_BezierPatchMock : public Mesh_BezierPatch
+{
+  public:
+    using Mesh_BezierPatch::evaluateSurface;
+    using Mesh_BezierPatch::MeshContainer;
+    using Mesh_BezierPatch::moveControlPoint;
+    using Mesh_BezierPatch::updateBasis;
+    using Mesh_BezierPatch::updatePatch;
+
+    Mesh_BezierPatchMock(int width, int height, int resolution)
+        : Mesh_BezierPatch(nullptr)
+    {
+        _patchResolution = resolution;
+        createPatch(width, height);
+    }
+
+    void setControlPoint(int index, const glm::vec2& position) { _patch.vertices[index] = position; }
+    const glm::vec2& getControlPoint(int index) const { return _patch.vertices[index]; }
+    const vector<float>& getBasisX() const { return _basisX; }
+    const vector<float>& getBasisY() const { return _basisY; }
+    const vector<glm::vec2>& getSurface() const { return _surface; }
+    shared_ptr<MeshContainer> getBezierMesh() const { return _bezierMesh; }
+    shared_ptr<MeshContainer> getBezierMeshSpare() const { return _bezierMeshSpare; }
+};
+
+/*************/
+float bernstein(int degree, int index, float t)
+{
+    float binomial = 1.f;
+    for (int k = 1; k <= index; ++k)
+        binomial = binomial * (degree - index + k) / k;
+    return binomial * pow(t, index) * pow(1.f - t, degree - index);
+}
+
+/*************/
+float maxDistance(const vector<glm::vec2>& lhs, const vector<glm::vec2>& rhs)
+{
+    float distance = 0.f;
+    for (size_t i = 0; i < lhs.size(); ++i)
+        distance = max(distance, glm::length(lhs[i] - rhs[i]));
+    return distance;
+}
+
+/*************/
+TEST_CASE("Testing Bezier patch basis")
+{
+    const int resolution = 17;
+    for (auto size : {2, 3, 4, 7, 12})
+    {
+        Mesh_BezierPatchMock patch(size, size + 1, resolution);
+        patch.updateBasis();
+
+        const auto& basisX = patch.getBasisX();
+        const auto& basisY = patch.getBasisY();
+        REQUIRE(basisX.size() == static_cast<size_t>(resolution * size));
+        REQUIRE(basisY.size() == static_cast<size_t>(resolution * (size + 1)));
+
+        for (int s = 0; s < resolution; ++s)
+        {
+            float t = static_cast<float>(s) / static_cast<float>(resolution - 1);
+            for (int i = 0; i < size; ++i)
+                CHECK(basisX[s * size + i] == doctest::Approx(bernstein(size - 1, i, t)).epsilon(1e-4));
+            for (int i = 0; i < size + 1; ++i)
+                CHECK(basisY[s * (size + 1) + i] == doctest::Approx(bernstein(size, i, t)).epsilon(1e-4));
+        }
+    }
+}
+
+/*************/
+TEST_CASE("Testing Bezier patch delta updates")
+{
+    Mesh_BezierPatchMock patch(5, 4, 32);
+    patch.updateBasis();
+    patch.evaluateSurface();
+
+    // The surface of the default patch is the square it spans
+    auto surface = patch.getSurface();
+    CHECK(surface.front() == glm::vec2(-1.f, -1.f));
+    CHECK(surface.back() == glm::vec2(1.f, 1.f));
+
+    // Moving control points one at a time gives the same surface as a full evaluation
+    for (int move = 0; move < 40; ++move)
+    {
+        int index = (move * 7) % 20;
+        auto delta = glm::vec2(0.01f * static_cast<float>(move % 5) - 0.02f, 0.005f * static_cast<float>(move % 3));
+        patch.setControlPoint(index, patch.getControlPoint(index) + delta);
+        patch.moveControlPoint(index, delta);
+    }
+
+    surface = patch.getSurface();
+    patch.evaluateSurface();
+    CHECK(maxDistance(surface, patch.getSurface()) < 1e-5f);
+}
+
+/*************/
+TEST_CASE("Testing Bezier patch mesh updates")
+{
+    const int resolution = 16;
+    Mesh_BezierPatchMock patch(4, 4, resolution);
+    patch.updatePatch();
+
+    auto getMeshPositions = [&](const shared_ptr<Mesh_BezierPatchMock::MeshContainer>& mesh) {
+        vector<glm::vec2> positions;
+        for (const auto& vertex : mesh->vertices)
+            positions.push_back(glm::vec2(vertex.x, vertex.y));
+        return positions;
+    };
+
+    auto initialMesh = patch.getBezierMesh();
+    REQUIRE(initialMesh != nullptr);
+    REQUIRE(initialMesh->vertices.size() == static_cast<size_t>(resolution * resolution));
+    CHECK(maxDistance(getMeshPositions(initialMesh), patch.getSurface()) == 0.f);
+    auto initialPositions = getMeshPositions(initialMesh);
+    auto initialMeshPtr = initialMesh.get();
+    initialMesh.reset();
+
+    // A few moved points go through the delta update, which matches a full evaluation
+    patch.setControlPoint(5, glm::vec2(-0.2f, -0.4f));
+    patch.setControlPoint(10, glm::vec2(0.5f, 0.1f));
+    patch.updatePatch();
+    auto firstMesh = patch.getBezierMesh();
+    auto firstPositions = getMeshPositions(firstMesh);
+    patch.evaluateSurface();
+    CHECK(maxDistance(firstPositions, patch.getSurface()) < 1e-5f);
+
+    // The previous container is reused in place once nothing else holds it
+    auto firstMeshPtr = firstMesh.get();
+    firstMesh.reset();
+    patch.setControlPoint(5, glm::vec2(-0.3f, -0.3f));
+    patch.updatePatch();
+    CHECK(patch.getBezierMesh().get() == initialMeshPtr);
+    CHECK(patch.getBezierMeshSpare().get() == firstMeshPtr);
+
+    // A container still in use is left untouched
+    auto heldMesh = patch.getBezierMeshSpare();
+    patch.setControlPoint(10, glm::vec2(0.4f, 0.2f));
+    patch.updatePatch();
+    CHECK(patch.getBezierMesh() != heldMesh);
+    CHECK(getMeshPositions(heldMesh) == firstPositions);
+    patch.evaluateSurface();
+    CHECK(maxDistance(getMeshPositions(patch.getBezierMesh()), patch.getSurface()) < 1e-5f);
+    CHECK(getMeshPositions(patch.getBezierMesh()) != initialPositions);
+}
@@ -0,0 +1,241 @@
+#include <doctest.h>
+#include <cstdio>
+#include <fcntl.h>
+#include <fstream>
+#include <string>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+
+#include "./mesh/meshloader.h"
+
+using namespace std;
+using namespace Splash;
+
+/*************/
+TEST_CASE("Testing OBJ parsing")
+{
+    string obj = "# A comment\r\n"
+                 "o object\r\n"
+                 "v 0.0 0.0 0.0\r\n"
+                 "v 1.5 0 -2e-1\r\n"
+                 "v\t1 1 0 2\r\n"
+                 "v 0 1 0\r\n"
+                 "v -0.5 0.5 0\r\n"
+                 "vt 0.25 0.75\r\n"
+                 "vt 1 0\r\n"
+                 "vt 1 1\r\n"
+                 "vn 0 0 1\r\n"
+                 "s off\r\n"
+                 "f 1/1/1 2/2/1 3/3/1\r\n"
+                 "f 1//1 3//1 4//1 5//1\r\n"
+                 "f -5 -4 -3 -2 -1";
+
+    Loader::Obj loader;
+    REQUIRE(loader.parse(obj.data(), obj.size()));
+
+    // 1 triangle, a quad and a pentagon give 1 + 2 + 3 triangles
+    auto vertices = loader.getVertices();
+    auto uvs = loader.getUVs();
+    auto normals = loader.getNormals();
+    REQUIRE(vertices.size() == 18);
+    REQUIRE(uvs.size() == 18);
+    REQUIRE(normals.size() == 18);
+
+    CHECK(vertices[1] == glm::vec4(1.5f, 0.f, -0.2f, 1.f));
+    CHECK(vertices[2] == glm::vec4(1.f, 1.f, 0.f, 2.f));
+    CHECK(uvs[0] == glm::vec2(0.25f, 0.75f));
+    CHECK(uvs[3] == glm::vec2(0.f, 0.f));
+    CHECK(normals[0] == glm::vec3(0.f, 0.f, 1.f));
+
+    // Polygons are triangulated as fans
+    CHECK(vertices[4] == glm::vec4(1.f, 1.f, 0.f, 2.f));
+    CHECK(vertices[6] == vertices[3]);
+    CHECK(vertices[7] == glm::vec4(0.f, 1.f, 0.f, 1.f));
+    CHECK(vertices[8] == glm::vec4(-0.5f, 0.5f, 0.f, 1.f));
+    CHECK(vertices[15] == vertices[9]);
+    CHECK(vertices[17] == glm::vec4(-0.5f, 0.5f, 0.f, 1.f));
+}
+
+/*************/
+TEST_CASE("Testing OBJ parsing errors")
+{
+    Loader::Obj loader;
+
+    string noFace = "v 0 0 0\nv 1 0 0\nv 0 1 0\n";
+    CHECK(!loader.parse(noFace.data(), noFace.size()));
+
+    string outOfBounds = "v 0 0 0\nv 1 0 0\nv 0 1 0\nf 1 2 4\n";
+    CHECK(!loader.parse(outOfBounds.data(), outOfBounds.size()));
+
+    string missingUV = "v 0 0 0\nv 1 0 0\nv 0 1 0\nf 1/1 2/1 3/1\n";
+    CHECK(!loader.parse(missingUV.data(), missingUV.size()));
+
+    CHECK(!loader.load("/this/file/does/not/exist.obj"));
+}
+
+/*************/
+TEST_CASE("Testing OBJ loading of a large file")
+{
+    // Large enough to be split in multiple chunks, with relative indices crossing chunk boundaries
+    const int quadCount = 100000;
+    string obj;
+    for (int i = 0; i < quadCount; ++i)
+    {
+        obj += "v " + to_string(i) + " 0 0\n";
+        obj += "v " + to_string(i) + " 1 0\n";
+        obj += "v " + to_string(i) + ".5 1 0\n";
+        obj += "v " + to_string(i) + ".5 0 0\n";
+        obj += "vt 0.5 0.5\n";
+        if (i % 2)
+            obj += "f -4/-1 -3/-1 -2/-1 -1/-1\n";
+        else
+            obj += "f " + to_string(4 * i + 1) + "/" + to_string(i + 1) + " " + to_string(4 * i + 2) + "/" + to_string(i + 1) + " " + to_string(4 * i + 3) + "/" +
+                   to_string(i + 1) + " " + to_string(4 * i + 4) + "/" + to_string(i + 1) + "\n";
+    }
+
+    auto path = "/tmp/splash_check_meshloader_" + to_string(getpid()) + ".obj";
+    {
+        ofstream file(path, ios::binary);
+        file << obj;
+    }
+
+    Loader::Obj loader;
+    REQUIRE(loader.load(path));
+    remove(path.c_str());
+
+    auto vertices = loader.getVertices();
+    REQUIRE(vertices.size() == quadCount * 6);
+
+    bool allMatch = true;
+    for (int i = 0; i < quadCount; ++i)
+    {
+        auto x = static_cast<float>(i);
+        allMatch = allMatch && vertices[i * 6] == glm::vec4(x, 0.f, 0.f, 1.f);
+        allMatch = allMatch && vertices[i * 6 + 2] == glm::vec4(x + 0.5f, 1.f, 0.f, 1.f);
+        allMatch = allMatch && vertices[i * 6 + 5] == glm::vec4(x + 0.5f, 0.f, 0.f, 1.f);
+    }
+    CHECK(allMatch);
+    CHECK(loader.getUVs()[quadCount * 3] == glm::vec2(0.5f, 0.5f));
+}
+
+/*************/
+TEST_CASE("Testing OBJ indexed mesh")
+{
+    string obj = "v 0 0 0\n"
+                 "v 1 0 0\n"
+                 "v 1 1 0\n"
+                 "v 0 1 0\n"
+                 "vt 0 0\n"
+                 "vt 1 1\n"
+                 "f 1/1 2/1 3/1 4/1\n"
+                 "f 1/2 3/1 4/1\n";
+
+    Loader::Obj loader;
+    REQUIRE(loader.parse(obj.data(), obj.size()));
+
+    vector<glm::vec4> vertices;
+    vector<glm::vec2> uvs;
+    vector<glm::vec3> normals;
+    vector<uint32_t> indices;
+    loader.getIndexedMesh(vertices, uvs, normals, indices);
+
+    // Corners are shared unless their UV differs
+    REQUIRE(indices.size() == 9);
+    REQUIRE(vertices.size() == 5);
+    REQUIRE(uvs.size() == vertices.size());
+    REQUIRE(normals.size() == vertices.size());
+
+    CHECK(indices[0] == indices[3]);
+    CHECK(indices[2] == indices[4]);
+    CHECK(indices[6] != indices[0]);
+    CHECK(vertices[indices[6]] == vertices[indices[0]]);
+    CHECK(uvs[indices[6]] == glm::vec2(1.f, 1.f));
+
+    for (auto& normal : normals)
+        CHECK(normal == glm::vec3(0.f, 0.f, 1.f));
+}
+
+/*************/
+TEST_CASE("Testing binary mesh writing and loading")
+{
+    vector<glm::vec4> vertices{glm::vec4(-1.f, 0.f, 2.f, 1.f), glm::vec4(1.f, 0.5f, 2.f, 1.f), glm::vec4(0.f, 1.f, 2.f, 1.f), glm::vec4(0.25f, -1.f, 2.f, 1.f)};
+    vector<glm::vec2> uvs{glm::vec2(0.f, 0.f), glm::vec2(1.f, 0.f), glm::vec2(0.5f, 1.f), glm::vec2(0.5f, -1.f)};
+    vector<glm::vec3> normals(4, glm::vec3(0.f, 0.f, 1.f));
+    vector<uint32_t> indices{0, 1, 2, 0, 3, 1};
+
+    auto path = "/tmp/splash_check_meshloader_" + to_string(getpid()) + Loader::Binary::extension;
+    Loader::Binary::Source source;
+    source.mtime = 1234;
+    source.size = 5678;
+    source.hash = 9012;
+
+    REQUIRE(Loader::Binary::write(path, vertices, uvs, normals, indices, false, source));
+    Loader::Binary loader;
+    REQUIRE(loader.load(path));
+    CHECK(loader.getSource() == source);
+
+    vector<glm::vec4> loadedVertices;
+    vector<glm::vec2> loadedUVs;
+    vector<glm::vec3> loadedNormals;
+    vector<uint32_t> loadedIndices;
+    loader.getIndexedMesh(loadedVertices, loadedUVs, loadedNormals, loadedIndices);
+    CHECK(loadedVertices == vertices);
+    CHECK(loadedUVs == uvs);
+    CHECK(loadedNormals == normals);
+    CHECK(loadedIndices == indices);
+
+    // Quantized attributes are restored within the precision of 16 bits over the mesh bounds
+    REQUIRE(Loader::Binary::write(path, vertices, uvs, normals, indices, true, source));
+    REQUIRE(loader.load(path));
+    loader.getIndexedMesh(loadedVertices, loadedUVs, loadedNormals, loadedIndices);
+    remove(path.c_str());
+
+    REQUIRE(loadedVertices.size() == vertices.size());
+    bool allClose = true;
+    for (size_t i = 0; i < vertices.size(); ++i)
+    {
+        allClose = allClose && glm::length(loadedVertices[i] - vertices[i]) < 1e-4f;
+        allClose = allClose && glm::length(loadedUVs[i] - uvs[i]) < 1e-4f;
+        allClose = allClose && glm::length(loadedNormals[i] - normals[i]) < 1e-4f;
+    }
+    CHECK(allClose);
+    CHECK(loadedVertices[0][2] == 2.f);
+    CHECK(loadedIndices == indices);
+
+    // Truncated files are rejected
+    string truncated(100, '\0');
+    CHECK(!loader.parse(truncated.data(), truncated.size()));
+}
+
+/*************/
+TEST_CASE("Testing binary mesh source description")
+{
+    auto path = "/tmp/splash_check_meshloader_source_" + to_string(getpid()) + ".obj";
+    ofstream(path, ios::binary | ios::trunc) << "v 0 0 0\n";
+
+    Loader::Binary::Source source;
+    REQUIRE(Loader::Binary::getSource(path, source));
+    CHECK(source.size == 8);
+
+    Loader::Binary::Source sameSource;
+    REQUIRE(Loader::Binary::getSource(path, sameSource));
+    CHECK(sameSource == source);
+
+    // A file modified with the same size, and with its modification time restored, is detected through its content
+    ofstream(path, ios::binary | ios::trunc) << "v 1 0 0\n";
+    struct timespec times[2];
+    times[0].tv_sec = source.mtime / 1000000000;
+    times[0].tv_nsec = source.mtime % 1000000000;
+    times[1] = times[0];
+    REQUIRE(utimensat(AT_FDCWD, path.c_str(), times, 0) == 0);
+
+    Loader::Binary::Source modifiedSource;
+    REQUIRE(Loader::Binary::getSource(path, modifiedSource));
+    CHECK(modifiedSource.mtime == source.mtime);
+    CHECK(modifiedSource.size == source.size);
+    CHECK(!(modifiedSource == source));
+
+    remove(path.c_str());
+    CHECK(!Loader::Binary::getSource(path, source));
+}
@@ -0,0 +1,173 @@
+#include <doctest.h>
+#include <random>
+#include <vector>
+
+#include "./utils/pixelutils.h"
+
+using namespace std;
+using namespace Splash;
+
+/*************/
+vector<uint8_t> randomBuffer(size_t size)
+{
+    static mt19937 generator(42);
+    uniform_int_distribution<int> distribution(0, 255);
+    vector<uint8_t> buffer(size);
+    for (auto& value : buffer)
+        value = static_cast<uint8_t>(distribution(generator));
+    return buffer;
+}
+
+/*************/
+// Runs the given kernel with the scalar implementation, then with every supported SIMD implementation, and checks that results match
+template <typename T>
+void checkAgainstScalar(T kernel)
+{
+    auto supportedLevel = static_cast<int>(PixelUtils::getSupportedSimdLevel());
+
+    PixelUtils::setSimdLevel(PixelUtils::SimdLevel::Scalar);
+    auto reference = kernel();
+    for (int level = 1; level <= supportedLevel; ++level)
+    {
+        PixelUtils::setSimdLevel(static_cast<PixelUtils::SimdLevel>(level));
+        CHECK(kernel() == reference);
+    }
+
+    PixelUtils::setSimdLevel(PixelUtils::getSupportedSimdLevel());
+}
+
+/*************/
+TEST_CASE("Testing YUV interleaving kernels")
+{
+    for (uint32_t width : {2, 18, 64, 98, 1922})
+    {
+        for (uint32_t height : {2, 5, 64})
+        {
+            auto y = randomBuffer(width * height);
+            auto u = randomBuffer(width / 2 * (height + 1) / 2);
+            auto v = randomBuffer(width / 2 * (height + 1) / 2);
+            auto uv = randomBuffer(width * (height + 1) / 2);
+            auto yuyv = randomBuffer(width * height * 2);
+
+            checkAgainstScalar([&]() {
+                vector<uint8_t> out(width * height * 2);
+                PixelUtils::i420ToUyvy(y.data(), u.data(), v.data(), out.data(), width, height);
+                return out;
+            });
+
+            checkAgainstScalar([&]() {
+                vector<uint8_t> out(width * height * 2);
+                PixelUtils::nv12ToUyvy(y.data(), uv.data(), out.data(), width, height);
+                return out;
+            });
+
+            checkAgainstScalar([&]() {
+                vector<uint8_t> out(width * height * 2);
+                PixelUtils::yuyvToUyvy(yuyv.data(), out.data(), width, height);
+                return out;
+            });
+        }
+    }
+
+    // Check the layout against a known value
+    uint8_t y[4] = {1, 2, 3, 4};
+    uint8_t u[1] = {5};
+    uint8_t v[1] = {6};
+    uint8_t out[8];
+    PixelUtils::i420ToUyvy(y, u, v, out, 2, 2);
+    CHECK(vector<uint8_t>(out, out + 8) == vector<uint8_t>({5, 1, 6, 2, 5, 3, 6, 4}));
+}
+
+/*************/
+TEST_CASE("Testing RGB kernels")
+{
+    for (size_t pixelCount : {1, 7, 64, 1001, 65536})
+    {
+        auto rgb = randomBuffer(pixelCount * 3);
+        auto rgba = randomBuffer(pixelCount * 4);
+
+        checkAgainstScalar([&]() {
+            vector<uint8_t> out(pixelCount * 4);
+            PixelUtils::rgbToRgba(rgb.data(), out.data(), pixelCount);
+            return out;
+        });
+
+        checkAgainstScalar([&]() {
+            vector<uint8_t> out(pixelCount * 4);
+            PixelUtils::swapRedBlue(rgba.data(), out.data(), pixelCount);
+            return out;
+        });
+
+        checkAgainstScalar([&]() {
+            uint64_t sums[4];
+            PixelUtils::channelSums(rgba.data(), pixelCount, sums);
+            return vector<uint64_t>(sums, sums + 4);
+        });
+    }
+}
+
+/*************/
+TEST_CASE("Testing RGBA to I420 conversion")
+{
+    for (uint32_t width : {2, 17, 18, 64, 98, 1922})
+    {
+        for (uint32_t height : {2, 5, 6, 64})
+        {
+            auto rgba = randomBuffer(width * height * 4);
+            for (auto bgra : {false, true})
+            {
+                checkAgainstScalar([&]() {
+                    auto chromaWidth = (width + 1) / 2;
+                    auto chromaSize = chromaWidth * ((height + 1) / 2);
+                    vector<uint8_t> out(width * height + chromaSize * 2);
+                    PixelUtils::rgbaToI420(
+                        rgba.data(), bgra, width, height, out.data(), width, out.data() + width * height, chromaWidth, out.data() + width * height + chromaSize, chromaWidth);
+                    return out;
+                });
+            }
+        }
+    }
+
+    // White and black must map to the limits of the BT.601 range
+    vector<uint8_t> white(16, 255);
+    vector<uint8_t> black(16, 0);
+    uint8_t y[4], u, v;
+    PixelUtils::rgbaToI420(white.data(), false, 2, 2, y, 2, &u, 1, &v, 1);
+    CHECK(y[0] == 235);
+    CHECK(u == 128);
+    CHECK(v == 128);
+    PixelUtils::rgbaToI420(black.data(), false, 2, 2, y, 2, &u, 1, &v, 1);
+    CHECK(y[0] == 16);
+
+    // At odd sizes, the chroma of the last column and row is set too
+    vector<uint8_t> red(3 * 3 * 4);
+    for (size_t i = 0; i < red.size(); i += 4)
+    {
+        red[i] = 255;
+        red[i + 3] = 255;
+    }
+    uint8_t redY[9];
+    vector<uint8_t> redU(4, 0);
+    vector<uint8_t> redV(4, 0);
+    PixelUtils::rgbaToI420(red.data(), false, 3, 3, redY, 3, redU.data(), 2, redV.data(), 2);
+    CHECK(redU == vector<uint8_t>(4, redU[0]));
+    CHECK(redV == vector<uint8_t>(4, redV[0]));
+    CHECK(redV[0] == 240);
+}
+
+/*************/
+TEST_CASE("Testing RGBA downscaling")
+{
+    for (uint32_t width : {2, 9, 64, 130})
+    {
+        for (uint32_t height : {2, 7, 64})
+        {
+            auto rgba = randomBuffer(width * height * 4);
+            checkAgainstScalar([&]() {
+                vector<uint8_t> out((width / 2) * (height / 2) * 4);
+                PixelUtils::downscaleRgba2x(rgba.data(), width, height, out.data());
+                return out;
+            });
+        }
+    }
+}
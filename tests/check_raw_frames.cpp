@@ -0,0 +1,150 @@
+#include <doctest.h>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <unistd.h>
+#include <vector>
+
+#include "./image/image_raw.h"
+#include "./image/raw_frames.h"
+#include "./sink/sink_file.h"
+
+using namespace std;
+using namespace Splash;
+
+/*************/
+class Sink_FileMock : public Sink_File
+{
+  public:
+    using Sink_File::endRecording;
+    using Sink_File::handlePixels;
+
+    Sink_FileMock()
+        : Sink_File(nullptr)
+    {
+    }
+};
+
+/*************/
+class Image_RawMock : public Image_Raw
+{
+  public:
+    // Overridden privately by Image_Raw, the calls still go to its implementation
+    using Image_Sequence::getFrameCount;
+    using Image_Sequence::readFrame;
+
+    Image_RawMock()
+        : Image_Raw(nullptr)
+    {
+    }
+};
+
+/*************/
+vector<char> createFrame(const ImageBufferSpec& spec, int index)
+{
+    vector<char> frame(spec.rawSize());
+    for (size_t i = 0; i < frame.size(); ++i)
+        frame[i] = static_cast<char>(i * 7 + index * 13);
+    return frame;
+}
+
+/*************/
+TEST_CASE("Testing raw frames header")
+{
+    auto spec = ImageBufferSpec(1000, 500, 2, 16, ImageBufferSpec::Type::UINT8, "YUYV");
+    auto header = RawFrames::headerFromSpec(spec, 60.0);
+    CHECK(RawFrames::isValid(header));
+    CHECK(RawFrames::specFromHeader(header) == spec);
+    CHECK(header.frameSize == static_cast<uint64_t>(spec.rawSize()));
+    CHECK(header.framerate == 60.0);
+
+    auto badHeader = header;
+    badHeader.magic[0] = 'X';
+    CHECK(!RawFrames::isValid(badHeader));
+    badHeader = header;
+    badHeader.frameSize += 1;
+    CHECK(!RawFrames::isValid(badHeader));
+
+    CHECK(RawFrames::alignedSize(0) == 0);
+    CHECK(RawFrames::alignedSize(1) == RawFrames::alignment);
+    CHECK(RawFrames::alignedSize(RawFrames::alignment) == RawFrames::alignment);
+    CHECK(RawFrames::alignedSize(RawFrames::alignment + 1) == 2 * RawFrames::alignment);
+}
+
+/*************/
+TEST_CASE("Testing raw frames container round trip")
+{
+    if (!RawFrames::isLittleEndian())
+        return;
+
+    char tmpPath[] = "/tmp/splash_raw_frames_XXXXXX";
+    REQUIRE(mkdtemp(tmpPath) != nullptr);
+    const string path = string(tmpPath) + "/record.raw";
+
+    // The frame size is not a multiple of the alignment, and the frames do not fit in a single write batch
+    const auto spec = ImageBufferSpec(1000, 1000, 4, 32);
+    const int frameCount = 10;
+
+    for (auto directIO : {0, 1})
+    {
+        {
+            Sink_FileMock sink;
+            sink.setAttribute("directIO", {directIO});
+            sink.setAttribute("path", {path});
+            for (int i = 0; i < frameCount; ++i)
+            {
+                auto frame = createFrame(spec, i);
+                sink.handlePixels(frame.data(), spec);
+            }
+            // The index and header are written when the recording ends, which the destructor waits for
+            sink.endRecording();
+        }
+
+        RawFrames::Header header;
+        ifstream file(path, ios::binary);
+        REQUIRE(file.is_open());
+        file.read(reinterpret_cast<char*>(&header), sizeof(header));
+        REQUIRE(file.good());
+        REQUIRE(RawFrames::isValid(header));
+        CHECK(RawFrames::specFromHeader(header) == spec);
+        CHECK(header.frameCount == frameCount);
+        CHECK(header.framerate == 30.0);
+        CHECK(header.indexOffset == RawFrames::alignment + frameCount * RawFrames::alignedSize(header.frameSize));
+
+        vector<RawFrames::IndexEntry> index(header.frameCount);
+        file.seekg(header.indexOffset);
+        file.read(reinterpret_cast<char*>(index.data()), index.size() * sizeof(RawFrames::IndexEntry));
+        REQUIRE(file.good());
+        file.close();
+
+        CHECK(index[0].timing == 0);
+        for (size_t i = 0; i < index.size(); ++i)
+        {
+            CHECK(index[i].offset == RawFrames::alignment + i * RawFrames::alignedSize(header.frameSize));
+            if (i > 0)
+                CHECK(index[i].timing >= index[i - 1].timing);
+        }
+
+        Image_RawMock image;
+        image.setAttribute("directIO", {directIO});
+        REQUIRE(image.read(path));
+        REQUIRE(image.getFrameCount() == frameCount);
+        for (int i = 0; i < frameCount; ++i)
+        {
+            ImageBuffer buffer;
+            REQUIRE(image.readFrame(i, buffer));
+            CHECK(buffer.getSpec() == spec);
+            auto expected = createFrame(spec, i);
+            CHECK(memcmp(buffer.data(), expected.data(), expected.size()) == 0);
+        }
+    }
+
+    // A truncated container is rejected
+    REQUIRE(truncate(path.c_str(), RawFrames::alignment * 2) == 0);
+    Image_RawMock image;
+    CHECK(!image.read(path));
+
+    remove(path.c_str());
+    rmdir(tmpPath);
+}
@@ -68,3 +68,34 @@ TEST_CASE("Testing ResizableArray copy")
         for (int shift = 100; shift < 500; shift += 100)
             CHECK(checkCopy(size, shift) == size - shift);
 }
+
+/*************/
+TEST_CASE("Testing ResizableArray with an external buffer")
+{
+    vector<uint8_t> external(1000, 42);
+    int releaseCount = 0;
+
+    {
+        auto array = ResizableArray<uint8_t>(external.data(), external.size(), [&]() { ++releaseCount; });
+        CHECK(array.isExternal());
+        CHECK(array.data() == external.data());
+
+        // Moving keeps the buffer external, and releases it only once
+        auto movedArray = std::move(array);
+        CHECK(movedArray.data() == external.data());
+        CHECK(releaseCount == 0);
+
+        // Copying makes an owned copy
+        auto copiedArray = movedArray;
+        CHECK(!copiedArray.isExternal());
+        CHECK(copiedArray[999] == 42);
+    }
+    CHECK(releaseCount == 1);
+
+    // Resizing copies the data to an owned buffer, and releases the external one
+    auto array = ResizableArray<uint8_t>(external.data(), external.size(), [&]() { ++releaseCount; });
+    array.resize(2000);
+    CHECK(releaseCount == 2);
+    CHECK(!array.isExternal());
+    CHECK(array[999] == 42);
+}
@@ -0,0 +1,86 @@
+#include <doctest.h>
+#include <numeric>
+#include <thread>
+#include <vector>
+
+#include "./core/ring_buffer.h"
+
+using namespace std;
+using namespace Splash;
+
+/*************/
+TEST_CASE("Testing RingBuffer push and pop")
+{
+    RingBuffer<int> ring(100);
+    CHECK(ring.capacity() == 128);
+    CHECK(ring.getWriteSpace() == 128);
+    CHECK(ring.getReadSpace() == 0);
+
+    // Go around the buffer a few times, with a size which does not divide the capacity
+    vector<int> in(48);
+    vector<int> out(48);
+    for (int i = 0; i < 20; ++i)
+    {
+        iota(in.begin(), in.end(), i * 48);
+        CHECK(ring.push(in.data(), in.size()));
+        CHECK(ring.getReadSpace() == 48);
+        CHECK(ring.pop(out.data(), out.size()));
+        CHECK(out == in);
+    }
+
+    CHECK(ring.push(in.data(), in.size()));
+    CHECK(ring.push(in.data(), in.size()));
+    CHECK(!ring.push(in.data(), in.size()));
+    CHECK(!ring.pop(out.data(), 100));
+}
+
+/*************/
+TEST_CASE("Testing RingBuffer flush")
+{
+    RingBuffer<uint8_t> ring(16);
+    vector<uint8_t> in{1, 2, 3, 4};
+    vector<uint8_t> out(4);
+
+    ring.push(in.data(), in.size());
+    ring.push(in.data(), in.size());
+    ring.flush();
+
+    // Data written after the flush is kept
+    in = {5, 6, 7, 8};
+    ring.push(in.data(), in.size());
+    CHECK(ring.getReadSpace() == 4);
+    CHECK(ring.pop(out.data(), out.size()));
+    CHECK(out == in);
+}
+
+/*************/
+TEST_CASE("Testing RingBuffer with concurrent producer and consumer")
+{
+    RingBuffer<uint32_t> ring(1000);
+    const uint32_t count = 1 << 20;
+
+    auto producer = thread([&]() {
+        uint32_t value = 0;
+        while (value < count)
+        {
+            auto space = min<size_t>(ring.getWriteSpace(), count - value);
+            for (size_t i = 0; i < space; ++i, ++value)
+                ring.copyIn(i, &value, 1);
+            ring.commitWrite(space);
+        }
+    });
+
+    bool ordered = true;
+    uint32_t expected = 0;
+    while (expected < count)
+    {
+        uint32_t value;
+        if (!ring.pop(&value, 1))
+            continue;
+        ordered = ordered && (value == expected);
+        ++expected;
+    }
+    producer.join();
+
+    CHECK(ordered);
+}
@@ -0,0 +1,59 @@
+#include <doctest.h>
+#include <numeric>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+#include "./core/shared_frame_ring.h"
+
+using namespace std;
+using namespace Splash;
+
+/*************/
+TEST_CASE("Testing SharedFrameRing")
+{
+    auto name = "splash_check_ring_" + to_string(getpid());
+    auto writer = SharedFrameRing::create(name, 3, 1024);
+    REQUIRE(writer != nullptr);
+
+    auto reader = SharedFrameRing::open(name);
+    REQUIRE(reader != nullptr);
+    CHECK(reader->getSlotCount() == 3);
+    CHECK(reader->getSlotSize() >= 1024);
+
+    SharedFrameRing::Frame frame;
+    CHECK(!reader->getLastFrame(frame));
+
+    auto spec = ImageBufferSpec(16, 16, 4, 32, ImageBufferSpec::Type::UINT8, "RGBA");
+    vector<uint8_t> pixels(spec.rawSize());
+    for (uint8_t value = 1; value <= 4; ++value)
+    {
+        iota(pixels.begin(), pixels.end(), value);
+        CHECK(writer->writeFrame(pixels.data(), pixels.size(), spec, value * 1000) == value);
+    }
+    CHECK(writer->writeFrame(pixels.data(), 2048, spec, 0) == 0);
+
+    // The last frame is read in place
+    REQUIRE(reader->getLastFrame(frame));
+    CHECK(frame.sequence == 4);
+    CHECK(frame.timestamp == 4000);
+    CHECK(frame.spec == spec);
+    CHECK(vector<uint8_t>(frame.data, frame.data + frame.size) == pixels);
+    CHECK(reader->isFrameValid(frame));
+
+    // Frames older than the ring size are gone
+    CHECK(reader->getFrame(2, frame));
+    CHECK(!reader->getFrame(1, frame));
+    CHECK(!reader->getFrame(5, frame));
+
+    // Overwriting a frame invalidates it for the readers still holding it
+    REQUIRE(reader->getFrame(2, frame));
+    writer->writeFrame(pixels.data(), pixels.size(), spec, 0);
+    CHECK(!reader->isFrameValid(frame));
+
+    // Readers keep their mapping once the writer is gone
+    writer.reset();
+    CHECK(reader->isClosed());
+    CHECK(reader->getLastFrame(frame));
+    CHECK(SharedFrameRing::open(name) == nullptr);
+}